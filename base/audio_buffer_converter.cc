@@ -191,8 +191,9 @@ void AudioBufferConverter::ConvertIfPossible() {
       kSampleFormatPlanarF32, output_params_.channel_layout(),
       output_params_.channels(), output_params_.sample_rate(), request_frames,
       pool_);
-  std::unique_ptr<AudioBus> output_bus =
-      AudioBus::CreateWrapper(output_buffer->channel_count());
+  if (!output_bus_)
+    output_bus_ = AudioBus::CreateWrapper(output_buffer->channel_count());
+  DCHECK_EQ(output_bus_->channels(), output_buffer->channel_count());
 
   int frames_remaining = request_frames;
 
@@ -209,16 +210,16 @@ void AudioBufferConverter::ConvertIfPossible() {
 
     // Wrap the portion of the AudioBuffer in an AudioBus so the AudioConverter
     // can fill it.
-    output_bus->set_frames(frames_this_iteration);
+    output_bus_->set_frames(frames_this_iteration);
     for (int ch = 0; ch < output_buffer->channel_count(); ++ch) {
-      output_bus->SetChannelData(
+      output_bus_->SetChannelData(
           ch,
           reinterpret_cast<float*>(output_buffer->channel_data()[ch]) +
               offset_into_buffer);
     }
 
     // Do the actual conversion.
-    audio_converter_->Convert(output_bus.get());
+    audio_converter_->Convert(output_bus_.get());
     frames_remaining -= frames_this_iteration;
     buffered_input_frames_ -= frames_this_iteration * io_sample_rate_ratio_;
   }
@@ -103,6 +103,10 @@ class MEDIA_EXPORT AudioBufferConverter : public AudioConverter::InputCallback {
 
   // The AudioConverter which does the real work here.
   std::unique_ptr<AudioConverter> audio_converter_;
+
+  // Wrapper used to slide over each output AudioBuffer; reused across calls to
+  // avoid an allocation per conversion.
+  std::unique_ptr<AudioBus> output_bus_;
 };
 
 }  // namespace media
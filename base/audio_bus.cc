@@ -52,6 +52,15 @@ static void ValidateConfig(int channels, int frames) {
   CHECK_LE(channels, static_cast<int>(limits::kMaxChannels));
 }
 
+// Fills |channels| with the channel pointers of |bus| advanced by |offset|
+// frames, for handing to the vector_math interleaving functions.
+template <class Bus, typename Sample>
+static void GetChannelPointers(Bus* bus, int offset, Sample* channels[]) {
+  DCHECK_LE(bus->channels(), static_cast<int>(limits::kMaxChannels));
+  for (int ch = 0; ch < bus->channels(); ++ch)
+    channels[ch] = bus->channel(ch) + offset;
+}
+
 void AudioBus::CheckOverflow(int start_frame, int frames, int total_frames) {
   CHECK_GE(start_frame, 0);
   CHECK_GE(frames, 0);
@@ -351,6 +360,66 @@ void AudioBus::ToInterleavedPartial(int start_frame,
   }
 }
 
+void AudioBus::DeinterleaveVectorized(const float* source_buffer,
+                                      int write_offset_in_frames,
+                                      int num_frames_to_write,
+                                      AudioBus* dest) {
+  float* channels[limits::kMaxChannels];
+  GetChannelPointers(dest, write_offset_in_frames, channels);
+  vector_math::Deinterleave(source_buffer, dest->channels(),
+                            num_frames_to_write, channels);
+}
+
+void AudioBus::DeinterleaveVectorized(const int16_t* source_buffer,
+                                      int write_offset_in_frames,
+                                      int num_frames_to_write,
+                                      AudioBus* dest) {
+  float* channels[limits::kMaxChannels];
+  GetChannelPointers(dest, write_offset_in_frames, channels);
+  vector_math::DeinterleaveS16(source_buffer, dest->channels(),
+                               num_frames_to_write, channels);
+}
+
+void AudioBus::DeinterleaveVectorized(const int32_t* source_buffer,
+                                      int write_offset_in_frames,
+                                      int num_frames_to_write,
+                                      AudioBus* dest) {
+  float* channels[limits::kMaxChannels];
+  GetChannelPointers(dest, write_offset_in_frames, channels);
+  vector_math::DeinterleaveS32(source_buffer, dest->channels(),
+                               num_frames_to_write, channels);
+}
+
+void AudioBus::InterleaveVectorized(const AudioBus* source,
+                                    int read_offset_in_frames,
+                                    int num_frames_to_read,
+                                    float* dest_buffer) {
+  const float* channels[limits::kMaxChannels];
+  GetChannelPointers(source, read_offset_in_frames, channels);
+  vector_math::InterleaveAndClamp(channels, source->channels(),
+                                  num_frames_to_read, dest_buffer);
+}
+
+void AudioBus::InterleaveVectorized(const AudioBus* source,
+                                    int read_offset_in_frames,
+                                    int num_frames_to_read,
+                                    int16_t* dest_buffer) {
+  const float* channels[limits::kMaxChannels];
+  GetChannelPointers(source, read_offset_in_frames, channels);
+  vector_math::InterleaveS16(channels, source->channels(), num_frames_to_read,
+                             dest_buffer);
+}
+
+void AudioBus::InterleaveVectorized(const AudioBus* source,
+                                    int read_offset_in_frames,
+                                    int num_frames_to_read,
+                                    int32_t* dest_buffer) {
+  const float* channels[limits::kMaxChannels];
+  GetChannelPointers(source, read_offset_in_frames, channels);
+  vector_math::InterleaveS32(channels, source->channels(), num_frames_to_read,
+                             dest_buffer);
+}
+
 void AudioBus::CopyTo(AudioBus* dest) const {
   dest->set_is_bitstream_format(is_bitstream_format());
   if (is_bitstream_format()) {
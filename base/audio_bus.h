@@ -12,6 +12,7 @@
 
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
+#include "media/base/audio_sample_types.h"
 #include "media/base/media_shmem_export.h"
 
 namespace media {
@@ -217,6 +218,33 @@ class MEDIA_SHMEM_EXPORT AudioBus {
       int num_frames_to_read,
       typename TargetSampleTypeTraits::ValueType* dest_buffer);
 
+  // Vectorized conversions backing the specializations of the two methods above
+  // for the commonly used sample formats.
+  static void DeinterleaveVectorized(const float* source_buffer,
+                                     int write_offset_in_frames,
+                                     int num_frames_to_write,
+                                     AudioBus* dest);
+  static void DeinterleaveVectorized(const int16_t* source_buffer,
+                                     int write_offset_in_frames,
+                                     int num_frames_to_write,
+                                     AudioBus* dest);
+  static void DeinterleaveVectorized(const int32_t* source_buffer,
+                                     int write_offset_in_frames,
+                                     int num_frames_to_write,
+                                     AudioBus* dest);
+  static void InterleaveVectorized(const AudioBus* source,
+                                   int read_offset_in_frames,
+                                   int num_frames_to_read,
+                                   float* dest_buffer);
+  static void InterleaveVectorized(const AudioBus* source,
+                                   int read_offset_in_frames,
+                                   int num_frames_to_read,
+                                   int16_t* dest_buffer);
+  static void InterleaveVectorized(const AudioBus* source,
+                                   int read_offset_in_frames,
+                                   int num_frames_to_read,
+                                   int32_t* dest_buffer);
+
   // Contiguous block of channel memory.
   std::unique_ptr<float, base::AlignedFreeDeleter> data_;
 
@@ -280,8 +308,7 @@ void AudioBus::ToInterleavedPartial(
       this, read_offset_in_frames, num_frames_to_read, dest);
 }
 
-// TODO(chfremer): Consider using vector instructions to speed this up,
-//                 https://crbug.com/619628
+// Float32, SignedInt16 and SignedInt32 have vectorized specializations below.
 template <class SourceSampleTypeTraits>
 void AudioBus::CopyConvertFromInterleavedSourceToAudioBus(
     const typename SourceSampleTypeTraits::ValueType* source_buffer,
@@ -302,8 +329,7 @@ void AudioBus::CopyConvertFromInterleavedSourceToAudioBus(
   }
 }
 
-// TODO(chfremer): Consider using vector instructions to speed this up,
-//                 https://crbug.com/619628
+// Float32, SignedInt16 and SignedInt32 have vectorized specializations below.
 template <class TargetSampleTypeTraits>
 void AudioBus::CopyConvertFromAudioBusToInterleavedTarget(
     const AudioBus* source,
@@ -323,6 +349,72 @@ void AudioBus::CopyConvertFromAudioBusToInterleavedTarget(
   }
 }
 
+template <>
+inline void AudioBus::CopyConvertFromInterleavedSourceToAudioBus<
+    Float32SampleTypeTraits>(
+    const float* source_buffer,
+    int write_offset_in_frames,
+    int num_frames_to_write,
+    AudioBus* dest) {
+  DeinterleaveVectorized(source_buffer, write_offset_in_frames,
+                         num_frames_to_write, dest);
+}
+
+template <>
+inline void AudioBus::CopyConvertFromInterleavedSourceToAudioBus<
+    SignedInt16SampleTypeTraits>(
+    const int16_t* source_buffer,
+    int write_offset_in_frames,
+    int num_frames_to_write,
+    AudioBus* dest) {
+  DeinterleaveVectorized(source_buffer, write_offset_in_frames,
+                         num_frames_to_write, dest);
+}
+
+template <>
+inline void AudioBus::CopyConvertFromInterleavedSourceToAudioBus<
+    SignedInt32SampleTypeTraits>(
+    const int32_t* source_buffer,
+    int write_offset_in_frames,
+    int num_frames_to_write,
+    AudioBus* dest) {
+  DeinterleaveVectorized(source_buffer, write_offset_in_frames,
+                         num_frames_to_write, dest);
+}
+
+template <>
+inline void AudioBus::CopyConvertFromAudioBusToInterleavedTarget<
+    Float32SampleTypeTraits>(
+    const AudioBus* source,
+    int read_offset_in_frames,
+    int num_frames_to_read,
+    float* dest_buffer) {
+  InterleaveVectorized(source, read_offset_in_frames, num_frames_to_read,
+                       dest_buffer);
+}
+
+template <>
+inline void AudioBus::CopyConvertFromAudioBusToInterleavedTarget<
+    SignedInt16SampleTypeTraits>(
+    const AudioBus* source,
+    int read_offset_in_frames,
+    int num_frames_to_read,
+    int16_t* dest_buffer) {
+  InterleaveVectorized(source, read_offset_in_frames, num_frames_to_read,
+                       dest_buffer);
+}
+
+template <>
+inline void AudioBus::CopyConvertFromAudioBusToInterleavedTarget<
+    SignedInt32SampleTypeTraits>(
+    const AudioBus* source,
+    int read_offset_in_frames,
+    int num_frames_to_read,
+    int32_t* dest_buffer) {
+  InterleaveVectorized(source, read_offset_in_frames, num_frames_to_read,
+                       dest_buffer);
+}
+
 }  // namespace media
 
 #endif  // MEDIA_BASE_AUDIO_BUS_H_
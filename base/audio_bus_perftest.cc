@@ -4,9 +4,13 @@
 
 #include <stdint.h>
 #include <memory>
+#include <string>
 
 #include "base/time/time.h"
 #include "media/base/audio_bus.h"
+#include "media/base/audio_bus_pool.h"
+#include "media/base/audio_converter.h"
+#include "media/base/audio_parameters.h"
 #include "media/base/audio_sample_types.h"
 #include "media/base/fake_audio_render_callback.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -40,16 +44,88 @@ void RunInterleaveBench(AudioBus* bus, const std::string& trace_name) {
                          true);
 }
 
-// Benchmark the FromInterleaved() and ToInterleaved() methods.
+// Benchmark the FromInterleaved() and ToInterleaved() methods for the common
+// channel layouts, which have vectorized versions.
 TEST(AudioBusPerfTest, Interleave) {
-  std::unique_ptr<AudioBus> bus = AudioBus::Create(2, kSampleRate * 120);
-  FakeAudioRenderCallback callback(0.2, kSampleRate);
-  callback.Render(base::TimeDelta(), base::TimeTicks::Now(), 0, bus.get());
-
-  // Only benchmark these two types since they're the only commonly used ones.
-  RunInterleaveBench<int16_t, SignedInt16SampleTypeTraits>(bus.get(),
-                                                           "int16_t");
-  RunInterleaveBench<float, Float32SampleTypeTraits>(bus.get(), "float");
+  static const struct {
+    int channels;
+    const char* name;
+  } kLayouts[] = {{1, "mono"}, {2, "stereo"}, {6, "5.1"}};
+  for (const auto& layout : kLayouts) {
+    std::unique_ptr<AudioBus> bus =
+        AudioBus::Create(layout.channels, kSampleRate * 120 / layout.channels);
+    FakeAudioRenderCallback callback(0.2, kSampleRate);
+    callback.Render(base::TimeDelta(), base::TimeTicks::Now(), 0, bus.get());
+
+    // Only benchmark these types since they're the only commonly used ones.
+    const std::string name = layout.name;
+    RunInterleaveBench<int16_t, SignedInt16SampleTypeTraits>(
+        bus.get(), name + "_int16_t");
+    RunInterleaveBench<int32_t, SignedInt32SampleTypeTraits>(
+        bus.get(), name + "_int32_t");
+    RunInterleaveBench<float, Float32SampleTypeTraits>(bus.get(),
+                                                       name + "_float");
+  }
+}
+
+static const int kConverterIterations = 10000;
+
+// InputCallback that zeros out the provided AudioBus.
+class NullInputProvider : public AudioConverter::InputCallback {
+ public:
+  NullInputProvider() {}
+  ~NullInputProvider() override {}
+
+  double ProvideInput(AudioBus* audio_bus, uint32_t frames_delayed) override {
+    audio_bus->Zero();
+    return 1;
+  }
+};
+
+// Creates an AudioConverter which mixes two 5.1 inputs down to stereo, converts
+// one buffer and destroys it, as happens on stream and device changes.  When
+// |use_free_buses| is false the pool is cleared before each converter, so every
+// temporary bus is allocated as it would be without a pool.
+static void RunConverterRecreationBench(bool use_free_buses,
+                                        const std::string& trace_name) {
+  const AudioParameters input_params(AudioParameters::AUDIO_PCM_LINEAR,
+                                     CHANNEL_LAYOUT_5_1, kSampleRate, 16, 480);
+  const AudioParameters output_params(AudioParameters::AUDIO_PCM_LINEAR,
+                                      CHANNEL_LAYOUT_STEREO, kSampleRate, 16,
+                                      480);
+  std::unique_ptr<AudioBus> output_bus = AudioBus::Create(output_params);
+  NullInputProvider input1;
+  NullInputProvider input2;
+
+  AudioBusPool::ClearCurrentThread();
+  const int allocations = AudioBusPool::GetAllocationCount();
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kConverterIterations; ++i) {
+    if (!use_free_buses)
+      AudioBusPool::ClearCurrentThread();
+    AudioConverter converter(input_params, output_params, true);
+    converter.AddInput(&input1);
+    converter.AddInput(&input2);
+    converter.Convert(output_bus.get());
+    converter.RemoveInput(&input1);
+    converter.RemoveInput(&input2);
+  }
+  const double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult("audio_converter_recreation", "", trace_name,
+                         kConverterIterations / total_time_milliseconds,
+                         "runs/ms", true);
+  perf_test::PrintResult(
+      "audio_converter_recreation_allocations", "", trace_name,
+      static_cast<size_t>(AudioBusPool::GetAllocationCount() - allocations),
+      "allocations", false);
+}
+
+// Benchmark recreating converters with and without reusing the temporary mixing
+// and down mixing buses of earlier converters.
+TEST(AudioBusPerfTest, ConverterRecreation) {
+  RunConverterRecreationBench(false, "unpooled");
+  RunConverterRecreationBench(true, "pooled");
 }
 
 }  // namespace media
@@ -0,0 +1,217 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/audio_bus_pool.h"
+
+#include <iterator>
+#include <utility>
+
+#include "base/atomicops.h"
+#include "base/containers/circular_deque.h"
+#include "base/logging.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace media {
+
+namespace {
+
+using BusList = base::circular_deque<std::unique_ptr<AudioBus>>;
+
+// Frees the oldest buses of |buses| beyond AudioBusPool::kMaxFreeBuses by
+// moving them to |evicted_buses|, so the caller can free them outside any lock.
+void TrimBusList(BusList* buses, BusList* evicted_buses) {
+  while (buses->size() > AudioBusPool::kMaxFreeBuses) {
+    evicted_buses->push_back(std::move(buses->front()));
+    buses->pop_front();
+  }
+}
+
+volatile base::subtle::Atomic32 g_allocation_count = 0;
+
+}  // namespace
+
+// The free buses of one thread, in the order they were released.  Buses
+// released on the owning thread go straight to |buses_|, which only the owning
+// thread touches.  Other threads add theirs to |returned_buses_|, which the
+// owning thread collects when it can take |returned_lock_| without waiting.
+class AudioBusFreeList
+    : public base::RefCountedThreadSafe<AudioBusFreeList> {
+ public:
+  AudioBusFreeList() {}
+
+  // Called on the owning thread.
+  std::unique_ptr<AudioBus> Take(int channels, int frames) {
+    std::unique_ptr<AudioBus> bus = TakeFrom(&buses_, channels, frames);
+    if (bus || !CollectReturnedBuses())
+      return bus;
+    return TakeFrom(&buses_, channels, frames);
+  }
+
+  // Called on the owning thread.
+  void Add(std::unique_ptr<AudioBus> bus) {
+    BusList evicted_buses;
+    buses_.push_back(std::move(bus));
+    TrimBusList(&buses_, &evicted_buses);
+  }
+
+  // Called on any other thread.
+  void AddReturned(std::unique_ptr<AudioBus> bus) {
+    BusList evicted_buses;
+    base::AutoLock auto_lock(returned_lock_);
+    returned_buses_.push_back(std::move(bus));
+    TrimBusList(&returned_buses_, &evicted_buses);
+  }
+
+  // Called on the owning thread.
+  void Clear() {
+    BusList buses;
+    buses.swap(buses_);
+
+    BusList returned_buses;
+    base::AutoLock auto_lock(returned_lock_);
+    returned_buses.swap(returned_buses_);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<AudioBusFreeList>;
+  ~AudioBusFreeList() {}
+
+  // Prefers the most recently released bus, which is the most likely to still
+  // be in cache.
+  static std::unique_ptr<AudioBus> TakeFrom(BusList* buses,
+                                            int channels,
+                                            int frames) {
+    for (auto it = buses->rbegin(); it != buses->rend(); ++it) {
+      if ((*it)->channels() != channels || (*it)->frames() != frames)
+        continue;
+      std::unique_ptr<AudioBus> bus = std::move(*it);
+      buses->erase(std::next(it).base());
+      return bus;
+    }
+    return nullptr;
+  }
+
+  // Moves the buses other threads have returned to |buses_|, unless one of
+  // them holds |returned_lock_|.  Returns whether any were moved.
+  bool CollectReturnedBuses() {
+    if (!returned_lock_.Try())
+      return false;
+    BusList returned_buses;
+    returned_buses.swap(returned_buses_);
+    returned_lock_.Release();
+    if (returned_buses.empty())
+      return false;
+
+    BusList evicted_buses;
+    for (auto& bus : returned_buses)
+      buses_.push_back(std::move(bus));
+    TrimBusList(&buses_, &evicted_buses);
+    return true;
+  }
+
+  BusList buses_;
+
+  base::Lock returned_lock_;
+  BusList returned_buses_;
+
+  DISALLOW_COPY_AND_ASSIGN(AudioBusFreeList);
+};
+
+namespace {
+
+void ReleaseFreeList(void* free_list) {
+  static_cast<AudioBusFreeList*>(free_list)->Clear();
+  static_cast<AudioBusFreeList*>(free_list)->Release();
+}
+
+base::ThreadLocalStorage::Slot* GetSlot() {
+  // Leaked on purpose; each thread's reference to its free list is dropped as
+  // the thread exits.
+  static base::ThreadLocalStorage::Slot* slot =
+      new base::ThreadLocalStorage::Slot(&ReleaseFreeList);
+  return slot;
+}
+
+}  // namespace
+
+AudioBusPool::ScopedAudioBus::ScopedAudioBus() {}
+
+AudioBusPool::ScopedAudioBus::ScopedAudioBus(
+    std::unique_ptr<AudioBus> bus,
+    scoped_refptr<AudioBusFreeList> free_list)
+    : bus_(std::move(bus)), free_list_(std::move(free_list)) {}
+
+AudioBusPool::ScopedAudioBus::ScopedAudioBus(ScopedAudioBus&& other)
+    : bus_(std::move(other.bus_)), free_list_(std::move(other.free_list_)) {}
+
+AudioBusPool::ScopedAudioBus& AudioBusPool::ScopedAudioBus::operator=(
+    ScopedAudioBus&& other) {
+  if (this != &other) {
+    reset();
+    bus_ = std::move(other.bus_);
+    free_list_ = std::move(other.free_list_);
+  }
+  return *this;
+}
+
+AudioBusPool::ScopedAudioBus::~ScopedAudioBus() {
+  reset();
+}
+
+void AudioBusPool::ScopedAudioBus::reset() {
+  if (bus_)
+    AudioBusPool::Release(std::move(bus_), std::move(free_list_));
+}
+
+// static
+AudioBusPool::ScopedAudioBus AudioBusPool::Acquire(int channels, int frames) {
+  AudioBusFreeList* free_list =
+      static_cast<AudioBusFreeList*>(GetSlot()->Get());
+  if (!free_list) {
+    free_list = new AudioBusFreeList();
+    free_list->AddRef();
+    GetSlot()->Set(free_list);
+  }
+
+  std::unique_ptr<AudioBus> bus = free_list->Take(channels, frames);
+  if (!bus) {
+    base::subtle::NoBarrier_AtomicIncrement(&g_allocation_count, 1);
+    bus = AudioBus::Create(channels, frames);
+  }
+  return ScopedAudioBus(std::move(bus), free_list);
+}
+
+// static
+void AudioBusPool::Release(std::unique_ptr<AudioBus> bus,
+                           scoped_refptr<AudioBusFreeList> free_list) {
+  DCHECK(free_list);
+
+  // Undo any per-use state so the next user sees a bus just like Create()'s.
+  if (bus->is_bitstream_format()) {
+    bus->SetBitstreamDataSize(0);
+    bus->SetBitstreamFrames(0);
+    bus->set_is_bitstream_format(false);
+  }
+
+  if (GetSlot()->Get() == free_list.get())
+    free_list->Add(std::move(bus));
+  else
+    free_list->AddReturned(std::move(bus));
+}
+
+// static
+void AudioBusPool::ClearCurrentThread() {
+  AudioBusFreeList* free_list =
+      static_cast<AudioBusFreeList*>(GetSlot()->Get());
+  if (free_list)
+    free_list->Clear();
+}
+
+// static
+int AudioBusPool::GetAllocationCount() {
+  return base::subtle::NoBarrier_Load(&g_allocation_count);
+}
+
+}  // namespace media
@@ -0,0 +1,89 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_AUDIO_BUS_POOL_H_
+#define MEDIA_BASE_AUDIO_BUS_POOL_H_
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "media/base/audio_bus.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+class AudioBusFreeList;
+
+// AudioBusPool recycles the AudioBus allocations made by code which creates and
+// drops temporary buses while rendering or decoding.  Each thread keeps its own
+// free buses, matched on (channels, frames), and a bus always goes back to the
+// thread which acquired it.  That thread never waits for a lock, so the pool
+// can be used on the real-time audio thread: buses released on other threads,
+// e.g. when a converter is destroyed on the main thread, are handed back under
+// a lock which the acquiring thread only ever tries to take.
+//
+// Sample usage:
+//   AudioBusPool::ScopedAudioBus bus = AudioBusPool::Acquire(2, 480);
+//   bus->Zero();
+//   ...
+//   // |bus| goes back to the pool here.
+class MEDIA_EXPORT AudioBusPool {
+ public:
+  // Maximum number of free buses kept per thread, of any shape; once there are
+  // more, the least recently released one is freed.
+  enum { kMaxFreeBuses = 16 };
+
+  // Move-only owner of a pooled AudioBus which returns the bus to the pool when
+  // destroyed or reset.
+  class MEDIA_EXPORT ScopedAudioBus {
+   public:
+    ScopedAudioBus();
+    ScopedAudioBus(ScopedAudioBus&& other);
+    ScopedAudioBus& operator=(ScopedAudioBus&& other);
+    ~ScopedAudioBus();
+
+    AudioBus* get() const { return bus_.get(); }
+    AudioBus* operator->() const { return bus_.get(); }
+    AudioBus& operator*() const { return *bus_; }
+    explicit operator bool() const { return !!bus_; }
+
+    // Returns the bus (if any) to the pool.
+    void reset();
+
+   private:
+    friend class AudioBusPool;
+    ScopedAudioBus(std::unique_ptr<AudioBus> bus,
+                   scoped_refptr<AudioBusFreeList> free_list);
+
+    std::unique_ptr<AudioBus> bus_;
+
+    // Free list of the thread which acquired |bus_|.
+    scoped_refptr<AudioBusFreeList> free_list_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedAudioBus);
+  };
+
+  // Returns a bus with |channels| of length |frames|, reusing one freed by the
+  // calling thread if possible.  As with AudioBus::Create(), the contents are
+  // undefined.
+  static ScopedAudioBus Acquire(int channels, int frames);
+
+  // Frees the calling thread's free buses.
+  static void ClearCurrentThread();
+
+  // Returns how many buses Acquire() has had to allocate on any thread; i.e.,
+  // the number of requests which found no free bus.
+  static int GetAllocationCount();
+
+ private:
+  static void Release(std::unique_ptr<AudioBus> bus,
+                      scoped_refptr<AudioBusFreeList> free_list);
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(AudioBusPool);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_AUDIO_BUS_POOL_H_
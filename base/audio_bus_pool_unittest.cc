@@ -0,0 +1,171 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/audio_bus_pool.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kChannels = 2;
+static const int kFrames = 128;
+
+class AudioBusPoolTest : public testing::Test {
+ public:
+  AudioBusPoolTest() { AudioBusPool::ClearCurrentThread(); }
+  ~AudioBusPoolTest() override { AudioBusPool::ClearCurrentThread(); }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AudioBusPoolTest);
+};
+
+// Verify a released bus is handed out again instead of allocating.
+TEST_F(AudioBusPoolTest, ReusesReleasedBus) {
+  const int allocations = AudioBusPool::GetAllocationCount();
+
+  AudioBusPool::ScopedAudioBus bus = AudioBusPool::Acquire(kChannels, kFrames);
+  ASSERT_TRUE(bus);
+  EXPECT_EQ(kChannels, bus->channels());
+  EXPECT_EQ(kFrames, bus->frames());
+  const AudioBus* first_bus = bus.get();
+  bus.reset();
+  EXPECT_FALSE(bus);
+
+  bus = AudioBusPool::Acquire(kChannels, kFrames);
+  EXPECT_EQ(first_bus, bus.get());
+  EXPECT_EQ(allocations + 1,
+            AudioBusPool::GetAllocationCount());
+}
+
+// Verify buses are only reused for the same channel and frame counts.
+TEST_F(AudioBusPoolTest, KeyedOnShape) {
+  const int allocations = AudioBusPool::GetAllocationCount();
+  AudioBusPool::Acquire(kChannels, kFrames);
+
+  AudioBusPool::ScopedAudioBus bus =
+      AudioBusPool::Acquire(kChannels + 1, kFrames);
+  EXPECT_EQ(kChannels + 1, bus->channels());
+  bus = AudioBusPool::Acquire(kChannels, kFrames + 1);
+  EXPECT_EQ(kFrames + 1, bus->frames());
+  EXPECT_EQ(allocations + 3,
+            AudioBusPool::GetAllocationCount());
+}
+
+// Verify moving a ScopedAudioBus transfers ownership without releasing.
+TEST_F(AudioBusPoolTest, Move) {
+  AudioBusPool::ScopedAudioBus bus = AudioBusPool::Acquire(kChannels, kFrames);
+  const AudioBus* raw_bus = bus.get();
+  AudioBusPool::ScopedAudioBus moved_bus(std::move(bus));
+  EXPECT_FALSE(bus);
+  EXPECT_EQ(raw_bus, moved_bus.get());
+
+  // |moved_bus| still owns the bus, so this must allocate.
+  AudioBusPool::ScopedAudioBus other_bus =
+      AudioBusPool::Acquire(kChannels, kFrames);
+  EXPECT_NE(raw_bus, other_bus.get());
+}
+
+// Verify only kMaxFreeBuses buses are kept, the most recently released ones.
+TEST_F(AudioBusPoolTest, FreeListLimit) {
+  const int kCount = AudioBusPool::kMaxFreeBuses + 2;
+  std::vector<AudioBusPool::ScopedAudioBus> buses;
+  for (int i = 0; i < kCount; ++i)
+    buses.push_back(AudioBusPool::Acquire(kChannels, kFrames + i));
+  buses.clear();
+
+  // Two of the buses were freed rather than kept.
+  const int allocations = AudioBusPool::GetAllocationCount();
+  for (int i = 0; i < kCount; ++i)
+    buses.push_back(AudioBusPool::Acquire(kChannels, kFrames + i));
+  EXPECT_EQ(allocations + kCount - AudioBusPool::kMaxFreeBuses,
+            AudioBusPool::GetAllocationCount());
+}
+
+// Verify ClearCurrentThread() drops the cached buses.
+TEST_F(AudioBusPoolTest, ClearCurrentThread) {
+  AudioBusPool::Acquire(kChannels, kFrames);
+  AudioBusPool::ClearCurrentThread();
+
+  const int allocations = AudioBusPool::GetAllocationCount();
+  AudioBusPool::Acquire(kChannels, kFrames);
+  EXPECT_EQ(allocations + 1,
+            AudioBusPool::GetAllocationCount());
+}
+
+// Verify bitstream state doesn't leak to the next user of a bus.
+TEST_F(AudioBusPoolTest, ResetsBitstreamState) {
+  AudioBusPool::ScopedAudioBus bus = AudioBusPool::Acquire(kChannels, kFrames);
+  bus->set_is_bitstream_format(true);
+  bus->SetBitstreamDataSize(16);
+  bus->SetBitstreamFrames(4);
+  bus.reset();
+
+  bus = AudioBusPool::Acquire(kChannels, kFrames);
+  EXPECT_FALSE(bus->is_bitstream_format());
+}
+
+class ReleaseDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit ReleaseDelegate(AudioBusPool::ScopedAudioBus bus)
+      : bus_(std::move(bus)) {}
+
+  void Run() override { bus_.reset(); }
+
+ private:
+  AudioBusPool::ScopedAudioBus bus_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReleaseDelegate);
+};
+
+// Verify a bus released on another thread is reused, as when a bus acquired
+// on the audio thread is released with its owner on the main thread.
+TEST_F(AudioBusPoolTest, ReleasedOnAnotherThread) {
+  AudioBusPool::ScopedAudioBus bus = AudioBusPool::Acquire(kChannels, kFrames);
+  const AudioBus* raw_bus = bus.get();
+
+  ReleaseDelegate delegate(std::move(bus));
+  base::DelegateSimpleThread thread(&delegate, "AudioBusPoolTest");
+  thread.Start();
+  thread.Join();
+
+  const int allocations = AudioBusPool::GetAllocationCount();
+  bus = AudioBusPool::Acquire(kChannels, kFrames);
+  EXPECT_EQ(raw_bus, bus.get());
+  EXPECT_EQ(allocations, AudioBusPool::GetAllocationCount());
+}
+
+class AcquireDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  AcquireDelegate() {}
+
+  void Run() override { bus_ = AudioBusPool::Acquire(kChannels, kFrames); }
+
+  AudioBusPool::ScopedAudioBus TakeBus() { return std::move(bus_); }
+
+ private:
+  AudioBusPool::ScopedAudioBus bus_;
+
+  DISALLOW_COPY_AND_ASSIGN(AcquireDelegate);
+};
+
+// Verify a bus goes back to the thread which acquired it, not to the one which
+// releases it.
+TEST_F(AudioBusPoolTest, ReturnedToAcquiringThread) {
+  AcquireDelegate delegate;
+  base::DelegateSimpleThread thread(&delegate, "AudioBusPoolTest");
+  thread.Start();
+  thread.Join();
+  delegate.TakeBus().reset();
+
+  const int allocations = AudioBusPool::GetAllocationCount();
+  AudioBusPool::Acquire(kChannels, kFrames);
+  EXPECT_EQ(allocations + 1, AudioBusPool::GetAllocationCount());
+}
+
+}  // namespace media
@@ -19,17 +19,31 @@
 #include "media/base/audio_pull_fifo.h"
 #include "media/base/channel_mixer.h"
 #include "media/base/multi_channel_resampler.h"
+#include "media/base/parallel_audio_mixer.h"
 #include "media/base/vector_math.h"
 
 namespace media {
 
+constexpr int AudioConverter::kFusedBlockFrames;
+
 AudioConverter::AudioConverter(const AudioParameters& input_params,
                                const AudioParameters& output_params,
                                bool disable_fifo)
-    : chunk_size_(input_params.frames_per_buffer()),
+    : AudioConverter(input_params,
+                     output_params,
+                     disable_fifo,
+                     ProcessingMode::kStaged) {}
+
+AudioConverter::AudioConverter(const AudioParameters& input_params,
+                               const AudioParameters& output_params,
+                               bool disable_fifo,
+                               ProcessingMode mode)
+    : mode_(mode),
+      chunk_size_(input_params.frames_per_buffer()),
       downmix_early_(false),
       initial_frames_delayed_(0),
       resampler_frames_delayed_(0),
+      block_frames_delayed_(0),
       io_sample_rate_ratio_(input_params.sample_rate() /
                             static_cast<double>(output_params.sample_rate())),
       input_channel_count_(input_params.channels()) {
@@ -59,6 +73,11 @@ AudioConverter::AudioConverter(const AudioParameters& input_params,
         downmix_early_ ? output_params.channels() : input_params.channels(),
         io_sample_rate_ratio_, request_size,
         base::Bind(&AudioConverter::ProvideInput, base::Unretained(this))));
+
+    if (mode_ == ProcessingMode::kFused && channel_mixer_ && !downmix_early_) {
+      unmixed_block_ = AudioBus::CreateWrapper(input_params.channels());
+      output_block_ = AudioBus::CreateWrapper(output_params.channels());
+    }
   }
 
   // The resampler can be configured to work with a specific request size, so a
@@ -116,6 +135,15 @@ void AudioConverter::PrimeWithSilence() {
   }
 }
 
+void AudioConverter::SetParallelMixingThreads(int helper_threads) {
+  if (helper_threads == 0) {
+    parallel_mixer_.reset();
+  } else if (!parallel_mixer_ ||
+             parallel_mixer_->helper_threads() != helper_threads) {
+    parallel_mixer_.reset(new ParallelAudioMixer(helper_threads));
+  }
+}
+
 void AudioConverter::ConvertWithDelay(uint32_t initial_frames_delayed,
                                       AudioBus* dest) {
   initial_frames_delayed_ = initial_frames_delayed;
@@ -131,6 +159,11 @@ void AudioConverter::ConvertWithDelay(uint32_t initial_frames_delayed,
   // to increase the channel count prior to resampling for the same reason.
   bool needs_mixing = channel_mixer_ && !downmix_early_;
 
+  if (needs_mixing && output_block_) {
+    ResampleAndUpmixInBlocks(dest);
+    return;
+  }
+
   if (needs_mixing)
     CreateUnmixedAudioIfNecessary(dest->frames());
 
@@ -167,24 +200,6 @@ void AudioConverter::SourceCallback(int fifo_frame_delay, AudioBus* dest) {
                fifo_frame_delay);
   const bool needs_downmix = channel_mixer_ && downmix_early_;
 
-  if (!mixer_input_audio_bus_ ||
-      mixer_input_audio_bus_->frames() != dest->frames()) {
-    mixer_input_audio_bus_ =
-        AudioBus::Create(input_channel_count_, dest->frames());
-  }
-
-  // If we're downmixing early we need a temporary AudioBus which matches
-  // the the input channel count and input frame size since we're passing
-  // |unmixed_audio_| directly to the |source_callback_|.
-  if (needs_downmix)
-    CreateUnmixedAudioIfNecessary(dest->frames());
-
-  AudioBus* const temp_dest = needs_downmix ? unmixed_audio_.get() : dest;
-
-  // Sanity check our inputs.
-  DCHECK_EQ(temp_dest->frames(), mixer_input_audio_bus_->frames());
-  DCHECK_EQ(temp_dest->channels(), mixer_input_audio_bus_->channels());
-
   // |total_frames_delayed| is reported to the *input* source in terms of the
   // *input* sample rate. |initial_frames_delayed_| is given in terms of the
   // output sample rate, so we scale by sample rate ratio (in/out).
@@ -201,6 +216,43 @@ void AudioConverter::SourceCallback(int fifo_frame_delay, AudioBus* dest) {
     total_frames_delayed += fifo_frame_delay;
   }
 
+  const bool mix_in_parallel =
+      parallel_mixer_ &&
+      transform_inputs_.size() >=
+          static_cast<size_t>(ParallelAudioMixer::kMinInputs);
+
+  // The parallel mixer renders into buffers of its own.
+  if (!mix_in_parallel &&
+      (!mixer_input_audio_bus_ ||
+       mixer_input_audio_bus_->frames() != dest->frames())) {
+    mixer_input_audio_bus_ =
+        AudioBusPool::Acquire(input_channel_count_, dest->frames());
+  }
+
+  if (needs_downmix && mode_ == ProcessingMode::kFused && !mix_in_parallel) {
+    MixAndDownmixInputs(total_frames_delayed, dest);
+    return;
+  }
+
+  // If we're downmixing early we need a temporary AudioBus which matches
+  // the the input channel count and input frame size since we're passing
+  // |unmixed_audio_| directly to the |source_callback_|.
+  if (needs_downmix)
+    CreateUnmixedAudioIfNecessary(dest->frames());
+
+  AudioBus* const temp_dest = needs_downmix ? unmixed_audio_.get() : dest;
+
+  if (mix_in_parallel) {
+    parallel_mixer_->Mix(transform_inputs_, total_frames_delayed, temp_dest);
+    if (needs_downmix)
+      channel_mixer_->Transform(temp_dest, dest);
+    return;
+  }
+
+  // Sanity check our inputs.
+  DCHECK_EQ(temp_dest->frames(), mixer_input_audio_bus_->frames());
+  DCHECK_EQ(temp_dest->channels(), mixer_input_audio_bus_->channels());
+
   // If we only have a single input, avoid an extra copy.
   AudioBus* const provide_input_dest =
       transform_inputs_.size() == 1 ? temp_dest : mixer_input_audio_bus_.get();
@@ -229,7 +281,13 @@ void AudioConverter::SourceCallback(int fifo_frame_delay, AudioBus* dest) {
     }
 
     // Volume adjust and mix each mixer input into |temp_dest| after rendering.
-    if (volume > 0) {
+    if (volume == 1.0f) {
+      for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
+        vector_math::FADD(mixer_input_audio_bus_->channel(i),
+                          mixer_input_audio_bus_->frames(),
+                          temp_dest->channel(i));
+      }
+    } else if (volume > 0) {
       for (int i = 0; i < mixer_input_audio_bus_->channels(); ++i) {
         vector_math::FMAC(
             mixer_input_audio_bus_->channel(i), volume,
@@ -247,16 +305,59 @@ void AudioConverter::SourceCallback(int fifo_frame_delay, AudioBus* dest) {
 void AudioConverter::ProvideInput(int resampler_frame_delay, AudioBus* dest) {
   TRACE_EVENT1("audio", "AudioConverter::ProvideInput", "resampler frame delay",
                resampler_frame_delay);
-  resampler_frames_delayed_ = resampler_frame_delay;
+  resampler_frames_delayed_ = block_frames_delayed_ + resampler_frame_delay;
   if (audio_fifo_)
     audio_fifo_->Consume(dest, dest->frames());
   else
     SourceCallback(0, dest);
 }
 
+void AudioConverter::MixAndDownmixInputs(uint32_t frames_delayed,
+                                         AudioBus* dest) {
+  // Every input, even a lone one, is rendered into |mixer_input_audio_bus_|
+  // and then scaled, down mixed and summed into |dest| in a single pass, so no
+  // full size buffer at the input channel count is ever mixed into.
+  bool dest_has_data = false;
+  for (auto* input : transform_inputs_) {
+    const float volume =
+        input->ProvideInput(mixer_input_audio_bus_.get(), frames_delayed);
+    if (volume > 0) {
+      channel_mixer_->TransformWithGain(mixer_input_audio_bus_.get(), volume,
+                                        dest_has_data, dest);
+      dest_has_data = true;
+    }
+  }
+
+  if (!dest_has_data)
+    dest->Zero();
+}
+
+void AudioConverter::ResampleAndUpmixInBlocks(AudioBus* dest) {
+  DCHECK(resampler_);
+  const int block_size = std::min(kFusedBlockFrames, dest->frames());
+  CreateUnmixedAudioIfNecessary(block_size);
+  for (int ch = 0; ch < unmixed_block_->channels(); ++ch)
+    unmixed_block_->SetChannelData(ch, unmixed_audio_->channel(ch));
+
+  // Each block is resampled into |unmixed_audio_| and up mixed into |dest|
+  // while it's still in cache.
+  for (int offset = 0; offset < dest->frames(); offset += block_size) {
+    const int frames = std::min(block_size, dest->frames() - offset);
+    unmixed_block_->set_frames(frames);
+    output_block_->set_frames(frames);
+    for (int ch = 0; ch < output_block_->channels(); ++ch)
+      output_block_->SetChannelData(ch, dest->channel(ch) + offset);
+
+    block_frames_delayed_ = offset;
+    resampler_->Resample(frames, unmixed_block_.get());
+    channel_mixer_->Transform(unmixed_block_.get(), output_block_.get());
+  }
+  block_frames_delayed_ = 0;
+}
+
 void AudioConverter::CreateUnmixedAudioIfNecessary(int frames) {
   if (!unmixed_audio_ || unmixed_audio_->frames() != frames)
-    unmixed_audio_ = AudioBus::Create(input_channel_count_, frames);
+    unmixed_audio_ = AudioBusPool::Acquire(input_channel_count_, frames);
 }
 
 }  // namespace media
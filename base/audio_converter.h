@@ -14,6 +14,13 @@
 // Additionally, since resampling is the most expensive operation, input mixing
 // and channel down mixing are done prior to resampling.  Likewise, channel up
 // mixing is performed after resampling.
+//
+// Converters may instead be created in a fused mode which avoids writing whole
+// intermediate buffers between stages: input mixing and volume scaling are
+// folded into the channel down mix, and resampling plus channel up mixing run
+// over the output in cache sized blocks.  Output matches the default, staged
+// mode only to within float rounding error (~1e-6 of full scale); the reported
+// delays are accurate to within a resampler chunk, as before.
 
 #ifndef MEDIA_BASE_AUDIO_CONVERTER_H_
 #define MEDIA_BASE_AUDIO_CONVERTER_H_
@@ -24,15 +31,16 @@
 #include "base/callback.h"
 #include "base/macros.h"
 #include "base/time/time.h"
+#include "media/base/audio_bus_pool.h"
 #include "media/base/audio_parameters.h"
 #include "media/base/media_export.h"
 
 namespace media {
 
-class AudioBus;
 class AudioPullFifo;
 class ChannelMixer;
 class MultiChannelResampler;
+class ParallelAudioMixer;
 
 // Converts audio data between two AudioParameters formats.  Sample usage:
 //   AudioParameters input(...), output(...);
@@ -64,15 +72,29 @@ class MEDIA_EXPORT AudioConverter {
     virtual ~InputCallback() {}
   };
 
+  // How Convert() moves audio between the mixing and resampling stages.
+  // kStaged runs each stage over the whole buffer before the next.  kFused
+  // isn't bit-exact with it, so users must opt in.
+  enum class ProcessingMode { kStaged, kFused };
+
+  // Output frames carried through resampling and up mixing at a time in fused
+  // mode; a block of 8 channels fits comfortably in L1.
+  static constexpr int kFusedBlockFrames = 256;
+
   // Constructs an AudioConverter for converting between the given input and
   // output parameters.  Specifying |disable_fifo| means all InputCallbacks are
   // capable of handling arbitrary buffer size requests; i.e. one call might ask
   // for 10 frames of data (indicated by the size of AudioBus provided) and the
   // next might ask for 20.  In synthetic testing, disabling the FIFO yields a
   // ~20% speed up for common cases.
+  // Converts in ProcessingMode::kStaged.
   AudioConverter(const AudioParameters& input_params,
                  const AudioParameters& output_params,
                  bool disable_fifo);
+  AudioConverter(const AudioParameters& input_params,
+                 const AudioParameters& output_params,
+                 bool disable_fifo,
+                 ProcessingMode mode);
   ~AudioConverter();
 
   // Converts audio from all inputs into the |dest|. If |frames_delayed| is
@@ -96,6 +118,12 @@ class MEDIA_EXPORT AudioConverter {
   // See SincResampler::PrimeWithSilence.
   void PrimeWithSilence();
 
+  // Pulls and sums the inputs on |helper_threads| threads as well as the
+  // calling thread whenever there are at least ParallelAudioMixer::kMinInputs
+  // of them; zero mixes on the calling thread alone, the default.  Inputs must
+  // then tolerate ProvideInput() calls on any of the threads.
+  void SetParallelMixingThreads(int helper_threads);
+
   bool empty() const { return transform_inputs_.empty(); }
 
  private:
@@ -107,9 +135,19 @@ class MEDIA_EXPORT AudioConverter {
   // necessary.
   void SourceCallback(int fifo_frame_delay, AudioBus* audio_bus);
 
+  // Fused mode version of SourceCallback() for early down mixing: each input
+  // is scaled and down mixed straight into |dest|.
+  void MixAndDownmixInputs(uint32_t frames_delayed, AudioBus* dest);
+
+  // Fused mode version of resampling followed by up mixing: |dest| is filled
+  // kFusedBlockFrames at a time.
+  void ResampleAndUpmixInBlocks(AudioBus* dest);
+
   // (Re)creates the temporary |unmixed_audio_| buffer if necessary.
   void CreateUnmixedAudioIfNecessary(int frames);
 
+  const ProcessingMode mode_;
+
   // Set of inputs for Convert().
   typedef std::list<InputCallback*> InputCallbackSet;
   InputCallbackSet transform_inputs_;
@@ -123,12 +161,22 @@ class MEDIA_EXPORT AudioConverter {
   std::unique_ptr<MultiChannelResampler> resampler_;
 
   // Handles channel transforms.  |unmixed_audio_| is a temporary destination
-  // for audio data before it goes into the channel mixer.
+  // for audio data before it goes into the channel mixer.  Temporary buses are
+  // pooled since converters are frequently recreated as streams come and go.
   std::unique_ptr<ChannelMixer> channel_mixer_;
-  std::unique_ptr<AudioBus> unmixed_audio_;
+  AudioBusPool::ScopedAudioBus unmixed_audio_;
 
   // Temporary AudioBus destination for mixing inputs.
-  std::unique_ptr<AudioBus> mixer_input_audio_bus_;
+  AudioBusPool::ScopedAudioBus mixer_input_audio_bus_;
+
+  // Mixes the inputs in place of SourceCallback()'s own loop when set and
+  // there are enough of them.
+  std::unique_ptr<ParallelAudioMixer> parallel_mixer_;
+
+  // Wrappers around one block of |unmixed_audio_| and of the output bus used
+  // by ResampleAndUpmixInBlocks().
+  std::unique_ptr<AudioBus> unmixed_block_;
+  std::unique_ptr<AudioBus> output_block_;
 
   // Since resampling is expensive, figure out if we should downmix channels
   // before resampling.
@@ -137,6 +185,9 @@ class MEDIA_EXPORT AudioConverter {
   // Used to calculate buffer delay information for InputCallbacks.
   uint32_t initial_frames_delayed_;
   uint32_t resampler_frames_delayed_;
+  // Output frames written by earlier blocks of the current fused conversion;
+  // the resampler only knows about frames produced within one block.
+  int block_frames_delayed_;
   const double io_sample_rate_ratio_;
 
   // Number of channels of input audio data.  Set during construction via the
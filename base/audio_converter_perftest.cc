@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <string>
 
 #include "base/time/time.h"
 #include "media/base/audio_converter.h"
@@ -29,13 +30,14 @@ class NullInputProvider : public AudioConverter::InputCallback {
 void RunConvertBenchmark(const AudioParameters& in_params,
                          const AudioParameters& out_params,
                          bool fifo,
+                         AudioConverter::ProcessingMode mode,
                          const std::string& trace_name) {
   NullInputProvider fake_input1;
   NullInputProvider fake_input2;
   NullInputProvider fake_input3;
   std::unique_ptr<AudioBus> output_bus = AudioBus::Create(out_params);
 
-  AudioConverter converter(in_params, out_params, !fifo);
+  AudioConverter converter(in_params, out_params, !fifo, mode);
   converter.AddInput(&fake_input1);
   converter.AddInput(&fake_input2);
   converter.AddInput(&fake_input3);
@@ -47,7 +49,20 @@ void RunConvertBenchmark(const AudioParameters& in_params,
   double runs_per_second = kBenchmarkIterations /
                            (base::TimeTicks::Now() - start).InSecondsF();
   perf_test::PrintResult(
-      "audio_converter", "", trace_name, runs_per_second, "runs/s", true);
+      "audio_converter",
+      mode == AudioConverter::ProcessingMode::kFused ? "_fused" : "_staged",
+      trace_name, runs_per_second, "runs/s", true);
+}
+
+// Runs the benchmark once in each processing mode.
+void RunConvertBenchmarks(const AudioParameters& in_params,
+                          const AudioParameters& out_params,
+                          bool fifo,
+                          const std::string& trace_name) {
+  RunConvertBenchmark(in_params, out_params, fifo,
+                      AudioConverter::ProcessingMode::kStaged, trace_name);
+  RunConvertBenchmark(in_params, out_params, fifo,
+                      AudioConverter::ProcessingMode::kFused, trace_name);
 }
 
 TEST(AudioConverterPerfTest, ConvertBenchmark) {
@@ -58,7 +73,25 @@ TEST(AudioConverterPerfTest, ConvertBenchmark) {
   AudioParameters output_params(
       AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 44100, 16, 440);
 
-  RunConvertBenchmark(input_params, output_params, false, "convert");
+  RunConvertBenchmarks(input_params, output_params, false, "convert");
+}
+
+TEST(AudioConverterPerfTest, ConvertBenchmarkChannelMixing) {
+  // Down and up mixing on either side of the resampler, the two places where
+  // the fused mode avoids full size intermediate buffers.
+  AudioParameters surround_params(AudioParameters::AUDIO_PCM_LINEAR,
+                                  CHANNEL_LAYOUT_5_1, 48000, 16, 2048);
+  AudioParameters stereo_params(
+      AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 44100, 16, 440);
+  RunConvertBenchmarks(surround_params, stereo_params, false,
+                       "convert_downmix");
+
+  AudioParameters stereo_input_params(AudioParameters::AUDIO_PCM_LINEAR,
+                                      CHANNEL_LAYOUT_STEREO, 44100, 16, 2048);
+  AudioParameters surround_output_params(AudioParameters::AUDIO_PCM_LINEAR,
+                                         CHANNEL_LAYOUT_7_1, 48000, 16, 2048);
+  RunConvertBenchmarks(stereo_input_params, surround_output_params, false,
+                       "convert_upmix");
 }
 
 TEST(AudioConverterPerfTest, ConvertBenchmarkFIFO) {
@@ -72,9 +105,10 @@ TEST(AudioConverterPerfTest, ConvertBenchmarkFIFO) {
   AudioParameters output_params(
       AudioParameters::AUDIO_PCM_LINEAR, CHANNEL_LAYOUT_STEREO, 44100, 16, 440);
 
-  RunConvertBenchmark(input_params, output_params, true, "convert_fifo_only");
-  RunConvertBenchmark(input_params, output_params, false,
-                      "convert_pass_through");
+  RunConvertBenchmarks(input_params, output_params, true,
+                       "convert_fifo_only");
+  RunConvertBenchmarks(input_params, output_params, false,
+                       "convert_pass_through");
 }
 
 } // namespace media
@@ -233,6 +233,70 @@ TEST(AudioConverterTest, AudioDelayAndDiscreteChannelCount) {
   EXPECT_EQ(input_parameters.channels(), callback.last_channel_count());
 }
 
+// Renders |buffers| output buffers from |inputs| sine inputs at descending
+// volumes with both processing modes and verifies the outputs match.
+static void TestFusedMatchesStaged(ChannelLayout input_layout,
+                                   int input_rate,
+                                   ChannelLayout output_layout,
+                                   int output_rate,
+                                   size_t inputs) {
+  SCOPED_TRACE(testing::Message() << input_layout << "@" << input_rate << " to "
+                                  << output_layout << "@" << output_rate
+                                  << " with " << inputs << " inputs");
+  const int kBuffers = 10;
+  AudioParameters input_parameters(AudioParameters::AUDIO_PCM_LINEAR,
+                                   input_layout, input_rate, kBitsPerChannel,
+                                   kHighLatencyBufferSize);
+  AudioParameters output_parameters(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                                    output_layout, output_rate,
+                                    kBitsPerChannel, kHighLatencyBufferSize);
+
+  AudioConverter staged(input_parameters, output_parameters, false,
+                        AudioConverter::ProcessingMode::kStaged);
+  AudioConverter fused(input_parameters, output_parameters, false,
+                       AudioConverter::ProcessingMode::kFused);
+  std::vector<std::unique_ptr<FakeAudioRenderCallback>> callbacks;
+  for (size_t i = 0; i < 2 * inputs; ++i) {
+    callbacks.push_back(
+        base::MakeUnique<FakeAudioRenderCallback>(0.01 * (i / 2 + 1),
+                                                  kSampleRate));
+    callbacks.back()->set_volume(1.0 - static_cast<double>(i / 2) / inputs);
+    (i % 2 ? fused : staged).AddInput(callbacks.back().get());
+  }
+
+  std::unique_ptr<AudioBus> staged_bus = AudioBus::Create(output_parameters);
+  std::unique_ptr<AudioBus> fused_bus = AudioBus::Create(output_parameters);
+  for (int i = 0; i < kBuffers; ++i) {
+    staged.Convert(staged_bus.get());
+    fused.Convert(fused_bus.get());
+    for (int ch = 0; ch < staged_bus->channels(); ++ch) {
+      for (int j = 0; j < staged_bus->frames(); ++j) {
+        ASSERT_NEAR(staged_bus->channel(ch)[j], fused_bus->channel(ch)[j],
+                    1e-6 * inputs)
+            << "buffer=" << i << ", ch=" << ch << ", j=" << j;
+      }
+    }
+  }
+}
+
+// Ensure the fused processing mode matches the staged one for every stage
+// combination it changes: early down mixing, resampling followed by up mixing,
+// and the paths left alone.
+TEST(AudioConverterTest, FusedMatchesStaged) {
+  for (size_t inputs = 1; inputs <= 3; ++inputs) {
+    TestFusedMatchesStaged(CHANNEL_LAYOUT_5_1, 48000, CHANNEL_LAYOUT_STEREO,
+                           44100, inputs);
+    TestFusedMatchesStaged(CHANNEL_LAYOUT_7_1, 48000, CHANNEL_LAYOUT_STEREO,
+                           48000, inputs);
+    TestFusedMatchesStaged(CHANNEL_LAYOUT_MONO, 48000, CHANNEL_LAYOUT_STEREO,
+                           44100, inputs);
+    TestFusedMatchesStaged(CHANNEL_LAYOUT_STEREO, 44100, CHANNEL_LAYOUT_5_1,
+                           96000, inputs);
+    TestFusedMatchesStaged(CHANNEL_LAYOUT_STEREO, 44100, CHANNEL_LAYOUT_QUAD,
+                           44100, inputs);
+  }
+}
+
 TEST_P(AudioConverterTest, ArbitraryOutputRequestSize) {
   // Resize output bus to be half of |output_parameters_|'s frames_per_buffer().
   audio_bus_ = AudioBus::Create(output_parameters_.channels(),
@@ -253,6 +317,11 @@ TEST_P(AudioConverterTest, ManyInputs) {
   RunTest(kConvertInputs);
 }
 
+TEST_P(AudioConverterTest, ManyInputsInParallel) {
+  converter_->SetParallelMixingThreads(2);
+  RunTest(kConvertInputs);
+}
+
 INSTANTIATE_TEST_CASE_P(
     AudioConverterTest, AudioConverterTest, testing::Values(
         // No resampling. No channel mixing.
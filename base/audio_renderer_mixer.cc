@@ -56,6 +56,7 @@ AudioRendererMixer::AudioRendererMixer(const AudioParameters& output_params,
     : output_params_(output_params),
       audio_sink_(std::move(sink)),
       master_converter_(output_params, output_params, true),
+      parallel_mixing_threads_(0),
       pause_delay_(base::TimeDelta::FromSeconds(kPauseDelaySeconds)),
       last_play_time_(base::TimeTicks::Now()),
       // Initialize |playing_| to true since Start() results in an auto-play.
@@ -101,6 +102,7 @@ void AudioRendererMixer::AddMixerInput(const AudioParameters& input_params,
                                      new LoopbackAudioConverter(
                                          input_params, output_params_, true))));
       converter = result.first;
+      converter->second->SetParallelMixingThreads(parallel_mixing_threads_);
 
       // Add newly-created resampler as an input to the master mixer.
       master_converter_.AddInput(converter->second.get());
@@ -154,6 +156,14 @@ void AudioRendererMixer::RemoveErrorCallback(const base::Closure& error_cb) {
   NOTREACHED();
 }
 
+void AudioRendererMixer::SetParallelMixingThreads(int helper_threads) {
+  base::AutoLock auto_lock(lock_);
+  parallel_mixing_threads_ = helper_threads;
+  master_converter_.SetParallelMixingThreads(helper_threads);
+  for (const auto& converter : converters_)
+    converter.second->SetParallelMixingThreads(helper_threads);
+}
+
 OutputDeviceInfo AudioRendererMixer::GetOutputDeviceInfo() {
   DVLOG(1) << __func__;
   return audio_sink_->GetOutputDeviceInfo();
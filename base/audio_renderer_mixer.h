@@ -45,6 +45,12 @@ class MEDIA_EXPORT AudioRendererMixer
   void AddErrorCallback(const base::Closure& error_cb);
   void RemoveErrorCallback(const base::Closure& error_cb);
 
+  // Pulls and sums the inputs on |helper_threads| threads besides the rendering
+  // thread once enough of them are playing; for mixers with hundreds of inputs,
+  // e.g. on a media server.  Each sample rate gets its own helpers.  Zero, the
+  // default, mixes on the rendering thread alone.  See ParallelAudioMixer.
+  void SetParallelMixingThreads(int helper_threads);
+
   void set_pause_delay_for_testing(base::TimeDelta delay) {
     pause_delay_ = delay;
   }
@@ -96,6 +102,9 @@ class MEDIA_EXPORT AudioRendererMixer
   // mixer inputs that are in the output sample rate.
   AudioConverter master_converter_;
 
+  // Helper threads given to each converter; see SetParallelMixingThreads().
+  int parallel_mixing_threads_;
+
   // Handles physical stream pause when no inputs are playing.  For latency
   // reasons we don't want to immediately pause the physical stream.
   base::TimeDelta pause_delay_;
@@ -0,0 +1,81 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/audio_parameters.h"
+#include "media/base/audio_renderer_mixer.h"
+#include "media/base/fake_audio_render_callback.h"
+#include "media/base/fake_audio_renderer_sink.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kSampleRate = 48000;
+static const int kBufferSize = 512;
+static const int kHelperThreads = 3;
+
+// Total ProvideInput() calls made per configuration, so larger mixes run
+// fewer iterations.
+static const int kInputRenders = 20000;
+static const int kMinIterations = 20;
+
+static void LogUma(int value) {}
+
+static void RunMixBenchmark(int input_count,
+                            int helper_threads,
+                            const std::string& trace_name) {
+  AudioParameters params(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                         CHANNEL_LAYOUT_STEREO, kSampleRate, 16, kBufferSize);
+  scoped_refptr<FakeAudioRendererSink> sink = new FakeAudioRendererSink(params);
+  AudioRendererMixer mixer(params, sink, base::Bind(&LogUma));
+  mixer.SetParallelMixingThreads(helper_threads);
+
+  std::vector<std::unique_ptr<FakeAudioRenderCallback>> inputs;
+  for (int i = 0; i < input_count; ++i) {
+    inputs.push_back(base::MakeUnique<FakeAudioRenderCallback>(
+        0.001 * (i % 100 + 1), kSampleRate));
+    inputs.back()->set_volume(1.0 / input_count);
+    mixer.AddMixerInput(params, inputs.back().get());
+  }
+
+  // Render as the sink's device thread would.
+  AudioRendererSink::RenderCallback* const callback = &mixer;
+  std::unique_ptr<AudioBus> dest = AudioBus::Create(params);
+  const int iterations = std::max(kInputRenders / input_count, kMinIterations);
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < iterations; ++i)
+    callback->Render(base::TimeDelta(), start, 0, dest.get());
+  double total_time_microseconds =
+      (base::TimeTicks::Now() - start).InMicrosecondsF();
+
+  perf_test::PrintResult("audio_renderer_mixer_render",
+                         "_" + std::to_string(input_count) + "_inputs",
+                         trace_name,
+                         total_time_microseconds / (iterations * input_count),
+                         "us/input", true);
+
+  for (const auto& input : inputs)
+    mixer.RemoveMixerInput(params, input.get());
+}
+
+// Benchmark the cost per input of a Render() from one to hundreds of inputs, as
+// on a media server, with every input pulled on the rendering thread and with
+// the pulling and mixing spread across helper threads.
+TEST(AudioRendererMixerPerfTest, Render) {
+  for (int inputs = 1; inputs <= 512; inputs *= 2) {
+    RunMixBenchmark(inputs, 0, "rendering_thread");
+    RunMixBenchmark(inputs, kHelperThreads, "helper_threads");
+  }
+}
+
+}  // namespace media
@@ -402,6 +402,13 @@ TEST_P(AudioRendererMixerTest, ManyInputPlayVolumeAdjusted) {
   PlayVolumeAdjustedTest(kMixerInputs);
 }
 
+// Test volume adjusted mixer output with many inputs mixed on helper threads in
+// the post-Play() state.
+TEST_P(AudioRendererMixerTest, ManyInputPlayVolumeAdjustedInParallel) {
+  mixer_->SetParallelMixingThreads(2);
+  PlayVolumeAdjustedTest(kMixerInputs);
+}
+
 // Test mixer output with one input and partial Render() in post-Play() state.
 TEST_P(AudioRendererMixerTest, OneInputPlayPartialRender) {
   PlayPartialRenderTest(1);
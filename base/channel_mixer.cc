@@ -5,6 +5,9 @@
 #include "media/base/channel_mixer.h"
 
 #include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include "base/logging.h"
 #include "media/base/audio_bus.h"
@@ -34,46 +37,86 @@ void ChannelMixer::Initialize(
     ChannelLayout input_layout, int input_channels,
     ChannelLayout output_layout, int output_channels) {
   // Create the transformation matrix
+  std::vector<std::vector<float>> matrix;
   ChannelMixingMatrix matrix_builder(input_layout, input_channels,
                                      output_layout, output_channels);
-  remapping_ = matrix_builder.CreateTransformationMatrix(&matrix_);
+  matrix_builder.CreateTransformationMatrix(&matrix);
+
+  // Compile the matrix, dropping every zero coefficient.  Remapping matrices
+  // end up with one coefficient of 1 per output channel, i.e., a copy.
+  input_channels_ = input_channels;
+  plan_.resize(output_channels);
+  size_t max_sources = 0;
+  for (int output_ch = 0; output_ch < output_channels; ++output_ch) {
+    OutputChannelPlan& plan = plan_[output_ch];
+    for (int input_ch = 0; input_ch < input_channels; ++input_ch) {
+      const float scale = matrix[output_ch][input_ch];
+      // Scale should always be positive.  Don't bother scaling by zero.
+      DCHECK_GE(scale, 0);
+      if (scale > 0) {
+        plan.input_channels.push_back(input_ch);
+        plan.scales.push_back(scale);
+      }
+    }
+    max_sources = std::max(max_sources, plan.input_channels.size());
+  }
+  sources_.resize(max_sources + 1);
+  scales_.resize(max_sources + 1);
 }
 
 ChannelMixer::~ChannelMixer() {}
 
+ChannelMixer::OutputChannelPlan::OutputChannelPlan() {}
+
+ChannelMixer::OutputChannelPlan::OutputChannelPlan(
+    const OutputChannelPlan& other) = default;
+
+ChannelMixer::OutputChannelPlan::~OutputChannelPlan() {}
+
 void ChannelMixer::Transform(const AudioBus* input, AudioBus* output) {
-  CHECK_EQ(matrix_.size(), static_cast<size_t>(output->channels()));
-  CHECK_EQ(matrix_[0].size(), static_cast<size_t>(input->channels()));
-  CHECK_EQ(input->frames(), output->frames());
+  TransformWithGain(input, 1.0f, false, output);
+}
 
-  // Zero initialize |output| so we're accumulating from zero.
-  output->Zero();
-
-  // If we're just remapping we can simply copy the correct input to output.
-  if (remapping_) {
-    for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
-      for (int input_ch = 0; input_ch < input->channels(); ++input_ch) {
-        float scale = matrix_[output_ch][input_ch];
-        if (scale > 0) {
-          DCHECK_EQ(scale, 1.0f);
-          memcpy(output->channel(output_ch), input->channel(input_ch),
-                 sizeof(*output->channel(output_ch)) * output->frames());
-          break;
-        }
-      }
-    }
-    return;
-  }
+void ChannelMixer::TransformWithGain(const AudioBus* input,
+                                     float gain,
+                                     bool accumulate,
+                                     AudioBus* output) {
+  CHECK_EQ(plan_.size(), static_cast<size_t>(output->channels()));
+  CHECK_EQ(input_channels_, input->channels());
+  CHECK_EQ(input->frames(), output->frames());
 
+  const int frames = output->frames();
   for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
-    for (int input_ch = 0; input_ch < input->channels(); ++input_ch) {
-      float scale = matrix_[output_ch][input_ch];
-      // Scale should always be positive.  Don't bother scaling by zero.
-      DCHECK_GE(scale, 0);
-      if (scale > 0) {
-        vector_math::FMAC(input->channel(input_ch), scale, output->frames(),
-                          output->channel(output_ch));
+    const OutputChannelPlan& plan = plan_[output_ch];
+    float* dest = output->channel(output_ch);
+    const int count = static_cast<int>(plan.input_channels.size());
+
+    if (count == 0) {
+      if (!accumulate)
+        memset(dest, 0, sizeof(*dest) * frames);
+    } else if (count == 1 && accumulate) {
+      vector_math::FMAC(input->channel(plan.input_channels[0]),
+                        plan.scales[0] * gain, frames, dest);
+    } else if (count == 1 && plan.scales[0] * gain == 1) {
+      memcpy(dest, input->channel(plan.input_channels[0]),
+             sizeof(*dest) * frames);
+    } else if (count == 1) {
+      vector_math::FMUL(input->channel(plan.input_channels[0]),
+                        plan.scales[0] * gain, frames, dest);
+    } else {
+      for (int i = 0; i < count; ++i) {
+        sources_[i] = input->channel(plan.input_channels[i]);
+        scales_[i] = plan.scales[i] * gain;
+      }
+      // WeightedSum() allows |dest| to be one of its sources, so accumulating
+      // is just one more source with unit scale.
+      int sources = count;
+      if (accumulate) {
+        sources_[sources] = dest;
+        scales_[sources++] = 1.0f;
       }
+      vector_math::WeightedSum(sources_.data(), scales_.data(), sources,
+                               frames, dest);
     }
   }
 }
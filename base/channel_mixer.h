@@ -22,6 +22,11 @@ class AudioParameters;
 // to list of input channels.  The transform renders all of the output channels,
 // with each output channel rendered according to a weighted sum of the relevant
 // input channels as defined in the matrix.
+//
+// The matrix is compiled into a per output channel plan upon construction, so
+// zero coefficients cost nothing and each output channel is written in a single
+// pass: a copy for remapped channels, a scale for single input channels, or a
+// fused weighted sum of all contributing input channels.
 class MEDIA_EXPORT ChannelMixer {
  public:
   // To mix two channels into one and preserve loudness, we must apply
@@ -35,16 +40,38 @@ class MEDIA_EXPORT ChannelMixer {
   // Transforms all channels from |input| into |output| channels.
   void Transform(const AudioBus* input, AudioBus* output);
 
+  // Like Transform(), but scales every output sample by |gain| and, if
+  // |accumulate| is true, adds the result to |output| instead of overwriting
+  // it.  Lets callers fold volume scaling and input mixing into the transform.
+  void TransformWithGain(const AudioBus* input,
+                         float gain,
+                         bool accumulate,
+                         AudioBus* output);
+
  private:
   void Initialize(ChannelLayout input_layout, int input_channels,
                   ChannelLayout output_layout, int output_channels);
 
-  // 2D matrix of output channels to input channels.
-  std::vector< std::vector<float> > matrix_;
+  // The non-zero coefficients of one row of the conversion matrix; i.e., the
+  // input channels which contribute to an output channel and their scales.
+  struct OutputChannelPlan {
+    OutputChannelPlan();
+    OutputChannelPlan(const OutputChannelPlan& other);
+    ~OutputChannelPlan();
+
+    std::vector<int> input_channels;
+    std::vector<float> scales;
+  };
+
+  int input_channels_;
+
+  // One entry per output channel.
+  std::vector<OutputChannelPlan> plan_;
 
-  // Optimization case for when we can simply remap the input channels to output
-  // channels and don't need to do a multiply-accumulate loop over |matrix_|.
-  bool remapping_;
+  // Scratch space for the input channel pointers and gain adjusted scales of
+  // one OutputChannelPlan, plus one entry for the output when accumulating.
+  std::vector<const float*> sources_;
+  std::vector<float> scales_;
 
   DISALLOW_COPY_AND_ASSIGN(ChannelMixer);
 };
@@ -0,0 +1,57 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/channel_layout.h"
+#include "media/base/channel_mixer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 200000;
+static const int kFrames = 480;
+
+static void RunTransformBenchmark(ChannelLayout input_layout,
+                                  ChannelLayout output_layout,
+                                  const std::string& trace_name) {
+  ChannelMixer mixer(input_layout, output_layout);
+  std::unique_ptr<AudioBus> input_bus =
+      AudioBus::Create(ChannelLayoutToChannelCount(input_layout), kFrames);
+  std::unique_ptr<AudioBus> output_bus =
+      AudioBus::Create(ChannelLayoutToChannelCount(output_layout), kFrames);
+  for (int ch = 0; ch < input_bus->channels(); ++ch) {
+    for (int i = 0; i < kFrames; ++i)
+      input_bus->channel(ch)[i] = 0.001f * (i % 100);
+  }
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kBenchmarkIterations; ++i)
+    mixer.Transform(input_bus.get(), output_bus.get());
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult("channel_mixer_transform", "", trace_name,
+                         kBenchmarkIterations / total_time_milliseconds,
+                         "runs/ms", true);
+}
+
+// Benchmark the common downmixes as well as the remapping and upmixing cases.
+TEST(ChannelMixerPerfTest, Transform) {
+  RunTransformBenchmark(CHANNEL_LAYOUT_7_1, CHANNEL_LAYOUT_STEREO,
+                        "7.1_to_stereo");
+  RunTransformBenchmark(CHANNEL_LAYOUT_5_1, CHANNEL_LAYOUT_STEREO,
+                        "5.1_to_stereo");
+  RunTransformBenchmark(CHANNEL_LAYOUT_STEREO, CHANNEL_LAYOUT_MONO,
+                        "stereo_to_mono");
+  RunTransformBenchmark(CHANNEL_LAYOUT_MONO, CHANNEL_LAYOUT_STEREO,
+                        "mono_to_stereo");
+  RunTransformBenchmark(CHANNEL_LAYOUT_5_1, CHANNEL_LAYOUT_5_1_BACK,
+                        "5.1_to_5.1_back");
+}
+
+}  // namespace media
@@ -3,12 +3,14 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/strings/stringprintf.h"
 #include "media/base/audio_bus.h"
 #include "media/base/audio_parameters.h"
 #include "media/base/channel_mixer.h"
+#include "media/base/channel_mixing_matrix.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace media {
@@ -50,6 +52,74 @@ TEST(ChannelMixerTest, ConstructAllPossibleLayouts) {
   }
 }
 
+// Verify the compiled plan renders exactly what the conversion matrix says for
+// every layout conversion, whether it remaps, scales or mixes channels.
+TEST(ChannelMixerTest, MatchesMatrix) {
+  for (ChannelLayout input_layout = CHANNEL_LAYOUT_MONO;
+       input_layout <= CHANNEL_LAYOUT_MAX;
+       input_layout = static_cast<ChannelLayout>(input_layout + 1)) {
+    for (ChannelLayout output_layout = CHANNEL_LAYOUT_MONO;
+         output_layout <= CHANNEL_LAYOUT_MAX;
+         output_layout = static_cast<ChannelLayout>(output_layout + 1)) {
+      // See ConstructAllPossibleLayouts for the exclusions.
+      if (input_layout == CHANNEL_LAYOUT_DISCRETE ||
+          input_layout == CHANNEL_LAYOUT_STEREO_AND_KEYBOARD_MIC ||
+          output_layout == CHANNEL_LAYOUT_DISCRETE ||
+          output_layout == CHANNEL_LAYOUT_STEREO_AND_KEYBOARD_MIC ||
+          output_layout == CHANNEL_LAYOUT_STEREO_DOWNMIX) {
+        continue;
+      }
+
+      SCOPED_TRACE(base::StringPrintf(
+          "Input Layout: %d, Output Layout: %d", input_layout, output_layout));
+      const int input_channels = ChannelLayoutToChannelCount(input_layout);
+      const int output_channels = ChannelLayoutToChannelCount(output_layout);
+      std::vector<std::vector<float>> matrix;
+      ChannelMixingMatrix(input_layout, input_channels, output_layout,
+                          output_channels)
+          .CreateTransformationMatrix(&matrix);
+
+      ChannelMixer mixer(input_layout, output_layout);
+      std::unique_ptr<AudioBus> input_bus =
+          AudioBus::Create(input_channels, kFrames);
+      std::unique_ptr<AudioBus> output_bus =
+          AudioBus::Create(output_channels, kFrames);
+      for (int ch = 0; ch < input_channels; ++ch) {
+        for (int i = 0; i < kFrames; ++i)
+          input_bus->channel(ch)[i] = (ch + 1) * 0.01f + i * 0.001f;
+      }
+      // Fill |output_bus| with garbage to make sure every sample is written.
+      for (int ch = 0; ch < output_channels; ++ch) {
+        std::fill(output_bus->channel(ch), output_bus->channel(ch) + kFrames,
+                  5);
+      }
+
+      mixer.Transform(input_bus.get(), output_bus.get());
+      for (int ch = 0; ch < output_channels; ++ch) {
+        for (int i = 0; i < kFrames; ++i) {
+          float expected = 0;
+          for (int input_ch = 0; input_ch < input_channels; ++input_ch)
+            expected += matrix[ch][input_ch] * input_bus->channel(input_ch)[i];
+          ASSERT_FLOAT_EQ(expected, output_bus->channel(ch)[i]);
+        }
+      }
+
+      // Accumulating a scaled transform on top must add |kGain| times the
+      // same result.
+      const float kGain = 0.5f;
+      mixer.TransformWithGain(input_bus.get(), kGain, true, output_bus.get());
+      for (int ch = 0; ch < output_channels; ++ch) {
+        for (int i = 0; i < kFrames; ++i) {
+          float expected = 0;
+          for (int input_ch = 0; input_ch < input_channels; ++input_ch)
+            expected += matrix[ch][input_ch] * input_bus->channel(input_ch)[i];
+          ASSERT_FLOAT_EQ((1 + kGain) * expected, output_bus->channel(ch)[i]);
+        }
+      }
+    }
+  }
+}
+
 struct ChannelMixerTestData {
   ChannelMixerTestData(ChannelLayout input_layout, ChannelLayout output_layout,
                        const float* channel_values, int num_channel_values,
@@ -15,8 +15,40 @@ static uint8_t* AllocateFFmpegSafeBlock(size_t size) {
   return block;
 }
 
+// Memory referenced by a buffer may be at most this many bytes larger than
+// twice the padded data, so that a small slice doesn't keep a large block, e.g.
+// a whole append, alive without anything accounting for it.
+static const size_t kMaxSharedMemoryOverhead = 64 * 1024;
+
+// Returns true if |size| bytes at |data| may be referenced within |memory|
+// rather than copied.
+static bool CanShare(const base::RefCountedMemory* memory,
+                     const uint8_t* data,
+                     size_t size) {
+  if (!memory)
+    return false;
+  const uint8_t* const front = memory->front();
+  const size_t padded_size = size + DecoderBuffer::kPaddingSize;
+  if (data < front || data > front + memory->size() ||
+      static_cast<size_t>(front + memory->size() - data) < padded_size ||
+      memory->size() > 2 * padded_size + kMaxSharedMemoryOverhead) {
+    return false;
+  }
+
+  // Like AllocateFFmpegSafeBlock(), FFmpeg's bitstream readers need the
+  // padding to be zero, which it isn't when the next frame follows the data.
+  for (size_t i = 0; i < DecoderBuffer::kPaddingSize; ++i) {
+    if (data[size + i])
+      return false;
+  }
+  return true;
+}
+
 DecoderBuffer::DecoderBuffer(size_t size)
-    : size_(size), side_data_size_(0), is_key_frame_(false) {
+    : size_(size),
+      shared_data_(nullptr),
+      side_data_size_(0),
+      is_key_frame_(false) {
   Initialize();
 }
 
@@ -24,7 +56,10 @@ DecoderBuffer::DecoderBuffer(const uint8_t* data,
                              size_t size,
                              const uint8_t* side_data,
                              size_t side_data_size)
-    : size_(size), side_data_size_(side_data_size), is_key_frame_(false) {
+    : size_(size),
+      shared_data_(nullptr),
+      side_data_size_(side_data_size),
+      is_key_frame_(false) {
   if (!data) {
     CHECK_EQ(size_, 0u);
     CHECK(!side_data);
@@ -44,6 +79,24 @@ DecoderBuffer::DecoderBuffer(const uint8_t* data,
   memcpy(side_data_.get(), side_data, side_data_size_);
 }
 
+DecoderBuffer::DecoderBuffer(scoped_refptr<base::RefCountedMemory> memory,
+                             const uint8_t* data,
+                             size_t size)
+    : size_(size),
+      shared_data_(nullptr),
+      side_data_size_(0),
+      is_key_frame_(false) {
+  CHECK(data);
+  if (CanShare(memory.get(), data, size_)) {
+    shared_memory_ = std::move(memory);
+    shared_data_ = data;
+    return;
+  }
+
+  Initialize();
+  memcpy(data_.get(), data, size_);
+}
+
 DecoderBuffer::~DecoderBuffer() {}
 
 void DecoderBuffer::Initialize() {
@@ -72,6 +125,17 @@ scoped_refptr<DecoderBuffer> DecoderBuffer::CopyFrom(const uint8_t* data,
       new DecoderBuffer(data, data_size, side_data, side_data_size));
 }
 
+// static
+scoped_refptr<DecoderBuffer> DecoderBuffer::FromSharedData(
+    scoped_refptr<base::RefCountedMemory> memory,
+    const uint8_t* data,
+    size_t data_size) {
+  // If you hit this CHECK you likely have a bug in a demuxer. Go fix it.
+  CHECK(data);
+  return base::WrapRefCounted(
+      new DecoderBuffer(std::move(memory), data, data_size));
+}
+
 // static
 scoped_refptr<DecoderBuffer> DecoderBuffer::CreateEOSBuffer() {
   return base::WrapRefCounted(new DecoderBuffer(NULL, 0, NULL, 0));
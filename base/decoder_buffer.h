@@ -16,6 +16,7 @@
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 #include "media/base/decrypt_config.h"
@@ -64,6 +65,21 @@ class MEDIA_EXPORT DecoderBuffer
                                                const uint8_t* side_data,
                                                size_t side_data_size);
 
+  // Create a DecoderBuffer whose |data_| references the |size| bytes at |data|
+  // within |memory| rather than a copy of them, e.g. the AVBuffer of an FFmpeg
+  // packet.  |memory| must not change for as long as it is referenced,
+  // so the buffer is read-only and writable_data() may not be called on it.
+  // Decoders may read up to kPaddingSize bytes past the end of the data, and
+  // those bytes must be zero.  The data is copied instead when they aren't,
+  // when |memory| doesn't extend that far, when |memory| is much larger than
+  // the data (so a small buffer doesn't keep a large block alive), or when
+  // |data| isn't within |memory| at all or |memory| is null.  Referenced data
+  // is not aligned.  The buffer's |is_key_frame_| will default to false.
+  static scoped_refptr<DecoderBuffer> FromSharedData(
+      scoped_refptr<base::RefCountedMemory> memory,
+      const uint8_t* data,
+      size_t size);
+
   // Create a DecoderBuffer indicating we've reached end of stream.
   //
   // Calling any method other than end_of_stream() on the resulting buffer
@@ -94,11 +110,12 @@ class MEDIA_EXPORT DecoderBuffer
 
   const uint8_t* data() const {
     DCHECK(!end_of_stream());
-    return data_.get();
+    return shared_memory_ ? shared_data_ : data_.get();
   }
 
   uint8_t* writable_data() const {
     DCHECK(!end_of_stream());
+    DCHECK(!shared_memory_) << "Shared data is read-only";
     return data_.get();
   }
 
@@ -145,7 +162,13 @@ class MEDIA_EXPORT DecoderBuffer
 
   // If there's no data in this buffer, it represents end of stream.
   bool end_of_stream() const {
-    return data_ == NULL;
+    return data_ == NULL && !shared_memory_;
+  }
+
+  // Returns true if the data is referenced rather than owned by this buffer.
+  bool is_shared() const {
+    DCHECK(!end_of_stream());
+    return !!shared_memory_;
   }
 
   bool is_key_frame() const {
@@ -179,6 +202,12 @@ class MEDIA_EXPORT DecoderBuffer
                 size_t size,
                 const uint8_t* side_data,
                 size_t side_data_size);
+
+  // References |data| within |memory| when it is followed by kPaddingSize
+  // bytes of it, and otherwise copies it as above.  See FromSharedData().
+  DecoderBuffer(scoped_refptr<base::RefCountedMemory> memory,
+                const uint8_t* data,
+                size_t size);
   virtual ~DecoderBuffer();
 
  private:
@@ -187,6 +216,12 @@ class MEDIA_EXPORT DecoderBuffer
 
   size_t size_;
   std::unique_ptr<uint8_t, base::AlignedFreeDeleter> data_;
+
+  // Set instead of |data_| when the data is referenced from |shared_memory_|
+  // rather than owned.
+  scoped_refptr<base::RefCountedMemory> shared_memory_;
+  const uint8_t* shared_data_;
+
   size_t side_data_size_;
   std::unique_ptr<uint8_t, base::AlignedFreeDeleter> side_data_;
   std::unique_ptr<DecryptConfig> decrypt_config_;
@@ -6,8 +6,11 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/strings/string_util.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -59,6 +62,75 @@ TEST(DecoderBufferTest, CopyFrom) {
   EXPECT_FALSE(buffer3->is_key_frame());
 }
 
+TEST(DecoderBufferTest, FromSharedData) {
+  const size_t kDataSize = 16;
+  const size_t kPaddingSize = DecoderBuffer::kPaddingSize;
+
+  // Data at offset 8, followed by zeroed padding and then more data.
+  std::vector<uint8_t> bytes(8 + kDataSize + kPaddingSize + kDataSize, 0);
+  for (size_t i = 0; i < 8 + kDataSize; ++i)
+    bytes[i] = i + 1;
+  for (size_t i = 8 + kDataSize + kPaddingSize; i < bytes.size(); ++i)
+    bytes[i] = i + 1;
+  scoped_refptr<base::RefCountedBytes> memory =
+      base::RefCountedBytes::TakeVector(&bytes);
+  const uint8_t* const front = memory->front();
+
+  // Data followed by enough zeroed bytes of |memory| to pad it is referenced.
+  scoped_refptr<DecoderBuffer> buffer(
+      DecoderBuffer::FromSharedData(memory, front + 8, kDataSize));
+  ASSERT_TRUE(buffer.get());
+  EXPECT_TRUE(buffer->is_shared());
+  EXPECT_EQ(front + 8, buffer->data());
+  EXPECT_EQ(kDataSize, buffer->data_size());
+  EXPECT_FALSE(buffer->end_of_stream());
+  EXPECT_FALSE(buffer->is_key_frame());
+
+  // Data followed by other data is copied, since decoders need the padding
+  // to be zero.
+  scoped_refptr<DecoderBuffer> copy(
+      DecoderBuffer::FromSharedData(memory, front, kDataSize));
+  EXPECT_FALSE(copy->is_shared());
+  EXPECT_NE(front, copy->data());
+  EXPECT_EQ(0, memcmp(front, copy->data(), kDataSize));
+  for (size_t i = 0; i < kPaddingSize; ++i)
+    EXPECT_EQ(0, copy->data()[kDataSize + i]);
+
+  // So is data too close to the end of its memory to pad it, data outside its
+  // memory and data without any memory.
+  const uint8_t* const tail = front + 8 + kDataSize + kPaddingSize;
+  copy = DecoderBuffer::FromSharedData(memory, tail, kDataSize);
+  EXPECT_FALSE(copy->is_shared());
+  EXPECT_EQ(0, memcmp(tail, copy->data(), kDataSize));
+
+  const uint8_t kOutside[kDataSize] = {1};
+  copy = DecoderBuffer::FromSharedData(memory, kOutside, kDataSize);
+  EXPECT_FALSE(copy->is_shared());
+  EXPECT_EQ(0, memcmp(kOutside, copy->data(), kDataSize));
+
+  copy = DecoderBuffer::FromSharedData(nullptr, tail, kDataSize);
+  EXPECT_FALSE(copy->is_shared());
+  EXPECT_EQ(0, memcmp(tail, copy->data(), kDataSize));
+
+  // The reference keeps |memory| alive.
+  memory = nullptr;
+  EXPECT_EQ(9, buffer->data()[0]);
+}
+
+// A small slice of a much larger block is copied rather than keep the whole
+// block alive.
+TEST(DecoderBufferTest, FromSharedDataOfLargeMemory) {
+  const size_t kDataSize = 16;
+  std::vector<uint8_t> bytes(1024 * 1024, 0);
+  bytes[0] = 1;
+  scoped_refptr<base::RefCountedBytes> memory =
+      base::RefCountedBytes::TakeVector(&bytes);
+  scoped_refptr<DecoderBuffer> buffer(
+      DecoderBuffer::FromSharedData(memory, memory->front(), kDataSize));
+  EXPECT_FALSE(buffer->is_shared());
+  EXPECT_EQ(1, buffer->data()[0]);
+}
+
 #if !defined(OS_ANDROID)
 TEST(DecoderBufferTest, PaddingAlignment) {
   const uint8_t kData[] = "hello";
@@ -0,0 +1,116 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/lock_free_audio_fifo.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace media {
+
+LockFreeAudioFifo::LockFreeAudioFifo(int channels, int frames)
+    : audio_bus_(AudioBus::Create(channels, frames)), max_frames_(frames) {
+  read_index_.value = 0;
+  write_index_.value = 0;
+}
+
+LockFreeAudioFifo::~LockFreeAudioFifo() {}
+
+int LockFreeAudioFifo::FramesBetween(int read_index, int write_index) const {
+  const int delta = write_index - read_index;
+  return delta < 0 ? delta + 2 * max_frames_ : delta;
+}
+
+int LockFreeAudioFifo::AdvanceIndex(int index, int frames) const {
+  index += frames;
+  return index >= 2 * max_frames_ ? index - 2 * max_frames_ : index;
+}
+
+int LockFreeAudioFifo::frames() const {
+  // Only the producer and consumer may call this, so one of the two positions
+  // is always the caller's own and can't move underneath it.
+  const int read_index = base::subtle::Acquire_Load(&read_index_.value);
+  return FramesBetween(read_index,
+                       base::subtle::Acquire_Load(&write_index_.value));
+}
+
+void LockFreeAudioFifo::Push(const AudioBus* source) {
+  DCHECK(source);
+  DCHECK_EQ(source->channels(), audio_bus_->channels());
+
+  // The acquire pairs with the release in Consume(), so the consumer is done
+  // reading the frames about to be overwritten.
+  const int write_index = base::subtle::NoBarrier_Load(&write_index_.value);
+  const int read_index = base::subtle::Acquire_Load(&read_index_.value);
+
+  // Ensure that there is space for the new data in the FIFO.
+  const int source_size = source->frames();
+  CHECK_LE(source_size + FramesBetween(read_index, write_index), max_frames_);
+
+  // Copy all channels from the source to the FIFO, wrapping around if needed.
+  const int write_pos =
+      write_index < max_frames_ ? write_index : write_index - max_frames_;
+  const int append_size = std::min(source_size, max_frames_ - write_pos);
+  const int wrap_size = source_size - append_size;
+  for (int ch = 0; ch < source->channels(); ++ch) {
+    float* dest = audio_bus_->channel(ch);
+    const float* src = source->channel(ch);
+    memcpy(&dest[write_pos], &src[0], append_size * sizeof(src[0]));
+    if (wrap_size > 0)
+      memcpy(&dest[0], &src[append_size], wrap_size * sizeof(src[0]));
+  }
+
+  // Publish the frames only once they're all written.
+  base::subtle::Release_Store(&write_index_.value,
+                              AdvanceIndex(write_index, source_size));
+}
+
+void LockFreeAudioFifo::Consume(AudioBus* destination,
+                                int start_frame,
+                                int frames_to_consume) {
+  DCHECK(destination);
+  DCHECK_EQ(destination->channels(), audio_bus_->channels());
+
+  // The acquire pairs with the release in Push(), so every published frame is
+  // visible here.
+  const int read_index = base::subtle::NoBarrier_Load(&read_index_.value);
+  const int write_index = base::subtle::Acquire_Load(&write_index_.value);
+
+  // It is not possible to ask for more data than what is available in the FIFO.
+  CHECK_LE(frames_to_consume, FramesBetween(read_index, write_index));
+
+  // A copy from the FIFO to |destination| will only be performed if the
+  // allocated memory in |destination| is sufficient.
+  CHECK_LE(frames_to_consume + start_frame, destination->frames());
+
+  // Copy all channels from the FIFO to the destination, wrapping around if
+  // needed.
+  const int read_pos =
+      read_index < max_frames_ ? read_index : read_index - max_frames_;
+  const int consume_size = std::min(frames_to_consume, max_frames_ - read_pos);
+  const int wrap_size = frames_to_consume - consume_size;
+  for (int ch = 0; ch < destination->channels(); ++ch) {
+    float* dest = destination->channel(ch);
+    const float* src = audio_bus_->channel(ch);
+    memcpy(&dest[start_frame], &src[read_pos], consume_size * sizeof(src[0]));
+    if (wrap_size > 0) {
+      memcpy(&dest[start_frame + consume_size], &src[0],
+             wrap_size * sizeof(src[0]));
+    }
+  }
+
+  // Hand the space back to the producer only once it's been read.
+  base::subtle::Release_Store(&read_index_.value,
+                              AdvanceIndex(read_index, frames_to_consume));
+}
+
+void LockFreeAudioFifo::Clear() {
+  base::subtle::Release_Store(&read_index_.value,
+                              base::subtle::Acquire_Load(&write_index_.value));
+}
+
+}  // namespace media
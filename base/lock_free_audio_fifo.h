@@ -0,0 +1,84 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_LOCK_FREE_AUDIO_FIFO_H_
+#define MEDIA_BASE_LOCK_FREE_AUDIO_FIFO_H_
+
+#include <memory>
+
+#include "base/atomicops.h"
+#include "base/macros.h"
+#include "media/base/audio_bus.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// First-in first-out container for AudioBus elements which may be pushed to on
+// one thread and consumed from on another without locking; e.g., to hand audio
+// between a real-time audio thread and a decode or IPC thread.  Push() and
+// Consume() are wait-free: each only copies data and then publishes its new
+// position with a single release store.
+//
+// Like AudioFifo, the maximum number of frames is set at construction and the
+// memory is used as a ring buffer.  At most one thread may call the producer
+// methods and at most one (possibly different) thread the consumer methods at
+// any one time; frames() and frames_free() may be called from either of them.
+class MEDIA_EXPORT LockFreeAudioFifo {
+ public:
+  // Creates a new LockFreeAudioFifo and allocates |channels| of length
+  // |frames|.
+  LockFreeAudioFifo(int channels, int frames);
+  ~LockFreeAudioFifo();
+
+  // Producer: pushes all audio channel data from |source| to the FIFO.  Push()
+  // will crash if the allocated space is insufficient; since the consumer only
+  // ever frees space, checking frames_free() first is race free.
+  void Push(const AudioBus* source);
+
+  // Consumer: consumes |frames_to_consume| audio frames from the FIFO and
+  // copies them to |destination| starting at position |start_frame|.  Consume()
+  // will crash if the FIFO does not contain |frames_to_consume| frames or if
+  // there is insufficient space in |destination| to store the frames; since the
+  // producer only ever adds frames, checking frames() first is race free.
+  void Consume(AudioBus* destination, int start_frame, int frames_to_consume);
+
+  // Consumer: drops every frame currently in the FIFO.
+  void Clear();
+
+  // Number of audio frames in the FIFO and of free frames respectively.  While
+  // the other side is active each is a lower bound for the side which acts on
+  // it, i.e., frames() for the consumer and frames_free() for the producer.
+  int frames() const;
+  int frames_free() const { return max_frames_ - frames(); }
+
+  int max_frames() const { return max_frames_; }
+
+ private:
+  // Frame counts between positions, which run over [0, 2 * |max_frames_|) so a
+  // full FIFO can be told apart from an empty one.
+  int FramesBetween(int read_index, int write_index) const;
+  int AdvanceIndex(int index, int frames) const;
+
+  std::unique_ptr<AudioBus> audio_bus_;
+
+  // Maximum number of frames the FIFO can contain.
+  const int max_frames_;
+
+  // A position padded out to a cache line, so the producer and consumer don't
+  // invalidate each other's lines whenever they publish.
+  struct PaddedIndex {
+    volatile base::subtle::Atomic32 value;
+    char padding[64 - sizeof(base::subtle::Atomic32)];
+  };
+
+  // Written only by the consumer and producer respectively.
+  PaddedIndex read_index_;
+  PaddedIndex write_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeAudioFifo);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_LOCK_FREE_AUDIO_FIFO_H_
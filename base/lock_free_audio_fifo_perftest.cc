@@ -0,0 +1,125 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/audio_fifo.h"
+#include "media/base/lock_free_audio_fifo.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kChannels = 2;
+static const int kFramesPerPush = 480;
+static const int kFramesPerConsume = 441;
+static const int kFifoFrames = 8 * kFramesPerPush;
+static const int kTotalFrames = kFramesPerPush * kFramesPerConsume * 200;
+
+// AudioFifo with the locking a client moving audio between threads has to add.
+class LockedAudioFifo {
+ public:
+  LockedAudioFifo(int channels, int frames) : fifo_(channels, frames) {}
+
+  void Push(const AudioBus* source) {
+    base::AutoLock auto_lock(lock_);
+    fifo_.Push(source);
+  }
+
+  void Consume(AudioBus* destination, int start_frame, int frames_to_consume) {
+    base::AutoLock auto_lock(lock_);
+    fifo_.Consume(destination, start_frame, frames_to_consume);
+  }
+
+  int frames() {
+    base::AutoLock auto_lock(lock_);
+    return fifo_.frames();
+  }
+
+  int frames_free() {
+    base::AutoLock auto_lock(lock_);
+    return fifo_.max_frames() - fifo_.frames();
+  }
+
+ private:
+  base::Lock lock_;
+  AudioFifo fifo_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockedAudioFifo);
+};
+
+template <typename Fifo>
+class Producer : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit Producer(Fifo* fifo)
+      : fifo_(fifo), bus_(AudioBus::Create(kChannels, kFramesPerPush)) {
+    bus_->Zero();
+  }
+
+  void Run() override {
+    for (int pushed = 0; pushed < kTotalFrames; pushed += kFramesPerPush) {
+      while (fifo_->frames_free() < kFramesPerPush)
+        base::PlatformThread::YieldCurrentThread();
+      fifo_->Push(bus_.get());
+    }
+  }
+
+ private:
+  Fifo* const fifo_;
+  std::unique_ptr<AudioBus> bus_;
+
+  DISALLOW_COPY_AND_ASSIGN(Producer);
+};
+
+// Moves |kTotalFrames| from a producer thread to this one through a Fifo and
+// reports the throughput and the longest any single Consume() call took, which
+// is what a real-time consumer cares about.
+template <typename Fifo>
+static void RunContentionBenchmark(const std::string& trace_name) {
+  Fifo fifo(kChannels, kFifoFrames);
+  Producer<Fifo> producer(&fifo);
+  base::DelegateSimpleThread thread(&producer, "FifoProducer");
+  std::unique_ptr<AudioBus> dest =
+      AudioBus::Create(kChannels, kFramesPerConsume);
+
+  base::TimeDelta max_consume_time;
+  base::TimeTicks start = base::TimeTicks::Now();
+  thread.Start();
+  for (int consumed = 0; consumed < kTotalFrames;
+       consumed += kFramesPerConsume) {
+    while (fifo.frames() < kFramesPerConsume)
+      base::PlatformThread::YieldCurrentThread();
+    base::TimeTicks consume_start = base::TimeTicks::Now();
+    fifo.Consume(dest.get(), 0, kFramesPerConsume);
+    max_consume_time =
+        std::max(max_consume_time, base::TimeTicks::Now() - consume_start);
+  }
+  thread.Join();
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+
+  perf_test::PrintResult("audio_fifo_contention", "_throughput", trace_name,
+                         kTotalFrames / total_time_milliseconds, "frames/ms",
+                         true);
+  perf_test::PrintResult("audio_fifo_contention", "_max_consume_time",
+                         trace_name, max_consume_time.InMicrosecondsF(), "us",
+                         true);
+}
+
+// Benchmark handing audio from one thread to another, as between a decode or
+// IPC thread and the real-time audio thread.
+TEST(LockFreeAudioFifoPerfTest, Contention) {
+  RunContentionBenchmark<LockedAudioFifo>("audio_fifo_with_lock");
+  RunContentionBenchmark<LockFreeAudioFifo>("lock_free_audio_fifo");
+}
+
+}  // namespace media
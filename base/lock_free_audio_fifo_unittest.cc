@@ -0,0 +1,162 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/lock_free_audio_fifo.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "base/macros.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kChannels = 2;
+static const int kMaxFrameCount = 128;
+
+// Fills |bus| with consecutive values starting at |start| in every channel,
+// offset by the channel index.
+static void FillRamp(AudioBus* bus, int start) {
+  for (int ch = 0; ch < bus->channels(); ++ch) {
+    for (int i = 0; i < bus->frames(); ++i)
+      bus->channel(ch)[i] = start + i + ch * 1000000;
+  }
+}
+
+// Returns true if |frames| of |bus| from |offset| continue a ramp filled by
+// FillRamp() at |start|.
+static bool VerifyRamp(const AudioBus* bus, int offset, int frames, int start) {
+  for (int ch = 0; ch < bus->channels(); ++ch) {
+    for (int i = 0; i < frames; ++i) {
+      if (bus->channel(ch)[offset + i] != start + i + ch * 1000000) {
+        ADD_FAILURE() << "ch=" << ch << ", i=" << i;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Verify that construction works as intended.
+TEST(LockFreeAudioFifoTest, Construct) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  EXPECT_EQ(0, fifo.frames());
+  EXPECT_EQ(kMaxFrameCount, fifo.frames_free());
+  EXPECT_EQ(kMaxFrameCount, fifo.max_frames());
+}
+
+// Push and consume uneven amounts so both sides wrap around the ring buffer
+// repeatedly, and verify the data comes out in order at |start_frame|.
+TEST(LockFreeAudioFifoTest, PushConsumeWrap) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> source = AudioBus::Create(kChannels, 37);
+  std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, 64);
+
+  int pushed = 0;
+  int consumed = 0;
+  for (int i = 0; i < 100; ++i) {
+    while (fifo.frames_free() >= source->frames()) {
+      FillRamp(source.get(), pushed);
+      fifo.Push(source.get());
+      pushed += source->frames();
+    }
+    EXPECT_EQ(pushed - consumed, fifo.frames());
+
+    const int frames = std::min(fifo.frames(), 53);
+    fifo.Consume(dest.get(), 5, frames);
+    ASSERT_TRUE(VerifyRamp(dest.get(), 5, frames, consumed));
+    consumed += frames;
+    EXPECT_EQ(pushed - consumed, fifo.frames());
+  }
+}
+
+// Verify a completely full FIFO isn't mistaken for an empty one.
+TEST(LockFreeAudioFifoTest, Full) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kMaxFrameCount);
+  for (int i = 0; i < 3; ++i) {
+    FillRamp(bus.get(), i);
+    fifo.Push(bus.get());
+    EXPECT_EQ(kMaxFrameCount, fifo.frames());
+    EXPECT_EQ(0, fifo.frames_free());
+    fifo.Consume(bus.get(), 0, kMaxFrameCount);
+    ASSERT_TRUE(VerifyRamp(bus.get(), 0, kMaxFrameCount, i));
+    EXPECT_EQ(0, fifo.frames());
+  }
+}
+
+// Verify Clear() drops everything pushed so far.
+TEST(LockFreeAudioFifoTest, Clear) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, 100);
+  fifo.Push(bus.get());
+  fifo.Clear();
+  EXPECT_EQ(0, fifo.frames());
+  EXPECT_EQ(kMaxFrameCount, fifo.frames_free());
+  fifo.Push(bus.get());
+  EXPECT_EQ(100, fifo.frames());
+}
+
+// Verify pushing more than the FIFO can hold crashes.
+TEST(LockFreeAudioFifoTest, Overflow) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, 100);
+  fifo.Push(bus.get());
+  EXPECT_DEATH(fifo.Push(bus.get()), "");
+}
+
+// Pushes |total_frames| of ramp into a FIFO in |frames_per_push| sized chunks,
+// yielding whenever the FIFO is full.
+class RampProducer : public base::DelegateSimpleThread::Delegate {
+ public:
+  RampProducer(LockFreeAudioFifo* fifo, int frames_per_push, int total_frames)
+      : fifo_(fifo),
+        bus_(AudioBus::Create(kChannels, frames_per_push)),
+        total_frames_(total_frames) {}
+
+  void Run() override {
+    for (int pushed = 0; pushed < total_frames_; pushed += bus_->frames()) {
+      FillRamp(bus_.get(), pushed);
+      while (fifo_->frames_free() < bus_->frames())
+        base::PlatformThread::YieldCurrentThread();
+      fifo_->Push(bus_.get());
+    }
+  }
+
+ private:
+  LockFreeAudioFifo* const fifo_;
+  std::unique_ptr<AudioBus> bus_;
+  const int total_frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(RampProducer);
+};
+
+// Verify data pushed on one thread arrives intact and in order on another.
+TEST(LockFreeAudioFifoTest, ProducerAndConsumerThreads) {
+  const int kFramesPerPush = 48;
+  const int kFramesPerConsume = 44;
+  const int kTotalFrames = kFramesPerPush * kFramesPerConsume * 500;
+  LockFreeAudioFifo fifo(kChannels, 4 * kFramesPerPush);
+  RampProducer producer(&fifo, kFramesPerPush, kTotalFrames);
+  base::DelegateSimpleThread thread(&producer, "RampProducer");
+  thread.Start();
+
+  // Keep consuming after a mismatch so the producer can finish.
+  std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, 64);
+  bool ramp_intact = true;
+  for (int consumed = 0; consumed < kTotalFrames;
+       consumed += kFramesPerConsume) {
+    while (fifo.frames() < kFramesPerConsume)
+      base::PlatformThread::YieldCurrentThread();
+    fifo.Consume(dest.get(), 0, kFramesPerConsume);
+    if (ramp_intact)
+      ramp_intact = VerifyRamp(dest.get(), 0, kFramesPerConsume, consumed);
+  }
+  thread.Join();
+  EXPECT_EQ(0, fifo.frames());
+}
+
+}  // namespace media
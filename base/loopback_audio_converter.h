@@ -34,6 +34,10 @@ class LoopbackAudioConverter : public AudioConverter::InputCallback {
 
   bool empty() { return audio_converter_.empty(); }
 
+  void SetParallelMixingThreads(int helper_threads) {
+    audio_converter_.SetParallelMixingThreads(helper_threads);
+  }
+
  private:
   double ProvideInput(AudioBus* audio_bus, uint32_t frames_delayed) override;
 
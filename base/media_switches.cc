@@ -223,15 +223,37 @@ const base::Feature kBackgroundVideoTrackOptimization{
 const base::Feature kBackgroundVideoPauseOptimization{
     "BackgroundVideoPauseOptimization", base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Size the read-ahead window of src= media from the measured download and
+// consumption rates instead of from the bitrate alone.
+const base::Feature kAdaptiveMediaReadAhead{"AdaptiveMediaReadAhead",
+                                            base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Size the video renderer's queue and the decode requests in flight from
+// measured decode times, frame size and a memory budget instead of from fixed
+// frame counts.
+const base::Feature kAdaptiveVideoDecodeAhead{
+    "AdaptiveVideoDecodeAhead", base::FEATURE_DISABLED_BY_DEFAULT};
+
 const base::Feature kComplexityBasedVideoBuffering{
     "ComplexityBasedVideoBuffering", base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Have FFmpegDemuxer fetch data ahead of FFmpeg's reads, so that its small
+// reads are served from memory instead of each waiting on the DataSource.
+const base::Feature kFFmpegDemuxerReadAhead{"FFmpegDemuxerReadAhead",
+                                            base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Make MSE garbage collection algorithm more aggressive when we are under
 // moderate or critical memory pressure. This will relieve memory pressure by
 // releasing stale data from MSE buffers.
 const base::Feature kMemoryPressureBasedSourceBufferGC{
     "MemoryPressureBasedSourceBufferGC", base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Spread MSE garbage collection over appends instead of evicting everything
+// needed in one go, and once the memory limit is reached evict a little below
+// it, so the following appends have headroom.
+const base::Feature kIncrementalSourceBufferGC{
+    "IncrementalSourceBufferGC", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // On systems where pepper CDMs are enabled, use mojo CDM instead of PPAPI CDM.
 // Note that mojo CDM support is still under development. Some features are
 // still missing and this feature should only be enabled for testing.
@@ -249,6 +271,27 @@ const base::Feature kMseFlacInIsobmff{"MseFlacInIsobmff",
 const base::Feature kNewRemotePlaybackPipeline{
     "NewRemotePlaybackPipeline", base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Append the frames of each track of an MSE append to its buffer concurrently
+// on the worker pool, rather than one track after another.
+const base::Feature kParallelMseTrackAppends{
+    "ParallelMseTrackAppends", base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Convert large software video frames to RGB in bands of rows on the worker
+// pool, for canvas draws and texture upload fallbacks.
+const base::Feature kParallelVideoFrameToRGB{"ParallelVideoFrameToRGB",
+                                             base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Allocate the frame memory of VideoFramePools and VpxVideoDecoders from a
+// process-wide pool, so that memory freed by one decoder is reused by others.
+const base::Feature kSharedFrameBufferPool{"SharedFrameBufferPool",
+                                           base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Decode software video on a process-wide set of threads shared by all the
+// VpxVideoDecoders and FFmpegVideoDecoders, instead of on the media thread
+// with codec threads sized per decoder.
+const base::Feature kSharedVideoDecodeThreads{
+    "SharedVideoDecodeThreads", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // CanPlayThrough issued according to standard.
 const base::Feature kSpecCompliantCanPlayThrough{
     "SpecCompliantCanPlayThrough", base::FEATURE_ENABLED_BY_DEFAULT};
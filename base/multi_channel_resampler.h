@@ -18,7 +18,9 @@ namespace media {
 class AudioBus;
 
 // MultiChannelResampler is a multi channel wrapper for SincResampler; allowing
-// high quality sample rate conversion of multiple channels at once.
+// high quality sample rate conversion of multiple channels at once.  All
+// channels are resampled in a single pass by one channel-batched SincResampler
+// so each kernel is only read once per output frame.
 class MEDIA_EXPORT MultiChannelResampler {
  public:
   // Callback type for providing more data into the resampler.  Expects AudioBus
@@ -44,7 +46,7 @@ class MEDIA_EXPORT MultiChannelResampler {
   // not call while Resample() is in progress.
   void Flush();
 
-  // Update ratio for all SincResamplers.  SetRatio() will cause reconstruction
+  // Update the resampling ratio.  SetRatio() will cause reconstruction
   // of the kernels used for resampling.  Not thread safe, do not call while
   // Resample() is in progress.
   void SetRatio(double io_sample_rate_ratio);
@@ -60,23 +62,24 @@ class MEDIA_EXPORT MultiChannelResampler {
   void PrimeWithSilence();
 
  private:
-  // SincResampler::ReadCB implementation.  ProvideInput() will be called for
-  // each channel (in channel order) as SincResampler needs more data.
-  void ProvideInput(int channel, int frames, float* destination);
+  // SincResampler::MultiChannelReadCB implementation.  Called as
+  // SincResampler needs more data for all channels.
+  void ProvideInput(int frames, float* const* destination);
 
   // Source of data for resampling.
   ReadCB read_cb_;
 
-  // Each channel has its own high quality resampler.
-  std::vector<std::unique_ptr<SincResampler>> resamplers_;
+  // Resamples every channel in lock step.
+  std::unique_ptr<SincResampler> resampler_;
 
-  // Buffers for audio data going into SincResampler from ReadCB.
-  std::unique_ptr<AudioBus> resampler_audio_bus_;
-
-  // To avoid a memcpy() on the first channel we create a wrapped AudioBus where
-  // the first channel points to the |destination| provided to ProvideInput().
+  // To avoid a memcpy() we create a wrapped AudioBus whose channels point to
+  // the |destination| provided to ProvideInput().
   std::unique_ptr<AudioBus> wrapped_resampler_audio_bus_;
 
+  // Output channel pointers handed to |resampler_|, offset by the frames
+  // already produced during the current Resample() call.
+  std::vector<float*> output_channels_;
+
   // The number of output frames that have successfully been processed during
   // the current Resample() call.
   int output_frames_ready_;
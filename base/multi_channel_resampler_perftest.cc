@@ -0,0 +1,75 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/memory/ptr_util.h"
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/multi_channel_resampler.h"
+#include "media/base/sinc_resampler.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 5000;
+static const int kFrames = SincResampler::kDefaultRequestSize;
+
+// Helper functions to provide silence to the resamplers.
+static void ProvideSilence(int frame_delay, AudioBus* audio_bus) {
+  audio_bus->Zero();
+}
+
+static void ProvideChannelSilence(int frames, float* destination) {
+  memset(destination, 0, sizeof(*destination) * frames);
+}
+
+// Benchmark MultiChannelResampler, which resamples all channels in one pass,
+// against running one SincResampler per channel.
+TEST(MultiChannelResamplerPerfTest, Resample) {
+  static const double kRatios[] = {44100.0 / 48000, 192000.0 / 44100};
+  static const char* const kRatioNames[] = {"polyphase", "interpolated"};
+  for (int channels : {2, 6, 8}) {
+    std::unique_ptr<AudioBus> output = AudioBus::Create(channels, kFrames);
+    for (size_t r = 0; r < arraysize(kRatios); ++r) {
+      const std::string test_name = "multi_channel_resampler_" +
+                                    std::to_string(channels) + "ch_" +
+                                    kRatioNames[r];
+
+      MultiChannelResampler resampler(channels, kRatios[r], kFrames,
+                                      base::Bind(&ProvideSilence));
+      base::TimeTicks start = base::TimeTicks::Now();
+      for (int i = 0; i < kBenchmarkIterations; ++i)
+        resampler.Resample(kFrames, output.get());
+      double total_time_milliseconds =
+          (base::TimeTicks::Now() - start).InMillisecondsF();
+      perf_test::PrintResult(test_name, "", "batched",
+                             kBenchmarkIterations / total_time_milliseconds,
+                             "runs/ms", true);
+
+      std::vector<std::unique_ptr<SincResampler>> per_channel;
+      for (int ch = 0; ch < channels; ++ch) {
+        per_channel.push_back(base::MakeUnique<SincResampler>(
+            kRatios[r], kFrames, base::Bind(&ProvideChannelSilence)));
+      }
+      start = base::TimeTicks::Now();
+      for (int i = 0; i < kBenchmarkIterations; ++i) {
+        for (int ch = 0; ch < channels; ++ch)
+          per_channel[ch]->Resample(kFrames, output->channel(ch));
+      }
+      total_time_milliseconds =
+          (base::TimeTicks::Now() - start).InMillisecondsF();
+      perf_test::PrintResult(test_name, "", "per_channel",
+                             kBenchmarkIterations / total_time_milliseconds,
+                             "runs/ms", true);
+    }
+  }
+}
+
+}  // namespace media
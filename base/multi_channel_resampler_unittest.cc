@@ -133,6 +133,60 @@ TEST_P(MultiChannelResamplerTest, LowLatency) {
   LowLatencyTest(GetParam());
 }
 
+// Fills every channel with a different ramp so that channel mixups show up.
+static void ProvideRamp(int* position, int frame_delay, AudioBus* audio_bus) {
+  for (int ch = 0; ch < audio_bus->channels(); ++ch) {
+    for (int i = 0; i < audio_bus->frames(); ++i) {
+      audio_bus->channel(ch)[i] =
+          ((*position + i) % 100) / 100.0f * (ch % 2 ? -1 : 1) / (ch + 1);
+    }
+  }
+  *position += audio_bus->frames();
+}
+
+// SincResampler::ReadCB which renders every channel of the ramp into |source|
+// but only hands out channel |ch|.
+static void ProvideRampChannel(int* position,
+                               AudioBus* source,
+                               int ch,
+                               int frames,
+                               float* destination) {
+  ProvideRamp(position, 0, source);
+  memcpy(destination, source->channel(ch), sizeof(*destination) * frames);
+}
+
+// Resampling all channels in one pass must produce exactly what a separate
+// single channel resampler produces for each channel.
+TEST_P(MultiChannelResamplerTest, MatchesSingleChannel) {
+  const int channels = GetParam();
+  static const int kFrames = 1000;
+
+  // Both a polyphase and an interpolated ratio.
+  for (double ratio : {44100.0 / 48000, static_cast<double>(kScaleFactor)}) {
+    int position = 0;
+    MultiChannelResampler resampler(
+        channels, ratio, SincResampler::kDefaultRequestSize,
+        base::Bind(&ProvideRamp, base::Unretained(&position)));
+    std::unique_ptr<AudioBus> output = AudioBus::Create(channels, kFrames);
+    resampler.Resample(kFrames, output.get());
+
+    for (int ch = 0; ch < channels; ++ch) {
+      std::unique_ptr<AudioBus> expected = AudioBus::Create(1, kFrames);
+      std::unique_ptr<AudioBus> source =
+          AudioBus::Create(channels, SincResampler::kDefaultRequestSize);
+      int single_position = 0;
+      SincResampler single_resampler(
+          ratio, SincResampler::kDefaultRequestSize,
+          base::Bind(&ProvideRampChannel, base::Unretained(&single_position),
+                     base::Unretained(source.get()), ch));
+      single_resampler.Resample(kFrames, expected->channel(0));
+
+      for (int i = 0; i < kFrames; ++i)
+        ASSERT_EQ(expected->channel(0)[i], output->channel(ch)[i]) << i;
+    }
+  }
+}
+
 // Test common channel layouts: mono, stereo, 5.1, 7.1.
 INSTANTIATE_TEST_CASE_P(
     MultiChannelResamplerTest, MultiChannelResamplerTest,
@@ -0,0 +1,191 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/parallel_audio_mixer.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/threading/simple_thread.h"
+#include "base/trace_event/trace_event.h"
+#include "media/base/audio_bus.h"
+#include "media/base/vector_math.h"
+
+namespace media {
+
+constexpr int ParallelAudioMixer::kTileFrames;
+constexpr int ParallelAudioMixer::kSourcesPerSum;
+constexpr int ParallelAudioMixer::kMinInputs;
+
+// Sleeps until woken, then joins in on the tasks of the current phase.
+class ParallelAudioMixer::HelperThread
+    : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit HelperThread(ParallelAudioMixer* mixer)
+      : mixer_(mixer),
+        wake_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+              base::WaitableEvent::InitialState::NOT_SIGNALED),
+        stop_(false),
+        thread_(this,
+                "AudioMixerHelper",
+                base::SimpleThread::Options(
+                    base::ThreadPriority::REALTIME_AUDIO)) {
+    thread_.Start();
+  }
+
+  ~HelperThread() override {
+    stop_ = true;
+    wake_.Signal();
+    thread_.Join();
+  }
+
+  void Wake() { wake_.Signal(); }
+
+  // base::DelegateSimpleThread::Delegate implementation.
+  void Run() override {
+    while (true) {
+      wake_.Wait();
+      if (stop_)
+        return;
+      mixer_->RunTasks();
+      mixer_->OnHelperDone();
+    }
+  }
+
+ private:
+  ParallelAudioMixer* const mixer_;
+  base::WaitableEvent wake_;
+
+  // Set before |wake_| is signaled for the last time.
+  bool stop_;
+
+  base::DelegateSimpleThread thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(HelperThread);
+};
+
+ParallelAudioMixer::ParallelAudioMixer(int helper_threads)
+    : frames_delayed_(0),
+      dest_(nullptr),
+      tiles_per_channel_(0),
+      phase_(Phase::kProvideInput),
+      task_count_(0),
+      next_task_(0),
+      busy_helpers_(0),
+      helpers_done_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                    base::WaitableEvent::InitialState::NOT_SIGNALED) {
+  DCHECK_GE(helper_threads, 0);
+  for (int i = 0; i < helper_threads; ++i)
+    helpers_.push_back(base::MakeUnique<HelperThread>(this));
+}
+
+ParallelAudioMixer::~ParallelAudioMixer() {}
+
+void ParallelAudioMixer::Mix(
+    const std::list<AudioConverter::InputCallback*>& inputs,
+    uint32_t frames_delayed,
+    AudioBus* dest) {
+  TRACE_EVENT1("audio", "ParallelAudioMixer::Mix", "inputs", inputs.size());
+  inputs_.assign(inputs.begin(), inputs.end());
+  volumes_.resize(inputs_.size());
+  frames_delayed_ = frames_delayed;
+  dest_ = dest;
+
+  // Buses are only (re)acquired when the number of inputs grows or the buffer
+  // size changes, so the steady state doesn't allocate.
+  if (input_buses_.size() < inputs_.size())
+    input_buses_.resize(inputs_.size());
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (!input_buses_[i] || input_buses_[i]->channels() != dest->channels() ||
+        input_buses_[i]->frames() != dest->frames()) {
+      input_buses_[i] = AudioBusPool::Acquire(dest->channels(), dest->frames());
+    }
+  }
+
+  RunInParallel(Phase::kProvideInput, inputs_.size());
+
+  audible_inputs_.clear();
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (volumes_[i] > 0)
+      audible_inputs_.push_back(i);
+  }
+  if (audible_inputs_.empty()) {
+    dest->Zero();
+    return;
+  }
+
+  tiles_per_channel_ = (dest->frames() + kTileFrames - 1) / kTileFrames;
+  RunInParallel(Phase::kSum, dest->channels() * tiles_per_channel_);
+}
+
+void ParallelAudioMixer::RunInParallel(Phase phase, int task_count) {
+  phase_ = phase;
+  task_count_ = task_count;
+  base::subtle::NoBarrier_Store(&next_task_, 0);
+
+  // The calling thread takes a share of the tasks too, so only wake as many
+  // helpers as there are tasks left over for.
+  const int helpers =
+      std::min(static_cast<int>(helpers_.size()), task_count - 1);
+  base::subtle::NoBarrier_Store(&busy_helpers_, std::max(helpers, 0));
+  for (int i = 0; i < helpers; ++i)
+    helpers_[i]->Wake();
+
+  RunTasks();
+  if (helpers > 0)
+    helpers_done_.Wait();
+}
+
+void ParallelAudioMixer::RunTasks() {
+  while (true) {
+    const int index =
+        base::subtle::NoBarrier_AtomicIncrement(&next_task_, 1) - 1;
+    if (index >= task_count_)
+      return;
+    if (phase_ == Phase::kProvideInput)
+      ProvideInput(index);
+    else
+      SumTile(index);
+  }
+}
+
+void ParallelAudioMixer::OnHelperDone() {
+  // The barrier publishes this helper's results to the calling thread.
+  if (base::subtle::Barrier_AtomicIncrement(&busy_helpers_, -1) == 0)
+    helpers_done_.Signal();
+}
+
+void ParallelAudioMixer::ProvideInput(int index) {
+  volumes_[index] = inputs_[index]->ProvideInput(input_buses_[index].get(),
+                                                 frames_delayed_);
+}
+
+void ParallelAudioMixer::SumTile(int index) {
+  const int ch = index / tiles_per_channel_;
+  const int offset = (index % tiles_per_channel_) * kTileFrames;
+  const int frames = std::min(kTileFrames, dest_->frames() - offset);
+  float* const dest = dest_->channel(ch) + offset;
+
+  // The first pass writes the tile; every later one also adds it back in.
+  const float* sources[kSourcesPerSum + 1];
+  float scales[kSourcesPerSum + 1];
+  const int audible_inputs = static_cast<int>(audible_inputs_.size());
+  for (int first = 0; first < audible_inputs; first += kSourcesPerSum) {
+    int count = 0;
+    if (first > 0) {
+      sources[count] = dest;
+      scales[count++] = 1.0f;
+    }
+    const int last = std::min(first + kSourcesPerSum, audible_inputs);
+    for (int i = first; i < last; ++i) {
+      const int input = audible_inputs_[i];
+      sources[count] = input_buses_[input]->channel(ch) + offset;
+      scales[count++] = volumes_[input];
+    }
+    vector_math::WeightedSum(sources, scales, count, frames, dest);
+  }
+}
+
+}  // namespace media
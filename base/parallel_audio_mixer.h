@@ -0,0 +1,108 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_PARALLEL_AUDIO_MIXER_H_
+#define MEDIA_BASE_PARALLEL_AUDIO_MIXER_H_
+
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/macros.h"
+#include "base/synchronization/waitable_event.h"
+#include "media/base/audio_bus_pool.h"
+#include "media/base/audio_converter.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// Mixes the inputs of an AudioConverter on a set of helper threads as well as
+// the calling thread, for converters with more inputs than one real-time thread
+// can pull within a buffer period; e.g., a mixer on a media server.
+//
+// Each Mix() first hands the inputs out across the threads, so their
+// ProvideInput() calls run concurrently into one AudioBus per input.  The
+// results are then summed into the destination in cache sized tiles, again
+// spread across the threads, with up to kSourcesPerSum inputs added by each
+// vector_math::WeightedSum() pass.  Inputs reporting a volume of zero are
+// skipped entirely.
+//
+// ProvideInput() may be called on any of the threads, though never on two at
+// once for the same input.  Mix() blocks until all of the work is done.
+class MEDIA_EXPORT ParallelAudioMixer {
+ public:
+  // Frames of one channel summed as a unit of work.  A tile of kSourcesPerSum
+  // inputs plus the destination fits comfortably in L1.
+  static constexpr int kTileFrames = 256;
+  static constexpr int kSourcesPerSum = 8;
+
+  // Below this many inputs waking the helper threads costs more than it saves,
+  // so AudioConverter mixes on the calling thread alone.
+  static constexpr int kMinInputs = 8;
+
+  // Starts |helper_threads| threads at real-time audio priority, which sleep
+  // between Mix() calls.
+  explicit ParallelAudioMixer(int helper_threads);
+  ~ParallelAudioMixer();
+
+  // Calls ProvideInput() on each of |inputs| with |frames_delayed| and sets
+  // |dest| to the sum of the results, each scaled by its volume.
+  void Mix(const std::list<AudioConverter::InputCallback*>& inputs,
+           uint32_t frames_delayed,
+           AudioBus* dest);
+
+  int helper_threads() const { return static_cast<int>(helpers_.size()); }
+
+ private:
+  class HelperThread;
+
+  enum class Phase { kProvideInput, kSum };
+
+  // Runs |task_count| tasks of |phase| across the helper threads and the
+  // calling thread, returning once all have finished.
+  void RunInParallel(Phase phase, int task_count);
+
+  // Claims and runs tasks of the current phase until none are left.  Called on
+  // every participating thread.
+  void RunTasks();
+
+  // Called by each helper thread once RunTasks() returns.
+  void OnHelperDone();
+
+  // Tasks: pulls the input at |index|, or sums the tile at |index|, counting
+  // tiles channel by channel.
+  void ProvideInput(int index);
+  void SumTile(int index);
+
+  std::vector<std::unique_ptr<HelperThread>> helpers_;
+
+  // State of the current Mix() call.  Written only while the helper threads
+  // sleep; signaling them publishes it.
+  std::vector<AudioConverter::InputCallback*> inputs_;
+  std::vector<AudioBusPool::ScopedAudioBus> input_buses_;
+  std::vector<float> volumes_;
+  std::vector<int> audible_inputs_;
+  uint32_t frames_delayed_;
+  AudioBus* dest_;
+  int tiles_per_channel_;
+  Phase phase_;
+  int task_count_;
+
+  // Index of the next unclaimed task, and the number of helper threads woken
+  // for the current phase which are still running tasks.
+  volatile base::subtle::Atomic32 next_task_;
+  volatile base::subtle::Atomic32 busy_helpers_;
+
+  // Signaled by the last helper thread to finish a phase.
+  base::WaitableEvent helpers_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelAudioMixer);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_PARALLEL_AUDIO_MIXER_H_
@@ -0,0 +1,113 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/parallel_audio_mixer.h"
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "media/base/audio_bus.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kChannels = 2;
+static const uint32_t kFramesDelayed = 123;
+
+// Fills every request with a value unique to the input, frame and channel, and
+// returns a fixed volume.
+class ConstantInput : public AudioConverter::InputCallback {
+ public:
+  ConstantInput(int id, float volume)
+      : id_(id), volume_(volume), calls_(0) {}
+  ~ConstantInput() override {}
+
+  double ProvideInput(AudioBus* audio_bus, uint32_t frames_delayed) override {
+    EXPECT_EQ(kFramesDelayed, frames_delayed);
+    ++calls_;
+    for (int ch = 0; ch < audio_bus->channels(); ++ch) {
+      for (int i = 0; i < audio_bus->frames(); ++i)
+        audio_bus->channel(ch)[i] = Sample(ch, i);
+    }
+    return volume_;
+  }
+
+  float Sample(int ch, int i) const {
+    return 0.001f * (id_ + 1) + 0.0001f * ((i + ch) % 7);
+  }
+
+  float volume() const { return volume_; }
+  int calls() const { return calls_; }
+
+ private:
+  const int id_;
+  const float volume_;
+  int calls_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConstantInput);
+};
+
+// Mixes |input_count| inputs, every fifth of them silent, into |frames| frames
+// and verifies the result and that each input was pulled once.
+static void TestMix(ParallelAudioMixer* mixer, int input_count, int frames) {
+  SCOPED_TRACE(testing::Message() << mixer->helper_threads() << " helpers, "
+                                  << input_count << " inputs, " << frames
+                                  << " frames");
+  std::vector<std::unique_ptr<ConstantInput>> inputs;
+  std::list<AudioConverter::InputCallback*> input_list;
+  for (int i = 0; i < input_count; ++i) {
+    inputs.push_back(
+        base::MakeUnique<ConstantInput>(i, i % 5 ? 0.1f * (i % 10) : 0.0f));
+    input_list.push_back(inputs.back().get());
+  }
+
+  std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, frames);
+  for (int ch = 0; ch < kChannels; ++ch)
+    std::fill(dest->channel(ch), dest->channel(ch) + frames, 100.0f);
+  mixer->Mix(input_list, kFramesDelayed, dest.get());
+
+  for (const auto& input : inputs)
+    EXPECT_EQ(1, input->calls());
+  for (int ch = 0; ch < kChannels; ++ch) {
+    for (int i = 0; i < frames; ++i) {
+      float expected = 0;
+      for (const auto& input : inputs)
+        expected += input->volume() * input->Sample(ch, i);
+      ASSERT_NEAR(expected, dest->channel(ch)[i], 1e-6) << "ch=" << ch
+                                                        << ", i=" << i;
+    }
+  }
+}
+
+// Verify mixing with and without helper threads, with input counts on either
+// side of ParallelAudioMixer::kSourcesPerSum and a partial last tile.
+TEST(ParallelAudioMixerTest, Mix) {
+  for (int helper_threads : {0, 1, 3}) {
+    ParallelAudioMixer mixer(helper_threads);
+    for (int input_count : {1, 2, 8, 9, 37}) {
+      TestMix(&mixer, input_count, 1000);
+      TestMix(&mixer, input_count, ParallelAudioMixer::kTileFrames);
+      TestMix(&mixer, input_count, 128);
+    }
+  }
+}
+
+// Verify the destination is zeroed if every input is silent.
+TEST(ParallelAudioMixerTest, AllSilent) {
+  ParallelAudioMixer mixer(2);
+  ConstantInput input_1(1, 0.0f);
+  ConstantInput input_2(2, 0.0f);
+  std::list<AudioConverter::InputCallback*> input_list = {&input_1, &input_2};
+
+  std::unique_ptr<AudioBus> dest = AudioBus::Create(kChannels, 480);
+  dest->channel(0)[0] = 1.0f;
+  mixer.Mix(input_list, kFramesDelayed, dest.get());
+  EXPECT_TRUE(dest->AreFramesZero());
+}
+
+}  // namespace media
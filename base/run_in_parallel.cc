@@ -0,0 +1,82 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/run_in_parallel.h"
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/task_scheduler/post_task.h"
+
+namespace media {
+
+namespace {
+
+// State shared by RunInParallel() and its worker tasks. A worker task can
+// start after RunInParallel() has returned; every index has been taken by
+// then, so it finds nothing to do and never runs |work_|.
+class ParallelRun : public base::RefCountedThreadSafe<ParallelRun> {
+ public:
+  ParallelRun(size_t count, const base::Callback<void(size_t)>& work)
+      : count_(count),
+        work_(work),
+        next_index_(0),
+        pending_(count),
+        done_(base::WaitableEvent::ResetPolicy::MANUAL,
+              base::WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  // Takes indices and runs |work_| on them until there are none left.
+  void RunRemaining() {
+    while (true) {
+      const size_t index =
+          base::subtle::NoBarrier_AtomicIncrement(&next_index_, 1) - 1;
+      if (index >= count_)
+        return;
+      work_.Run(index);
+      if (base::subtle::Barrier_AtomicIncrement(&pending_, -1) == 0)
+        done_.Signal();
+    }
+  }
+
+  // Waits for the runs that other threads have taken to finish.
+  void Wait() { done_.Wait(); }
+
+ private:
+  friend class base::RefCountedThreadSafe<ParallelRun>;
+  ~ParallelRun() {}
+
+  const size_t count_;
+  const base::Callback<void(size_t)> work_;
+
+  // The next index to run, and the number of runs not yet finished.
+  volatile base::subtle::Atomic32 next_index_;
+  volatile base::subtle::Atomic32 pending_;
+
+  base::WaitableEvent done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelRun);
+};
+
+}  // namespace
+
+void RunInParallel(size_t count, const base::Callback<void(size_t)>& work) {
+  if (count <= 1) {
+    if (count)
+      work.Run(0);
+    return;
+  }
+
+  scoped_refptr<ParallelRun> run(new ParallelRun(count, work));
+  for (size_t i = 1; i < count; ++i) {
+    base::PostTaskWithTraits(
+        FROM_HERE, {base::TaskPriority::USER_BLOCKING},
+        base::BindOnce(&ParallelRun::RunRemaining, run));
+  }
+  run->RunRemaining();
+  run->Wait();
+}
+
+}  // namespace media
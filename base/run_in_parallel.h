@@ -0,0 +1,29 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_RUN_IN_PARALLEL_H_
+#define MEDIA_BASE_RUN_IN_PARALLEL_H_
+
+#include <stddef.h>
+
+#include "base/callback.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// Runs |work| once for each index in [0, |count|), and returns once every run
+// has finished. The calling thread and up to |count| - 1 worker pool tasks
+// take indices from a shared counter. An index that no worker has taken yet is
+// run on the calling thread, so the caller never waits for a worker to be
+// scheduled, only for runs that are already under way on one. If the pool is
+// busy, every index runs on the calling thread, in order.
+//
+// |work| must be safe to run on any thread, and must not block on the thread
+// calling RunInParallel().
+MEDIA_EXPORT void RunInParallel(size_t count,
+                                const base::Callback<void(size_t)>& work);
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_RUN_IN_PARALLEL_H_
@@ -0,0 +1,58 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/run_in_parallel.h"
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+// Counts the runs of each index, and records which thread ran them.
+static void CountRun(std::vector<base::subtle::Atomic32>* runs,
+                     std::vector<base::PlatformThreadId>* threads,
+                     size_t index) {
+  base::subtle::NoBarrier_AtomicIncrement(&(*runs)[index], 1);
+  (*threads)[index] = base::PlatformThread::CurrentId();
+}
+
+static void ExpectEachRanOnce(const std::vector<base::subtle::Atomic32>& runs) {
+  for (size_t i = 0; i < runs.size(); ++i)
+    EXPECT_EQ(1, base::subtle::NoBarrier_Load(&runs[i])) << "index " << i;
+}
+
+TEST(RunInParallelTest, RunsEachIndexOnce) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  for (size_t count : {0, 1, 2, 7, 64}) {
+    std::vector<base::subtle::Atomic32> runs(count, 0);
+    std::vector<base::PlatformThreadId> threads(count);
+    RunInParallel(count, base::Bind(&CountRun, &runs, &threads));
+    ExpectEachRanOnce(runs);
+  }
+}
+
+// Worker tasks that have not started yet must not hold up the caller, and
+// must do nothing when they finally run.
+TEST(RunInParallelTest, RunsOnCallingThreadWhenWorkersDoNotStart) {
+  base::test::ScopedTaskEnvironment scoped_task_environment(
+      base::test::ScopedTaskEnvironment::MainThreadType::DEFAULT,
+      base::test::ScopedTaskEnvironment::ExecutionMode::QUEUED);
+  const size_t kCount = 8;
+  std::vector<base::subtle::Atomic32> runs(kCount, 0);
+  std::vector<base::PlatformThreadId> threads(kCount);
+  RunInParallel(kCount, base::Bind(&CountRun, &runs, &threads));
+  ExpectEachRanOnce(runs);
+  for (size_t i = 0; i < kCount; ++i)
+    EXPECT_EQ(base::PlatformThread::CurrentId(), threads[i]);
+
+  scoped_task_environment.RunUntilIdle();
+  ExpectEachRanOnce(runs);
+}
+
+}  // namespace media
@@ -0,0 +1,239 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/shared_frame_buffer_pool.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/aligned_memory.h"
+#include "base/memory/ptr_util.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task_scheduler/post_task.h"
+#include "media/base/video_frame.h"
+
+namespace media {
+
+namespace {
+
+// Idle buffers kept by the pool of the process.
+const size_t kMaxIdleBytes = 64 << 20;  // 64 MB
+
+// Smallest size class. Smaller buffers aren't worth sharing finely.
+const size_t kMinSizeClass = 4096;
+
+// Idle buffers are freed when they haven't been used for this long.
+constexpr base::TimeDelta kStaleBufferLimit = base::TimeDelta::FromSeconds(10);
+
+}  // namespace
+
+SharedFrameBufferPool::Buffer::Buffer()
+    : pool_(nullptr), data_(nullptr), size_(0) {}
+
+SharedFrameBufferPool::Buffer::Buffer(SharedFrameBufferPool* pool,
+                                      uint8_t* data,
+                                      size_t size)
+    : pool_(pool), data_(data), size_(size) {}
+
+SharedFrameBufferPool::Buffer::Buffer(Buffer&& other)
+    : pool_(other.pool_), data_(other.data_), size_(other.size_) {
+  other.pool_ = nullptr;
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+SharedFrameBufferPool::Buffer& SharedFrameBufferPool::Buffer::operator=(
+    Buffer&& other) {
+  if (this != &other) {
+    Reset();
+    std::swap(pool_, other.pool_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+  }
+  return *this;
+}
+
+SharedFrameBufferPool::Buffer::~Buffer() {
+  Reset();
+}
+
+void SharedFrameBufferPool::Buffer::Reset() {
+  if (data_)
+    pool_->Release(data_, size_);
+  pool_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+}
+
+// static
+SharedFrameBufferPool* SharedFrameBufferPool::GetInstance() {
+  static SharedFrameBufferPool* pool = [] {
+    SharedFrameBufferPool* pool = new SharedFrameBufferPool(kMaxIdleBytes);
+    // The first user may be on a thread without a message loop, so the pool
+    // gets a sequence of its own. The pool is leaked, so its tasks can't
+    // outlive it.
+    scoped_refptr<base::SequencedTaskRunner> task_runner =
+        base::CreateSequencedTaskRunnerWithTraits(
+            {base::TaskPriority::BACKGROUND,
+             base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN});
+    task_runner->PostTask(
+        FROM_HERE, base::Bind(&SharedFrameBufferPool::ListenForMemoryPressure,
+                              base::Unretained(pool)));
+    pool->ExpireIdleBuffersOn(std::move(task_runner));
+    return pool;
+  }();
+  return pool;
+}
+
+SharedFrameBufferPool::SharedFrameBufferPool(size_t max_idle_bytes)
+    : max_idle_bytes_(max_idle_bytes),
+      idle_bytes_(0),
+      allocated_bytes_(0),
+      peak_allocated_bytes_(0),
+      expiry_pending_(false),
+      tick_clock_(&default_tick_clock_) {}
+
+SharedFrameBufferPool::~SharedFrameBufferPool() {
+  base::AutoLock auto_lock(lock_);
+  FreeIdleBuffers(0);
+  DCHECK_EQ(allocated_bytes_, 0u) << "Buffers must not outlive the pool.";
+}
+
+SharedFrameBufferPool::Buffer SharedFrameBufferPool::Allocate(
+    size_t min_size) {
+  const size_t size = SizeClass(min_size);
+  {
+    base::AutoLock auto_lock(lock_);
+
+    // Prefer the most recently used buffer, which is the most likely to still
+    // be in cache.
+    for (auto it = idle_buffers_.rbegin(); it != idle_buffers_.rend(); ++it) {
+      if (it->size != size)
+        continue;
+      uint8_t* data = it->data;
+      idle_buffers_.erase(std::next(it).base());
+      idle_bytes_ -= size;
+      return Buffer(this, data, size);
+    }
+
+    allocated_bytes_ += size;
+    peak_allocated_bytes_ = std::max(peak_allocated_bytes_, allocated_bytes_);
+  }
+
+  uint8_t* data = static_cast<uint8_t*>(
+      base::AlignedAlloc(size, VideoFrame::kFrameAddressAlignment));
+  return Buffer(this, data, size);
+}
+
+void SharedFrameBufferPool::ExpireIdleBuffersOn(
+    scoped_refptr<base::SequencedTaskRunner> task_runner) {
+  base::AutoLock auto_lock(lock_);
+  DCHECK(!expiry_task_runner_);
+  expiry_task_runner_ = std::move(task_runner);
+  ExpireIdleBuffers(tick_clock_->NowTicks());
+}
+
+void SharedFrameBufferPool::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level) {
+  base::AutoLock auto_lock(lock_);
+  switch (memory_pressure_level) {
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      FreeIdleBuffers(idle_bytes_ / 2);
+      break;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      FreeIdleBuffers(0);
+      break;
+    case base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      break;
+  }
+}
+
+// static
+size_t SharedFrameBufferPool::SizeClass(size_t size) {
+  if (size <= kMinSizeClass)
+    return kMinSizeClass;
+
+  // Round up to a quarter of the largest power of two below |size|.
+  size_t power = kMinSizeClass;
+  while (power * 2 < size)
+    power *= 2;
+  const size_t step = power / 4;
+  return (size + step - 1) / step * step;
+}
+
+size_t SharedFrameBufferPool::allocated_bytes() const {
+  base::AutoLock auto_lock(lock_);
+  return allocated_bytes_;
+}
+
+size_t SharedFrameBufferPool::peak_allocated_bytes() const {
+  base::AutoLock auto_lock(lock_);
+  return peak_allocated_bytes_;
+}
+
+size_t SharedFrameBufferPool::idle_bytes() const {
+  base::AutoLock auto_lock(lock_);
+  return idle_bytes_;
+}
+
+void SharedFrameBufferPool::Release(uint8_t* data, size_t size) {
+  base::AutoLock auto_lock(lock_);
+  const base::TimeTicks now = tick_clock_->NowTicks();
+  idle_buffers_.push_back({data, size, now});
+  idle_bytes_ += size;
+  FreeIdleBuffers(max_idle_bytes_);
+  ExpireIdleBuffers(now);
+}
+
+void SharedFrameBufferPool::ExpireIdleBuffers(base::TimeTicks now) {
+  lock_.AssertAcquired();
+  while (!idle_buffers_.empty() &&
+         now - idle_buffers_.front().last_use_time >= kStaleBufferLimit) {
+    FreeBuffer(idle_buffers_.front().data, idle_buffers_.front().size);
+    idle_buffers_.pop_front();
+  }
+
+  if (idle_buffers_.empty() || !expiry_task_runner_ || expiry_pending_)
+    return;
+
+  // Wake up when the least recently used buffer goes stale. If that fails,
+  // e.g. during shutdown, the next release tries again.
+  expiry_pending_ = expiry_task_runner_->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&SharedFrameBufferPool::OnExpiryTask, base::Unretained(this)),
+      idle_buffers_.front().last_use_time + kStaleBufferLimit - now);
+}
+
+void SharedFrameBufferPool::OnExpiryTask() {
+  base::AutoLock auto_lock(lock_);
+  expiry_pending_ = false;
+  ExpireIdleBuffers(tick_clock_->NowTicks());
+}
+
+void SharedFrameBufferPool::FreeIdleBuffers(size_t max_idle_bytes) {
+  lock_.AssertAcquired();
+  while (idle_bytes_ > max_idle_bytes) {
+    FreeBuffer(idle_buffers_.front().data, idle_buffers_.front().size);
+    idle_buffers_.pop_front();
+  }
+}
+
+void SharedFrameBufferPool::FreeBuffer(uint8_t* data, size_t size) {
+  lock_.AssertAcquired();
+  base::AlignedFree(data);
+  idle_bytes_ -= size;
+  allocated_bytes_ -= size;
+}
+
+void SharedFrameBufferPool::ListenForMemoryPressure() {
+  memory_pressure_listener_ = base::MakeUnique<base::MemoryPressureListener>(
+      base::Bind(&SharedFrameBufferPool::OnMemoryPressure,
+                 base::Unretained(this)));
+}
+
+}  // namespace media
@@ -0,0 +1,153 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_SHARED_FRAME_BUFFER_POOL_H_
+#define MEDIA_BASE_SHARED_FRAME_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/default_tick_clock.h"
+#include "media/base/media_export.h"
+
+namespace base {
+class SequencedTaskRunner;
+class TickClock;
+}
+
+namespace media {
+
+// Process-wide pool of video frame memory, shared by the software decoders'
+// frame pools. Instead of every decoder keeping the buffers of its own peak
+// working set around, buffers that no decoder uses go back here, where any
+// decoder can reuse them, even after a resolution change.
+//
+// Buffer sizes are rounded up to size classes, a quarter of a power of two
+// apart, so that frames of similar sizes share buffers. Idle buffers are kept
+// up to a global cap, for at most ten seconds, and are freed on memory
+// pressure: half of them when moderate, all of them when critical.
+//
+// All methods may be called on any thread.
+class MEDIA_EXPORT SharedFrameBufferPool {
+ public:
+  // Memory borrowed from the pool, returned to it on destruction or Reset().
+  class MEDIA_EXPORT Buffer {
+   public:
+    Buffer();
+    Buffer(Buffer&& other);
+    Buffer& operator=(Buffer&& other);
+    ~Buffer();
+
+    // Aligned to VideoFrame::kFrameAddressAlignment. The contents of a new
+    // buffer are unspecified.
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    void Reset();
+
+   private:
+    friend class SharedFrameBufferPool;
+
+    Buffer(SharedFrameBufferPool* pool, uint8_t* data, size_t size);
+
+    SharedFrameBufferPool* pool_;
+    uint8_t* data_;
+    size_t size_;
+
+    DISALLOW_COPY_AND_ASSIGN(Buffer);
+  };
+
+  // Returns the pool of the process. It listens for memory pressure and expires
+  // idle buffers on a TaskScheduler sequence of its own, so it may first be
+  // used on any thread.
+  static SharedFrameBufferPool* GetInstance();
+
+  // Keeps at most |max_idle_bytes| of idle buffers. Buffers must not outlive
+  // the pool.
+  explicit SharedFrameBufferPool(size_t max_idle_bytes);
+  ~SharedFrameBufferPool();
+
+  // Returns a buffer of at least |min_size| bytes.
+  Buffer Allocate(size_t min_size);
+
+  // Frees idle buffers once they have been unused for ten seconds, using
+  // delayed tasks on |task_runner|, which must not run them after the pool is
+  // destroyed. Until this is called, stale buffers are only freed when another
+  // buffer is released.
+  void ExpireIdleBuffersOn(
+      scoped_refptr<base::SequencedTaskRunner> task_runner);
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
+
+  // Returns the size class |size| is rounded up to.
+  static size_t SizeClass(size_t size);
+
+  // Bytes allocated by the pool, both used and idle, and their peak.
+  size_t allocated_bytes() const;
+  size_t peak_allocated_bytes() const;
+  size_t idle_bytes() const;
+
+  void set_tick_clock_for_testing(base::TickClock* tick_clock) {
+    tick_clock_ = tick_clock;
+  }
+
+ private:
+  void Release(uint8_t* data, size_t size);
+
+  // Frees the idle buffers unused for too long at |now|, and schedules the
+  // next expiry if any remain. |lock_| must be held.
+  void ExpireIdleBuffers(base::TimeTicks now);
+
+  void OnExpiryTask();
+
+  // Frees the least recently used idle buffers until at most |max_idle_bytes|
+  // remain. |lock_| must be held.
+  void FreeIdleBuffers(size_t max_idle_bytes);
+
+  void FreeBuffer(uint8_t* data, size_t size);
+
+  void ListenForMemoryPressure();
+
+  const size_t max_idle_bytes_;
+
+  mutable base::Lock lock_;
+
+  struct IdleBuffer {
+    uint8_t* data;
+    size_t size;
+    base::TimeTicks last_use_time;
+  };
+
+  // Idle buffers in LRU order, the least recently used at the front.
+  base::circular_deque<IdleBuffer> idle_buffers_;
+  size_t idle_bytes_;
+
+  size_t allocated_bytes_;
+  size_t peak_allocated_bytes_;
+
+  std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  // See ExpireIdleBuffersOn(). |expiry_pending_| is true while an expiry task
+  // is posted.
+  scoped_refptr<base::SequencedTaskRunner> expiry_task_runner_;
+  bool expiry_pending_;
+
+  // |tick_clock_| is always &|default_tick_clock_| outside of testing.
+  base::DefaultTickClock default_tick_clock_;
+  base::TickClock* tick_clock_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedFrameBufferPool);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_SHARED_FRAME_BUFFER_POOL_H_
@@ -0,0 +1,183 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/test/simple_test_tick_clock.h"
+#include "base/test/test_simple_task_runner.h"
+#include "media/base/shared_frame_buffer_pool.h"
+#include "media/base/video_frame.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+// Sizes in the same size class.
+const size_t kSize = 100000;
+const size_t kSimilarSize = 110000;
+const size_t kSizeClass = 114688;
+
+class SharedFrameBufferPoolTest : public testing::Test {
+ public:
+  SharedFrameBufferPoolTest() : pool_(4 * kSizeClass) {
+    pool_.set_tick_clock_for_testing(&clock_);
+  }
+
+ protected:
+  base::SimpleTestTickClock clock_;
+  SharedFrameBufferPool pool_;
+};
+
+TEST_F(SharedFrameBufferPoolTest, SizeClasses) {
+  EXPECT_EQ(4096u, SharedFrameBufferPool::SizeClass(1));
+  EXPECT_EQ(4096u, SharedFrameBufferPool::SizeClass(4096));
+  EXPECT_EQ(5120u, SharedFrameBufferPool::SizeClass(4097));
+  EXPECT_EQ(kSizeClass, SharedFrameBufferPool::SizeClass(kSize));
+  EXPECT_EQ(kSizeClass, SharedFrameBufferPool::SizeClass(kSimilarSize));
+  EXPECT_EQ(131072u, SharedFrameBufferPool::SizeClass(kSizeClass + 1));
+
+  // A 1080p I420 frame wastes less than a quarter of its buffer.
+  EXPECT_EQ(3145728u, SharedFrameBufferPool::SizeClass(1920 * 1080 * 3 / 2));
+}
+
+TEST_F(SharedFrameBufferPoolTest, ReusesBuffersOfTheSameSizeClass) {
+  SharedFrameBufferPool::Buffer buffer = pool_.Allocate(kSize);
+  ASSERT_TRUE(buffer.data());
+  EXPECT_EQ(kSizeClass, buffer.size());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(buffer.data()) %
+                    VideoFrame::kFrameAddressAlignment);
+  uint8_t* const data = buffer.data();
+
+  buffer.Reset();
+  EXPECT_FALSE(buffer.data());
+  EXPECT_EQ(kSizeClass, pool_.idle_bytes());
+
+  buffer = pool_.Allocate(kSimilarSize);
+  EXPECT_EQ(data, buffer.data());
+  EXPECT_EQ(0u, pool_.idle_bytes());
+  EXPECT_EQ(kSizeClass, pool_.allocated_bytes());
+
+  // A buffer of another size class is not reused.
+  buffer.Reset();
+  SharedFrameBufferPool::Buffer larger = pool_.Allocate(2 * kSize);
+  EXPECT_EQ(kSizeClass, pool_.idle_bytes());
+}
+
+TEST_F(SharedFrameBufferPoolTest, CapsIdleBytes) {
+  std::vector<SharedFrameBufferPool::Buffer> buffers;
+  for (int i = 0; i < 6; ++i)
+    buffers.push_back(pool_.Allocate(kSize));
+  EXPECT_EQ(6 * kSizeClass, pool_.allocated_bytes());
+
+  buffers.clear();
+  EXPECT_EQ(4 * kSizeClass, pool_.idle_bytes());
+  EXPECT_EQ(4 * kSizeClass, pool_.allocated_bytes());
+  EXPECT_EQ(6 * kSizeClass, pool_.peak_allocated_bytes());
+}
+
+TEST_F(SharedFrameBufferPoolTest, StaleBuffersAreFreed) {
+  SharedFrameBufferPool::Buffer buffer1 = pool_.Allocate(kSize);
+  SharedFrameBufferPool::Buffer buffer2 = pool_.Allocate(kSize);
+  buffer1.Reset();
+
+  clock_.Advance(base::TimeDelta::FromSeconds(11));
+  buffer2.Reset();
+  EXPECT_EQ(kSizeClass, pool_.idle_bytes());
+  EXPECT_EQ(kSizeClass, pool_.allocated_bytes());
+}
+
+TEST_F(SharedFrameBufferPoolTest, StaleBuffersExpireWithoutReleases) {
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner(
+      new base::TestSimpleTaskRunner());
+  pool_.ExpireIdleBuffersOn(task_runner);
+
+  SharedFrameBufferPool::Buffer buffer1 = pool_.Allocate(kSize);
+  SharedFrameBufferPool::Buffer buffer2 = pool_.Allocate(kSize);
+  buffer1.Reset();
+  clock_.Advance(base::TimeDelta::FromSeconds(5));
+  buffer2.Reset();
+  EXPECT_EQ(2 * kSizeClass, pool_.idle_bytes());
+
+  // A single task wakes up when the oldest buffer goes stale...
+  ASSERT_EQ(1u, task_runner->NumPendingTasks());
+  EXPECT_EQ(base::TimeDelta::FromSeconds(10),
+            task_runner->NextPendingTaskDelay());
+  clock_.Advance(base::TimeDelta::FromSeconds(5));
+  task_runner->RunPendingTasks();
+  EXPECT_EQ(kSizeClass, pool_.idle_bytes());
+
+  // ...and then again for the next one.
+  ASSERT_EQ(1u, task_runner->NumPendingTasks());
+  EXPECT_EQ(base::TimeDelta::FromSeconds(5),
+            task_runner->NextPendingTaskDelay());
+  clock_.Advance(base::TimeDelta::FromSeconds(5));
+  task_runner->RunPendingTasks();
+  EXPECT_EQ(0u, pool_.idle_bytes());
+  EXPECT_EQ(0u, pool_.allocated_bytes());
+  EXPECT_FALSE(task_runner->HasPendingTask());
+}
+
+// TestSimpleTaskRunner which can be made to reject tasks, as task runners do
+// during shutdown.
+class RejectingTaskRunner : public base::TestSimpleTaskRunner {
+ public:
+  RejectingTaskRunner() : reject_tasks_(false) {}
+
+  bool PostDelayedTask(const base::Location& from_here,
+                       base::OnceClosure task,
+                       base::TimeDelta delay) override {
+    if (reject_tasks_)
+      return false;
+    return base::TestSimpleTaskRunner::PostDelayedTask(from_here,
+                                                       std::move(task), delay);
+  }
+
+  void set_reject_tasks(bool reject_tasks) { reject_tasks_ = reject_tasks; }
+
+ private:
+  ~RejectingTaskRunner() override {}
+
+  bool reject_tasks_;
+};
+
+TEST_F(SharedFrameBufferPoolTest, ExpiryIsRescheduledAfterAFailedPost) {
+  scoped_refptr<RejectingTaskRunner> task_runner(new RejectingTaskRunner());
+  task_runner->set_reject_tasks(true);
+  pool_.ExpireIdleBuffersOn(task_runner);
+
+  SharedFrameBufferPool::Buffer buffer1 = pool_.Allocate(kSize);
+  SharedFrameBufferPool::Buffer buffer2 = pool_.Allocate(kSize);
+  buffer1.Reset();
+  EXPECT_FALSE(task_runner->HasPendingTask());
+
+  task_runner->set_reject_tasks(false);
+  buffer2.Reset();
+  ASSERT_EQ(1u, task_runner->NumPendingTasks());
+  clock_.Advance(base::TimeDelta::FromSeconds(10));
+  task_runner->RunPendingTasks();
+  EXPECT_EQ(0u, pool_.idle_bytes());
+}
+
+TEST_F(SharedFrameBufferPoolTest, MemoryPressureFreesIdleBuffers) {
+  std::vector<SharedFrameBufferPool::Buffer> buffers;
+  for (int i = 0; i < 4; ++i)
+    buffers.push_back(pool_.Allocate(kSize));
+  SharedFrameBufferPool::Buffer used = pool_.Allocate(kSize);
+  buffers.clear();
+
+  pool_.OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  EXPECT_EQ(2 * kSizeClass, pool_.idle_bytes());
+
+  pool_.OnMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  EXPECT_EQ(0u, pool_.idle_bytes());
+
+  // Buffers in use are not affected.
+  EXPECT_EQ(kSizeClass, pool_.allocated_bytes());
+}
+
+}  // namespace media
@@ -72,9 +72,14 @@
 //
 // Note: we're glossing over how the sub-sample handling works with
 // |virtual_source_idx_|, etc.
+//
+// Multi-channel resamplers lay out one such buffer per channel back-to-back in
+// |input_buffer_|; the region pointers always refer to the first channel and
+// every step above is applied to all channels at once.
 
 #include "media/base/sinc_resampler.h"
 
+#include <cmath>
 #include <limits>
 
 #include "base/logging.h"
@@ -84,15 +89,30 @@
 #if defined(ARCH_CPU_X86_FAMILY)
 #include <xmmintrin.h>
 #define CONVOLVE_FUNC Convolve_SSE
+#define CONVOLVE_POLYPHASE_FUNC ConvolvePolyphase_SSE
+#define CONVOLVE_CHANNELS_FUNC ConvolveChannels_SSE
+#define CONVOLVE_POLYPHASE_CHANNELS_FUNC ConvolvePolyphaseChannels_SSE
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #include <arm_neon.h>
 #define CONVOLVE_FUNC Convolve_NEON
+#define CONVOLVE_POLYPHASE_FUNC ConvolvePolyphase_NEON
+#define CONVOLVE_CHANNELS_FUNC ConvolveChannels_NEON
+#define CONVOLVE_POLYPHASE_CHANNELS_FUNC ConvolvePolyphaseChannels_NEON
 #else
 #define CONVOLVE_FUNC Convolve_C
+#define CONVOLVE_POLYPHASE_FUNC ConvolvePolyphase_C
+#define CONVOLVE_CHANNELS_FUNC ConvolveChannels_C
+#define CONVOLVE_POLYPHASE_CHANNELS_FUNC ConvolvePolyphaseChannels_C
 #endif
 
 namespace media {
 
+// Blackman window parameters.
+static const double kAlpha = 0.16;
+static const double kA0 = 0.5 * (1.0 - kAlpha);
+static const double kA1 = 0.5;
+static const double kA2 = 0.5 * kAlpha;
+
 static double SincScaleFactor(double io_ratio) {
   // |sinc_scale_factor| is basically the normalized cutoff frequency of the
   // low-pass filter.
@@ -109,17 +129,64 @@ static double SincScaleFactor(double io_ratio) {
   return sinc_scale_factor;
 }
 
+// Rounds |size| up so that consecutive channel buffers stay 16-byte aligned.
+static int CalculateInputBufferStride(int size) {
+  return (size + 3) & ~3;
+}
+
 static int CalculateChunkSize(int block_size_, double io_ratio) {
   return block_size_ / io_ratio;
 }
 
+// Returns the smallest |denominator| <= |max_denominator| for which |io_ratio|
+// is |numerator| / |denominator| to within double precision, or zero if there
+// is no such fraction.  Ratios built from integer sample rates are exact here.
+static int CalculatePolyphaseCount(double io_ratio,
+                                   int max_denominator,
+                                   int* numerator) {
+  for (int denominator = 1; denominator <= max_denominator; ++denominator) {
+    const double candidate = std::round(io_ratio * denominator);
+    if (candidate < 1 || candidate > std::numeric_limits<int>::max())
+      continue;
+    if (std::fabs(candidate / denominator - io_ratio) <= io_ratio * 1e-12) {
+      *numerator = static_cast<int>(candidate);
+      return denominator;
+    }
+  }
+  return 0;
+}
+
 SincResampler::SincResampler(double io_sample_rate_ratio,
                              int request_frames,
                              const ReadCB& read_cb)
+    : SincResampler(1,
+                    io_sample_rate_ratio,
+                    request_frames,
+                    read_cb,
+                    MultiChannelReadCB()) {}
+
+SincResampler::SincResampler(int channels,
+                             double io_sample_rate_ratio,
+                             int request_frames,
+                             const MultiChannelReadCB& read_cb)
+    : SincResampler(channels,
+                    io_sample_rate_ratio,
+                    request_frames,
+                    ReadCB(),
+                    read_cb) {}
+
+SincResampler::SincResampler(int channels,
+                             double io_sample_rate_ratio,
+                             int request_frames,
+                             const ReadCB& read_cb,
+                             const MultiChannelReadCB& multi_channel_read_cb)
     : io_sample_rate_ratio_(io_sample_rate_ratio),
+      channels_(channels),
       read_cb_(read_cb),
+      multi_channel_read_cb_(multi_channel_read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
+      input_buffer_stride_(CalculateInputBufferStride(input_buffer_size_)),
       // Create input buffers with a 16-byte alignment for SSE optimizations.
       kernel_storage_(static_cast<float*>(
           base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
@@ -127,11 +194,22 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
           base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
       kernel_window_storage_(static_cast<float*>(
           base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
+      polyphase_ratio_(0),
+      polyphase_kernel_count_(0),
+      polyphase_count_(0),
+      polyphase_step_(0),
+      polyphase_phase_step_(0),
+      polyphase_source_idx_(0),
+      polyphase_phase_(0),
       input_buffer_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * input_buffer_size_, 16))),
+          base::AlignedAlloc(sizeof(float) * input_buffer_stride_ * channels_,
+                             16))),
+      read_destinations_(new float*[channels_]),
       r1_(input_buffer_.get()),
       r2_(input_buffer_.get() + kKernelSize / 2) {
+  CHECK_GT(channels_, 0);
   CHECK_GT(request_frames_, 0);
+  CHECK_NE(read_cb_.is_null(), multi_channel_read_cb_.is_null());
   Flush();
   CHECK_GT(block_size_, kKernelSize)
       << "block_size must be greater than kKernelSize!";
@@ -144,6 +222,8 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
          sizeof(*kernel_window_storage_.get()) * kKernelStorageSize);
 
   InitializeKernel();
+  InitializePolyphase();
+  SelectPolyphase(true);
 }
 
 SincResampler::~SincResampler() {}
@@ -165,13 +245,18 @@ void SincResampler::UpdateRegions(bool second_load) {
   CHECK_LT(r2_, r3_);
 }
 
-void SincResampler::InitializeKernel() {
-  // Blackman window parameters.
-  static const double kAlpha = 0.16;
-  static const double kA0 = 0.5 * (1.0 - kAlpha);
-  static const double kA1 = 0.5;
-  static const double kA2 = 0.5 * kAlpha;
+void SincResampler::ReadInput() {
+  if (!read_cb_.is_null()) {
+    read_cb_.Run(request_frames_, r0_);
+    return;
+  }
+
+  for (int ch = 0; ch < channels_; ++ch)
+    read_destinations_[ch] = r0_ + ch * input_buffer_stride_;
+  multi_channel_read_cb_.Run(request_frames_, read_destinations_.get());
+}
 
+void SincResampler::InitializeKernel() {
   // Generates a set of windowed sinc() kernels.
   // We generate a range of sub-sample offsets from 0.0 to 1.0.
   const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
@@ -201,6 +286,74 @@ void SincResampler::InitializeKernel() {
   }
 }
 
+void SincResampler::InitializePolyphase() {
+  int numerator = 0;
+  const int count = CalculatePolyphaseCount(io_sample_rate_ratio_,
+                                            kMaxPolyphaseKernels, &numerator);
+  if (!count)
+    return;
+
+  polyphase_ratio_ = io_sample_rate_ratio_;
+  polyphase_kernel_count_ = count;
+  polyphase_step_ = numerator / count;
+  polyphase_phase_step_ = numerator % count;
+  polyphase_kernel_storage_.reset(static_cast<float*>(
+      base::AlignedAlloc(sizeof(float) * count * kKernelSize, 16)));
+
+  // Generate one windowed sinc() kernel per phase, using the same math as
+  // InitializeKernel() so that phases which coincide with a kernel offset
+  // produce identical kernels.
+  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
+  for (int phase = 0; phase < count; ++phase) {
+    const float subsample_offset = static_cast<float>(phase) / count;
+
+    for (int i = 0; i < kKernelSize; ++i) {
+      const float pre_sinc =
+          base::kPiFloat * (i - kKernelSize / 2 - subsample_offset);
+      const float x = (i - subsample_offset) / kKernelSize;
+      const float window =
+          static_cast<float>(kA0 - kA1 * cos(2.0 * base::kPiDouble * x) +
+                             kA2 * cos(4.0 * base::kPiDouble * x));
+      polyphase_kernel_storage_[phase * kKernelSize + i] = static_cast<float>(
+          window * (pre_sinc ? sin(sinc_scale_factor * pre_sinc) / pre_sinc
+                             : sinc_scale_factor));
+    }
+  }
+}
+
+void SincResampler::SelectPolyphase(bool allow_polyphase) {
+  const double virtual_source_idx = GetVirtualSourceIndex();
+  const bool use_polyphase =
+      allow_polyphase && polyphase_kernel_count_ &&
+      fabs(io_sample_rate_ratio_ - polyphase_ratio_) <
+          std::numeric_limits<double>::epsilon();
+  polyphase_count_ = use_polyphase ? polyphase_kernel_count_ : 0;
+  SetVirtualSourceIndex(virtual_source_idx);
+}
+
+double SincResampler::GetVirtualSourceIndex() const {
+  if (!polyphase_count_)
+    return virtual_source_idx_;
+  return polyphase_source_idx_ +
+         static_cast<double>(polyphase_phase_) / polyphase_count_;
+}
+
+void SincResampler::SetVirtualSourceIndex(double virtual_source_idx) {
+  virtual_source_idx_ = virtual_source_idx;
+  if (!polyphase_count_)
+    return;
+
+  // Snap to the nearest phase.  This only happens when switching modes in
+  // SetRatio(), and is off by at most half a phase.
+  polyphase_source_idx_ = static_cast<int>(virtual_source_idx);
+  polyphase_phase_ = static_cast<int>(std::round(
+      (virtual_source_idx - polyphase_source_idx_) * polyphase_count_));
+  if (polyphase_phase_ == polyphase_count_) {
+    polyphase_phase_ = 0;
+    ++polyphase_source_idx_;
+  }
+}
+
 void SincResampler::SetRatio(double io_sample_rate_ratio) {
   if (fabs(io_sample_rate_ratio_ - io_sample_rate_ratio) <
       std::numeric_limits<double>::epsilon()) {
@@ -224,20 +377,59 @@ void SincResampler::SetRatio(double io_sample_rate_ratio) {
                              : sinc_scale_factor));
     }
   }
+
+  SelectPolyphase(true);
 }
 
 void SincResampler::Resample(int frames, float* destination) {
+  DCHECK_EQ(channels_, 1);
+  Resample(frames, &destination);
+}
+
+void SincResampler::Resample(int frames, float* const* destination) {
   int remaining_frames = frames;
+  int output_idx = 0;
 
   // Step (1) -- Prime the input buffer at the start of the input stream.
   if (!buffer_primed_ && remaining_frames) {
-    read_cb_.Run(request_frames_, r0_);
+    ReadInput();
     buffer_primed_ = true;
   }
 
   // Step (2) -- Resample!
   while (remaining_frames) {
-    while (virtual_source_idx_ < block_size_) {
+    if (polyphase_count_) {
+      // Every output sample lands exactly on one of the precomputed phases, so
+      // a single convolution with that phase's kernel is all that's needed.
+      while (polyphase_source_idx_ < block_size_) {
+        const float* kernel =
+            polyphase_kernel_storage_.get() + polyphase_phase_ * kKernelSize;
+        const float* input_ptr = r1_ + polyphase_source_idx_;
+        if (channels_ == 1) {
+          destination[0][output_idx++] =
+              CONVOLVE_POLYPHASE_FUNC(input_ptr, kernel);
+        } else {
+          CONVOLVE_POLYPHASE_CHANNELS_FUNC(input_ptr, input_buffer_stride_,
+                                           channels_, kernel, destination,
+                                           output_idx++);
+        }
+
+        // Advance the exact read position.
+        polyphase_source_idx_ += polyphase_step_;
+        polyphase_phase_ += polyphase_phase_step_;
+        if (polyphase_phase_ >= polyphase_count_) {
+          polyphase_phase_ -= polyphase_count_;
+          ++polyphase_source_idx_;
+        }
+        if (!--remaining_frames)
+          return;
+      }
+
+      // Wrap back around to the start.
+      polyphase_source_idx_ -= block_size_;
+    }
+
+    while (!polyphase_count_ && virtual_source_idx_ < block_size_) {
       // |virtual_source_idx_| lies in between two kernel offsets so figure out
       // what they are.
       const int source_idx = static_cast<int>(virtual_source_idx_);
@@ -261,8 +453,14 @@ void SincResampler::Resample(int frames, float* destination) {
       // Figure out how much to weight each kernel's "convolution".
       const double kernel_interpolation_factor =
           virtual_offset_idx - offset_idx;
-      *destination++ =
-          CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+      if (channels_ == 1) {
+        destination[0][output_idx++] =
+            CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+      } else {
+        CONVOLVE_CHANNELS_FUNC(input_ptr, input_buffer_stride_, channels_, k1,
+                               k2, kernel_interpolation_factor, destination,
+                               output_idx++);
+      }
 
       // Advance the virtual index.
       virtual_source_idx_ += io_sample_rate_ratio_;
@@ -271,19 +469,25 @@ void SincResampler::Resample(int frames, float* destination) {
     }
 
     // Wrap back around to the start.
-    DCHECK_GE(virtual_source_idx_, block_size_);
-    virtual_source_idx_ -= block_size_;
+    if (!polyphase_count_) {
+      DCHECK_GE(virtual_source_idx_, block_size_);
+      virtual_source_idx_ -= block_size_;
+    }
 
     // Step (3) -- Copy r3_, r4_ to r1_, r2_.
     // This wraps the last input frames back to the start of the buffer.
-    memcpy(r1_, r3_, sizeof(*input_buffer_.get()) * kKernelSize);
+    for (int ch = 0; ch < channels_; ++ch) {
+      const int offset = ch * input_buffer_stride_;
+      memcpy(r1_ + offset, r3_ + offset,
+             sizeof(*input_buffer_.get()) * kKernelSize);
+    }
 
     // Step (4) -- Reinitialize regions if necessary.
     if (r0_ == r2_)
       UpdateRegions(true);
 
     // Step (5) -- Refresh the buffer with more input.
-    read_cb_.Run(request_frames_, r0_);
+    ReadInput();
   }
 }
 
@@ -297,14 +501,16 @@ void SincResampler::PrimeWithSilence() {
 
 void SincResampler::Flush() {
   virtual_source_idx_ = 0;
+  polyphase_source_idx_ = 0;
+  polyphase_phase_ = 0;
   buffer_primed_ = false;
   memset(input_buffer_.get(), 0,
-         sizeof(*input_buffer_.get()) * input_buffer_size_);
+         sizeof(*input_buffer_.get()) * input_buffer_stride_ * channels_);
   UpdateRegions(false);
 }
 
 double SincResampler::BufferedFrames() const {
-  return buffer_primed_ ? request_frames_ - virtual_source_idx_ : 0;
+  return buffer_primed_ ? request_frames_ - GetVirtualSourceIndex() : 0;
 }
 
 float SincResampler::Convolve_C(const float* input_ptr, const float* k1,
@@ -326,7 +532,176 @@ float SincResampler::Convolve_C(const float* input_ptr, const float* k1,
       kernel_interpolation_factor * sum2);
 }
 
+float SincResampler::ConvolvePolyphase_C(const float* input_ptr,
+                                         const float* k) {
+  float sum = 0;
+  int n = kKernelSize;
+  while (n--)
+    sum += *input_ptr++ * *k++;
+  return sum;
+}
+
+void SincResampler::ConvolveChannels_C(const float* input_ptr,
+                                       int input_stride,
+                                       int channels,
+                                       const float* k1,
+                                       const float* k2,
+                                       double kernel_interpolation_factor,
+                                       float* const* destination,
+                                       int frame) {
+  // Without SIMD there are no registers to share the kernel across, so just
+  // run the single channel version.
+  for (int ch = 0; ch < channels; ++ch) {
+    destination[ch][frame] = Convolve_C(input_ptr + ch * input_stride, k1, k2,
+                                        kernel_interpolation_factor);
+  }
+}
+
+void SincResampler::ConvolvePolyphaseChannels_C(const float* input_ptr,
+                                                int input_stride,
+                                                int channels,
+                                                const float* k,
+                                                float* const* destination,
+                                                int frame) {
+  for (int ch = 0; ch < channels; ++ch) {
+    destination[ch][frame] =
+        ConvolvePolyphase_C(input_ptr + ch * input_stride, k);
+  }
+}
+
 #if defined(ARCH_CPU_X86_FAMILY)
+// Convolves a pair of channels at once, loading each vector of |k1| and |k2|
+// a single time.  The four accumulators, two kernel vectors and two inputs fit
+// in the eight XMM registers available on 32-bit x86; larger groups spill.
+// The per-channel arithmetic is the same as Convolve_SSE(), so results are
+// identical.  Input loads are always unaligned since the read position moves
+// by fractional amounts.
+static void ConvolveChannelPair_SSE(const float* input0,
+                                    const float* input1,
+                                    const float* k1,
+                                    const float* k2,
+                                    double kernel_interpolation_factor,
+                                    float* result0,
+                                    float* result1) {
+  __m128 m_sums1_0 = _mm_setzero_ps();
+  __m128 m_sums2_0 = _mm_setzero_ps();
+  __m128 m_sums1_1 = _mm_setzero_ps();
+  __m128 m_sums2_1 = _mm_setzero_ps();
+  for (int i = 0; i < SincResampler::kKernelSize; i += 4) {
+    const __m128 m_k1 = _mm_load_ps(k1 + i);
+    const __m128 m_k2 = _mm_load_ps(k2 + i);
+    const __m128 m_input0 = _mm_loadu_ps(input0 + i);
+    const __m128 m_input1 = _mm_loadu_ps(input1 + i);
+    m_sums1_0 = _mm_add_ps(m_sums1_0, _mm_mul_ps(m_input0, m_k1));
+    m_sums2_0 = _mm_add_ps(m_sums2_0, _mm_mul_ps(m_input0, m_k2));
+    m_sums1_1 = _mm_add_ps(m_sums1_1, _mm_mul_ps(m_input1, m_k1));
+    m_sums2_1 = _mm_add_ps(m_sums2_1, _mm_mul_ps(m_input1, m_k2));
+  }
+
+  // Linearly interpolate the two "convolutions".
+  const __m128 m_factor1 =
+      _mm_set_ps1(static_cast<float>(1.0 - kernel_interpolation_factor));
+  const __m128 m_factor2 =
+      _mm_set_ps1(static_cast<float>(kernel_interpolation_factor));
+  __m128 m_sums0 = _mm_add_ps(_mm_mul_ps(m_sums1_0, m_factor1),
+                              _mm_mul_ps(m_sums2_0, m_factor2));
+  __m128 m_sums1 = _mm_add_ps(_mm_mul_ps(m_sums1_1, m_factor1),
+                              _mm_mul_ps(m_sums2_1, m_factor2));
+
+  // Sum components together.
+  m_sums0 = _mm_add_ps(_mm_movehl_ps(m_sums0, m_sums0), m_sums0);
+  m_sums1 = _mm_add_ps(_mm_movehl_ps(m_sums1, m_sums1), m_sums1);
+  _mm_store_ss(result0,
+               _mm_add_ss(m_sums0, _mm_shuffle_ps(m_sums0, m_sums0, 1)));
+  _mm_store_ss(result1,
+               _mm_add_ss(m_sums1, _mm_shuffle_ps(m_sums1, m_sums1, 1)));
+}
+
+// Polyphase version of ConvolveChannelPair_SSE().
+static void ConvolvePolyphaseChannelPair_SSE(const float* input0,
+                                             const float* input1,
+                                             const float* k,
+                                             float* result0,
+                                             float* result1) {
+  __m128 m_sums0 = _mm_setzero_ps();
+  __m128 m_sums1 = _mm_setzero_ps();
+  for (int i = 0; i < SincResampler::kKernelSize; i += 4) {
+    const __m128 m_k = _mm_load_ps(k + i);
+    m_sums0 = _mm_add_ps(m_sums0, _mm_mul_ps(_mm_loadu_ps(input0 + i), m_k));
+    m_sums1 = _mm_add_ps(m_sums1, _mm_mul_ps(_mm_loadu_ps(input1 + i), m_k));
+  }
+
+  // Sum components together.
+  m_sums0 = _mm_add_ps(_mm_movehl_ps(m_sums0, m_sums0), m_sums0);
+  m_sums1 = _mm_add_ps(_mm_movehl_ps(m_sums1, m_sums1), m_sums1);
+  _mm_store_ss(result0,
+               _mm_add_ss(m_sums0, _mm_shuffle_ps(m_sums0, m_sums0, 1)));
+  _mm_store_ss(result1,
+               _mm_add_ss(m_sums1, _mm_shuffle_ps(m_sums1, m_sums1, 1)));
+}
+
+void SincResampler::ConvolveChannels_SSE(const float* input_ptr,
+                                         int input_stride,
+                                         int channels,
+                                         const float* k1,
+                                         const float* k2,
+                                         double kernel_interpolation_factor,
+                                         float* const* destination,
+                                         int frame) {
+  int ch = 0;
+  for (; ch + 2 <= channels; ch += 2, input_ptr += 2 * input_stride) {
+    ConvolveChannelPair_SSE(input_ptr, input_ptr + input_stride, k1, k2,
+                            kernel_interpolation_factor,
+                            destination[ch] + frame,
+                            destination[ch + 1] + frame);
+  }
+  if (ch < channels) {
+    destination[ch][frame] =
+        Convolve_SSE(input_ptr, k1, k2, kernel_interpolation_factor);
+  }
+}
+
+void SincResampler::ConvolvePolyphaseChannels_SSE(const float* input_ptr,
+                                                  int input_stride,
+                                                  int channels,
+                                                  const float* k,
+                                                  float* const* destination,
+                                                  int frame) {
+  int ch = 0;
+  for (; ch + 2 <= channels; ch += 2, input_ptr += 2 * input_stride) {
+    ConvolvePolyphaseChannelPair_SSE(input_ptr, input_ptr + input_stride, k,
+                                     destination[ch] + frame,
+                                     destination[ch + 1] + frame);
+  }
+  if (ch < channels)
+    destination[ch][frame] = ConvolvePolyphase_SSE(input_ptr, k);
+}
+
+float SincResampler::ConvolvePolyphase_SSE(const float* input_ptr,
+                                           const float* k) {
+  __m128 m_sums = _mm_setzero_ps();
+
+  // Based on |input_ptr| alignment, we need to use loadu or load.
+  if (reinterpret_cast<uintptr_t>(input_ptr) & 0x0F) {
+    for (int i = 0; i < kKernelSize; i += 4) {
+      m_sums = _mm_add_ps(
+          m_sums, _mm_mul_ps(_mm_loadu_ps(input_ptr + i), _mm_load_ps(k + i)));
+    }
+  } else {
+    for (int i = 0; i < kKernelSize; i += 4) {
+      m_sums = _mm_add_ps(
+          m_sums, _mm_mul_ps(_mm_load_ps(input_ptr + i), _mm_load_ps(k + i)));
+    }
+  }
+
+  // Sum components together.
+  float result;
+  m_sums = _mm_add_ps(_mm_movehl_ps(m_sums, m_sums), m_sums);
+  _mm_store_ss(&result,
+               _mm_add_ss(m_sums, _mm_shuffle_ps(m_sums, m_sums, 1)));
+  return result;
+}
+
 float SincResampler::Convolve_SSE(const float* input_ptr, const float* k1,
                                   const float* k2,
                                   double kernel_interpolation_factor) {
@@ -366,6 +741,114 @@ float SincResampler::Convolve_SSE(const float* input_ptr, const float* k1,
   return result;
 }
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+// NEON versions of the channel pair helpers above.
+static void ConvolveChannelPair_NEON(const float* input0,
+                                     const float* input1,
+                                     const float* k1,
+                                     const float* k2,
+                                     double kernel_interpolation_factor,
+                                     float* result0,
+                                     float* result1) {
+  float32x4_t m_sums1_0 = vmovq_n_f32(0);
+  float32x4_t m_sums2_0 = vmovq_n_f32(0);
+  float32x4_t m_sums1_1 = vmovq_n_f32(0);
+  float32x4_t m_sums2_1 = vmovq_n_f32(0);
+  for (int i = 0; i < SincResampler::kKernelSize; i += 4) {
+    const float32x4_t m_k1 = vld1q_f32(k1 + i);
+    const float32x4_t m_k2 = vld1q_f32(k2 + i);
+    const float32x4_t m_input0 = vld1q_f32(input0 + i);
+    const float32x4_t m_input1 = vld1q_f32(input1 + i);
+    m_sums1_0 = vmlaq_f32(m_sums1_0, m_input0, m_k1);
+    m_sums2_0 = vmlaq_f32(m_sums2_0, m_input0, m_k2);
+    m_sums1_1 = vmlaq_f32(m_sums1_1, m_input1, m_k1);
+    m_sums2_1 = vmlaq_f32(m_sums2_1, m_input1, m_k2);
+  }
+
+  // Linearly interpolate the two "convolutions".
+  const float32x4_t m_factor1 = vmovq_n_f32(1.0 - kernel_interpolation_factor);
+  const float32x4_t m_factor2 = vmovq_n_f32(kernel_interpolation_factor);
+  const float32x4_t m_sums0 =
+      vmlaq_f32(vmulq_f32(m_sums1_0, m_factor1), m_sums2_0, m_factor2);
+  const float32x4_t m_sums1 =
+      vmlaq_f32(vmulq_f32(m_sums1_1, m_factor1), m_sums2_1, m_factor2);
+
+  // Sum components together.
+  float32x2_t m_half = vadd_f32(vget_high_f32(m_sums0), vget_low_f32(m_sums0));
+  *result0 = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+  m_half = vadd_f32(vget_high_f32(m_sums1), vget_low_f32(m_sums1));
+  *result1 = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+}
+
+static void ConvolvePolyphaseChannelPair_NEON(const float* input0,
+                                              const float* input1,
+                                              const float* k,
+                                              float* result0,
+                                              float* result1) {
+  float32x4_t m_sums0 = vmovq_n_f32(0);
+  float32x4_t m_sums1 = vmovq_n_f32(0);
+  for (int i = 0; i < SincResampler::kKernelSize; i += 4) {
+    const float32x4_t m_k = vld1q_f32(k + i);
+    m_sums0 = vmlaq_f32(m_sums0, vld1q_f32(input0 + i), m_k);
+    m_sums1 = vmlaq_f32(m_sums1, vld1q_f32(input1 + i), m_k);
+  }
+
+  // Sum components together.
+  float32x2_t m_half = vadd_f32(vget_high_f32(m_sums0), vget_low_f32(m_sums0));
+  *result0 = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+  m_half = vadd_f32(vget_high_f32(m_sums1), vget_low_f32(m_sums1));
+  *result1 = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+}
+
+void SincResampler::ConvolveChannels_NEON(const float* input_ptr,
+                                          int input_stride,
+                                          int channels,
+                                          const float* k1,
+                                          const float* k2,
+                                          double kernel_interpolation_factor,
+                                          float* const* destination,
+                                          int frame) {
+  int ch = 0;
+  for (; ch + 2 <= channels; ch += 2, input_ptr += 2 * input_stride) {
+    ConvolveChannelPair_NEON(input_ptr, input_ptr + input_stride, k1, k2,
+                             kernel_interpolation_factor,
+                             destination[ch] + frame,
+                             destination[ch + 1] + frame);
+  }
+  if (ch < channels) {
+    destination[ch][frame] =
+        Convolve_NEON(input_ptr, k1, k2, kernel_interpolation_factor);
+  }
+}
+
+void SincResampler::ConvolvePolyphaseChannels_NEON(const float* input_ptr,
+                                                   int input_stride,
+                                                   int channels,
+                                                   const float* k,
+                                                   float* const* destination,
+                                                   int frame) {
+  int ch = 0;
+  for (; ch + 2 <= channels; ch += 2, input_ptr += 2 * input_stride) {
+    ConvolvePolyphaseChannelPair_NEON(input_ptr, input_ptr + input_stride, k,
+                                      destination[ch] + frame,
+                                      destination[ch + 1] + frame);
+  }
+  if (ch < channels)
+    destination[ch][frame] = ConvolvePolyphase_NEON(input_ptr, k);
+}
+
+float SincResampler::ConvolvePolyphase_NEON(const float* input_ptr,
+                                            const float* k) {
+  float32x4_t m_sums = vmovq_n_f32(0);
+
+  const float* upper = input_ptr + kKernelSize;
+  for (; input_ptr < upper; input_ptr += 4, k += 4)
+    m_sums = vmlaq_f32(m_sums, vld1q_f32(input_ptr), vld1q_f32(k));
+
+  // Sum components together.
+  float32x2_t m_half = vadd_f32(vget_high_f32(m_sums), vget_low_f32(m_sums));
+  return vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+}
+
 float SincResampler::Convolve_NEON(const float* input_ptr, const float* k1,
                                    const float* k2,
                                    double kernel_interpolation_factor) {
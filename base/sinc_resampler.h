@@ -16,7 +16,9 @@
 
 namespace media {
 
-// SincResampler is a high-quality single-channel sample-rate converter.
+// SincResampler is a high-quality sample-rate converter.  It is usually used
+// for a single channel, but may also resample several channels in lock step;
+// in that case each kernel is loaded once per output frame for all channels.
 class MEDIA_EXPORT SincResampler {
  public:
   enum {
@@ -34,6 +36,15 @@ class MEDIA_EXPORT SincResampler {
     // at the expense of allocating more memory.
     kKernelOffsetCount = 32,
     kKernelStorageSize = kKernelSize * (kKernelOffsetCount + 1),
+
+    // When the io sample rate ratio given on construction reduces to a
+    // fraction whose denominator is no larger than this, SincResampler uses a
+    // polyphase filter bank with one exact kernel per sub-sample phase instead
+    // of interpolating between kKernelOffsetCount kernels.  Covers all common
+    // pairs between 8kHz, 16kHz, 22.05kHz, 32kHz, 44.1kHz and 48kHz (e.g.,
+    // 44.1kHz to 48kHz is 147 / 160).  Each phase costs kKernelSize floats of
+    // memory.
+    kMaxPolyphaseKernels = 320,
   };
 
   // Callback type for providing more data into the resampler.  Expects |frames|
@@ -41,6 +52,11 @@ class MEDIA_EXPORT SincResampler {
   // are available to satisfy the request.
   typedef base::Callback<void(int frames, float* destination)> ReadCB;
 
+  // Multi-channel version of ReadCB.  Expects |frames| of data to be rendered
+  // into each of the channel pointers in |destination|.
+  typedef base::Callback<void(int frames, float* const* destination)>
+      MultiChannelReadCB;
+
   // Constructs a SincResampler with the specified |read_cb|, which is used to
   // acquire audio data for resampling.  |io_sample_rate_ratio| is the ratio
   // of input / output sample rates.  |request_frames| controls the size in
@@ -50,11 +66,26 @@ class MEDIA_EXPORT SincResampler {
   SincResampler(double io_sample_rate_ratio,
                 int request_frames,
                 const ReadCB& read_cb);
+
+  // Constructs a SincResampler which resamples |channels| channels in lock
+  // step, acquiring input for all of them with each call to |read_cb|.  All
+  // channels share a single set of kernels.
+  SincResampler(int channels,
+                double io_sample_rate_ratio,
+                int request_frames,
+                const MultiChannelReadCB& read_cb);
   ~SincResampler();
 
-  // Resample |frames| of data from |read_cb_| into |destination|.
+  // Resample |frames| of data from |read_cb_| into |destination|.  Only valid
+  // for single channel resamplers.
   void Resample(int frames, float* destination);
 
+  // Resample |frames| of data into each of the channels() pointers in
+  // |destination|.
+  void Resample(int frames, float* const* destination);
+
+  int channels() const { return channels_; }
+
   // The maximum size in frames that guarantees Resample() will only make a
   // single call to |read_cb_| for more data.  Note: If PrimeWithSilence() is
   // not called, chunk size will grow after the first two Resample() calls by
@@ -72,12 +103,17 @@ class MEDIA_EXPORT SincResampler {
   void Flush();
 
   // Update |io_sample_rate_ratio_|.  SetRatio() will cause a reconstruction of
-  // the kernels used for resampling.  Not thread safe, do not call while
-  // Resample() is in progress.
+  // the kernels used for resampling.  The polyphase filter bank is only built
+  // on construction, so it is only used while the ratio is the one given
+  // there.  Not thread safe, do not call while Resample() is in progress.
   void SetRatio(double io_sample_rate_ratio);
 
   float* get_kernel_for_testing() { return kernel_storage_.get(); }
 
+  // Returns true if the current ratio is handled by the polyphase filter bank.
+  // See kMaxPolyphaseKernels.
+  bool is_polyphase() const { return polyphase_count_ > 0; }
+
   // Return number of input frames consumed by a callback but not yet processed.
   // Since input/output ratio can be fractional, so can this value.
   // Zero before first call to Resample().
@@ -86,10 +122,39 @@ class MEDIA_EXPORT SincResampler {
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerPerfTest, Convolve);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, PolyphaseMatchesInterpolation);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerPerfTest, Resample);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveChannels);
+
+  SincResampler(int channels,
+                double io_sample_rate_ratio,
+                int request_frames,
+                const ReadCB& read_cb,
+                const MultiChannelReadCB& multi_channel_read_cb);
 
   void InitializeKernel();
   void UpdateRegions(bool second_load);
 
+  // Runs whichever read callback was provided to fill r0_ for every channel.
+  void ReadInput();
+
+  // Builds the polyphase filter bank for |io_sample_rate_ratio_|, if it has a
+  // small fractional form.  Only called on construction: it allocates memory
+  // and computes up to kMaxPolyphaseKernels kernels, which SetRatio() must not
+  // do on the audio thread.
+  void InitializePolyphase();
+
+  // Uses the polyphase filter bank if there is one for the current
+  // |io_sample_rate_ratio_|, or the interpolated kernels otherwise, preserving
+  // the current read position.  |allow_polyphase| is only false in tests which
+  // compare the two modes.
+  void SelectPolyphase(bool allow_polyphase);
+
+  // Returns the position of the next output sample in |input_buffer_| relative
+  // to r1_, in whichever representation the current mode uses.
+  double GetVirtualSourceIndex() const;
+  void SetVirtualSourceIndex(double virtual_source_idx);
+
   // Compute convolution of |k1| and |k2| over |input_ptr|, resultant sums are
   // linearly interpolated using |kernel_interpolation_factor|.  On x86, the
   // underlying implementation is chosen at run time based on SSE support.  On
@@ -106,6 +171,66 @@ class MEDIA_EXPORT SincResampler {
                              double kernel_interpolation_factor);
 #endif
 
+  // Compute convolution of the single polyphase kernel |k| over |input_ptr|.
+  // |k| must be 16-byte aligned; |input_ptr| need not be.
+  static float ConvolvePolyphase_C(const float* input_ptr, const float* k);
+#if defined(ARCH_CPU_X86_FAMILY)
+  static float ConvolvePolyphase_SSE(const float* input_ptr, const float* k);
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  static float ConvolvePolyphase_NEON(const float* input_ptr, const float* k);
+#endif
+
+  // Multi-channel versions of Convolve() and ConvolvePolyphase().  Channel |c|
+  // reads from |input_ptr| + |c| * |input_stride| and its result is written to
+  // |destination|[c][|frame|].  Channels are processed in pairs so each kernel
+  // vector is loaded once per pair.  Results are bit identical to calling the
+  // single channel version once per channel.
+  static void ConvolveChannels_C(const float* input_ptr,
+                                 int input_stride,
+                                 int channels,
+                                 const float* k1,
+                                 const float* k2,
+                                 double kernel_interpolation_factor,
+                                 float* const* destination,
+                                 int frame);
+  static void ConvolvePolyphaseChannels_C(const float* input_ptr,
+                                          int input_stride,
+                                          int channels,
+                                          const float* k,
+                                          float* const* destination,
+                                          int frame);
+#if defined(ARCH_CPU_X86_FAMILY)
+  static void ConvolveChannels_SSE(const float* input_ptr,
+                                   int input_stride,
+                                   int channels,
+                                   const float* k1,
+                                   const float* k2,
+                                   double kernel_interpolation_factor,
+                                   float* const* destination,
+                                   int frame);
+  static void ConvolvePolyphaseChannels_SSE(const float* input_ptr,
+                                            int input_stride,
+                                            int channels,
+                                            const float* k,
+                                            float* const* destination,
+                                            int frame);
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  static void ConvolveChannels_NEON(const float* input_ptr,
+                                    int input_stride,
+                                    int channels,
+                                    const float* k1,
+                                    const float* k2,
+                                    double kernel_interpolation_factor,
+                                    float* const* destination,
+                                    int frame);
+  static void ConvolvePolyphaseChannels_NEON(const float* input_ptr,
+                                             int input_stride,
+                                             int channels,
+                                             const float* k,
+                                             float* const* destination,
+                                             int frame);
+#endif
+
   // The ratio of input / output sample rates.
   double io_sample_rate_ratio_;
 
@@ -116,8 +241,12 @@ class MEDIA_EXPORT SincResampler {
   // The buffer is primed once at the very beginning of processing.
   bool buffer_primed_;
 
-  // Source of data for resampling.
+  // The number of channels resampled in lock step.
+  const int channels_;
+
+  // Source of data for resampling; exactly one of these is set.
   const ReadCB read_cb_;
+  const MultiChannelReadCB multi_channel_read_cb_;
 
   // The size (in samples) to request from each |read_cb_| execution.
   const int request_frames_;
@@ -132,6 +261,11 @@ class MEDIA_EXPORT SincResampler {
   // The size (in samples) of the internal buffer used by the resampler.
   const int input_buffer_size_;
 
+  // The distance (in samples) between the start of each channel's portion of
+  // |input_buffer_|.  A multiple of four so every channel has the same
+  // alignment.
+  const int input_buffer_stride_;
+
   // Contains kKernelOffsetCount kernels back-to-back, each of size kKernelSize.
   // The kernel offsets are sub-sample shifts of a windowed sinc shifted from
   // 0.0 to 1.0 sample.
@@ -139,11 +273,39 @@ class MEDIA_EXPORT SincResampler {
   std::unique_ptr<float[], base::AlignedFreeDeleter> kernel_pre_sinc_storage_;
   std::unique_ptr<float[], base::AlignedFreeDeleter> kernel_window_storage_;
 
+  // The ratio the polyphase filter bank was built for, and its number of
+  // kernels, which is zero if there is no bank.
+  double polyphase_ratio_;
+  int polyphase_kernel_count_;
+
+  // Polyphase state; |polyphase_count_| is zero when the bank is not in use.
+  // Otherwise it is |polyphase_kernel_count_|, the ratio is exactly
+  //   polyphase_step_ + polyphase_phase_step_ / polyphase_count_
+  // and the read position is tracked exactly as
+  //   polyphase_source_idx_ + polyphase_phase_ / polyphase_count_
+  // instead of in |virtual_source_idx_|.
+  int polyphase_count_;
+  int polyphase_step_;
+  int polyphase_phase_step_;
+  int polyphase_source_idx_;
+  int polyphase_phase_;
+
+  // Contains |polyphase_kernel_count_| kernels back-to-back, each of size
+  // kKernelSize, one for each sub-sample phase i / |polyphase_kernel_count_|.
+  std::unique_ptr<float[], base::AlignedFreeDeleter> polyphase_kernel_storage_;
+
   // Data from the source is copied into this buffer for each processing pass.
+  // Holds |channels_| buffers of |input_buffer_size_|, |input_buffer_stride_|
+  // apart.
   std::unique_ptr<float[], base::AlignedFreeDeleter> input_buffer_;
 
-  // Pointers to the various regions inside |input_buffer_|.  See the diagram at
-  // the top of the .cc file for more information.
+  // Per-channel r0_ pointers handed to |multi_channel_read_cb_|.
+  std::unique_ptr<float*[]> read_destinations_;
+
+  // Pointers to the various regions inside the first channel of
+  // |input_buffer_|.  See the diagram at the top of the .cc file for more
+  // information.  The same regions of channel |c| are |c| *
+  // |input_buffer_stride_| further along.
   float* r0_;
   float* const r1_;
   float* const r2_;
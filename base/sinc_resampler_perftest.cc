@@ -2,6 +2,9 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <memory>
+#include <string>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/time/time.h"
@@ -68,6 +71,51 @@ TEST(SincResamplerPerfTest, Convolve) {
 #endif
 }
 
+static const int kResampleIterations = 20000;
+
+// Helper function to provide silence to SincResampler's Resample benchmark.
+static void ProvideSilence(int frames, float* destination) {
+  memset(destination, 0, sizeof(*destination) * frames);
+}
+
+static void RunResampleBenchmark(SincResampler* resampler,
+                                 const std::string& test_name,
+                                 const std::string& trace_name) {
+  std::unique_ptr<float[]> destination(
+      new float[SincResampler::kDefaultRequestSize]);
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kResampleIterations; ++i) {
+    resampler->Resample(SincResampler::kDefaultRequestSize,
+                        destination.get());
+  }
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult(test_name, "", trace_name,
+                         kResampleIterations / total_time_milliseconds,
+                         "runs/ms", true);
+}
+
+// Benchmark Resample() for common fixed ratios, with and without the polyphase
+// filter bank.
+TEST(SincResamplerPerfTest, Resample) {
+  static const int kRates[][2] = {{44100, 48000}, {48000, 44100},
+                                  {16000, 48000}, {48000, 16000}};
+  for (const auto& rates : kRates) {
+    const std::string test_name = "sinc_resampler_resample_" +
+                                  std::to_string(rates[0]) + "_" +
+                                  std::to_string(rates[1]);
+    SincResampler resampler(static_cast<double>(rates[0]) / rates[1],
+                            SincResampler::kDefaultRequestSize,
+                            base::Bind(&ProvideSilence));
+    ASSERT_TRUE(resampler.is_polyphase());
+    RunResampleBenchmark(&resampler, test_name, "polyphase");
+
+    resampler.SelectPolyphase(false);
+    ASSERT_FALSE(resampler.is_polyphase());
+    RunResampleBenchmark(&resampler, test_name, "interpolated");
+  }
+}
+
 #undef CONVOLVE_FUNC
 
 } // namespace media
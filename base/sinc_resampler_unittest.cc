@@ -152,8 +152,10 @@ TEST(SincResamplerTest, DISABLED_SetRatioBench) {
 // Define platform independent function name for Convolve* tests.
 #if defined(ARCH_CPU_X86_FAMILY)
 #define CONVOLVE_FUNC Convolve_SSE
+#define CONVOLVE_POLYPHASE_FUNC ConvolvePolyphase_SSE
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define CONVOLVE_FUNC Convolve_NEON
+#define CONVOLVE_POLYPHASE_FUNC ConvolvePolyphase_NEON
 #endif
 
 // Ensure various optimized Convolve() methods return the same value.  Only run
@@ -191,9 +193,103 @@ TEST(SincResamplerTest, Convolve) {
       resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
       resampler.kernel_storage_.get(), kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
+
+  // Test the single kernel polyphase versions too.
+  result = resampler.ConvolvePolyphase_C(resampler.kernel_storage_.get() + 1,
+                                         resampler.kernel_storage_.get());
+  result2 = resampler.CONVOLVE_POLYPHASE_FUNC(
+      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get());
+  EXPECT_NEAR(result2, result, kEpsilon);
 }
 #endif
 
+// Ensure the channel-batched Convolve methods match the single channel ones
+// exactly for every channel, including the leftover channels which don't fill
+// a whole group.
+TEST(SincResamplerTest, ConvolveChannels) {
+  MockSource mock_source;
+  SincResampler resampler(
+      kSampleRateRatio, SincResampler::kDefaultRequestSize,
+      base::Bind(&MockSource::ProvideInput, base::Unretained(&mock_source)));
+
+  static const int kChannels = 7;
+  static const int kStride = SincResampler::kKernelSize + 4;
+  static const int kFrame = 3;
+  float output[kChannels][kFrame + 1];
+  float* destination[kChannels];
+  for (int ch = 0; ch < kChannels; ++ch)
+    destination[ch] = output[ch];
+
+  const float* input = resampler.kernel_storage_.get() + 1;
+  const float* k1 = resampler.kernel_storage_.get();
+  const float* k2 = k1 + SincResampler::kKernelSize;
+
+  resampler.ConvolveChannels_C(input, kStride, kChannels, k1, k2, 0.25,
+                               destination, kFrame);
+  for (int ch = 0; ch < kChannels; ++ch) {
+    EXPECT_EQ(resampler.Convolve_C(input + ch * kStride, k1, k2, 0.25),
+              output[ch][kFrame]);
+  }
+  resampler.ConvolvePolyphaseChannels_C(input, kStride, kChannels, k1,
+                                        destination, kFrame);
+  for (int ch = 0; ch < kChannels; ++ch) {
+    EXPECT_EQ(resampler.ConvolvePolyphase_C(input + ch * kStride, k1),
+              output[ch][kFrame]);
+  }
+
+#if defined(CONVOLVE_FUNC)
+#if defined(ARCH_CPU_X86_FAMILY)
+  resampler.ConvolveChannels_SSE(input, kStride, kChannels, k1, k2, 0.25,
+                                 destination, kFrame);
+#else
+  resampler.ConvolveChannels_NEON(input, kStride, kChannels, k1, k2, 0.25,
+                                  destination, kFrame);
+#endif
+  for (int ch = 0; ch < kChannels; ++ch) {
+    EXPECT_EQ(resampler.CONVOLVE_FUNC(input + ch * kStride, k1, k2, 0.25),
+              output[ch][kFrame]);
+  }
+#if defined(ARCH_CPU_X86_FAMILY)
+  resampler.ConvolvePolyphaseChannels_SSE(input, kStride, kChannels, k1,
+                                          destination, kFrame);
+#else
+  resampler.ConvolvePolyphaseChannels_NEON(input, kStride, kChannels, k1,
+                                           destination, kFrame);
+#endif
+  for (int ch = 0; ch < kChannels; ++ch) {
+    EXPECT_EQ(resampler.CONVOLVE_POLYPHASE_FUNC(input + ch * kStride, k1),
+              output[ch][kFrame]);
+  }
+#endif
+}
+
+// Verify the polyphase filter bank is only used for ratios which reduce to a
+// small fraction, and that SetRatio() only moves back to it for the ratio it
+// was built for on construction.
+TEST(SincResamplerTest, PolyphaseSelection) {
+  MockSource mock_source;
+  SincResampler resampler(
+      44100.0 / 48000, SincResampler::kDefaultRequestSize,
+      base::Bind(&MockSource::ProvideInput, base::Unretained(&mock_source)));
+  EXPECT_TRUE(resampler.is_polyphase());
+
+  resampler.SetRatio(base::kPiDouble);
+  EXPECT_FALSE(resampler.is_polyphase());
+
+  // Building a bank for a new ratio is too slow for SetRatio().
+  resampler.SetRatio(48000.0 / 44100);
+  EXPECT_FALSE(resampler.is_polyphase());
+
+  resampler.SetRatio(44100.0 / 48000);
+  EXPECT_TRUE(resampler.is_polyphase());
+
+  // 147 / 640 needs more than kMaxPolyphaseKernels phases.
+  SincResampler large_ratio_resampler(
+      44100.0 / 192000, SincResampler::kDefaultRequestSize,
+      base::Bind(&MockSource::ProvideInput, base::Unretained(&mock_source)));
+  EXPECT_FALSE(large_ratio_resampler.is_polyphase());
+}
+
 // Fake audio source for testing the resampler.  Generates a sinusoidal linear
 // chirp (http://en.wikipedia.org/wiki/Chirp) which can be tuned to stress the
 // resampler for the specific sample rate conversion being used.
@@ -356,6 +452,51 @@ TEST_P(SincResamplerTest, Resample) {
   EXPECT_LE(high_freq_max_error, kHighFrequencyMaxError);
 }
 
+// Verify the polyphase filter bank produces nearly the same output as kernel
+// interpolation; the remaining difference is the interpolation error that the
+// polyphase path avoids.
+TEST(SincResamplerTest, PolyphaseMatchesInterpolation) {
+  static const int kInputRate = 44100;
+  static const int kOutputRate = 48000;
+  static const int kOutputFrames = kOutputRate / 4;
+  const double io_ratio = kInputRate / static_cast<double>(kOutputRate);
+
+  SinusoidalLinearChirpSource polyphase_source(kInputRate, kInputRate,
+                                               0.5 * kInputRate);
+  SincResampler polyphase_resampler(
+      io_ratio, SincResampler::kDefaultRequestSize,
+      base::Bind(&SinusoidalLinearChirpSource::ProvideInput,
+                 base::Unretained(&polyphase_source)));
+  ASSERT_TRUE(polyphase_resampler.is_polyphase());
+
+  SinusoidalLinearChirpSource interpolated_source(kInputRate, kInputRate,
+                                                  0.5 * kInputRate);
+  SincResampler interpolated_resampler(
+      io_ratio, SincResampler::kDefaultRequestSize,
+      base::Bind(&SinusoidalLinearChirpSource::ProvideInput,
+                 base::Unretained(&interpolated_source)));
+  interpolated_resampler.SelectPolyphase(false);
+  ASSERT_FALSE(interpolated_resampler.is_polyphase());
+
+  std::unique_ptr<float[]> polyphase_output(new float[kOutputFrames]);
+  std::unique_ptr<float[]> interpolated_output(new float[kOutputFrames]);
+
+  // Resample in uneven pieces to exercise the block wrap around.
+  for (int offset = 0, frames = 0; offset < kOutputFrames; offset += frames) {
+    frames = std::min(kOutputFrames - offset, 331);
+    polyphase_resampler.Resample(frames, polyphase_output.get() + offset);
+    interpolated_resampler.Resample(frames,
+                                    interpolated_output.get() + offset);
+    // The interpolated path accumulates |io_ratio| in a double, so it drifts
+    // slightly from the exact polyphase position.
+    EXPECT_NEAR(interpolated_resampler.BufferedFrames(),
+                polyphase_resampler.BufferedFrames(), 1e-6);
+  }
+
+  for (int i = 0; i < kOutputFrames; ++i)
+    ASSERT_NEAR(interpolated_output[i], polyphase_output[i], 0.0005f) << i;
+}
+
 // Almost all conversions have an RMS error of around -14 dbFS.
 static const double kResamplingRMSError = -14.58;
 
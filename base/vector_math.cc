@@ -5,14 +5,25 @@
 #include "media/base/vector_math.h"
 #include "media/base/vector_math_testing.h"
 
+#include <stdint.h>
+
 #include <algorithm>
+#include <cmath>
 
 #include "base/logging.h"
 #include "build/build_config.h"
+#include "media/base/audio_sample_types.h"
 
 // NaCl does not allow intrinsics.
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include <emmintrin.h>
 #include <xmmintrin.h>
+#include "base/cpu.h"
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
 // Don't use custom SSE versions where the auto-vectorized C version performs
 // better, which is anywhere clang is used.
 // TODO(pcc): Linux currently uses ThinLTO which has broken auto-vectorization
@@ -25,25 +36,96 @@
 #define FMUL_FUNC FMUL_C
 #endif
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_SSE
+#define FADD_FUNC FADD_SSE
+#define WeightedSum_FUNC WeightedSum_SSE
+#define DotProduct_FUNC DotProduct_SSE
+#define Deinterleave_FUNC Deinterleave_SSE
+#define DeinterleaveS16_FUNC DeinterleaveS16_SSE
+#define DeinterleaveS32_FUNC DeinterleaveS32_SSE
+#define InterleaveAndClamp_FUNC InterleaveAndClamp_SSE
+#define InterleaveS16_FUNC InterleaveS16_SSE
+#define InterleaveS32_FUNC InterleaveS32_SSE
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #include <arm_neon.h>
 #define FMAC_FUNC FMAC_NEON
 #define FMUL_FUNC FMUL_NEON
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_NEON
+#define FADD_FUNC FADD_NEON
+#define WeightedSum_FUNC WeightedSum_NEON
+#define DotProduct_FUNC DotProduct_NEON
+#define Deinterleave_FUNC Deinterleave_NEON
+#define DeinterleaveS16_FUNC DeinterleaveS16_NEON
+#define DeinterleaveS32_FUNC DeinterleaveS32_NEON
+#define InterleaveAndClamp_FUNC InterleaveAndClamp_NEON
+#define InterleaveS16_FUNC InterleaveS16_NEON
+#define InterleaveS32_FUNC InterleaveS32_NEON
 #else
 #define FMAC_FUNC FMAC_C
 #define FMUL_FUNC FMUL_C
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_C
+#define FADD_FUNC FADD_C
+#define WeightedSum_FUNC WeightedSum_C
+#define DotProduct_FUNC DotProduct_C
+#define Deinterleave_FUNC Deinterleave_C
+#define DeinterleaveS16_FUNC DeinterleaveS16_C
+#define DeinterleaveS32_FUNC DeinterleaveS32_C
+#define InterleaveAndClamp_FUNC InterleaveAndClamp_C
+#define InterleaveS16_FUNC InterleaveS16_C
+#define InterleaveS32_FUNC InterleaveS32_C
 #endif
 
 namespace media {
 namespace vector_math {
 
+namespace {
+
+// The implementations used by the public entry points.  Starts out with the
+// compile time choices above; on x86 these are upgraded at run time to the
+// AVX2 or AVX-512 versions when the CPU and OS support them.
+struct Implementations {
+  decltype(&FMAC_C) fmac;
+  decltype(&FMUL_C) fmul;
+  decltype(&EWMAAndMaxPower_C) ewma_and_max_power;
+  decltype(&FADD_C) fadd;
+  decltype(&WeightedSum_C) weighted_sum;
+  decltype(&DotProduct_C) dot_product;
+};
+
+Implementations SelectImplementations() {
+  Implementations impl = {FMAC_FUNC,        FMUL_FUNC,
+                          EWMAAndMaxPower_FUNC, FADD_FUNC,
+                          WeightedSum_FUNC, DotProduct_FUNC};
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  if (CPUHasAVX2()) {
+    impl.fmac = FMAC_AVX2;
+    impl.fmul = FMUL_AVX2;
+    impl.ewma_and_max_power = EWMAAndMaxPower_AVX2;
+    impl.fadd = FADD_AVX2;
+    impl.weighted_sum = WeightedSum_AVX2;
+    impl.dot_product = DotProduct_AVX2;
+  }
+  // Only the accumulation kernels benefit from the wider registers; the others
+  // keep their AVX2 versions.
+  if (CPUHasAVX512()) {
+    impl.fmac = FMAC_AVX512;
+    impl.fadd = FADD_AVX512;
+  }
+#endif
+  return impl;
+}
+
+const Implementations& GetImplementations() {
+  static const Implementations impl = SelectImplementations();
+  return impl;
+}
+
+}  // namespace
+
 void FMAC(const float src[], float scale, int len, float dest[]) {
   // Ensure |src| and |dest| are 16-byte aligned.
   DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(src) & (kRequiredAlignment - 1));
   DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(dest) & (kRequiredAlignment - 1));
-  return FMAC_FUNC(src, scale, len, dest);
+  return GetImplementations().fmac(src, scale, len, dest);
 }
 
 void FMAC_C(const float src[], float scale, int len, float dest[]) {
@@ -55,7 +137,7 @@ void FMUL(const float src[], float scale, int len, float dest[]) {
   // Ensure |src| and |dest| are 16-byte aligned.
   DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(src) & (kRequiredAlignment - 1));
   DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(dest) & (kRequiredAlignment - 1));
-  return FMUL_FUNC(src, scale, len, dest);
+  return GetImplementations().fmul(src, scale, len, dest);
 }
 
 void FMUL_C(const float src[], float scale, int len, float dest[]) {
@@ -74,7 +156,8 @@ std::pair<float, float> EWMAAndMaxPower(
     float initial_value, const float src[], int len, float smoothing_factor) {
   // Ensure |src| is 16-byte aligned.
   DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(src) & (kRequiredAlignment - 1));
-  return EWMAAndMaxPower_FUNC(initial_value, src, len, smoothing_factor);
+  return GetImplementations().ewma_and_max_power(initial_value, src, len,
+                                                 smoothing_factor);
 }
 
 std::pair<float, float> EWMAAndMaxPower_C(
@@ -91,7 +174,225 @@ std::pair<float, float> EWMAAndMaxPower_C(
   return result;
 }
 
+void FADD(const float src[], int len, float dest[]) {
+  // Ensure |src| and |dest| are 16-byte aligned.
+  DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(src) & (kRequiredAlignment - 1));
+  DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(dest) & (kRequiredAlignment - 1));
+  return GetImplementations().fadd(src, len, dest);
+}
+
+void FADD_C(const float src[], int len, float dest[]) {
+  for (int i = 0; i < len; ++i)
+    dest[i] += src[i];
+}
+
+void WeightedSum(const float* const src[],
+                 const float scales[],
+                 int count,
+                 int len,
+                 float dest[]) {
+  DCHECK_GE(count, 1);
+  return GetImplementations().weighted_sum(src, scales, count, len, dest);
+}
+
+void WeightedSum_C(const float* const src[],
+                   const float scales[],
+                   int count,
+                   int len,
+                   float dest[]) {
+  for (int i = 0; i < len; ++i) {
+    float sum = src[0][i] * scales[0];
+    for (int k = 1; k < count; ++k)
+      sum += src[k][i] * scales[k];
+    dest[i] = sum;
+  }
+}
+
+float DotProduct(const float a[], const float b[], int len) {
+  return GetImplementations().dot_product(a, b, len);
+}
+
+float DotProduct_C(const float a[], const float b[], int len) {
+  float sum = 0;
+  for (int i = 0; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+namespace {
+
+// Scalar sample conversions shared by the interleaving functions.  Each matches
+// the corresponding SampleTypeTraits, except that FromFloat() maps NaN to 0 for
+// the integer formats instead of leaving it undefined.
+struct UnclampedFloatConversion {
+  using ValueType = float;
+  static float ToFloat(float value) { return value; }
+  static float FromFloat(float value) { return value; }
+};
+
+struct ClampedFloatConversion {
+  using ValueType = float;
+  static float FromFloat(float value) {
+    return Float32SampleTypeTraits::FromFloat(value);
+  }
+};
+
+template <class Traits>
+struct FixedConversion {
+  using ValueType = typename Traits::ValueType;
+  static float ToFloat(ValueType value) { return Traits::ToFloat(value); }
+  static ValueType FromFloat(float value) {
+    return Traits::FromFloat(std::isnan(value) ? 0.0f : value);
+  }
+};
+
+using S16Conversion = FixedConversion<SignedInt16SampleTypeTraits>;
+using S32Conversion = FixedConversion<SignedInt32SampleTypeTraits>;
+
+// Interleaves or deinterleaves frames [|start|, |len|) one sample at a time.
+template <class Conversion>
+void InterleaveAndConvertFrom(int start,
+                              const float* const src[],
+                              int channels,
+                              int len,
+                              typename Conversion::ValueType dest[]) {
+  for (int ch = 0; ch < channels; ++ch) {
+    const float* src_ch = src[ch];
+    for (int i = start, j = start * channels + ch; i < len; ++i, j += channels)
+      dest[j] = Conversion::FromFloat(src_ch[i]);
+  }
+}
+
+template <class Conversion>
+void DeinterleaveAndConvertFrom(int start,
+                                const typename Conversion::ValueType src[],
+                                int channels,
+                                int len,
+                                float* const dest[]) {
+  for (int ch = 0; ch < channels; ++ch) {
+    float* dest_ch = dest[ch];
+    for (int i = start, j = start * channels + ch; i < len; ++i, j += channels)
+      dest_ch[i] = Conversion::ToFloat(src[j]);
+  }
+}
+
+}  // namespace
+
+void Deinterleave(const float src[],
+                  int channels,
+                  int len,
+                  float* const dest[]) {
+  return Deinterleave_FUNC(src, channels, len, dest);
+}
+
+void Deinterleave_C(const float src[],
+                    int channels,
+                    int len,
+                    float* const dest[]) {
+  DeinterleaveAndConvertFrom<UnclampedFloatConversion>(0, src, channels, len,
+                                                       dest);
+}
+
+void DeinterleaveS16(const int16_t src[],
+                     int channels,
+                     int len,
+                     float* const dest[]) {
+  return DeinterleaveS16_FUNC(src, channels, len, dest);
+}
+
+void DeinterleaveS16_C(const int16_t src[],
+                       int channels,
+                       int len,
+                       float* const dest[]) {
+  DeinterleaveAndConvertFrom<S16Conversion>(0, src, channels, len, dest);
+}
+
+void DeinterleaveS32(const int32_t src[],
+                     int channels,
+                     int len,
+                     float* const dest[]) {
+  return DeinterleaveS32_FUNC(src, channels, len, dest);
+}
+
+void DeinterleaveS32_C(const int32_t src[],
+                       int channels,
+                       int len,
+                       float* const dest[]) {
+  DeinterleaveAndConvertFrom<S32Conversion>(0, src, channels, len, dest);
+}
+
+void InterleaveAndClamp(const float* const src[],
+                        int channels,
+                        int len,
+                        float dest[]) {
+  return InterleaveAndClamp_FUNC(src, channels, len, dest);
+}
+
+void InterleaveAndClamp_C(const float* const src[],
+                          int channels,
+                          int len,
+                          float dest[]) {
+  InterleaveAndConvertFrom<ClampedFloatConversion>(0, src, channels, len,
+                                                   dest);
+}
+
+void InterleaveS16(const float* const src[],
+                   int channels,
+                   int len,
+                   int16_t dest[]) {
+  return InterleaveS16_FUNC(src, channels, len, dest);
+}
+
+void InterleaveS16_C(const float* const src[],
+                     int channels,
+                     int len,
+                     int16_t dest[]) {
+  InterleaveAndConvertFrom<S16Conversion>(0, src, channels, len, dest);
+}
+
+void InterleaveS32(const float* const src[],
+                   int channels,
+                   int len,
+                   int32_t dest[]) {
+  return InterleaveS32_FUNC(src, channels, len, dest);
+}
+
+void InterleaveS32_C(const float* const src[],
+                     int channels,
+                     int len,
+                     int32_t dest[]) {
+  InterleaveAndConvertFrom<S32Conversion>(0, src, channels, len, dest);
+}
+
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+bool CPUHasAVX2() {
+  return base::CPU().has_avx2();
+}
+
+bool CPUHasAVX512() {
+  // base::CPU doesn't report AVX-512, so check CPUID leaf 7 for AVX512F and
+  // XCR0 for OS support of the opmask and ZMM register state.  AVX2 support
+  // implies leaf 7 is available and that the OS saves the YMM state.
+  if (!CPUHasAVX2())
+    return false;
+
+  const uint32_t kAVX512FBit = 1u << 16;
+  const uint64_t kZMMStateMask = 0xE6;
+#if defined(COMPILER_MSVC)
+  int regs[4];
+  __cpuidex(regs, 7, 0);
+  const uint32_t ebx = static_cast<uint32_t>(regs[1]);
+  const uint64_t xcr0 = _xgetbv(0);
+#else
+  uint32_t eax, ebx, ecx, edx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  uint32_t xcr0_lo, xcr0_hi;
+  __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  const uint64_t xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+#endif
+  return (ebx & kAVX512FBit) && (xcr0 & kZMMStateMask) == kZMMStateMask;
+}
+
 void FMUL_SSE(const float src[], float scale, int len, float dest[]) {
   const int rem = len % 4;
   const int last_index = len - rem;
@@ -194,6 +495,307 @@ std::pair<float, float> EWMAAndMaxPower_SSE(
 
   return result;
 }
+
+void FADD_SSE(const float src[], int len, float dest[]) {
+  const int rem = len % 4;
+  const int last_index = len - rem;
+  for (int i = 0; i < last_index; i += 4) {
+    _mm_store_ps(dest + i,
+                 _mm_add_ps(_mm_load_ps(dest + i), _mm_load_ps(src + i)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an SSE pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i];
+}
+
+void WeightedSum_SSE(const float* const src[],
+                     const float scales[],
+                     int count,
+                     int len,
+                     float dest[]) {
+  // Sum 16 values at a time in four independent accumulators, so consecutive
+  // additions don't wait on each other.
+  int i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128 m_scale = _mm_load1_ps(scales);
+    const float* src_k = src[0] + i;
+    __m128 m_sum0 = _mm_mul_ps(_mm_loadu_ps(src_k), m_scale);
+    __m128 m_sum1 = _mm_mul_ps(_mm_loadu_ps(src_k + 4), m_scale);
+    __m128 m_sum2 = _mm_mul_ps(_mm_loadu_ps(src_k + 8), m_scale);
+    __m128 m_sum3 = _mm_mul_ps(_mm_loadu_ps(src_k + 12), m_scale);
+    for (int k = 1; k < count; ++k) {
+      m_scale = _mm_load1_ps(scales + k);
+      src_k = src[k] + i;
+      m_sum0 = _mm_add_ps(m_sum0, _mm_mul_ps(_mm_loadu_ps(src_k), m_scale));
+      m_sum1 =
+          _mm_add_ps(m_sum1, _mm_mul_ps(_mm_loadu_ps(src_k + 4), m_scale));
+      m_sum2 =
+          _mm_add_ps(m_sum2, _mm_mul_ps(_mm_loadu_ps(src_k + 8), m_scale));
+      m_sum3 =
+          _mm_add_ps(m_sum3, _mm_mul_ps(_mm_loadu_ps(src_k + 12), m_scale));
+    }
+    _mm_storeu_ps(dest + i, m_sum0);
+    _mm_storeu_ps(dest + i + 4, m_sum1);
+    _mm_storeu_ps(dest + i + 8, m_sum2);
+    _mm_storeu_ps(dest + i + 12, m_sum3);
+  }
+
+  for (; i + 4 <= len; i += 4) {
+    __m128 m_sum = _mm_mul_ps(_mm_loadu_ps(src[0] + i), _mm_load1_ps(scales));
+    for (int k = 1; k < count; ++k) {
+      m_sum = _mm_add_ps(m_sum, _mm_mul_ps(_mm_loadu_ps(src[k] + i),
+                                           _mm_load1_ps(scales + k)));
+    }
+    _mm_storeu_ps(dest + i, m_sum);
+  }
+
+  // Handle any remaining values that wouldn't fit in an SSE pass.
+  for (; i < len; ++i) {
+    float sum = src[0][i] * scales[0];
+    for (int k = 1; k < count; ++k)
+      sum += src[k][i] * scales[k];
+    dest[i] = sum;
+  }
+}
+
+float DotProduct_SSE(const float a[], const float b[], int len) {
+  const int rem = len % 4;
+  const int last_index = len - rem;
+  __m128 m_sum = _mm_setzero_ps();
+  for (int i = 0; i < last_index; i += 4) {
+    m_sum = _mm_add_ps(
+        m_sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+
+  // Reduce to a single float.
+  m_sum = _mm_add_ps(_mm_movehl_ps(m_sum, m_sum), m_sum);
+  float sum;
+  _mm_store_ss(&sum, _mm_add_ss(m_sum, _mm_shuffle_ps(m_sum, m_sum, 1)));
+
+  // Handle any remaining values that wouldn't fit in an SSE pass.
+  for (int i = last_index; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+namespace {
+
+// Multiplies each element of |v| by |negative_scale| if it's negative and by
+// |positive_scale| otherwise.
+__m128 ScaleBySign(__m128 v, float negative_scale, float positive_scale) {
+  const __m128 m_negative = _mm_cmplt_ps(v, _mm_setzero_ps());
+  return _mm_mul_ps(
+      v, _mm_or_ps(_mm_and_ps(m_negative, _mm_set1_ps(negative_scale)),
+                   _mm_andnot_ps(m_negative, _mm_set1_ps(positive_scale))));
+}
+
+// Replaces NaN elements of |v| by 0 and clamps the rest to [-1.0, 1.0].
+__m128 ClampSamples(__m128 v) {
+  v = _mm_and_ps(v, _mm_cmpord_ps(v, v));
+  return _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+// Vector versions of the conversions above, which load or store four samples
+// as floats.  The scales are those of the SampleTypeTraits, so the results are
+// bit-exact with the scalar versions.
+struct UnclampedFloatConversionSSE : UnclampedFloatConversion {
+  static __m128 Load(const float* src) { return _mm_loadu_ps(src); }
+  static void Store(__m128 v, float* dest) { _mm_storeu_ps(dest, v); }
+};
+
+struct ClampedFloatConversionSSE : ClampedFloatConversion {
+  static void Store(__m128 v, float* dest) {
+    _mm_storeu_ps(dest, ClampSamples(v));
+  }
+};
+
+struct S16ConversionSSE : S16Conversion {
+  static __m128 Load(const int16_t* src) {
+    const __m128i m_src =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+    // Sign extend to 32 bits by unpacking into the upper halves.
+    const __m128i m_src32 =
+        _mm_srai_epi32(_mm_unpacklo_epi16(m_src, m_src), 16);
+    return ScaleBySign(_mm_cvtepi32_ps(m_src32), 1.0f / 32768, 1.0f / 32767);
+  }
+  static void Store(__m128 v, int16_t* dest) {
+    // Clamping first keeps every product within int16_t, so the saturating
+    // pack never saturates.
+    const __m128i m_dest32 =
+        _mm_cvttps_epi32(ScaleBySign(ClampSamples(v), 32768, 32767));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest),
+                     _mm_packs_epi32(m_dest32, m_dest32));
+  }
+};
+
+struct S32ConversionSSE : S32Conversion {
+  static __m128 Load(const int32_t* src) {
+    const __m128i m_src =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    return _mm_mul_ps(_mm_cvtepi32_ps(m_src),
+                      _mm_set1_ps(1.0f / 2147483648.0f));
+  }
+  static void Store(__m128 v, int32_t* dest) {
+    // 1.0 scales to 2^31, which doesn't fit and converts to INT32_MIN; flipping
+    // every bit of those lanes turns that into INT32_MAX.
+    v = ClampSamples(v);
+    const __m128i m_dest = _mm_xor_si128(
+        _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(2147483648.0f))),
+        _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(1.0f))));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), m_dest);
+  }
+};
+
+// Interleaves four frames of 5.1 from |c| into |dest|.  Pairs of channels are
+// interleaved as in stereo, after which each frame is three 64 bit pairs.
+template <class Conversion>
+void Interleave6x4(const __m128 c[6], typename Conversion::ValueType* dest) {
+  const __m128 m_01_lo = _mm_unpacklo_ps(c[0], c[1]);
+  const __m128 m_01_hi = _mm_unpackhi_ps(c[0], c[1]);
+  const __m128 m_23_lo = _mm_unpacklo_ps(c[2], c[3]);
+  const __m128 m_23_hi = _mm_unpackhi_ps(c[2], c[3]);
+  const __m128 m_45_lo = _mm_unpacklo_ps(c[4], c[5]);
+  const __m128 m_45_hi = _mm_unpackhi_ps(c[4], c[5]);
+  Conversion::Store(_mm_shuffle_ps(m_01_lo, m_23_lo, _MM_SHUFFLE(1, 0, 1, 0)),
+                    dest);
+  Conversion::Store(_mm_shuffle_ps(m_45_lo, m_01_lo, _MM_SHUFFLE(3, 2, 1, 0)),
+                    dest + 4);
+  Conversion::Store(_mm_shuffle_ps(m_23_lo, m_45_lo, _MM_SHUFFLE(3, 2, 3, 2)),
+                    dest + 8);
+  Conversion::Store(_mm_shuffle_ps(m_01_hi, m_23_hi, _MM_SHUFFLE(1, 0, 1, 0)),
+                    dest + 12);
+  Conversion::Store(_mm_shuffle_ps(m_45_hi, m_01_hi, _MM_SHUFFLE(3, 2, 1, 0)),
+                    dest + 16);
+  Conversion::Store(_mm_shuffle_ps(m_23_hi, m_45_hi, _MM_SHUFFLE(3, 2, 3, 2)),
+                    dest + 20);
+}
+
+// The inverse of Interleave6x4().
+template <class Conversion>
+void Deinterleave6x4(const typename Conversion::ValueType* src, __m128 c[6]) {
+  __m128 m_pairs[2][3];
+  for (int half = 0; half < 2; ++half) {
+    const __m128 m_a = Conversion::Load(src + 12 * half);
+    const __m128 m_b = Conversion::Load(src + 12 * half + 4);
+    const __m128 m_c = Conversion::Load(src + 12 * half + 8);
+    m_pairs[half][0] = _mm_shuffle_ps(m_a, m_b, _MM_SHUFFLE(3, 2, 1, 0));
+    m_pairs[half][1] = _mm_shuffle_ps(m_a, m_c, _MM_SHUFFLE(1, 0, 3, 2));
+    m_pairs[half][2] = _mm_shuffle_ps(m_b, m_c, _MM_SHUFFLE(3, 2, 1, 0));
+  }
+  for (int pair = 0; pair < 3; ++pair) {
+    c[2 * pair] = _mm_shuffle_ps(m_pairs[0][pair], m_pairs[1][pair],
+                                 _MM_SHUFFLE(2, 0, 2, 0));
+    c[2 * pair + 1] = _mm_shuffle_ps(m_pairs[0][pair], m_pairs[1][pair],
+                                     _MM_SHUFFLE(3, 1, 3, 1));
+  }
+}
+
+// Vectorizes mono, stereo and 5.1, four frames at a time.  Everything else,
+// and any remaining frames, go through the scalar conversion.
+template <class Conversion>
+void InterleaveAndConvert_SSE(const float* const src[],
+                              int channels,
+                              int len,
+                              typename Conversion::ValueType dest[]) {
+  const int last_index = len - len % 4;
+  int i = 0;
+  if (channels == 1) {
+    for (; i < last_index; i += 4)
+      Conversion::Store(_mm_loadu_ps(src[0] + i), dest + i);
+  } else if (channels == 2) {
+    for (; i < last_index; i += 4) {
+      const __m128 m_left = _mm_loadu_ps(src[0] + i);
+      const __m128 m_right = _mm_loadu_ps(src[1] + i);
+      Conversion::Store(_mm_unpacklo_ps(m_left, m_right), dest + 2 * i);
+      Conversion::Store(_mm_unpackhi_ps(m_left, m_right), dest + 2 * i + 4);
+    }
+  } else if (channels == 6) {
+    __m128 m_channels[6];
+    for (; i < last_index; i += 4) {
+      for (int ch = 0; ch < 6; ++ch)
+        m_channels[ch] = _mm_loadu_ps(src[ch] + i);
+      Interleave6x4<Conversion>(m_channels, dest + 6 * i);
+    }
+  }
+  InterleaveAndConvertFrom<Conversion>(i, src, channels, len, dest);
+}
+
+template <class Conversion>
+void DeinterleaveAndConvert_SSE(const typename Conversion::ValueType src[],
+                                int channels,
+                                int len,
+                                float* const dest[]) {
+  const int last_index = len - len % 4;
+  int i = 0;
+  if (channels == 1) {
+    for (; i < last_index; i += 4)
+      _mm_storeu_ps(dest[0] + i, Conversion::Load(src + i));
+  } else if (channels == 2) {
+    for (; i < last_index; i += 4) {
+      const __m128 m_lo = Conversion::Load(src + 2 * i);
+      const __m128 m_hi = Conversion::Load(src + 2 * i + 4);
+      _mm_storeu_ps(dest[0] + i,
+                    _mm_shuffle_ps(m_lo, m_hi, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(dest[1] + i,
+                    _mm_shuffle_ps(m_lo, m_hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  } else if (channels == 6) {
+    __m128 m_channels[6];
+    for (; i < last_index; i += 4) {
+      Deinterleave6x4<Conversion>(src + 6 * i, m_channels);
+      for (int ch = 0; ch < 6; ++ch)
+        _mm_storeu_ps(dest[ch] + i, m_channels[ch]);
+    }
+  }
+  DeinterleaveAndConvertFrom<Conversion>(i, src, channels, len, dest);
+}
+
+}  // namespace
+
+void Deinterleave_SSE(const float src[],
+                      int channels,
+                      int len,
+                      float* const dest[]) {
+  DeinterleaveAndConvert_SSE<UnclampedFloatConversionSSE>(src, channels, len,
+                                                          dest);
+}
+
+void DeinterleaveS16_SSE(const int16_t src[],
+                         int channels,
+                         int len,
+                         float* const dest[]) {
+  DeinterleaveAndConvert_SSE<S16ConversionSSE>(src, channels, len, dest);
+}
+
+void DeinterleaveS32_SSE(const int32_t src[],
+                         int channels,
+                         int len,
+                         float* const dest[]) {
+  DeinterleaveAndConvert_SSE<S32ConversionSSE>(src, channels, len, dest);
+}
+
+void InterleaveAndClamp_SSE(const float* const src[],
+                            int channels,
+                            int len,
+                            float dest[]) {
+  InterleaveAndConvert_SSE<ClampedFloatConversionSSE>(src, channels, len,
+                                                      dest);
+}
+
+void InterleaveS16_SSE(const float* const src[],
+                       int channels,
+                       int len,
+                       int16_t dest[]) {
+  InterleaveAndConvert_SSE<S16ConversionSSE>(src, channels, len, dest);
+}
+
+void InterleaveS32_SSE(const float* const src[],
+                       int channels,
+                       int len,
+                       int32_t dest[]) {
+  InterleaveAndConvert_SSE<S32ConversionSSE>(src, channels, len, dest);
+}
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -287,6 +889,224 @@ std::pair<float, float> EWMAAndMaxPower_NEON(
 
   return result;
 }
+
+void FADD_NEON(const float src[], int len, float dest[]) {
+  const int rem = len % 4;
+  const int last_index = len - rem;
+  for (int i = 0; i < last_index; i += 4)
+    vst1q_f32(dest + i, vaddq_f32(vld1q_f32(dest + i), vld1q_f32(src + i)));
+
+  // Handle any remaining values that wouldn't fit in an NEON pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i];
+}
+
+void WeightedSum_NEON(const float* const src[],
+                      const float scales[],
+                      int count,
+                      int len,
+                      float dest[]) {
+  // Sum 16 values at a time in four independent accumulators, so consecutive
+  // additions don't wait on each other.
+  int i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const float* src_k = src[0] + i;
+    float32x4_t m_sum0 = vmulq_n_f32(vld1q_f32(src_k), scales[0]);
+    float32x4_t m_sum1 = vmulq_n_f32(vld1q_f32(src_k + 4), scales[0]);
+    float32x4_t m_sum2 = vmulq_n_f32(vld1q_f32(src_k + 8), scales[0]);
+    float32x4_t m_sum3 = vmulq_n_f32(vld1q_f32(src_k + 12), scales[0]);
+    for (int k = 1; k < count; ++k) {
+      src_k = src[k] + i;
+      m_sum0 = vmlaq_n_f32(m_sum0, vld1q_f32(src_k), scales[k]);
+      m_sum1 = vmlaq_n_f32(m_sum1, vld1q_f32(src_k + 4), scales[k]);
+      m_sum2 = vmlaq_n_f32(m_sum2, vld1q_f32(src_k + 8), scales[k]);
+      m_sum3 = vmlaq_n_f32(m_sum3, vld1q_f32(src_k + 12), scales[k]);
+    }
+    vst1q_f32(dest + i, m_sum0);
+    vst1q_f32(dest + i + 4, m_sum1);
+    vst1q_f32(dest + i + 8, m_sum2);
+    vst1q_f32(dest + i + 12, m_sum3);
+  }
+
+  for (; i + 4 <= len; i += 4) {
+    float32x4_t m_sum = vmulq_n_f32(vld1q_f32(src[0] + i), scales[0]);
+    for (int k = 1; k < count; ++k)
+      m_sum = vmlaq_n_f32(m_sum, vld1q_f32(src[k] + i), scales[k]);
+    vst1q_f32(dest + i, m_sum);
+  }
+
+  // Handle any remaining values that wouldn't fit in an NEON pass.
+  for (; i < len; ++i) {
+    float sum = src[0][i] * scales[0];
+    for (int k = 1; k < count; ++k)
+      sum += src[k][i] * scales[k];
+    dest[i] = sum;
+  }
+}
+
+float DotProduct_NEON(const float a[], const float b[], int len) {
+  const int rem = len % 4;
+  const int last_index = len - rem;
+  float32x4_t m_sum = vmovq_n_f32(0);
+  for (int i = 0; i < last_index; i += 4)
+    m_sum = vmlaq_f32(m_sum, vld1q_f32(a + i), vld1q_f32(b + i));
+
+  // Reduce to a single float.
+  float32x2_t m_half = vadd_f32(vget_high_f32(m_sum), vget_low_f32(m_sum));
+  float sum = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+
+  // Handle any remaining values that wouldn't fit in an NEON pass.
+  for (int i = last_index; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+namespace {
+
+// Multiplies each element of |v| by |negative_scale| if it's negative and by
+// |positive_scale| otherwise.
+float32x4_t ScaleBySign(float32x4_t v,
+                        float negative_scale,
+                        float positive_scale) {
+  return vmulq_f32(v, vbslq_f32(vcltq_f32(v, vdupq_n_f32(0)),
+                                vdupq_n_f32(negative_scale),
+                                vdupq_n_f32(positive_scale)));
+}
+
+// Replaces NaN elements of |v| by 0 and clamps the rest to [-1.0, 1.0].
+float32x4_t ClampSamples(float32x4_t v) {
+  v = vreinterpretq_f32_u32(
+      vandq_u32(vreinterpretq_u32_f32(v), vceqq_f32(v, v)));
+  return vminq_f32(vmaxq_f32(v, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+}
+
+// Vector versions of the conversions above, which load or store four samples
+// as floats.  The scales are those of the SampleTypeTraits, so the results are
+// bit-exact with the scalar versions.  vcvtq_s32_f32() saturates, so 1.0 needs
+// no special casing for 32 bit samples.
+struct UnclampedFloatConversionNEON : UnclampedFloatConversion {
+  static float32x4_t Load(const float* src) { return vld1q_f32(src); }
+  static void Store(float32x4_t v, float* dest) { vst1q_f32(dest, v); }
+};
+
+struct ClampedFloatConversionNEON : ClampedFloatConversion {
+  static void Store(float32x4_t v, float* dest) {
+    vst1q_f32(dest, ClampSamples(v));
+  }
+};
+
+struct S16ConversionNEON : S16Conversion {
+  static float32x4_t Load(const int16_t* src) {
+    return ScaleBySign(vcvtq_f32_s32(vmovl_s16(vld1_s16(src))), 1.0f / 32768,
+                       1.0f / 32767);
+  }
+  static void Store(float32x4_t v, int16_t* dest) {
+    vst1_s16(dest, vmovn_s32(vcvtq_s32_f32(
+                       ScaleBySign(ClampSamples(v), 32768, 32767))));
+  }
+};
+
+struct S32ConversionNEON : S32Conversion {
+  static float32x4_t Load(const int32_t* src) {
+    return vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src)), 1.0f / 2147483648.0f);
+  }
+  static void Store(float32x4_t v, int32_t* dest) {
+    vst1q_s32(dest,
+              vcvtq_s32_f32(vmulq_n_f32(ClampSamples(v), 2147483648.0f)));
+  }
+};
+
+// Vectorizes mono and stereo, four frames at a time, converting after a plain
+// 32 bit vzip/vuzp.  Everything else, and any remaining frames, go through the
+// scalar conversion.
+template <class Conversion>
+void InterleaveAndConvert_NEON(const float* const src[],
+                               int channels,
+                               int len,
+                               typename Conversion::ValueType dest[]) {
+  const int last_index = len - len % 4;
+  int i = 0;
+  if (channels == 1) {
+    for (; i < last_index; i += 4)
+      Conversion::Store(vld1q_f32(src[0] + i), dest + i);
+  } else if (channels == 2) {
+    for (; i < last_index; i += 4) {
+      const float32x4x2_t m_frames =
+          vzipq_f32(vld1q_f32(src[0] + i), vld1q_f32(src[1] + i));
+      Conversion::Store(m_frames.val[0], dest + 2 * i);
+      Conversion::Store(m_frames.val[1], dest + 2 * i + 4);
+    }
+  }
+  InterleaveAndConvertFrom<Conversion>(i, src, channels, len, dest);
+}
+
+template <class Conversion>
+void DeinterleaveAndConvert_NEON(const typename Conversion::ValueType src[],
+                                 int channels,
+                                 int len,
+                                 float* const dest[]) {
+  const int last_index = len - len % 4;
+  int i = 0;
+  if (channels == 1) {
+    for (; i < last_index; i += 4)
+      vst1q_f32(dest[0] + i, Conversion::Load(src + i));
+  } else if (channels == 2) {
+    for (; i < last_index; i += 4) {
+      const float32x4x2_t m_channels =
+          vuzpq_f32(Conversion::Load(src + 2 * i),
+                    Conversion::Load(src + 2 * i + 4));
+      vst1q_f32(dest[0] + i, m_channels.val[0]);
+      vst1q_f32(dest[1] + i, m_channels.val[1]);
+    }
+  }
+  DeinterleaveAndConvertFrom<Conversion>(i, src, channels, len, dest);
+}
+
+}  // namespace
+
+void Deinterleave_NEON(const float src[],
+                       int channels,
+                       int len,
+                       float* const dest[]) {
+  DeinterleaveAndConvert_NEON<UnclampedFloatConversionNEON>(src, channels, len,
+                                                            dest);
+}
+
+void DeinterleaveS16_NEON(const int16_t src[],
+                          int channels,
+                          int len,
+                          float* const dest[]) {
+  DeinterleaveAndConvert_NEON<S16ConversionNEON>(src, channels, len, dest);
+}
+
+void DeinterleaveS32_NEON(const int32_t src[],
+                          int channels,
+                          int len,
+                          float* const dest[]) {
+  DeinterleaveAndConvert_NEON<S32ConversionNEON>(src, channels, len, dest);
+}
+
+void InterleaveAndClamp_NEON(const float* const src[],
+                             int channels,
+                             int len,
+                             float dest[]) {
+  InterleaveAndConvert_NEON<ClampedFloatConversionNEON>(src, channels, len,
+                                                        dest);
+}
+
+void InterleaveS16_NEON(const float* const src[],
+                        int channels,
+                        int len,
+                        int16_t dest[]) {
+  InterleaveAndConvert_NEON<S16ConversionNEON>(src, channels, len, dest);
+}
+
+void InterleaveS32_NEON(const float* const src[],
+                        int channels,
+                        int len,
+                        int32_t dest[]) {
+  InterleaveAndConvert_NEON<S32ConversionNEON>(src, channels, len, dest);
+}
 #endif
 
 }  // namespace vector_math
@@ -5,6 +5,8 @@
 #ifndef MEDIA_BASE_VECTOR_MATH_H_
 #define MEDIA_BASE_VECTOR_MATH_H_
 
+#include <stdint.h>
+
 #include <utility>
 
 #include "media/base/media_shmem_export.h"
@@ -44,6 +46,65 @@ MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower(
 
 MEDIA_SHMEM_EXPORT void Crossfade(const float src[], int len, float dest[]);
 
+// Add each element of |src| (up to |len|) to |dest|.  |src| and |dest| must be
+// aligned by kRequiredAlignment.
+MEDIA_SHMEM_EXPORT void FADD(const float src[], int len, float dest[]);
+
+// Sets each element of |dest| (up to |len|) to the sum of the corresponding
+// elements of the |count| arrays in |src|, each multiplied by its entry in
+// |scales|.  Unlike repeated FMAC() calls, |dest| is written once and never
+// read.  |count| must be at least 1.  Neither |src| nor |dest| has an
+// alignment requirement.  |dest| may also be one of the arrays in |src|.
+MEDIA_SHMEM_EXPORT void WeightedSum(const float* const src[],
+                                    const float scales[],
+                                    int count,
+                                    int len,
+                                    float dest[]);
+
+// Returns the sum of the products of the first |len| elements of |a| and |b|.
+// Unlike the functions above, |a| and |b| have no alignment requirement.
+MEDIA_SHMEM_EXPORT float DotProduct(const float a[], const float b[], int len);
+
+// Splits |len| interleaved frames of |channels| channels, with layout
+// [ch0, ch1, ..., chN, ch0, ch1, ...], from |src| into the planar arrays in
+// |dest|.  Neither |src| nor |dest| has an alignment requirement.
+MEDIA_SHMEM_EXPORT void Deinterleave(const float src[],
+                                     int channels,
+                                     int len,
+                                     float* const dest[]);
+
+// Like Deinterleave(), but converts each signed 16 or 32 bit sample to float
+// exactly as SignedInt16SampleTypeTraits::ToFloat() and
+// SignedInt32SampleTypeTraits::ToFloat() do.  Mono, stereo and 5.1 have
+// vectorized versions.
+MEDIA_SHMEM_EXPORT void DeinterleaveS16(const int16_t src[],
+                                        int channels,
+                                        int len,
+                                        float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS32(const int32_t src[],
+                                        int channels,
+                                        int len,
+                                        float* const dest[]);
+
+// Interleaves |len| frames from the |channels| planar arrays in |src| into
+// |dest|, the inverse of Deinterleave().  Each sample is converted exactly as
+// the FromFloat() method of Float32SampleTypeTraits,
+// SignedInt16SampleTypeTraits and SignedInt32SampleTypeTraits respectively
+// does; i.e., clamped to [-1.0, 1.0] and, for the integer types, scaled.  NaN
+// values are replaced by 0.  Mono, stereo and 5.1 have vectorized versions.
+MEDIA_SHMEM_EXPORT void InterleaveAndClamp(const float* const src[],
+                                           int channels,
+                                           int len,
+                                           float dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS16(const float* const src[],
+                                      int channels,
+                                      int len,
+                                      int16_t dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS32(const float* const src[],
+                                      int channels,
+                                      int len,
+                                      int32_t dest[]);
+
 }  // namespace vector_math
 }  // namespace media
 
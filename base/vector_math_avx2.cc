@@ -0,0 +1,221 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// AVX2 versions of the vector_math kernels.  None of them may run before
+// vector_math::CPUHasAVX2() has been checked; see SelectImplementations() in
+// vector_math.cc.
+//
+// The file is built with the default instruction set, and only the functions
+// below are compiled for AVX2, through a target attribute.  Enabling AVX2 for
+// the whole file would also enable it for any inline or template code pulled
+// in from headers, whose copies the linker may then pick for every caller.
+
+#include <immintrin.h>
+
+#include "media/base/vector_math_testing.h"
+
+#if defined(__clang__) || defined(__GNUC__)
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+// MSVC allows AVX2 intrinsics without any instruction set option.
+#define AVX2_FUNCTION
+#endif
+
+namespace media {
+namespace vector_math {
+
+// All loads and stores below are unaligned since callers only guarantee
+// kRequiredAlignment (16 bytes); on AVX2 hardware unaligned accesses to aligned
+// addresses carry no penalty.
+
+AVX2_FUNCTION void FMAC_AVX2(const float src[],
+                             float scale,
+                             int len,
+                             float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  const __m256 m_scale = _mm256_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i,
+                     _mm256_add_ps(_mm256_loadu_ps(dest + i),
+                                   _mm256_mul_ps(_mm256_loadu_ps(src + i),
+                                                 m_scale)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX2 pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i] * scale;
+}
+
+AVX2_FUNCTION void FMUL_AVX2(const float src[],
+                             float scale,
+                             int len,
+                             float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  const __m256 m_scale = _mm256_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i,
+                     _mm256_mul_ps(_mm256_loadu_ps(src + i), m_scale));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX2 pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] = src[i] * scale;
+}
+
+AVX2_FUNCTION std::pair<float, float> EWMAAndMaxPower_AVX2(
+    float initial_value,
+    const float src[],
+    int len,
+    float smoothing_factor) {
+  // Same lane splitting as EWMAAndMaxPower_SSE(), just 8 lanes wide:
+  //
+  //   y[n] = z[n] + (1-a)^1(z[n-1]) + ... + (1-a)^7(z[n-7])
+  //
+  // where z[n] = a(S[n]^2) + (1-a)^8(z[n-8]) + (1-a)^16(z[n-16]) + ...
+  const int rem = len % 8;
+  const int last_index = len - rem;
+
+  const float weight_prev = 1.0f - smoothing_factor;
+  float weight_prev_8th = weight_prev * weight_prev;
+  weight_prev_8th *= weight_prev_8th;
+  weight_prev_8th *= weight_prev_8th;
+  const __m256 smoothing_factor_x8 = _mm256_set1_ps(smoothing_factor);
+  const __m256 weight_prev_8th_x8 = _mm256_set1_ps(weight_prev_8th);
+
+  // Compute z[n] ... z[n-7] in parallel in lanes 7 ... 0, respectively.
+  __m256 max_x8 = _mm256_setzero_ps();
+  __m256 ewma_x8 =
+      _mm256_setr_ps(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, initial_value);
+  int i;
+  for (i = 0; i < last_index; i += 8) {
+    ewma_x8 = _mm256_mul_ps(ewma_x8, weight_prev_8th_x8);
+    const __m256 sample_x8 = _mm256_loadu_ps(src + i);
+    const __m256 sample_squared_x8 = _mm256_mul_ps(sample_x8, sample_x8);
+    max_x8 = _mm256_max_ps(max_x8, sample_squared_x8);
+    ewma_x8 = _mm256_add_ps(ewma_x8,
+                            _mm256_mul_ps(sample_squared_x8,
+                                          smoothing_factor_x8));
+  }
+
+  // Combine the lanes.  This only happens once per call, so spill to memory
+  // rather than shuffling.
+  float ewma_lanes[8];
+  float max_lanes[8];
+  _mm256_storeu_ps(ewma_lanes, ewma_x8);
+  _mm256_storeu_ps(max_lanes, max_x8);
+
+  std::pair<float, float> result(ewma_lanes[7], max_lanes[7]);
+  float weight = weight_prev;
+  for (int lane = 6; lane >= 0; --lane) {
+    result.first += weight * ewma_lanes[lane];
+    if (max_lanes[lane] > result.second)
+      result.second = max_lanes[lane];
+    weight *= weight_prev;
+  }
+
+  // Handle remaining values at the end of |src|.
+  for (; i < len; ++i) {
+    result.first *= weight_prev;
+    const float sample = src[i];
+    const float sample_squared = sample * sample;
+    result.first += sample_squared * smoothing_factor;
+    if (sample_squared > result.second)
+      result.second = sample_squared;
+  }
+
+  return result;
+}
+
+AVX2_FUNCTION void FADD_AVX2(const float src[], int len, float dest[]) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  for (int i = 0; i < last_index; i += 8) {
+    _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i),
+                                             _mm256_loadu_ps(src + i)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX2 pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i];
+}
+
+AVX2_FUNCTION void WeightedSum_AVX2(const float* const src[],
+                                    const float scales[],
+                                    int count,
+                                    int len,
+                                    float dest[]) {
+  // Sum 32 values at a time in four independent accumulators, so consecutive
+  // additions don't wait on each other.
+  int i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256 m_scale = _mm256_broadcast_ss(scales);
+    const float* src_k = src[0] + i;
+    __m256 m_sum0 = _mm256_mul_ps(_mm256_loadu_ps(src_k), m_scale);
+    __m256 m_sum1 = _mm256_mul_ps(_mm256_loadu_ps(src_k + 8), m_scale);
+    __m256 m_sum2 = _mm256_mul_ps(_mm256_loadu_ps(src_k + 16), m_scale);
+    __m256 m_sum3 = _mm256_mul_ps(_mm256_loadu_ps(src_k + 24), m_scale);
+    for (int k = 1; k < count; ++k) {
+      m_scale = _mm256_broadcast_ss(scales + k);
+      src_k = src[k] + i;
+      m_sum0 = _mm256_add_ps(
+          m_sum0, _mm256_mul_ps(_mm256_loadu_ps(src_k), m_scale));
+      m_sum1 = _mm256_add_ps(
+          m_sum1, _mm256_mul_ps(_mm256_loadu_ps(src_k + 8), m_scale));
+      m_sum2 = _mm256_add_ps(
+          m_sum2, _mm256_mul_ps(_mm256_loadu_ps(src_k + 16), m_scale));
+      m_sum3 = _mm256_add_ps(
+          m_sum3, _mm256_mul_ps(_mm256_loadu_ps(src_k + 24), m_scale));
+    }
+    _mm256_storeu_ps(dest + i, m_sum0);
+    _mm256_storeu_ps(dest + i + 8, m_sum1);
+    _mm256_storeu_ps(dest + i + 16, m_sum2);
+    _mm256_storeu_ps(dest + i + 24, m_sum3);
+  }
+
+  for (; i + 8 <= len; i += 8) {
+    __m256 m_sum = _mm256_mul_ps(_mm256_loadu_ps(src[0] + i),
+                                 _mm256_broadcast_ss(scales));
+    for (int k = 1; k < count; ++k) {
+      m_sum = _mm256_add_ps(m_sum,
+                            _mm256_mul_ps(_mm256_loadu_ps(src[k] + i),
+                                          _mm256_broadcast_ss(scales + k)));
+    }
+    _mm256_storeu_ps(dest + i, m_sum);
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX2 pass.
+  for (; i < len; ++i) {
+    float sum = src[0][i] * scales[0];
+    for (int k = 1; k < count; ++k)
+      sum += src[k][i] * scales[k];
+    dest[i] = sum;
+  }
+}
+
+AVX2_FUNCTION float DotProduct_AVX2(const float a[], const float b[], int len) {
+  const int rem = len % 8;
+  const int last_index = len - rem;
+  __m256 m_sum = _mm256_setzero_ps();
+  for (int i = 0; i < last_index; i += 8) {
+    m_sum = _mm256_add_ps(
+        m_sum, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  }
+
+  // Reduce to a single float.
+  __m128 m_half = _mm_add_ps(_mm256_castps256_ps128(m_sum),
+                             _mm256_extractf128_ps(m_sum, 1));
+  m_half = _mm_add_ps(_mm_movehl_ps(m_half, m_half), m_half);
+  float sum = _mm_cvtss_f32(
+      _mm_add_ss(m_half, _mm_shuffle_ps(m_half, m_half, 1)));
+
+  // Handle any remaining values that wouldn't fit in an AVX2 pass.
+  for (int i = last_index; i < len; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+}  // namespace vector_math
+}  // namespace media
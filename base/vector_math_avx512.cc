@@ -0,0 +1,58 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// AVX-512 versions of the vector_math accumulation kernels.  None of them may
+// run before vector_math::CPUHasAVX512() has been checked.  As in
+// vector_math_avx2.cc, only these functions are compiled for AVX-512F.
+//
+// Only FMAC() and FADD() have AVX-512 versions; in local testing FMUL() and
+// DotProduct() were no faster than their AVX2 versions.
+
+#include <immintrin.h>
+
+#include "media/base/vector_math_testing.h"
+
+#if defined(__clang__) || defined(__GNUC__)
+#define AVX512_FUNCTION __attribute__((target("avx512f")))
+#else
+#define AVX512_FUNCTION
+#endif
+
+namespace media {
+namespace vector_math {
+
+AVX512_FUNCTION void FMAC_AVX512(const float src[],
+                                 float scale,
+                                 int len,
+                                 float dest[]) {
+  const int rem = len % 16;
+  const int last_index = len - rem;
+  const __m512 m_scale = _mm512_set1_ps(scale);
+  for (int i = 0; i < last_index; i += 16) {
+    _mm512_storeu_ps(dest + i,
+                     _mm512_add_ps(_mm512_loadu_ps(dest + i),
+                                   _mm512_mul_ps(_mm512_loadu_ps(src + i),
+                                                 m_scale)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX-512 pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i] * scale;
+}
+
+AVX512_FUNCTION void FADD_AVX512(const float src[], int len, float dest[]) {
+  const int rem = len % 16;
+  const int last_index = len - rem;
+  for (int i = 0; i < last_index; i += 16) {
+    _mm512_storeu_ps(dest + i, _mm512_add_ps(_mm512_loadu_ps(dest + i),
+                                             _mm512_loadu_ps(src + i)));
+  }
+
+  // Handle any remaining values that wouldn't fit in an AVX-512 pass.
+  for (int i = last_index; i < len; ++i)
+    dest[i] += src[i];
+}
+
+}  // namespace vector_math
+}  // namespace media
@@ -56,6 +56,63 @@ class VectorMathPerfTest : public testing::Test {
                            true);
   }
 
+  void RunBenchmark(void (*fn)(const float[], int, float[]),
+                    bool aligned,
+                    const std::string& test_name,
+                    const std::string& trace_name) {
+    TimeTicks start = TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      fn(input_vector_.get(), kVectorSize - (aligned ? 0 : 1),
+         output_vector_.get());
+    }
+    double total_time_milliseconds =
+        (TimeTicks::Now() - start).InMillisecondsF();
+    perf_test::PrintResult(test_name, "", trace_name,
+                           kBenchmarkIterations / total_time_milliseconds,
+                           "runs/ms", true);
+  }
+
+  void RunBenchmark(float (*fn)(const float[], const float[], int),
+                    bool aligned,
+                    const std::string& test_name,
+                    const std::string& trace_name) {
+    float sum = 0;
+    TimeTicks start = TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      sum += fn(input_vector_.get(), output_vector_.get(),
+                kVectorSize - (aligned ? 0 : 1));
+    }
+    double total_time_milliseconds =
+        (TimeTicks::Now() - start).InMillisecondsF();
+    // |output_vector_| is all zeros; checking |sum| keeps the calls from being
+    // optimized away.
+    EXPECT_EQ(0.0f, sum);
+    perf_test::PrintResult(test_name, "", trace_name,
+                           kBenchmarkIterations / total_time_milliseconds,
+                           "runs/ms", true);
+  }
+
+  void RunBenchmark(
+      void (*fn)(const float* const[], const float[], int, int, float[]),
+      bool aligned,
+      const std::string& test_name,
+      const std::string& trace_name) {
+    // Four inputs, as when downmixing a 7.1 stream's left side to stereo.
+    const float* const src[] = {input_vector_.get(), input_vector_.get(),
+                                input_vector_.get(), input_vector_.get()};
+    const float scales[] = {1.0f, kScale, kScale, kScale};
+    TimeTicks start = TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      fn(src, scales, arraysize(src), kVectorSize - (aligned ? 0 : 1),
+         output_vector_.get());
+    }
+    double total_time_milliseconds =
+        (TimeTicks::Now() - start).InMillisecondsF();
+    perf_test::PrintResult(test_name, "", trace_name,
+                           kBenchmarkIterations / total_time_milliseconds,
+                           "runs/ms", true);
+  }
+
   void RunBenchmark(
       std::pair<float, float> (*fn)(float, const float[], int, float),
       int len,
@@ -87,10 +144,30 @@ class VectorMathPerfTest : public testing::Test {
 #define FMAC_FUNC FMAC_SSE
 #define FMUL_FUNC FMUL_SSE
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_SSE
+#define FADD_FUNC FADD_SSE
+#define WeightedSum_FUNC WeightedSum_SSE
+#define DotProduct_FUNC DotProduct_SSE
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define FMAC_FUNC FMAC_NEON
 #define FMUL_FUNC FMUL_NEON
 #define EWMAAndMaxPower_FUNC EWMAAndMaxPower_NEON
+#define FADD_FUNC FADD_NEON
+#define WeightedSum_FUNC WeightedSum_NEON
+#define DotProduct_FUNC DotProduct_NEON
+#endif
+
+// The wider x86 versions are only usable when the CPU supports them, so they
+// are benchmarked in addition to the baseline SIMD version above.
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#define RUN_AVX2_BENCHMARK(fn, aligned, test_name, trace_name) \
+  if (vector_math::CPUHasAVX2())                               \
+    RunBenchmark(vector_math::fn##_AVX2, aligned, test_name, trace_name)
+#define RUN_AVX512_BENCHMARK(fn, aligned, test_name, trace_name) \
+  if (vector_math::CPUHasAVX512())                               \
+    RunBenchmark(vector_math::fn##_AVX512, aligned, test_name, trace_name)
+#else
+#define RUN_AVX2_BENCHMARK(fn, aligned, test_name, trace_name)
+#define RUN_AVX512_BENCHMARK(fn, aligned, test_name, trace_name)
 #endif
 
 // Benchmark for each optimized vector_math::FMAC() method.
@@ -110,6 +187,10 @@ TEST_F(VectorMathPerfTest, FMAC) {
   RunBenchmark(
       vector_math::FMAC_FUNC, true, "vector_math_fmac", "optimized_aligned");
 #endif
+  RUN_AVX2_BENCHMARK(FMAC, false, "vector_math_fmac", "avx2_unaligned");
+  RUN_AVX2_BENCHMARK(FMAC, true, "vector_math_fmac", "avx2_aligned");
+  RUN_AVX512_BENCHMARK(FMAC, false, "vector_math_fmac", "avx512_unaligned");
+  RUN_AVX512_BENCHMARK(FMAC, true, "vector_math_fmac", "avx512_aligned");
 }
 
 // Benchmark for each optimized vector_math::FMUL() method.
@@ -129,6 +210,8 @@ TEST_F(VectorMathPerfTest, FMUL) {
   RunBenchmark(
       vector_math::FMUL_FUNC, true, "vector_math_fmul", "optimized_aligned");
 #endif
+  RUN_AVX2_BENCHMARK(FMUL, false, "vector_math_fmul", "avx2_unaligned");
+  RUN_AVX2_BENCHMARK(FMUL, true, "vector_math_fmul", "avx2_aligned");
 }
 
 // Benchmark for each optimized vector_math::EWMAAndMaxPower() method.
@@ -154,6 +237,57 @@ TEST_F(VectorMathPerfTest, EWMAAndMaxPower) {
                "vector_math_ewma_and_max_power",
                "optimized_aligned");
 #endif
+  RUN_AVX2_BENCHMARK(EWMAAndMaxPower, kVectorSize - 1,
+                     "vector_math_ewma_and_max_power", "avx2_unaligned");
+  RUN_AVX2_BENCHMARK(EWMAAndMaxPower, kVectorSize,
+                     "vector_math_ewma_and_max_power", "avx2_aligned");
+}
+
+// Benchmark for each optimized vector_math::FADD() method.
+TEST_F(VectorMathPerfTest, FADD) {
+  RunBenchmark(vector_math::FADD_C, true, "vector_math_fadd", "unoptimized");
+#if defined(FADD_FUNC)
+  RunBenchmark(vector_math::FADD_FUNC, false, "vector_math_fadd",
+               "optimized_unaligned");
+  RunBenchmark(vector_math::FADD_FUNC, true, "vector_math_fadd",
+               "optimized_aligned");
+#endif
+  RUN_AVX2_BENCHMARK(FADD, false, "vector_math_fadd", "avx2_unaligned");
+  RUN_AVX2_BENCHMARK(FADD, true, "vector_math_fadd", "avx2_aligned");
+  RUN_AVX512_BENCHMARK(FADD, false, "vector_math_fadd", "avx512_unaligned");
+  RUN_AVX512_BENCHMARK(FADD, true, "vector_math_fadd", "avx512_aligned");
+}
+
+// Benchmark for each optimized vector_math::WeightedSum() method.
+TEST_F(VectorMathPerfTest, WeightedSum) {
+  RunBenchmark(vector_math::WeightedSum_C, true, "vector_math_weighted_sum",
+               "unoptimized");
+#if defined(WeightedSum_FUNC)
+  RunBenchmark(vector_math::WeightedSum_FUNC, false, "vector_math_weighted_sum",
+               "optimized_unaligned");
+  RunBenchmark(vector_math::WeightedSum_FUNC, true, "vector_math_weighted_sum",
+               "optimized_aligned");
+#endif
+  RUN_AVX2_BENCHMARK(WeightedSum, false, "vector_math_weighted_sum",
+                     "avx2_unaligned");
+  RUN_AVX2_BENCHMARK(WeightedSum, true, "vector_math_weighted_sum",
+                     "avx2_aligned");
+}
+
+// Benchmark for each optimized vector_math::DotProduct() method.
+TEST_F(VectorMathPerfTest, DotProduct) {
+  RunBenchmark(vector_math::DotProduct_C, true, "vector_math_dot_product",
+               "unoptimized");
+#if defined(DotProduct_FUNC)
+  RunBenchmark(vector_math::DotProduct_FUNC, false, "vector_math_dot_product",
+               "optimized_unaligned");
+  RunBenchmark(vector_math::DotProduct_FUNC, true, "vector_math_dot_product",
+               "optimized_aligned");
+#endif
+  RUN_AVX2_BENCHMARK(DotProduct, false, "vector_math_dot_product",
+                     "avx2_unaligned");
+  RUN_AVX2_BENCHMARK(DotProduct, true, "vector_math_dot_product",
+                     "avx2_aligned");
 }
 
 } // namespace media
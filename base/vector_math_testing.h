@@ -5,6 +5,8 @@
 #ifndef MEDIA_BASE_VECTOR_MATH_TESTING_H_
 #define MEDIA_BASE_VECTOR_MATH_TESTING_H_
 
+#include <stdint.h>
+
 #include <utility>
 
 #include "build/build_config.h"
@@ -27,6 +29,39 @@ MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_C(
     const float src[],
     int len,
     float smoothing_factor);
+MEDIA_SHMEM_EXPORT void FADD_C(const float src[], int len, float dest[]);
+MEDIA_SHMEM_EXPORT void WeightedSum_C(const float* const src[],
+                                      const float scales[],
+                                      int count,
+                                      int len,
+                                      float dest[]);
+MEDIA_SHMEM_EXPORT float DotProduct_C(const float a[],
+                                      const float b[],
+                                      int len);
+MEDIA_SHMEM_EXPORT void Deinterleave_C(const float src[],
+                                       int channels,
+                                       int len,
+                                       float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS16_C(const int16_t src[],
+                                          int channels,
+                                          int len,
+                                          float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS32_C(const int32_t src[],
+                                          int channels,
+                                          int len,
+                                          float* const dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveAndClamp_C(const float* const src[],
+                                             int channels,
+                                             int len,
+                                             float dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS16_C(const float* const src[],
+                                        int channels,
+                                        int len,
+                                        int16_t dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS32_C(const float* const src[],
+                                        int channels,
+                                        int len,
+                                        int32_t dest[]);
 
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
 MEDIA_SHMEM_EXPORT void FMAC_SSE(const float src[],
@@ -42,6 +77,74 @@ MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_SSE(
     const float src[],
     int len,
     float smoothing_factor);
+MEDIA_SHMEM_EXPORT void FADD_SSE(const float src[], int len, float dest[]);
+MEDIA_SHMEM_EXPORT void WeightedSum_SSE(const float* const src[],
+                                        const float scales[],
+                                        int count,
+                                        int len,
+                                        float dest[]);
+MEDIA_SHMEM_EXPORT float DotProduct_SSE(const float a[],
+                                        const float b[],
+                                        int len);
+MEDIA_SHMEM_EXPORT void Deinterleave_SSE(const float src[],
+                                         int channels,
+                                         int len,
+                                         float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS16_SSE(const int16_t src[],
+                                            int channels,
+                                            int len,
+                                            float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS32_SSE(const int32_t src[],
+                                            int channels,
+                                            int len,
+                                            float* const dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveAndClamp_SSE(const float* const src[],
+                                               int channels,
+                                               int len,
+                                               float dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS16_SSE(const float* const src[],
+                                          int channels,
+                                          int len,
+                                          int16_t dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS32_SSE(const float* const src[],
+                                          int channels,
+                                          int len,
+                                          int32_t dest[]);
+
+// AVX2 and AVX-512 versions live in their own translation units so they can be
+// compiled with the matching instruction set enabled.  They must only be called
+// when the corresponding CPUHas*() function returns true.
+MEDIA_SHMEM_EXPORT bool CPUHasAVX2();
+MEDIA_SHMEM_EXPORT bool CPUHasAVX512();
+
+MEDIA_SHMEM_EXPORT void FMAC_AVX2(const float src[],
+                                  float scale,
+                                  int len,
+                                  float dest[]);
+MEDIA_SHMEM_EXPORT void FMUL_AVX2(const float src[],
+                                  float scale,
+                                  int len,
+                                  float dest[]);
+MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_AVX2(
+    float initial_value,
+    const float src[],
+    int len,
+    float smoothing_factor);
+MEDIA_SHMEM_EXPORT void FADD_AVX2(const float src[], int len, float dest[]);
+MEDIA_SHMEM_EXPORT void WeightedSum_AVX2(const float* const src[],
+                                         const float scales[],
+                                         int count,
+                                         int len,
+                                         float dest[]);
+MEDIA_SHMEM_EXPORT float DotProduct_AVX2(const float a[],
+                                         const float b[],
+                                         int len);
+
+MEDIA_SHMEM_EXPORT void FMAC_AVX512(const float src[],
+                                    float scale,
+                                    int len,
+                                    float dest[]);
+MEDIA_SHMEM_EXPORT void FADD_AVX512(const float src[], int len, float dest[]);
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -58,6 +161,39 @@ MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_NEON(
     const float src[],
     int len,
     float smoothing_factor);
+MEDIA_SHMEM_EXPORT void FADD_NEON(const float src[], int len, float dest[]);
+MEDIA_SHMEM_EXPORT void WeightedSum_NEON(const float* const src[],
+                                         const float scales[],
+                                         int count,
+                                         int len,
+                                         float dest[]);
+MEDIA_SHMEM_EXPORT float DotProduct_NEON(const float a[],
+                                         const float b[],
+                                         int len);
+MEDIA_SHMEM_EXPORT void Deinterleave_NEON(const float src[],
+                                          int channels,
+                                          int len,
+                                          float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS16_NEON(const int16_t src[],
+                                             int channels,
+                                             int len,
+                                             float* const dest[]);
+MEDIA_SHMEM_EXPORT void DeinterleaveS32_NEON(const int32_t src[],
+                                             int channels,
+                                             int len,
+                                             float* const dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveAndClamp_NEON(const float* const src[],
+                                                int channels,
+                                                int len,
+                                                float dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS16_NEON(const float* const src[],
+                                           int channels,
+                                           int len,
+                                           int16_t dest[]);
+MEDIA_SHMEM_EXPORT void InterleaveS32_NEON(const float* const src[],
+                                           int channels,
+                                           int len,
+                                           int32_t dest[]);
 #endif
 
 }  // namespace vector_math
@@ -2,14 +2,21 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringize_macros.h"
+#include "base/strings/stringprintf.h"
 #include "build/build_config.h"
+#include "media/base/audio_sample_types.h"
 #include "media/base/vector_math.h"
 #include "media/base/vector_math_testing.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -83,6 +90,24 @@ TEST_F(VectorMathTest, FMAC) {
   }
 #endif
 
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  if (vector_math::CPUHasAVX2()) {
+    SCOPED_TRACE("FMAC_AVX2");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMAC_AVX2(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
+
+  if (vector_math::CPUHasAVX512()) {
+    SCOPED_TRACE("FMAC_AVX512");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMAC_AVX512(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
+#endif
+
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
   {
     SCOPED_TRACE("FMAC_NEON");
@@ -124,6 +149,16 @@ TEST_F(VectorMathTest, FMUL) {
   }
 #endif
 
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  if (vector_math::CPUHasAVX2()) {
+    SCOPED_TRACE("FMUL_AVX2");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMUL_AVX2(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
+#endif
+
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
   {
     SCOPED_TRACE("FMUL_NEON");
@@ -135,6 +170,346 @@ TEST_F(VectorMathTest, FMUL) {
 #endif
 }
 
+// Ensure each optimized vector_math::FADD() method returns the same value.
+TEST_F(VectorMathTest, FADD) {
+  static const float kResult = kInputFillValue + kOutputFillValue;
+
+  {
+    SCOPED_TRACE("FADD");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FADD(input_vector_.get(), kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
+
+  {
+    SCOPED_TRACE("FADD_C");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FADD_C(input_vector_.get(), kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  {
+    SCOPED_TRACE("FADD_SSE");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FADD_SSE(input_vector_.get(), kVectorSize,
+                          output_vector_.get());
+    VerifyOutput(kResult);
+  }
+#endif
+
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  if (vector_math::CPUHasAVX2()) {
+    SCOPED_TRACE("FADD_AVX2");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FADD_AVX2(input_vector_.get(), kVectorSize,
+                           output_vector_.get());
+    VerifyOutput(kResult);
+  }
+
+  if (vector_math::CPUHasAVX512()) {
+    SCOPED_TRACE("FADD_AVX512");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FADD_AVX512(input_vector_.get(), kVectorSize,
+                             output_vector_.get());
+    VerifyOutput(kResult);
+  }
+#endif
+
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  {
+    SCOPED_TRACE("FADD_NEON");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FADD_NEON(input_vector_.get(), kVectorSize,
+                           output_vector_.get());
+    VerifyOutput(kResult);
+  }
+#endif
+}
+
+// Ensure each optimized vector_math::WeightedSum() method returns the same
+// value for one and for several inputs.  Uses an odd length so the scalar tail
+// of each SIMD version is exercised too.
+TEST_F(VectorMathTest, WeightedSum) {
+  typedef void (*WeightedSumProc)(const float* const[], const float[], int, int,
+                                  float[]);
+  std::vector<std::pair<std::string, WeightedSumProc>> procs = {
+      {"WeightedSum", vector_math::WeightedSum},
+      {"WeightedSum_C", vector_math::WeightedSum_C}};
+#if defined(ARCH_CPU_X86_FAMILY)
+  procs.push_back({"WeightedSum_SSE", vector_math::WeightedSum_SSE});
+#endif
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  if (vector_math::CPUHasAVX2())
+    procs.push_back({"WeightedSum_AVX2", vector_math::WeightedSum_AVX2});
+#endif
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  procs.push_back({"WeightedSum_NEON", vector_math::WeightedSum_NEON});
+#endif
+
+  const int kInputs = 5;
+  const int kLength = kVectorSize - 1;
+  const float kScales[kInputs] = {1.0f, 0.5f, 0.25f, 2.0f, 0.125f};
+  std::vector<std::vector<float>> inputs(kInputs, std::vector<float>(kLength));
+  std::vector<const float*> src(kInputs);
+  for (int k = 0; k < kInputs; ++k) {
+    for (int i = 0; i < kLength; ++i)
+      inputs[k][i] = (k + 1) * (i % 16);
+    src[k] = inputs[k].data();
+  }
+
+  for (const auto& proc : procs) {
+    SCOPED_TRACE(proc.first);
+    for (int count : {1, kInputs}) {
+      FillTestVectors(kInputFillValue, kOutputFillValue);
+      proc.second(src.data(), kScales, count, kLength, output_vector_.get());
+      for (int i = 0; i < kLength; ++i) {
+        float expected = 0;
+        for (int k = 0; k < count; ++k)
+          expected += inputs[k][i] * kScales[k];
+        ASSERT_FLOAT_EQ(expected, output_vector_[i]) << "i=" << i;
+      }
+      // Nothing past |kLength| is written.
+      EXPECT_EQ(kOutputFillValue, output_vector_[kLength]);
+    }
+  }
+}
+
+// Ensure each optimized vector_math::DotProduct() method returns the same
+// value, including for unaligned inputs.
+TEST_F(VectorMathTest, DotProduct) {
+  static const float kResult =
+      kInputFillValue * kOutputFillValue * (kVectorSize - 1);
+  typedef float (*DotProductProc)(const float[], const float[], int);
+  std::vector<std::pair<std::string, DotProductProc>> procs = {
+      {"DotProduct", vector_math::DotProduct},
+      {"DotProduct_C", vector_math::DotProduct_C}};
+#if defined(ARCH_CPU_X86_FAMILY)
+  procs.push_back({"DotProduct_SSE", vector_math::DotProduct_SSE});
+#endif
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+  if (vector_math::CPUHasAVX2())
+    procs.push_back({"DotProduct_AVX2", vector_math::DotProduct_AVX2});
+#endif
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  procs.push_back({"DotProduct_NEON", vector_math::DotProduct_NEON});
+#endif
+
+  FillTestVectors(kInputFillValue, kOutputFillValue);
+  for (const auto& proc : procs) {
+    SCOPED_TRACE(proc.first);
+    EXPECT_FLOAT_EQ(kResult, proc.second(input_vector_.get() + 1,
+                                         output_vector_.get(),
+                                         kVectorSize - 1));
+  }
+}
+
+// Ensure vector_math::InterleaveAndClamp() and vector_math::Deinterleave()
+// round trip in-range samples for mono, stereo and 5.1, which have SIMD
+// versions, and for three channels, which do not.
+TEST_F(VectorMathTest, InterleaveDeinterleave) {
+  typedef void (*InterleaveProc)(const float* const[], int, int, float[]);
+  typedef void (*DeinterleaveProc)(const float[], int, int, float* const[]);
+  std::vector<std::pair<InterleaveProc, DeinterleaveProc>> procs = {
+      {vector_math::InterleaveAndClamp, vector_math::Deinterleave},
+      {vector_math::InterleaveAndClamp_C, vector_math::Deinterleave_C}};
+#if defined(ARCH_CPU_X86_FAMILY)
+  procs.push_back(
+      {vector_math::InterleaveAndClamp_SSE, vector_math::Deinterleave_SSE});
+#endif
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  procs.push_back(
+      {vector_math::InterleaveAndClamp_NEON, vector_math::Deinterleave_NEON});
+#endif
+
+  for (int channels : {1, 2, 3, 6}) {
+    // Odd frame count to exercise the scalar tails.
+    const int frames = kVectorSize / channels - 1;
+    std::vector<std::vector<float>> planar(channels,
+                                           std::vector<float>(frames));
+    std::vector<const float*> src(channels);
+    for (int ch = 0; ch < channels; ++ch) {
+      for (int i = 0; i < frames; ++i)
+        planar[ch][i] = static_cast<float>(ch * frames + i) / kVectorSize;
+      src[ch] = planar[ch].data();
+    }
+
+    for (size_t p = 0; p < procs.size(); ++p) {
+      SCOPED_TRACE(base::StringPrintf("channels=%d procs=%zu", channels, p));
+      procs[p].first(src.data(), channels, frames, output_vector_.get());
+      for (int i = 0; i < frames * channels; ++i) {
+        ASSERT_EQ(planar[i % channels][i / channels], output_vector_[i])
+            << "i=" << i;
+      }
+
+      std::vector<std::vector<float>> result(channels,
+                                             std::vector<float>(frames));
+      std::vector<float*> dest(channels);
+      for (int ch = 0; ch < channels; ++ch)
+        dest[ch] = result[ch].data();
+      procs[p].second(output_vector_.get(), channels, frames, dest.data());
+      EXPECT_EQ(planar, result);
+    }
+  }
+}
+
+// Interleaves |channels| planar arrays of |frames| samples, each covering the
+// edge cases of the sample conversions followed by a ramp through and beyond
+// [-1.0, 1.0], with every |procs| and verifies the result against
+// |SampleTypeTraits|.
+template <class SampleTypeTraits>
+static void TestInterleaveAndConvert(
+    const std::vector<void (*)(const float* const[],
+                               int,
+                               int,
+                               typename SampleTypeTraits::ValueType[])>&
+        procs) {
+  using ValueType = typename SampleTypeTraits::ValueType;
+  static const float kEdgeValues[] = {
+      -std::numeric_limits<float>::infinity(),
+      -1.5f,
+      -1.0f,
+      std::nextafter(-1.0f, 0.0f),
+      -0.5f,
+      -std::numeric_limits<float>::min(),
+      0.0f,
+      std::numeric_limits<float>::min(),
+      0.5f,
+      std::nextafter(1.0f, 0.0f),
+      1.0f,
+      1.5f,
+      std::numeric_limits<float>::infinity(),
+      std::numeric_limits<float>::quiet_NaN()};
+
+  for (int channels : {1, 2, 3, 6}) {
+    const int frames = 1001;
+    std::vector<std::vector<float>> planar(channels,
+                                           std::vector<float>(frames));
+    std::vector<const float*> src(channels);
+    for (int ch = 0; ch < channels; ++ch) {
+      for (int i = 0; i < frames; ++i) {
+        planar[ch][i] = (i + ch) < static_cast<int>(arraysize(kEdgeValues))
+                            ? kEdgeValues[i + ch]
+                            : -1.25f + 2.5f * (i * channels + ch) /
+                                           (frames * channels);
+      }
+      src[ch] = planar[ch].data();
+    }
+
+    std::vector<ValueType> interleaved(frames * channels);
+    for (size_t p = 0; p < procs.size(); ++p) {
+      SCOPED_TRACE(base::StringPrintf("channels=%d procs=%zu", channels, p));
+      procs[p](src.data(), channels, frames, interleaved.data());
+      for (int i = 0; i < frames * channels; ++i) {
+        const float value = planar[i % channels][i / channels];
+        ASSERT_EQ(std::isnan(value) ? SampleTypeTraits::kZeroPointValue
+                                    : SampleTypeTraits::FromFloat(value),
+                  interleaved[i])
+            << "i=" << i << ", value=" << value;
+      }
+    }
+  }
+}
+
+// Ensure the converting interleave functions match the SampleTypeTraits.
+TEST_F(VectorMathTest, InterleaveAndConvert) {
+  std::vector<void (*)(const float* const[], int, int, float[])> float_procs = {
+      vector_math::InterleaveAndClamp, vector_math::InterleaveAndClamp_C};
+  std::vector<void (*)(const float* const[], int, int, int16_t[])> s16_procs = {
+      vector_math::InterleaveS16, vector_math::InterleaveS16_C};
+  std::vector<void (*)(const float* const[], int, int, int32_t[])> s32_procs = {
+      vector_math::InterleaveS32, vector_math::InterleaveS32_C};
+#if defined(ARCH_CPU_X86_FAMILY)
+  float_procs.push_back(vector_math::InterleaveAndClamp_SSE);
+  s16_procs.push_back(vector_math::InterleaveS16_SSE);
+  s32_procs.push_back(vector_math::InterleaveS32_SSE);
+#endif
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  float_procs.push_back(vector_math::InterleaveAndClamp_NEON);
+  s16_procs.push_back(vector_math::InterleaveS16_NEON);
+  s32_procs.push_back(vector_math::InterleaveS32_NEON);
+#endif
+
+  TestInterleaveAndConvert<Float32SampleTypeTraits>(float_procs);
+  TestInterleaveAndConvert<SignedInt16SampleTypeTraits>(s16_procs);
+  TestInterleaveAndConvert<SignedInt32SampleTypeTraits>(s32_procs);
+}
+
+// Deinterleaves |interleaved| as |channels| channels with every |procs| and
+// verifies the result against |SampleTypeTraits|.
+template <class SampleTypeTraits>
+static void TestDeinterleaveAndConvert(
+    const std::vector<typename SampleTypeTraits::ValueType>& interleaved,
+    int channels,
+    const std::vector<void (*)(const typename SampleTypeTraits::ValueType[],
+                               int,
+                               int,
+                               float* const[])>& procs) {
+  const int frames = interleaved.size() / channels;
+  std::vector<std::vector<float>> planar(channels,
+                                         std::vector<float>(frames));
+  std::vector<float*> dest(channels);
+  for (int ch = 0; ch < channels; ++ch)
+    dest[ch] = planar[ch].data();
+
+  for (size_t p = 0; p < procs.size(); ++p) {
+    SCOPED_TRACE(base::StringPrintf("channels=%d procs=%zu", channels, p));
+    procs[p](interleaved.data(), channels, frames, dest.data());
+    for (int i = 0; i < frames * channels; ++i) {
+      ASSERT_EQ(SampleTypeTraits::ToFloat(interleaved[i]),
+                planar[i % channels][i / channels])
+          << "i=" << i << ", value=" << interleaved[i];
+    }
+  }
+}
+
+// Ensure the converting deinterleave functions match the SampleTypeTraits for
+// every int16_t value and for the int32_t edge cases and a spread in between.
+TEST_F(VectorMathTest, DeinterleaveAndConvert) {
+  std::vector<void (*)(const int16_t[], int, int, float* const[])> s16_procs =
+      {vector_math::DeinterleaveS16, vector_math::DeinterleaveS16_C};
+  std::vector<void (*)(const int32_t[], int, int, float* const[])> s32_procs =
+      {vector_math::DeinterleaveS32, vector_math::DeinterleaveS32_C};
+#if defined(ARCH_CPU_X86_FAMILY)
+  s16_procs.push_back(vector_math::DeinterleaveS16_SSE);
+  s32_procs.push_back(vector_math::DeinterleaveS32_SSE);
+#endif
+#if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  s16_procs.push_back(vector_math::DeinterleaveS16_NEON);
+  s32_procs.push_back(vector_math::DeinterleaveS32_NEON);
+#endif
+
+  std::vector<int16_t> s16;
+  for (int i = std::numeric_limits<int16_t>::min();
+       i <= std::numeric_limits<int16_t>::max(); ++i) {
+    s16.push_back(i);
+  }
+  std::vector<int32_t> s32 = {std::numeric_limits<int32_t>::min(),
+                              std::numeric_limits<int32_t>::min() + 1,
+                              -1,
+                              0,
+                              1,
+                              std::numeric_limits<int32_t>::max() - 1,
+                              std::numeric_limits<int32_t>::max()};
+  for (int i = 0; i < 65536; ++i)
+    s32.push_back(static_cast<int32_t>(i * 2654435761u));
+
+  // Pad to an odd count so mono exercises the scalar tail.
+  s16.push_back(0);
+
+  for (int channels : {1, 2, 3, 6}) {
+    // Trim to a whole number of frames.
+    const int s16_frames = s16.size() / channels;
+    TestDeinterleaveAndConvert<SignedInt16SampleTypeTraits>(
+        std::vector<int16_t>(s16.begin(), s16.begin() + s16_frames * channels),
+        channels, s16_procs);
+    const int s32_frames = s32.size() / channels;
+    TestDeinterleaveAndConvert<SignedInt32SampleTypeTraits>(
+        std::vector<int32_t>(s32.begin(), s32.begin() + s32_frames * channels),
+        channels, s32_procs);
+  }
+}
+
 TEST_F(VectorMathTest, Crossfade) {
   FillTestVectors(0, 1);
   vector_math::Crossfade(
@@ -232,6 +607,16 @@ class EWMATestScenario {
     }
 #endif
 
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+    if (vector_math::CPUHasAVX2()) {
+      SCOPED_TRACE("EWMAAndMaxPower_AVX2");
+      const std::pair<float, float>& result = vector_math::EWMAAndMaxPower_AVX2(
+          initial_value_, data_.get(), data_len_, smoothing_factor_);
+      EXPECT_NEAR(expected_final_avg_, result.first, 0.0000001f);
+      EXPECT_NEAR(expected_max_, result.second, 0.0000001f);
+    }
+#endif
+
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
     {
       SCOPED_TRACE("EWMAAndMaxPower_NEON");
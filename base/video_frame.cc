@@ -558,6 +558,36 @@ size_t VideoFrame::AllocationSize(VideoPixelFormat format,
   return total;
 }
 
+// static
+size_t VideoFrame::PlanarAllocationLayout(VideoPixelFormat format,
+                                          const gfx::Size& coded_size,
+                                          int32_t strides[kMaxPlanes],
+                                          size_t offsets[kMaxPlanes]) {
+  DCHECK_GT(NumPlanes(format), 1u);
+  size_t data_size = 0;
+  for (size_t plane = 0; plane < NumPlanes(format); ++plane) {
+    // The *2 in alignment for height is because some formats (e.g. h264)
+    // allow interlaced coding, and then the size needs to be a multiple of
+    // two macroblocks (vertically). See
+    // libavcodec/utils.c:avcodec_align_dimensions2().
+    const size_t height =
+        RoundUp(Rows(plane, format, coded_size.height()),
+                kFrameSizeAlignment * 2);
+    strides[plane] = RoundUp(RowBytes(plane, format, coded_size.width()),
+                             kFrameSizeAlignment);
+    offsets[plane] = data_size;
+    data_size += height * strides[plane];
+  }
+
+  // The extra line of UV being allocated is because h264 chroma MC
+  // overreads by one line in some cases, see libavcodec/utils.c:
+  // avcodec_align_dimensions2() and libavcodec/x86/h264_chromamc.asm:
+  // put_h264_chroma_mc4_ssse3().
+  DCHECK(IsValidPlane(kUPlane, format));
+  data_size += strides[kUPlane] + kFrameSizePadding;
+  return data_size;
+}
+
 // static
 gfx::Size VideoFrame::PlaneSize(VideoPixelFormat format,
                                 size_t plane,
@@ -1209,23 +1239,7 @@ void VideoFrame::AllocateMemory(bool zero_initialize_memory) {
     data_size = AllocationSize(format_, coded_size_);
     offset[0] = 0;
   } else {
-    for (size_t plane = 0; plane < NumPlanes(format_); ++plane) {
-      // The *2 in alignment for height is because some formats (e.g. h264)
-      // allow interlaced coding, and then the size needs to be a multiple of
-      // two macroblocks (vertically). See
-      // libavcodec/utils.c:avcodec_align_dimensions2().
-      const size_t height = RoundUp(rows(plane), kFrameSizeAlignment * 2);
-      strides_[plane] = RoundUp(row_bytes(plane), kFrameSizeAlignment);
-      offset[plane] = data_size;
-      data_size += height * strides_[plane];
-    }
-
-    // The extra line of UV being allocated is because h264 chroma MC
-    // overreads by one line in some cases, see libavcodec/utils.c:
-    // avcodec_align_dimensions2() and libavcodec/x86/h264_chromamc.asm:
-    // put_h264_chroma_mc4_ssse3().
-    DCHECK(IsValidPlane(kUPlane, format_));
-    data_size += strides_[kUPlane] + kFrameSizePadding;
+    data_size = PlanarAllocationLayout(format_, coded_size_, strides_, offset);
   }
 
   uint8_t* data = reinterpret_cast<uint8_t*>(
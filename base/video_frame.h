@@ -256,6 +256,14 @@ class MEDIA_EXPORT VideoFrame : public base::RefCountedThreadSafe<VideoFrame> {
   static size_t AllocationSize(VideoPixelFormat format,
                                const gfx::Size& coded_size);
 
+  // Returns the size of the memory CreateFrame() allocates for a frame of
+  // multi-planar |format| and |coded_size|, and fills in the stride and offset
+  // of each plane in it.
+  static size_t PlanarAllocationLayout(VideoPixelFormat format,
+                                       const gfx::Size& coded_size,
+                                       int32_t strides[kMaxPlanes],
+                                       size_t offsets[kMaxPlanes]);
+
   // Returns the plane gfx::Size (in bytes) for a plane of the given coded size
   // and format.
   static gfx::Size PlaneSize(VideoPixelFormat format,
@@ -4,19 +4,35 @@
 
 #include "media/base/video_frame_pool.h"
 
+#include <string.h>
+
+#include <memory>
+
 #include "base/bind.h"
 #include "base/containers/circular_deque.h"
+#include "base/feature_list.h"
 #include "base/macros.h"
+#include "base/memory/ptr_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
 #include "base/time/default_tick_clock.h"
+#include "media/base/media_switches.h"
+#include "media/base/shared_frame_buffer_pool.h"
 
 namespace media {
 
+namespace {
+
+// Returns |buffer| to its pool when the frame using it is destroyed.
+void ReleaseSharedBuffer(
+    std::unique_ptr<SharedFrameBufferPool::Buffer> buffer) {}
+
+}  // namespace
+
 class VideoFramePool::PoolImpl
     : public base::RefCountedThreadSafe<VideoFramePool::PoolImpl> {
  public:
-  PoolImpl();
+  explicit PoolImpl(SharedFrameBufferPool* shared_buffer_pool);
 
   // See VideoFramePool::CreateFrame() for usage. Attempts to keep |frames_| in
   // LRU order by always pulling from the back of |frames_|.
@@ -48,6 +64,16 @@ class VideoFramePool::PoolImpl
   // least recently used entry.
   void FrameReleased(scoped_refptr<VideoFrame> frame);
 
+  // Creates a zero initialized frame whose memory comes from
+  // |shared_buffer_pool_|, or from the heap for formats it doesn't serve.
+  scoped_refptr<VideoFrame> CreateNewFrame(VideoPixelFormat format,
+                                           const gfx::Size& coded_size,
+                                           const gfx::Rect& visible_rect,
+                                           const gfx::Size& natural_size,
+                                           base::TimeDelta timestamp);
+
+  SharedFrameBufferPool* const shared_buffer_pool_;
+
   base::Lock lock_;
   bool is_shutdown_ = false;
 
@@ -65,7 +91,9 @@ class VideoFramePool::PoolImpl
   DISALLOW_COPY_AND_ASSIGN(PoolImpl);
 };
 
-VideoFramePool::PoolImpl::PoolImpl() : tick_clock_(&default_tick_clock_) {}
+VideoFramePool::PoolImpl::PoolImpl(SharedFrameBufferPool* shared_buffer_pool)
+    : shared_buffer_pool_(shared_buffer_pool),
+      tick_clock_(&default_tick_clock_) {}
 
 VideoFramePool::PoolImpl::~PoolImpl() {
   DCHECK(is_shutdown_);
@@ -97,8 +125,8 @@ scoped_refptr<VideoFrame> VideoFramePool::PoolImpl::CreateFrame(
   }
 
   if (!frame) {
-    frame = VideoFrame::CreateZeroInitializedFrame(
-        format, coded_size, visible_rect, natural_size, timestamp);
+    frame = CreateNewFrame(format, coded_size, visible_rect, natural_size,
+                           timestamp);
     // This can happen if the arguments are not valid.
     if (!frame) {
       LOG(ERROR) << "Failed to create a video frame";
@@ -140,7 +168,63 @@ void VideoFramePool::PoolImpl::FrameReleased(scoped_refptr<VideoFrame> frame) {
     frames_.erase(frames_.begin(), frames_.begin() + stale_index);
 }
 
-VideoFramePool::VideoFramePool() : pool_(new PoolImpl()) {}
+scoped_refptr<VideoFrame> VideoFramePool::PoolImpl::CreateNewFrame(
+    VideoPixelFormat format,
+    const gfx::Size& coded_size,
+    const gfx::Rect& visible_rect,
+    const gfx::Size& natural_size,
+    base::TimeDelta timestamp) {
+  const size_t num_planes = VideoFrame::NumPlanes(format);
+  if (!shared_buffer_pool_ || num_planes < 3 ||
+      !VideoFrame::IsValidConfig(format, VideoFrame::STORAGE_UNOWNED_MEMORY,
+                                 coded_size, visible_rect, natural_size)) {
+    return VideoFrame::CreateZeroInitializedFrame(
+        format, coded_size, visible_rect, natural_size, timestamp);
+  }
+
+  int32_t strides[VideoFrame::kMaxPlanes] = {};
+  size_t offsets[VideoFrame::kMaxPlanes] = {};
+  const size_t data_size = VideoFrame::PlanarAllocationLayout(
+      format, coded_size, strides, offsets);
+  auto buffer = base::MakeUnique<SharedFrameBufferPool::Buffer>(
+      shared_buffer_pool_->Allocate(data_size));
+  uint8_t* data = buffer->data();
+  memset(data, 0, data_size);
+
+  scoped_refptr<VideoFrame> frame;
+  if (num_planes == 3) {
+    frame = VideoFrame::WrapExternalYuvData(
+        format, coded_size, visible_rect, natural_size,
+        strides[VideoFrame::kYPlane], strides[VideoFrame::kUPlane],
+        strides[VideoFrame::kVPlane], data + offsets[VideoFrame::kYPlane],
+        data + offsets[VideoFrame::kUPlane],
+        data + offsets[VideoFrame::kVPlane], timestamp);
+  } else {
+    frame = VideoFrame::WrapExternalYuvaData(
+        format, coded_size, visible_rect, natural_size,
+        strides[VideoFrame::kYPlane], strides[VideoFrame::kUPlane],
+        strides[VideoFrame::kVPlane], strides[VideoFrame::kAPlane],
+        data + offsets[VideoFrame::kYPlane],
+        data + offsets[VideoFrame::kUPlane],
+        data + offsets[VideoFrame::kVPlane],
+        data + offsets[VideoFrame::kAPlane], timestamp);
+  }
+  if (!frame)
+    return nullptr;
+
+  // The memory goes back to |shared_buffer_pool_| along with the frame.
+  frame->AddDestructionObserver(
+      base::Bind(&ReleaseSharedBuffer, base::Passed(&buffer)));
+  return frame;
+}
+
+VideoFramePool::VideoFramePool()
+    : VideoFramePool(base::FeatureList::IsEnabled(kSharedFrameBufferPool)
+                         ? SharedFrameBufferPool::GetInstance()
+                         : nullptr) {}
+
+VideoFramePool::VideoFramePool(SharedFrameBufferPool* shared_buffer_pool)
+    : pool_(new PoolImpl(shared_buffer_pool)) {}
 
 VideoFramePool::~VideoFramePool() {
   pool_->Shutdown();
@@ -17,6 +17,8 @@ class TickClock;
 
 namespace media {
 
+class SharedFrameBufferPool;
+
 // Simple VideoFrame pool used to avoid unnecessarily allocating and destroying
 // VideoFrame objects. The pool manages the memory for the VideoFrame
 // returned by CreateFrame(). When one of these VideoFrames is destroyed,
@@ -25,9 +27,17 @@ namespace media {
 // VideoFramePool object. If the parameters passed to CreateFrame() change
 // during the life of this object, then the memory used by frames with the old
 // parameter values will be purged from the pool.
+//
+// With the kSharedFrameBufferPool feature, the memory of new planar YUV frames
+// is borrowed from the SharedFrameBufferPool of the process, and goes back to
+// it when the frames are purged, so that other pools can reuse it.
 class MEDIA_EXPORT VideoFramePool {
  public:
   VideoFramePool();
+
+  // Borrows the memory of new frames from |shared_buffer_pool| if not null.
+  // |shared_buffer_pool| must outlive the frames.
+  explicit VideoFramePool(SharedFrameBufferPool* shared_buffer_pool);
   ~VideoFramePool();
 
   // Returns a frame from the pool that matches the specified
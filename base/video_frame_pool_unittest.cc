@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "base/test/simple_test_tick_clock.h"
+#include "media/base/shared_frame_buffer_pool.h"
 #include "media/base/video_frame_pool.h"
 #include "testing/gmock/include/gmock/gmock.h"
 
@@ -122,4 +123,38 @@ TEST_F(VideoFramePoolTest, StaleFramesAreExpired) {
   CheckPoolSize(1u);
 }
 
+TEST_F(VideoFramePoolTest, PurgedFramesReturnMemoryToSharedPool) {
+  SharedFrameBufferPool shared_pool(64 << 20);
+  pool_.reset(new VideoFramePool(&shared_pool));
+  pool_->SetTickClockForTesting(&test_clock_);
+
+  scoped_refptr<VideoFrame> frame = CreateFrame(PIXEL_FORMAT_YV12, 10);
+  EXPECT_EQ(0, frame->data(VideoFrame::kYPlane)[0]);
+  const uint8_t* old_y_data = frame->data(VideoFrame::kYPlane);
+  const size_t allocated_bytes = shared_pool.allocated_bytes();
+  EXPECT_GT(allocated_bytes, 0u);
+  EXPECT_EQ(0u, shared_pool.idle_bytes());
+
+  // Frames kept by the pool keep their memory.
+  frame = nullptr;
+  CheckPoolSize(1u);
+  EXPECT_EQ(0u, shared_pool.idle_bytes());
+
+  // Once the pool drops the frame, another pool reuses its memory.
+  scoped_refptr<VideoFrame> other_frame = CreateFrame(PIXEL_FORMAT_ARGB, 10);
+  CheckPoolSize(0u);
+  EXPECT_EQ(allocated_bytes, shared_pool.idle_bytes());
+
+  VideoFramePool other_pool(&shared_pool);
+  frame = other_pool.CreateFrame(PIXEL_FORMAT_YV12, gfx::Size(320, 240),
+                                 gfx::Rect(320, 240), gfx::Size(320, 240),
+                                 base::TimeDelta());
+  EXPECT_EQ(old_y_data, frame->data(VideoFrame::kYPlane));
+  EXPECT_EQ(allocated_bytes, shared_pool.allocated_bytes());
+  EXPECT_EQ(0u, shared_pool.idle_bytes());
+
+  frame = nullptr;
+  pool_.reset();
+}
+
 }  // namespace media
@@ -2,12 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <limits>
+#include <list>
 #include <utility>
 
 #include "media/blink/multibuffer.h"
 
 #include "base/bind.h"
 #include "base/location.h"
+#include "base/memory/ptr_util.h"
 
 namespace media {
 
@@ -47,6 +50,67 @@ static MultiBuffer::BlockId ClosestNextEntry(
   return i->first;
 }
 
+//
+// MultiBuffer::GlobalLRU::Shard
+//
+class MultiBuffer::GlobalLRU::Shard {
+ public:
+  Shard() {}
+
+  // Adds |id|, which must not be in the shard, as the most recently used
+  // block, with |use| as the time of its use.
+  void Insert(MultiBufferBlockId id, int64_t use) {
+    DCHECK(!Contains(id));
+    blocks_.emplace_front(id, use);
+    pos_[id] = blocks_.begin();
+  }
+
+  // Moves |id|, which must be in the shard, to the front.
+  void Use(MultiBufferBlockId id, int64_t use) {
+    auto i = pos_.find(id);
+    DCHECK(i != pos_.end());
+    blocks_.splice(blocks_.begin(), blocks_, i->second);
+    blocks_.front().second = use;
+  }
+
+  void Remove(MultiBufferBlockId id) {
+    auto i = pos_.find(id);
+    DCHECK(i != pos_.end());
+    blocks_.erase(i->second);
+    pos_.erase(i);
+  }
+
+  // Removes and returns the least recently used block.
+  MultiBufferBlockId Pop() {
+    DCHECK(!Empty());
+    MultiBufferBlockId id = blocks_.back().first;
+    blocks_.pop_back();
+    pos_.erase(id);
+    return id;
+  }
+
+  // Returns when the least recently used block was used.
+  int64_t OldestUse() const {
+    DCHECK(!Empty());
+    return blocks_.back().second;
+  }
+
+  bool Contains(MultiBufferBlockId id) const {
+    return pos_.find(id) != pos_.end();
+  }
+  bool Empty() const { return blocks_.empty(); }
+  size_t Size() const { return pos_.size(); }
+
+ private:
+  // Blocks and when they were last used, most recently used first.
+  std::list<std::pair<MultiBufferBlockId, int64_t>> blocks_;
+  base::hash_map<MultiBufferBlockId,
+                 std::list<std::pair<MultiBufferBlockId, int64_t>>::iterator>
+      pos_;
+
+  DISALLOW_COPY_AND_ASSIGN(Shard);
+};
+
 //
 // MultiBuffer::GlobalLRU
 //
@@ -55,40 +119,105 @@ MultiBuffer::GlobalLRU::GlobalLRU(
     : max_size_(0),
       data_size_(0),
       background_pruning_pending_(false),
+      use_count_(0),
+      size_(0),
       task_runner_(task_runner) {}
 
 MultiBuffer::GlobalLRU::~GlobalLRU() {
   // By the time we're freed, all blocks should have been removed,
   // and our sums should be zero.
-  DCHECK(lru_.Empty());
+  DCHECK(shards_.empty());
+  DCHECK(shards_by_oldest_use_.empty());
+  DCHECK_EQ(size_, 0);
   DCHECK_EQ(max_size_, 0);
   DCHECK_EQ(data_size_, 0);
 }
 
+MultiBuffer::GlobalLRU::Shard* MultiBuffer::GlobalLRU::GetShard(
+    MultiBuffer* multibuffer,
+    bool create) {
+  auto i = shards_.find(multibuffer);
+  if (i != shards_.end())
+    return i->second.get();
+  if (!create)
+    return nullptr;
+  std::unique_ptr<Shard>& shard = shards_[multibuffer];
+  shard = base::MakeUnique<Shard>();
+  return shard.get();
+}
+
+void MultiBuffer::GlobalLRU::OnShardChanged(MultiBuffer* multibuffer,
+                                            Shard* shard,
+                                            int64_t oldest_use) {
+  const int64_t new_oldest_use = shard->Empty() ? -1 : shard->OldestUse();
+  if (new_oldest_use == oldest_use)
+    return;
+  if (oldest_use >= 0)
+    shards_by_oldest_use_.erase(std::make_pair(oldest_use, multibuffer));
+  if (new_oldest_use >= 0)
+    shards_by_oldest_use_.insert(std::make_pair(new_oldest_use, multibuffer));
+  else
+    shards_.erase(multibuffer);
+}
+
 void MultiBuffer::GlobalLRU::Use(MultiBuffer* multibuffer,
                                  MultiBufferBlockId block_id) {
-  GlobalBlockId id(multibuffer, block_id);
-  lru_.Use(id);
-  SchedulePrune();
+  Use(multibuffer, std::vector<MultiBufferBlockId>(1, block_id));
+}
+
+void MultiBuffer::GlobalLRU::Use(MultiBuffer* multibuffer,
+                                 const std::vector<MultiBufferBlockId>& ids) {
+  if (ids.empty())
+    return;
+  Shard* shard = GetShard(multibuffer, true);
+  const int64_t oldest_use = shard->Empty() ? -1 : shard->OldestUse();
+  for (MultiBufferBlockId block_id : ids) {
+    if (shard->Contains(block_id)) {
+      shard->Use(block_id, use_count_++);
+    } else {
+      shard->Insert(block_id, use_count_++);
+      ++size_;
+    }
+  }
+  OnShardChanged(multibuffer, shard, oldest_use);
+  // Callers add new blocks to the data size right after using them, which
+  // schedules pruning if it is needed.
 }
 
 void MultiBuffer::GlobalLRU::Insert(MultiBuffer* multibuffer,
                                     MultiBufferBlockId block_id) {
-  GlobalBlockId id(multibuffer, block_id);
-  lru_.Insert(id);
+  Shard* shard = GetShard(multibuffer, true);
+  const int64_t oldest_use = shard->Empty() ? -1 : shard->OldestUse();
+  shard->Insert(block_id, use_count_++);
+  ++size_;
+  OnShardChanged(multibuffer, shard, oldest_use);
   SchedulePrune();
 }
 
 void MultiBuffer::GlobalLRU::Remove(MultiBuffer* multibuffer,
                                     MultiBufferBlockId block_id) {
-  GlobalBlockId id(multibuffer, block_id);
-  lru_.Remove(id);
+  Shard* shard = GetShard(multibuffer, false);
+  DCHECK(shard);
+  const int64_t oldest_use = shard->OldestUse();
+  shard->Remove(block_id);
+  --size_;
+  OnShardChanged(multibuffer, shard, oldest_use);
+}
+
+void MultiBuffer::GlobalLRU::RemoveAll(MultiBuffer* multibuffer) {
+  auto i = shards_.find(multibuffer);
+  if (i == shards_.end())
+    return;
+  size_ -= i->second->Size();
+  shards_by_oldest_use_.erase(
+      std::make_pair(i->second->OldestUse(), multibuffer));
+  shards_.erase(i);
 }
 
 bool MultiBuffer::GlobalLRU::Contains(MultiBuffer* multibuffer,
                                       MultiBufferBlockId block_id) {
-  GlobalBlockId id(multibuffer, block_id);
-  return lru_.Contains(id);
+  Shard* shard = GetShard(multibuffer, false);
+  return shard && shard->Contains(block_id);
 }
 
 void MultiBuffer::GlobalLRU::IncrementDataSize(int64_t blocks) {
@@ -104,7 +233,7 @@ void MultiBuffer::GlobalLRU::IncrementMaxSize(int64_t blocks) {
 }
 
 bool MultiBuffer::GlobalLRU::Pruneable() const {
-  return data_size_ > max_size_ && !lru_.Empty();
+  return data_size_ > max_size_ && size_ > 0;
 }
 
 void MultiBuffer::GlobalLRU::SchedulePrune() {
@@ -128,10 +257,29 @@ void MultiBuffer::GlobalLRU::TryFree(int64_t max_to_free) {
   // when their available ranges change.
   std::map<MultiBuffer*, std::vector<MultiBufferBlockId>> to_free;
   int64_t freed = 0;
-  while (!lru_.Empty() && freed < max_to_free) {
-    GlobalBlockId block_id = lru_.Pop();
-    to_free[block_id.first].push_back(block_id.second);
-    freed++;
+  while (!shards_by_oldest_use_.empty() && freed < max_to_free) {
+    // Take blocks from the shard with the least recently used block for
+    // as long as they are older than the oldest block of every other shard.
+    MultiBuffer* multibuffer = shards_by_oldest_use_.begin()->second;
+    shards_by_oldest_use_.erase(shards_by_oldest_use_.begin());
+    const int64_t next_oldest_use =
+        shards_by_oldest_use_.empty()
+            ? std::numeric_limits<int64_t>::max()
+            : shards_by_oldest_use_.begin()->first;
+    Shard* shard = GetShard(multibuffer, false);
+    std::vector<MultiBufferBlockId>* blocks = &to_free[multibuffer];
+    while (!shard->Empty() && shard->OldestUse() < next_oldest_use &&
+           freed < max_to_free) {
+      blocks->push_back(shard->Pop());
+      --size_;
+      freed++;
+    }
+    if (shard->Empty()) {
+      shards_.erase(multibuffer);
+    } else {
+      shards_by_oldest_use_.insert(
+          std::make_pair(shard->OldestUse(), multibuffer));
+    }
   }
   for (const auto& to_free_pair : to_free) {
     to_free_pair.first->ReleaseBlocks(to_free_pair.second);
@@ -156,7 +304,7 @@ void MultiBuffer::GlobalLRU::Prune(int64_t max_to_free) {
 }
 
 int64_t MultiBuffer::GlobalLRU::Size() const {
-  return lru_.Size();
+  return size_;
 }
 
 //
@@ -170,9 +318,7 @@ MultiBuffer::~MultiBuffer() {
   CHECK(pinned_.empty());
   DCHECK_EQ(max_size_, 0);
   // Remove all blocks from the LRU.
-  for (const auto& i : data_) {
-    lru_->Remove(this, i.first);
-  }
+  lru_->RemoveAll(this);
   lru_->IncrementDataSize(-static_cast<int64_t>(data_.size()));
   lru_->IncrementMaxSize(-max_size_);
 }
@@ -390,6 +536,7 @@ void MultiBuffer::OnDataProviderEvent(DataProvider* provider_tmp) {
 
   {
     base::AutoLock auto_lock(data_lock_);
+    std::vector<MultiBufferBlockId> used;
     while (!ProviderCollision(pos) && !eof) {
       if (!provider->Available()) {
         AddProvider(std::move(provider));
@@ -400,9 +547,10 @@ void MultiBuffer::OnDataProviderEvent(DataProvider* provider_tmp) {
       data_[pos] = data;
       eof = data->end_of_stream();
       if (!pinned_[pos])
-        lru_->Use(this, pos);
+        used.push_back(pos);
       ++pos;
     }
+    lru_->Use(this, used);
   }
   int64_t blocks_after = data_.size();
   int64_t blocks_added = blocks_after - blocks_before;
@@ -12,11 +12,11 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "base/callback.h"
 #include "base/containers/hash_tables.h"
-#include "base/hash.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/single_thread_task_runner.h"
@@ -24,7 +24,6 @@
 #include "build/build_config.h"
 #include "media/base/data_buffer.h"
 #include "media/blink/interval_map.h"
-#include "media/blink/lru.h"
 #include "media/blink/media_blink_export.h"
 
 namespace media {
@@ -33,26 +32,6 @@ namespace media {
 // Our blocks are 32kb (1 << 15), so our maximum cacheable file size
 // is 1 << (15 + 31) = 64Tb
 typedef int32_t MultiBufferBlockId;
-class MultiBuffer;
-
-// This type is used to identify a block in the LRU, which is shared between
-// multibuffers.
-typedef std::pair<MultiBuffer*, MultiBufferBlockId> MultiBufferGlobalBlockId;
-
-}  // namespace media
-
-namespace BASE_HASH_NAMESPACE {
-
-template <>
-struct hash<media::MultiBufferGlobalBlockId> {
-  std::size_t operator()(const media::MultiBufferGlobalBlockId& key) const {
-    return base::HashInts(reinterpret_cast<uintptr_t>(key.first), key.second);
-  }
-};
-
-}  // namespace BASE_HASH_NAMESPACE
-
-namespace media {
 
 // Freeing a lot of blocks can be expensive, to keep thing
 // flowing smoothly we only free a maximum of |kMaxFreesPerAdd|
@@ -134,9 +113,15 @@ class MEDIA_BLINK_EXPORT MultiBuffer {
   // Multibuffers use a global shared LRU to free memory.
   // This effectively means that recently used multibuffers can
   // borrow memory from less recently used ones.
+  //
+  // The LRU is split into one shard per multibuffer, so that the blocks of a
+  // busy multibuffer are looked up among its own blocks only, and dropping a
+  // multibuffer does not have to remove its blocks one by one. Blocks are
+  // stamped with a global use count, which keeps the order across shards
+  // exact: the least recently used block is always the oldest block of the
+  // shard whose oldest block is oldest.
   class MEDIA_BLINK_EXPORT GlobalLRU : public base::RefCounted<GlobalLRU> {
    public:
-    typedef MultiBufferGlobalBlockId GlobalBlockId;
     explicit GlobalLRU(
         const scoped_refptr<base::SingleThreadTaskRunner>& task_runner);
 
@@ -168,15 +153,35 @@ class MEDIA_BLINK_EXPORT MultiBuffer {
 
     // LRU operations.
     void Use(MultiBuffer* multibuffer, MultiBufferBlockId id);
+    // Same as calling Use() on each of |ids| in turn, but only updates the
+    // shard ordering once.
+    void Use(MultiBuffer* multibuffer,
+             const std::vector<MultiBufferBlockId>& ids);
     void Remove(MultiBuffer* multibuffer, MultiBufferBlockId id);
     void Insert(MultiBuffer* multibuffer, MultiBufferBlockId id);
     bool Contains(MultiBuffer* multibuffer, MultiBufferBlockId id);
     int64_t Size() const;
 
+    // Removes all blocks belonging to |multibuffer|.
+    void RemoveAll(MultiBuffer* multibuffer);
+
    private:
     friend class base::RefCounted<GlobalLRU>;
     ~GlobalLRU();
 
+    // The blocks of one multibuffer, defined in multibuffer.cc.
+    class Shard;
+
+    // Returns the shard for |multibuffer|, creating it if |create| is true.
+    Shard* GetShard(MultiBuffer* multibuffer, bool create);
+
+    // Called after |multibuffer|'s shard has changed; |oldest_use| is what
+    // the shard's oldest use was before the change, or -1 if it was empty.
+    // Keeps |shards_by_oldest_use_| up to date and drops empty shards.
+    void OnShardChanged(MultiBuffer* multibuffer,
+                        Shard* shard,
+                        int64_t oldest_use);
+
     // Schedule background pruning, if needed.
     void SchedulePrune();
 
@@ -193,8 +198,19 @@ class MEDIA_BLINK_EXPORT MultiBuffer {
     bool background_pruning_pending_;
 
     // The LRU should contain all blocks which are not pinned from
-    // all multibuffers.
-    LRU<GlobalBlockId> lru_;
+    // all multibuffers. It is made up of one shard per multibuffer
+    // with blocks in it.
+    base::hash_map<MultiBuffer*, std::unique_ptr<Shard>> shards_;
+
+    // The oldest use of each shard's blocks, along with the shard's
+    // multibuffer, ordered from least to most recent.
+    std::set<std::pair<int64_t, MultiBuffer*>> shards_by_oldest_use_;
+
+    // Incremented each time a block is inserted or used.
+    int64_t use_count_;
+
+    // Number of blocks in |shards_|.
+    int64_t size_;
 
     // Where we run our tasks.
     scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
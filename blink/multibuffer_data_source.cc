@@ -8,13 +8,17 @@
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/macros.h"
+#include "base/memory/ptr_util.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/single_thread_task_runner.h"
 #include "media/base/media_log.h"
+#include "media/base/media_switches.h"
 #include "media/blink/buffered_data_source_host_impl.h"
 #include "media/blink/multibuffer_reader.h"
+#include "media/blink/read_ahead_controller.h"
 #include "net/base/net_errors.h"
 
 namespace {
@@ -138,6 +142,8 @@ MultibufferDataSource::MultibufferDataSource(
   DCHECK(!downloading_cb_.is_null());
   DCHECK(render_task_runner_->BelongsToCurrentThread());
   DCHECK(url_data_);
+  if (base::FeatureList::IsEnabled(kAdaptiveMediaReadAhead))
+    read_ahead_controller_ = base::MakeUnique<ReadAheadController>();
   url_data_->Use();
   url_data_->OnRedirect(
       base::Bind(&MultibufferDataSource::OnRedirect, weak_ptr_));
@@ -292,6 +298,8 @@ void MultibufferDataSource::MediaPlaybackRateChanged(double playback_rate) {
     return;
 
   playback_rate_ = playback_rate;
+  if (read_ahead_controller_)
+    read_ahead_controller_->SetPlaybackRate(playback_rate);
   cancel_on_defer_ = false;
   UpdateBufferSizes();
 }
@@ -457,6 +465,12 @@ void MultibufferDataSource::ReadTask() {
 
     SeekTask_Locked();
   } else {
+    // Waiting for data right where playback reads next is a stall.
+    if (read_ahead_controller_ && media_has_played_ && playback_rate_ != 0.0 &&
+        read_op_->position() >= reader_->Tell() &&
+        read_op_->position() <= reader_->Tell() + reader_->Available()) {
+      read_ahead_controller_->OnStall();
+    }
     reader_->Seek(read_op_->position());
     reader_->Wait(1, base::Bind(&MultibufferDataSource::ReadTask,
                                 weak_factory_.GetWeakPtr()));
@@ -483,6 +497,8 @@ void MultibufferDataSource::SeekTask_Locked() {
     return;
 
   url_data_->AddBytesRead(bytes_read_);
+  if (read_ahead_controller_ && media_has_played_)
+    read_ahead_controller_->OnBytesRead(bytes_read_);
   bytes_read_ = 0;
 
   if (reader_) {
@@ -543,6 +559,8 @@ void MultibufferDataSource::SetBitrateTask(int bitrate) {
   DCHECK(render_task_runner_->BelongsToCurrentThread());
 
   bitrate_ = bitrate;
+  if (read_ahead_controller_)
+    read_ahead_controller_->SetBitrate(bitrate);
   UpdateBufferSizes();
 }
 
@@ -628,6 +646,14 @@ void MultibufferDataSource::ProgressCallback(int64_t begin, int64_t end) {
     host_->AddBufferedByteRange(begin, end);
   }
 
+  if (read_ahead_controller_ && reader_) {
+    read_ahead_controller_->OnProgress(url_data_->BytesReadFromNetwork(),
+                                       reader_->IsLoading());
+    // Don't wait for the periodic update when the window has moved.
+    if (read_ahead_controller_->UpdateWindow())
+      buffer_size_update_counter_ = 0;
+  }
+
   if (buffer_size_update_counter_ > 0) {
     buffer_size_update_counter_--;
   } else {
@@ -680,54 +706,72 @@ void MultibufferDataSource::UpdateBufferSizes() {
 
   buffer_size_update_counter_ = kUpdateBufferSizeFrequency;
 
-  // Use a default bit rate if unknown and clamp to prevent overflow.
-  int64_t bitrate = clamp<int64_t>(bitrate_, 0, kMaxBitrate);
-  if (bitrate == 0)
-    bitrate = kDefaultBitrate;
-
-  // Only scale the buffer window for playback rates greater than 1.0 in
-  // magnitude and clamp to prevent overflow.
-  double playback_rate = playback_rate_;
-
-  playback_rate = std::max(playback_rate, 1.0);
-  playback_rate = std::min(playback_rate, kMaxPlaybackRate);
-
-  int64_t bytes_per_second = (bitrate / 8.0) * playback_rate;
-
-  // Preload 10 seconds of data, clamped to some min/max value.
-  int64_t preload = clamp(kTargetSecondsBufferedAhead * bytes_per_second,
-                          kMinBufferPreload, kMaxBufferPreload);
-
-  // Increase buffering slowly at a rate of 10% of data downloaded so
-  // far, maxing out at the preload size.
-  int64_t extra_buffer = std::min(
-      preload, url_data_->BytesReadFromCache() * kSlowPreloadPercentage / 100);
-
-  // Add extra buffer to preload.
-  preload += extra_buffer;
-
-  // We preload this much, then we stop unil we read |preload| before resuming.
-  int64_t preload_high = preload + kPreloadHighExtra;
-
-  // We pin a few seconds of data behind the current reading position.
-  int64_t pin_backward = clamp(kTargetSecondsBufferedBehind * bytes_per_second,
-                               kMinBufferPreload, kMaxBufferPreload);
-
-  // We always pin at least kDefaultPinSize ahead of the read position.
-  // Normally, the extra space between preload_high and kDefaultPinSize will
-  // not actually have any data in it, but if it does, we don't want to throw it
-  // away right before we need it.
-  int64_t pin_forward = std::max(preload_high, kDefaultPinSize);
-
-  // Note that the buffer size is advisory as only non-pinned data is allowed
-  // to be thrown away. Most of the time we pin a region that is larger than
-  // |buffer_size|, which only makes sense because most of the time, some of
-  // the data in pinned region is not present in the cache.
-  int64_t buffer_size =
-      std::min((kTargetSecondsBufferedAhead + kTargetSecondsBufferedBehind) *
-                       bytes_per_second +
-                   extra_buffer * 3,
-               preload_high + pin_backward + extra_buffer);
+  int64_t preload;
+  int64_t preload_high;
+  int64_t pin_backward;
+  int64_t pin_forward;
+  int64_t buffer_size;
+  if (read_ahead_controller_) {
+    read_ahead_controller_->UpdateWindow();
+    const ReadAheadController::Window& window =
+        read_ahead_controller_->window();
+    preload = window.preload;
+    preload_high = window.preload_high;
+    pin_backward = window.pin_backward;
+    pin_forward = window.pin_forward;
+    buffer_size = window.buffer_size;
+  } else {
+    // Use a default bit rate if unknown and clamp to prevent overflow.
+    int64_t bitrate = clamp<int64_t>(bitrate_, 0, kMaxBitrate);
+    if (bitrate == 0)
+      bitrate = kDefaultBitrate;
+
+    // Only scale the buffer window for playback rates greater than 1.0 in
+    // magnitude and clamp to prevent overflow.
+    double playback_rate = playback_rate_;
+
+    playback_rate = std::max(playback_rate, 1.0);
+    playback_rate = std::min(playback_rate, kMaxPlaybackRate);
+
+    int64_t bytes_per_second = (bitrate / 8.0) * playback_rate;
+
+    // Preload 10 seconds of data, clamped to some min/max value.
+    preload = clamp(kTargetSecondsBufferedAhead * bytes_per_second,
+                    kMinBufferPreload, kMaxBufferPreload);
+
+    // Increase buffering slowly at a rate of 10% of data downloaded so
+    // far, maxing out at the preload size.
+    int64_t extra_buffer =
+        std::min(preload, url_data_->BytesReadFromCache() *
+                              kSlowPreloadPercentage / 100);
+
+    // Add extra buffer to preload.
+    preload += extra_buffer;
+
+    // We preload this much, then we stop unil we read |preload| before
+    // resuming.
+    preload_high = preload + kPreloadHighExtra;
+
+    // We pin a few seconds of data behind the current reading position.
+    pin_backward = clamp(kTargetSecondsBufferedBehind * bytes_per_second,
+                         kMinBufferPreload, kMaxBufferPreload);
+
+    // We always pin at least kDefaultPinSize ahead of the read position.
+    // Normally, the extra space between preload_high and kDefaultPinSize will
+    // not actually have any data in it, but if it does, we don't want to throw
+    // it away right before we need it.
+    pin_forward = std::max(preload_high, kDefaultPinSize);
+
+    // Note that the buffer size is advisory as only non-pinned data is allowed
+    // to be thrown away. Most of the time we pin a region that is larger than
+    // |buffer_size|, which only makes sense because most of the time, some of
+    // the data in pinned region is not present in the cache.
+    buffer_size =
+        std::min((kTargetSecondsBufferedAhead + kTargetSecondsBufferedBehind) *
+                         bytes_per_second +
+                     extra_buffer * 3,
+                 preload_high + pin_backward + extra_buffer);
+  }
 
   if (url_data_->FullyCached() ||
       (url_data_->length() != kPositionNotSpecified &&
@@ -30,6 +30,7 @@ namespace media {
 class BufferedDataSourceHost;
 class MediaLog;
 class MultiBufferReader;
+class ReadAheadController;
 
 // A data source capable of loading URLs and buffering the data using an
 // in-memory sliding window.
@@ -102,6 +103,12 @@ class MEDIA_BLINK_EXPORT MultibufferDataSource : public DataSource {
 
   GURL GetUrlAfterRedirects() const;
 
+  // Returns the controller sizing the read-ahead window, or null if the
+  // window is sized from the bitrate alone.
+  ReadAheadController* read_ahead_controller() const {
+    return read_ahead_controller_.get();
+  }
+
   // DataSource implementation.
   // Called from demuxer thread.
   void Stop() override;
@@ -248,6 +255,10 @@ class MEDIA_BLINK_EXPORT MultibufferDataSource : public DataSource {
 
   int buffer_size_update_counter_;
 
+  // Sizes the read-ahead window when kAdaptiveMediaReadAhead is enabled.
+  // Only used on the render thread.
+  std::unique_ptr<ReadAheadController> read_ahead_controller_;
+
   // Host object to report buffered byte range changes to.
   BufferedDataSourceHost* host_;
 
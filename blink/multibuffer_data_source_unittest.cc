@@ -10,7 +10,9 @@
 #include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/test/scoped_feature_list.h"
 #include "media/base/media_log.h"
+#include "media/base/media_switches.h"
 #include "media/base/mock_filters.h"
 #include "media/base/test_helpers.h"
 #include "media/blink/buffered_data_source_host_impl.h"
@@ -18,6 +20,7 @@
 #include "media/blink/mock_webassociatedurlloader.h"
 #include "media/blink/multibuffer_data_source.h"
 #include "media/blink/multibuffer_reader.h"
+#include "media/blink/read_ahead_controller.h"
 #include "media/blink/resource_multibuffer_data_provider.h"
 #include "media/blink/test_response_generator.h"
 #include "third_party/WebKit/public/platform/WebURL.h"
@@ -931,6 +934,24 @@ TEST_F(MultibufferDataSourceTest, SetBitrate) {
   Stop();
 }
 
+TEST_F(MultibufferDataSourceTest, AdaptiveReadAhead) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kAdaptiveMediaReadAhead);
+  InitializeWith206Response();
+  ReadAheadController* controller = data_source_->read_ahead_controller();
+  ASSERT_TRUE(controller);
+
+  // The reader follows the controller's window.
+  EXPECT_EQ(controller->window().preload, preload_low());
+  EXPECT_EQ(controller->window().preload_high, preload_high());
+
+  data_source_->SetBitrate(8 << 20);
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(10 << 20, preload_low());
+  EXPECT_EQ(controller->window().preload_high, preload_high());
+  Stop();
+}
+
 TEST_F(MultibufferDataSourceTest, MediaPlaybackRateChanged) {
   InitializeWith206Response();
 
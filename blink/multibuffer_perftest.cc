@@ -0,0 +1,166 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/circular_deque.h"
+#include "base/memory/ptr_util.h"
+#include "base/message_loop/message_loop.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "media/blink/multibuffer.h"
+#include "media/blink/multibuffer_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBlockSizeShift = 10;
+static const int64_t kBlockSize = 1LL << kBlockSizeShift;
+
+// Each reader may keep this many blocks, and reads ahead of its position by
+// about half of that, so readers keep evicting each other's blocks.
+static const int64_t kBlocksPerReader = 32;
+static const int64_t kPreloadBlocks = 16;
+
+// Total blocks read per configuration, so configurations with more readers
+// advance each reader fewer times.
+static const int kBlockReads = 200000;
+static const int kMinRounds = 50;
+
+namespace {
+
+class PerfDataProvider;
+std::vector<PerfDataProvider*> providers;
+
+// Hands out one block of an endless file each time it is advanced, unless the
+// multibuffer has deferred it.
+class PerfDataProvider : public MultiBuffer::DataProvider {
+ public:
+  PerfDataProvider(MultiBufferBlockId pos, MultiBuffer* multibuffer)
+      : pos_(pos), deferred_(false), multibuffer_(multibuffer) {
+    providers.push_back(this);
+  }
+
+  ~PerfDataProvider() override {
+    for (size_t i = 0; i < providers.size(); i++) {
+      if (providers[i] == this) {
+        providers[i] = providers.back();
+        providers.pop_back();
+        return;
+      }
+    }
+  }
+
+  MultiBufferBlockId Tell() const override { return pos_; }
+  bool Available() const override { return !fifo_.empty(); }
+  int64_t AvailableBytes() const override { return 0; }
+
+  scoped_refptr<DataBuffer> Read() override {
+    scoped_refptr<DataBuffer> ret = fifo_.front();
+    fifo_.pop_front();
+    ++pos_;
+    return ret;
+  }
+
+  void SetDeferred(bool deferred) override { deferred_ = deferred; }
+
+  // Note that this may delete |this|.
+  void Advance() {
+    if (deferred_)
+      return;
+    scoped_refptr<DataBuffer> block =
+        new DataBuffer(static_cast<int>(kBlockSize));
+    block->set_data_size(static_cast<int>(kBlockSize));
+    fifo_.push_back(block);
+    multibuffer_->OnDataProviderEvent(this);
+  }
+
+ private:
+  base::circular_deque<scoped_refptr<DataBuffer>> fifo_;
+  MultiBufferBlockId pos_;
+  bool deferred_;
+  MultiBuffer* multibuffer_;
+};
+
+class PerfMultiBuffer : public MultiBuffer {
+ public:
+  explicit PerfMultiBuffer(const scoped_refptr<MultiBuffer::GlobalLRU>& lru)
+      : MultiBuffer(kBlockSizeShift, lru) {}
+
+ protected:
+  std::unique_ptr<DataProvider> CreateWriter(const BlockId& pos) override {
+    return base::MakeUnique<PerfDataProvider>(pos, this);
+  }
+  bool RangeSupported() const override { return true; }
+};
+
+}  // namespace
+
+static void RunReadBenchmark(int reader_count) {
+  scoped_refptr<MultiBuffer::GlobalLRU> lru =
+      new MultiBuffer::GlobalLRU(base::ThreadTaskRunnerHandle::Get());
+
+  std::vector<std::unique_ptr<PerfMultiBuffer>> multibuffers;
+  std::vector<std::unique_ptr<MultiBufferReader>> readers;
+  for (int i = 0; i < reader_count; ++i) {
+    multibuffers.push_back(base::MakeUnique<PerfMultiBuffer>(lru));
+    readers.push_back(base::MakeUnique<MultiBufferReader>(
+        multibuffers.back().get(), 0, -1,
+        base::Callback<void(int64_t, int64_t)>()));
+    readers.back()->SetMaxBuffer(kBlocksPerReader * kBlockSize);
+    readers.back()->SetPinRange(kBlockSize, kBlockSize);
+    readers.back()->SetPreload(kPreloadBlocks * kBlockSize,
+                               kPreloadBlocks * kBlockSize);
+  }
+
+  // Interleave the readers as a renderer playing |reader_count| media elements
+  // would: every round each provider delivers a block, and each reader that has
+  // data moves on by a block.
+  const int rounds = std::max(kBlockReads / reader_count, kMinRounds);
+  int64_t blocks_read = 0;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int round = 0; round < rounds; ++round) {
+    for (size_t i = 0; i < providers.size(); ++i)
+      providers[i]->Advance();
+    for (const auto& reader : readers) {
+      if (reader->Available() > 0) {
+        reader->Seek(reader->Tell() + kBlockSize);
+        ++blocks_read;
+      }
+    }
+  }
+  double total_time_microseconds =
+      (base::TimeTicks::Now() - start).InMicrosecondsF();
+
+  perf_test::PrintResult("multibuffer_read",
+                         "_" + std::to_string(reader_count) + "_readers",
+                         "time_per_block",
+                         total_time_microseconds / blocks_read, "us/block",
+                         true);
+  perf_test::PrintResult("multibuffer_read",
+                         "_" + std::to_string(reader_count) + "_readers",
+                         "lru_size", static_cast<size_t>(lru->Size()),
+                         "blocks", false);
+
+  readers.clear();
+  multibuffers.clear();
+}
+
+// Benchmark the cost of reading a block when one to hundreds of readers stream
+// through their own multibuffers at once, sharing one GlobalLRU that has to
+// keep evicting their blocks.
+TEST(MultiBufferPerfTest, ConcurrentReaders) {
+  base::MessageLoop message_loop;
+  for (int readers = 1; readers <= 512; readers *= 2)
+    RunReadBenchmark(readers);
+}
+
+}  // namespace media
@@ -478,6 +478,48 @@ TEST_F(MultiBufferTest, LRUTestExpirationTest) {
   EXPECT_FALSE(lru_->Pruneable());
 }
 
+// Checks that blocks are freed in least recently used order across all of the
+// multibuffers sharing an LRU.
+TEST_F(MultiBufferTest, LRUTestSharedBetweenMultiBuffers) {
+  int64_t max_size = 100;
+  lru_->IncrementMaxSize(max_size);
+
+  TestMultiBuffer multibuffer2(kBlockSizeShift, lru_, &rnd_);
+  multibuffer_.SetFileSize(10 * kBlockSize);
+  multibuffer2.SetFileSize(10 * kBlockSize);
+  MultiBufferReader reader(&multibuffer_, 0, 10 * kBlockSize,
+                           base::Callback<void(int64_t, int64_t)>());
+  MultiBufferReader reader2(&multibuffer2, 0, 10 * kBlockSize,
+                            base::Callback<void(int64_t, int64_t)>());
+  reader.SetPreload(10000, 10000);
+  reader2.SetPreload(10000, 10000);
+
+  // Blocks are added to the two multibuffers in turn, ten blocks and an end of
+  // stream block to each.
+  while (AdvanceAll()) {
+  }
+  EXPECT_EQ(22, lru_->Size());
+  EXPECT_TRUE(lru_->Contains(&multibuffer_, 0));
+  EXPECT_TRUE(lru_->Contains(&multibuffer2, 0));
+
+  // Make the first block of |multibuffer_| the most recently used one.
+  lru_->Use(&multibuffer_, 0);
+  lru_->TryFree(3);
+  EXPECT_EQ(19, lru_->Size());
+  EXPECT_TRUE(multibuffer_.Contains(0));
+  EXPECT_FALSE(multibuffer_.Contains(1));
+  EXPECT_TRUE(multibuffer_.Contains(2));
+  EXPECT_FALSE(multibuffer2.Contains(0));
+  EXPECT_FALSE(multibuffer2.Contains(1));
+  EXPECT_TRUE(multibuffer2.Contains(2));
+  multibuffer_.CheckLRUState();
+  multibuffer2.CheckLRUState();
+
+  lru_->TryFreeAll();
+  EXPECT_EQ(0, lru_->Size());
+  lru_->IncrementMaxSize(-max_size);
+}
+
 class ReadHelper {
  public:
   ReadHelper(size_t end,
@@ -0,0 +1,215 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/blink/read_ahead_controller.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/logging.h"
+
+namespace media {
+
+namespace {
+
+// Rates are sampled over at least this long.
+constexpr base::TimeDelta kSampleInterval = base::TimeDelta::FromSeconds(1);
+
+// Reads further apart than this mean playback was paused or seeking rather
+// than slow, so the interval is not sampled.
+constexpr base::TimeDelta kMaxReadGap = base::TimeDelta::FromSeconds(5);
+
+// Weight of a new sample in the rate estimates.
+const double kSampleWeight = 0.25;
+
+// If bitrate is not known, use this.
+const int64_t kDefaultBitrate = 200 * 8 << 10;  // 200 Kbps.
+
+// Maximum bitrate for buffer calculations.
+const int64_t kMaxBitrate = 20 * 8 << 20;  // 20 Mbps.
+
+// Maximum playback rate for buffer calculations.
+const double kMaxPlaybackRate = 25.0;
+
+// Seconds of data to keep ahead of the reader. The minimum is used when
+// downloads are at least kComfortableHeadroom times faster than playback, the
+// maximum when they barely keep up, and the default until the download rate
+// is known.
+const double kMinSecondsAhead = 4.0;
+const double kMaxSecondsAhead = 30.0;
+const double kDefaultSecondsAhead = 10.0;
+const double kComfortableHeadroom = 3.0;
+
+// Once loading resumes, keep going for this many seconds of playback before
+// deferring again, so the connection isn't toggled for every few blocks.
+const double kResumeSeconds = 2.0;
+
+// Keep this many seconds of data for going back.
+const double kSecondsBehind = 2.0;
+
+// Bounds on the preload and pin sizes.
+const int64_t kMinPreload = 512 << 10;     // 512 Kb
+const int64_t kMaxPreload = 50 << 20;      // 50 Mb
+const int64_t kMinResumeExtra = 256 << 10;  // 256 Kb
+const int64_t kMaxResumeExtra = 4 << 20;   // 4 Mb
+
+// Each stall grows the window by this factor, up to kMaxStallFactor. The
+// factor decays back towards 1 for every sampled second without a stall.
+const double kStallGrowth = 1.5;
+const double kMaxStallFactor = 4.0;
+const double kStallDecayPerSecond = 0.99;
+
+// Window changes smaller than this are not worth reconfiguring the reader.
+const double kMinWindowChange = 0.1;
+
+template <typename T>
+T clamp(T value, T min, T max) {
+  return std::max(std::min(value, max), min);
+}
+
+double UpdateRate(double rate, double sample) {
+  return rate == 0 ? sample : rate + (sample - rate) * kSampleWeight;
+}
+
+}  // namespace
+
+ReadAheadController::ReadAheadController()
+    : tick_clock_(&default_tick_clock_),
+      bitrate_(0),
+      playback_rate_(0.0),
+      bytes_read_in_interval_(0),
+      consumption_rate_(0),
+      last_bytes_downloaded_(0),
+      last_loading_(false),
+      bytes_downloaded_in_interval_(0),
+      download_rate_(0),
+      stall_count_(0),
+      stall_factor_(1.0),
+      window_(),
+      window_valid_(false) {}
+
+ReadAheadController::~ReadAheadController() {}
+
+void ReadAheadController::SetBitrate(int bitrate) {
+  bitrate_ = bitrate;
+}
+
+void ReadAheadController::SetPlaybackRate(double playback_rate) {
+  // Don't count the time spent paused.
+  if (playback_rate_ == 0.0 && playback_rate != 0.0)
+    read_interval_start_ = base::TimeTicks();
+  playback_rate_ = playback_rate;
+}
+
+void ReadAheadController::OnBytesRead(int64_t bytes) {
+  if (playback_rate_ == 0.0)
+    return;
+  const base::TimeTicks now = tick_clock_->NowTicks();
+  if (!last_read_time_.is_null() && now - last_read_time_ > kMaxReadGap)
+    read_interval_start_ = base::TimeTicks();
+  last_read_time_ = now;
+  if (read_interval_start_.is_null()) {
+    // Start measuring from the first read; it tells us when reading began,
+    // but not how long it took to consume these bytes.
+    bytes_read_in_interval_ = 0;
+    read_interval_start_ = now;
+    return;
+  }
+  bytes_read_in_interval_ += bytes;
+
+  const base::TimeDelta elapsed = now - read_interval_start_;
+  if (elapsed < kSampleInterval)
+    return;
+  const double seconds = elapsed.InSecondsF();
+  consumption_rate_ =
+      UpdateRate(consumption_rate_, bytes_read_in_interval_ / seconds);
+  stall_factor_ =
+      std::max(1.0, stall_factor_ * std::pow(kStallDecayPerSecond, seconds));
+  bytes_read_in_interval_ = 0;
+  read_interval_start_ = now;
+}
+
+void ReadAheadController::OnStall() {
+  stall_count_++;
+  stall_factor_ = std::min(stall_factor_ * kStallGrowth, kMaxStallFactor);
+}
+
+void ReadAheadController::OnProgress(int64_t bytes_downloaded, bool loading) {
+  const base::TimeTicks now = tick_clock_->NowTicks();
+  if (!last_progress_time_.is_null() && last_loading_) {
+    bytes_downloaded_in_interval_ +=
+        std::max<int64_t>(0, bytes_downloaded - last_bytes_downloaded_);
+    loading_time_in_interval_ += now - last_progress_time_;
+    if (loading_time_in_interval_ >= kSampleInterval) {
+      download_rate_ = UpdateRate(
+          download_rate_, bytes_downloaded_in_interval_ /
+                              loading_time_in_interval_.InSecondsF());
+      bytes_downloaded_in_interval_ = 0;
+      loading_time_in_interval_ = base::TimeDelta();
+    }
+  }
+  last_bytes_downloaded_ = bytes_downloaded;
+  last_loading_ = loading;
+  last_progress_time_ = now;
+}
+
+double ReadAheadController::EstimatedConsumptionRate() const {
+  if (consumption_rate_ > 0)
+    return consumption_rate_;
+  // Use a default bit rate if unknown and clamp to prevent overflow.
+  int64_t bitrate = clamp<int64_t>(bitrate_, 0, kMaxBitrate);
+  if (bitrate == 0)
+    bitrate = kDefaultBitrate;
+  const double playback_rate =
+      clamp(std::abs(playback_rate_), 1.0, kMaxPlaybackRate);
+  return bitrate / 8.0 * playback_rate;
+}
+
+bool ReadAheadController::UpdateWindow() {
+  const double consumption = EstimatedConsumptionRate();
+
+  double seconds_ahead = kDefaultSecondsAhead;
+  if (download_rate_ > 0) {
+    // How far the download rate is from comfortably outpacing playback, from
+    // 0 (comfortable) to 1 (barely keeping up, or falling behind).
+    const double headroom = download_rate_ / consumption;
+    const double tightness = clamp(
+        (kComfortableHeadroom - headroom) / (kComfortableHeadroom - 1.0), 0.0,
+        1.0);
+    seconds_ahead =
+        kMinSecondsAhead + (kMaxSecondsAhead - kMinSecondsAhead) * tightness;
+  }
+  seconds_ahead *= stall_factor_;
+
+  Window window;
+  window.preload = clamp<int64_t>(seconds_ahead * consumption, kMinPreload,
+                                  kMaxPreload);
+  window.preload_high =
+      window.preload + clamp<int64_t>(kResumeSeconds * consumption,
+                                      kMinResumeExtra, kMaxResumeExtra);
+  window.pin_backward = clamp<int64_t>(kSecondsBehind * consumption,
+                                       kMinPreload, kMaxPreload);
+  window.pin_forward = window.preload_high;
+  window.buffer_size = window.preload_high + window.pin_backward;
+
+  const bool changed =
+      !window_valid_ ||
+      std::abs(window.preload - window_.preload) >
+          window_.preload * kMinWindowChange ||
+      std::abs(window.pin_backward - window_.pin_backward) >
+          window_.pin_backward * kMinWindowChange;
+  if (changed) {
+    window_ = window;
+    window_valid_ = true;
+  }
+  return changed;
+}
+
+void ReadAheadController::SetTickClockForTest(base::TickClock* tick_clock) {
+  tick_clock_ = tick_clock;
+}
+
+}  // namespace media
@@ -0,0 +1,123 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BLINK_READ_AHEAD_CONTROLLER_H_
+#define MEDIA_BLINK_READ_AHEAD_CONTROLLER_H_
+
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/tick_clock.h"
+#include "base/time/time.h"
+#include "media/blink/media_blink_export.h"
+
+namespace media {
+
+// Sizes the read-ahead window of a MultibufferDataSource from what it
+// measures, rather than from the bitrate alone.
+//
+// The controller estimates how fast the media is consumed (bytes handed to
+// the demuxer while playing) and how fast the network delivers it (bytes
+// downloaded while loading). When downloads comfortably outpace playback, a
+// few seconds of data ahead is enough, and keeping less resident saves
+// memory. As the two rates get closer, the window grows towards tens of
+// seconds, so that dips in throughput can be ridden out. Each stall makes the
+// controller more cautious for a while.
+//
+// All methods must be called on the same thread.
+class MEDIA_BLINK_EXPORT ReadAheadController {
+ public:
+  // Sizes, in bytes, to configure a MultiBufferReader with.
+  struct Window {
+    // Loading resumes when less than |preload| bytes are buffered ahead of
+    // the reader, and is deferred once |preload_high| bytes are.
+    int64_t preload;
+    int64_t preload_high;
+
+    // Pinned range around the reader.
+    int64_t pin_backward;
+    int64_t pin_forward;
+
+    // How much memory the reader may use.
+    int64_t buffer_size;
+  };
+
+  ReadAheadController();
+  ~ReadAheadController();
+
+  // Bitrate of the media in bits per second, 0 if unknown. Used to estimate
+  // consumption until it has been measured.
+  void SetBitrate(int bitrate);
+
+  // Consumption is only measured while |playback_rate| is not zero.
+  void SetPlaybackRate(double playback_rate);
+
+  // Called when |bytes| have been handed to the demuxer.
+  void OnBytesRead(int64_t bytes);
+
+  // Called when a read during playback had to wait for data.
+  void OnStall();
+
+  // Called on reader progress. |bytes_downloaded| is the total number of bytes
+  // downloaded so far, and |loading| is whether the reader is loading now.
+  void OnProgress(int64_t bytes_downloaded, bool loading);
+
+  // Recomputes the window. Returns true if it changed enough that the reader
+  // should be reconfigured.
+  bool UpdateWindow();
+
+  const Window& window() const { return window_; }
+
+  // Measured rates in bytes per second, or 0 if not measured yet.
+  double consumption_rate() const { return consumption_rate_; }
+  double download_rate() const { return download_rate_; }
+
+  // Number of stalls so far.
+  int stall_count() const { return stall_count_; }
+
+  // Factor by which the window is currently grown because of recent stalls.
+  double stall_factor() const { return stall_factor_; }
+
+  // Caller must make sure |tick_clock| is valid for lifetime of this object.
+  void SetTickClockForTest(base::TickClock* tick_clock);
+
+ private:
+  // Returns the estimated consumption rate in bytes per second.
+  double EstimatedConsumptionRate() const;
+
+  base::DefaultTickClock default_tick_clock_;
+  base::TickClock* tick_clock_;
+
+  int bitrate_;
+  double playback_rate_;
+
+  // Bytes read since |read_interval_start_|.
+  int64_t bytes_read_in_interval_;
+  base::TimeTicks read_interval_start_;
+  base::TimeTicks last_read_time_;
+  double consumption_rate_;
+
+  // Download progress at the previous OnProgress() call.
+  int64_t last_bytes_downloaded_;
+  bool last_loading_;
+  base::TimeTicks last_progress_time_;
+
+  // Bytes downloaded and time spent loading since the last sample.
+  int64_t bytes_downloaded_in_interval_;
+  base::TimeDelta loading_time_in_interval_;
+  double download_rate_;
+
+  int stall_count_;
+  double stall_factor_;
+
+  Window window_;
+  bool window_valid_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadAheadController);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BLINK_READ_AHEAD_CONTROLLER_H_
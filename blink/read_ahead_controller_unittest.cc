@@ -0,0 +1,206 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/time/time.h"
+#include "media/blink/read_ahead_controller.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+const int kBitrate = 4000000;  // 4 Mbps
+const int64_t kBytesPerSecond = kBitrate / 8;
+
+// Old fixed heuristics of MultibufferDataSource for kBitrate, for comparison.
+const int64_t kFixedPreload = 10 * kBytesPerSecond;
+const int64_t kFixedPreloadHigh = kFixedPreload + (1 << 20);
+const int64_t kFixedPinBackward = 2 << 20;
+
+struct SimulationResult {
+  int stalls;
+  double mean_resident_bytes;
+  int64_t peak_resident_bytes;
+};
+
+class ReadAheadControllerTest : public testing::Test {
+ public:
+  ReadAheadControllerTest() {
+    controller_.SetTickClockForTest(&clock_);
+    clock_.Advance(base::TimeDelta::FromSeconds(1));
+  }
+
+  // Plays ten minutes of kBitrate media over a network delivering
+  // |throughput| bytes per second at a given time in seconds. Loading is
+  // deferred and resumed according to the window of a ReadAheadController if
+  // |adaptive| is set, or according to the old fixed heuristics otherwise.
+  SimulationResult Simulate(bool adaptive,
+                            const base::Callback<double(double)>& throughput) {
+    const base::TimeDelta kStep = base::TimeDelta::FromMilliseconds(100);
+    const int kSteps = 10 * 60 * 10;
+    const double kStepSeconds = kStep.InSecondsF();
+    const int64_t kBytesPerStep = kBytesPerSecond * kStepSeconds;
+
+    ReadAheadController controller;
+    controller.SetTickClockForTest(&clock_);
+    controller.SetBitrate(kBitrate);
+    controller.SetPlaybackRate(1.0);
+
+    SimulationResult result = {0, 0.0, 0};
+    double ahead = 0;
+    double behind = 0;
+    double downloaded = 0;
+    bool loading = true;
+    bool stalled = false;
+    for (int step = 0; step < kSteps; ++step) {
+      int64_t preload = kFixedPreload;
+      int64_t preload_high = kFixedPreloadHigh;
+      int64_t pin_backward = kFixedPinBackward;
+      if (adaptive) {
+        controller.UpdateWindow();
+        preload = controller.window().preload;
+        preload_high = controller.window().preload_high;
+        pin_backward = controller.window().pin_backward;
+      }
+
+      if (ahead < preload)
+        loading = true;
+      if (ahead >= preload_high)
+        loading = false;
+      if (loading) {
+        const double bytes = throughput.Run(step * kStepSeconds) * kStepSeconds;
+        ahead += bytes;
+        downloaded += bytes;
+      }
+      controller.OnProgress(downloaded, loading);
+
+      // After a stall, wait for a second of data before playing again.
+      if (stalled && ahead >= kBytesPerSecond)
+        stalled = false;
+      if (!stalled) {
+        if (ahead >= kBytesPerStep) {
+          ahead -= kBytesPerStep;
+          behind += kBytesPerStep;
+          controller.OnBytesRead(kBytesPerStep);
+        } else {
+          stalled = true;
+          result.stalls++;
+          controller.OnStall();
+        }
+      }
+
+      // Data behind the pinned range may be evicted.
+      const int64_t resident = ahead + std::min<double>(behind, pin_backward);
+      result.mean_resident_bytes += static_cast<double>(resident) / kSteps;
+      result.peak_resident_bytes =
+          std::max(result.peak_resident_bytes, resident);
+      clock_.Advance(kStep);
+    }
+    return result;
+  }
+
+  void Report(const std::string& name, const SimulationResult& result) {
+    RecordProperty(name + "_stalls", result.stalls);
+    RecordProperty(name + "_mean_resident_kb",
+                   static_cast<int>(result.mean_resident_bytes / 1024));
+    RecordProperty(name + "_peak_resident_kb",
+                   static_cast<int>(result.peak_resident_bytes / 1024));
+  }
+
+ protected:
+  base::SimpleTestTickClock clock_;
+  ReadAheadController controller_;
+};
+
+static double FastNetwork(double seconds) {
+  return 4 * kBytesPerSecond;
+}
+
+// Slightly faster than playback on average, but with a 25 second dip to a
+// quarter of the bitrate every minute.
+static double DippingNetwork(double seconds) {
+  const double seconds_into_minute =
+      seconds - 60 * static_cast<int>(seconds / 60);
+  return (seconds_into_minute < 35 ? 1.6 : 0.25) * kBytesPerSecond;
+}
+
+TEST_F(ReadAheadControllerTest, DefaultsBeforeMeasuring) {
+  controller_.SetBitrate(kBitrate);
+  EXPECT_TRUE(controller_.UpdateWindow());
+  EXPECT_EQ(0, controller_.consumption_rate());
+  EXPECT_EQ(0, controller_.download_rate());
+  EXPECT_EQ(10 * kBytesPerSecond, controller_.window().preload);
+  EXPECT_EQ(controller_.window().preload_high,
+            controller_.window().pin_forward);
+  EXPECT_FALSE(controller_.UpdateWindow());
+}
+
+TEST_F(ReadAheadControllerTest, MeasuresRates) {
+  controller_.SetPlaybackRate(1.0);
+  for (int i = 0; i < 20; ++i) {
+    controller_.OnBytesRead(100000);
+    controller_.OnProgress(i * 300000, true);
+    clock_.Advance(base::TimeDelta::FromMilliseconds(500));
+  }
+  EXPECT_NEAR(200000, controller_.consumption_rate(), 1000);
+  EXPECT_NEAR(600000, controller_.download_rate(), 1000);
+
+  // Time spent deferred does not count against the download rate.
+  controller_.OnProgress(20 * 300000, false);
+  clock_.Advance(base::TimeDelta::FromSeconds(10));
+  controller_.OnProgress(20 * 300000, true);
+  clock_.Advance(base::TimeDelta::FromSeconds(1));
+  controller_.OnProgress(22 * 300000, true);
+  EXPECT_NEAR(600000, controller_.download_rate(), 1000);
+
+  // Downloads are three times faster than playback, so the window is at its
+  // smallest.
+  controller_.UpdateWindow();
+  EXPECT_NEAR(4 * 200000, controller_.window().preload, 1000);
+}
+
+TEST_F(ReadAheadControllerTest, StallsGrowWindow) {
+  controller_.SetBitrate(kBitrate);
+  controller_.UpdateWindow();
+  const int64_t preload = controller_.window().preload;
+
+  controller_.OnStall();
+  EXPECT_EQ(1, controller_.stall_count());
+  EXPECT_TRUE(controller_.UpdateWindow());
+  EXPECT_EQ(preload * 3 / 2, controller_.window().preload);
+
+  for (int i = 0; i < 10; ++i)
+    controller_.OnStall();
+  EXPECT_EQ(4.0, controller_.stall_factor());
+}
+
+TEST_F(ReadAheadControllerTest, FastNetworkUsesLessMemory) {
+  SimulationResult fixed = Simulate(false, base::Bind(&FastNetwork));
+  SimulationResult adaptive = Simulate(true, base::Bind(&FastNetwork));
+  Report("fixed", fixed);
+  Report("adaptive", adaptive);
+
+  EXPECT_EQ(0, fixed.stalls);
+  EXPECT_EQ(0, adaptive.stalls);
+  EXPECT_LT(adaptive.mean_resident_bytes, fixed.mean_resident_bytes * 0.6);
+  EXPECT_LT(adaptive.peak_resident_bytes, fixed.peak_resident_bytes);
+}
+
+TEST_F(ReadAheadControllerTest, DippingNetworkStallsLess) {
+  SimulationResult fixed = Simulate(false, base::Bind(&DippingNetwork));
+  SimulationResult adaptive = Simulate(true, base::Bind(&DippingNetwork));
+  Report("fixed", fixed);
+  Report("adaptive", adaptive);
+
+  EXPECT_GT(fixed.stalls, 0);
+  EXPECT_LT(adaptive.stalls, fixed.stalls / 4);
+}
+
+}  // namespace media
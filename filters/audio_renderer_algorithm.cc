@@ -190,6 +190,11 @@ int AudioRendererAlgorithm::FillBuffer(AudioBus* dest,
     search_block_ = AudioBus::Create(
         channels_, num_candidate_blocks_ + (ola_window_size_ - 1));
     target_block_ = AudioBus::Create(channels_, ola_window_size_);
+    if (internal::ShouldUseFftSearch(target_block_->frames(),
+                                     search_block_->frames())) {
+      fft_correlator_.reset(new internal::FftCrossCorrelator(
+          target_block_->frames(), search_block_->frames()));
+    }
 
     // Create potentially smaller wrappers for playback rate adaptation.
     CreateSearchWrappers();
@@ -357,8 +362,13 @@ void AudioRendererAlgorithm::GetOptimalBlock() {
     // |optimal_index| is in frames and it is relative to the beginning of the
     // |search_block_|.
     optimal_index =
-        internal::OptimalIndex(search_block_wrapper_.get(),
-                               target_block_wrapper_.get(), exclude_interval);
+        fft_correlator_
+            ? internal::OptimalIndex(search_block_wrapper_.get(),
+                                     target_block_wrapper_.get(),
+                                     exclude_interval, fft_correlator_.get())
+            : internal::OptimalIndex(search_block_wrapper_.get(),
+                                     target_block_wrapper_.get(),
+                                     exclude_interval);
 
     // Translate |index| w.r.t. the beginning of |audio_buffer_| and extract the
     // optimal block.
@@ -36,6 +36,10 @@ namespace media {
 
 class AudioBus;
 
+namespace internal {
+class FftCrossCorrelator;
+}
+
 class MEDIA_EXPORT AudioRendererAlgorithm {
  public:
   AudioRendererAlgorithm();
@@ -226,6 +230,11 @@ class MEDIA_EXPORT AudioRendererAlgorithm {
   // |target_block_|.
   std::unique_ptr<AudioBus> target_block_;
 
+  // Computes the similarity of every candidate block at once when the blocks
+  // are long enough for that to beat the decimated search, i.e. at high sample
+  // rates; null otherwise.
+  std::unique_ptr<internal::FftCrossCorrelator> fft_correlator_;
+
   // Active channels to consider while searching. Used to speed up WSOLA
   // processing by ignoring always muted channels. Wrappers are always
   // constructed during Initialize() and have <= |channels_|.
@@ -0,0 +1,84 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "base/numerics/math_constants.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "media/base/audio_buffer.h"
+#include "media/base/audio_bus.h"
+#include "media/base/audio_parameters.h"
+#include "media/base/channel_layout.h"
+#include "media/filters/audio_renderer_algorithm.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+// Seconds of audio rendered per benchmark run.
+static const int kBenchmarkSeconds = 20;
+static const int kFramesPerBuffer = 512;
+
+// Renders |kBenchmarkSeconds| of stereo audio at |sample_rate| and
+// |playback_rate|, refilling the algorithm's queue with a two-tone signal as
+// it drains.
+static void RunFillBufferBenchmark(int sample_rate, double playback_rate) {
+  const ChannelLayout kLayout = CHANNEL_LAYOUT_STEREO;
+  const int channels = ChannelLayoutToChannelCount(kLayout);
+  AudioParameters params(AudioParameters::AUDIO_PCM_LOW_LATENCY, kLayout,
+                         sample_rate, 32, kFramesPerBuffer);
+
+  // Use one buffer of non-trivial audio for the whole run; AudioBufferQueue
+  // never modifies enqueued buffers.
+  const int kInputFrames = sample_rate / 10;
+  scoped_refptr<AudioBuffer> input = AudioBuffer::CreateBuffer(
+      kSampleFormatPlanarF32, kLayout, channels, sample_rate, kInputFrames);
+  for (int ch = 0; ch < channels; ++ch) {
+    float* data = reinterpret_cast<float*>(input->channel_data()[ch]);
+    const double step = 2.0 * base::kPiDouble / sample_rate;
+    for (int i = 0; i < kInputFrames; ++i) {
+      data[i] = 0.5f * std::sin(step * 440 * i) +
+                0.25f * std::sin(step * (1000 + 500 * ch) * i);
+    }
+  }
+
+  AudioRendererAlgorithm algorithm;
+  algorithm.Initialize(params, false);
+  std::unique_ptr<AudioBus> dest = AudioBus::Create(channels, kFramesPerBuffer);
+
+  const int kRenderCalls = kBenchmarkSeconds * sample_rate / kFramesPerBuffer;
+  base::TimeDelta elapsed;
+  for (int i = 0; i < kRenderCalls; ++i) {
+    while (!algorithm.IsQueueFull())
+      algorithm.EnqueueBuffer(input);
+
+    // Only time FillBuffer(), not the queue maintenance above.
+    base::TimeTicks start = base::TimeTicks::Now();
+    algorithm.FillBuffer(dest.get(), 0, kFramesPerBuffer, playback_rate);
+    elapsed += base::TimeTicks::Now() - start;
+  }
+
+  perf_test::PrintResult(
+      "audio_renderer_algorithm_fill_buffer",
+      base::StringPrintf("_%dhz", sample_rate),
+      base::StringPrintf("rate_%.2f", playback_rate),
+      kRenderCalls / elapsed.InMillisecondsF(), "runs/ms", true);
+}
+
+// Benchmark FillBuffer() at the playback rates exposed to users. 44.1 and
+// 48 kHz use the decimated WSOLA search, 96 and 192 kHz the FFT-based one.
+TEST(AudioRendererAlgorithmPerfTest, FillBuffer) {
+  static const int kSampleRates[] = {44100, 48000, 96000, 192000};
+  static const double kPlaybackRates[] = {0.5, 0.75, 1.0, 1.25, 1.5, 2.0};
+  for (int sample_rate : kSampleRates) {
+    for (double playback_rate : kPlaybackRates)
+      RunFillBufferBenchmark(sample_rate, playback_rate);
+  }
+}
+
+}  // namespace media
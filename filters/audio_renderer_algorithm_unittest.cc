@@ -476,6 +476,15 @@ TEST_F(AudioRendererAlgorithmTest, FillBuffer_HigherQualityAudio) {
   TestPlaybackRate(1.5);
 }
 
+TEST_F(AudioRendererAlgorithmTest, FillBuffer_FftSearch) {
+  // At 96 kHz the blocks are long enough to use the FFT-based search.
+  const int kHighSampleRate = 96000;
+  Initialize(CHANNEL_LAYOUT_STEREO, kSampleFormatS16, kHighSampleRate,
+             kHighSampleRate / 100);
+  TestPlaybackRate(1.5);
+  TestPlaybackRate(0.75);
+}
+
 TEST_F(AudioRendererAlgorithmTest, DotProduct) {
   const int kChannels = 3;
   const int kFrames = 20;
@@ -634,6 +643,51 @@ TEST_F(AudioRendererAlgorithmTest, FullAndDecimatedSearch) {
 
   EXPECT_EQ(5, internal::OptimalIndex(search_region.get(), target.get(),
                                       exclude_interval));
+
+  // The exhaustive FFT search must find the same blocks as FullSearch().
+  internal::FftCrossCorrelator correlator(kFramePerBlock,
+                                          kFramesInSearchRegion);
+  EXPECT_EQ(5, internal::OptimalIndex(search_region.get(), target.get(),
+                                      exclude_interval, &correlator));
+  exclude_interval = std::make_pair(2, 5);
+  EXPECT_EQ(7, internal::OptimalIndex(search_region.get(), target.get(),
+                                      exclude_interval, &correlator));
+}
+
+TEST_F(AudioRendererAlgorithmTest, FftCrossCorrelation) {
+  const int kChannels = 3;
+  const int kSearchFrames = 300;
+  const int kTargetFrames = 70;
+  const int kNumCandidBlocks = kSearchFrames - (kTargetFrames - 1);
+
+  std::unique_ptr<AudioBus> search = AudioBus::Create(kChannels, kSearchFrames);
+  std::unique_ptr<AudioBus> target = AudioBus::Create(kChannels, kTargetFrames);
+  for (int k = 0; k < kChannels; ++k) {
+    for (int n = 0; n < kSearchFrames; ++n)
+      search->channel(k)[n] = std::sin(0.05f * (k + 1) * n) + 0.01f * (n % 7);
+    for (int n = 0; n < kTargetFrames; ++n)
+      target->channel(k)[n] = std::cos(0.07f * (k + 2) * n);
+  }
+
+  std::unique_ptr<float[]> dot_prods(new float[kChannels * kNumCandidBlocks]);
+  internal::FftCrossCorrelator correlator(kTargetFrames, kSearchFrames);
+  correlator.MultiChannelCrossCorrelation(target.get(), search.get(),
+                                          dot_prods.get());
+
+  std::unique_ptr<float[]> expected(new float[kChannels]);
+  for (int n = 0; n < kNumCandidBlocks; ++n) {
+    internal::MultiChannelDotProduct(target.get(), 0, search.get(), n,
+                                     kTargetFrames, expected.get());
+    for (int k = 0; k < kChannels; ++k)
+      EXPECT_NEAR(expected[k], dot_prods[k + n * kChannels], 1e-3f);
+  }
+}
+
+TEST_F(AudioRendererAlgorithmTest, FftSearchOnlyForLargeBlocks) {
+  // 20 ms blocks at 48 kHz keep using the decimated search; at 192 kHz the FFT
+  // is cheaper.
+  EXPECT_FALSE(internal::ShouldUseFftSearch(960, 960 + 1440));
+  EXPECT_TRUE(internal::ShouldUseFftSearch(3840, 3840 + 5760));
 }
 
 TEST_F(AudioRendererAlgorithmTest, QuadraticInterpolation) {
@@ -667,6 +667,8 @@ ChunkDemuxer::Status ChunkDemuxer::AddId(const std::string& id,
       media_log_,
       buffering_by_pts_ ? ChunkDemuxerStream::RangeApi::kNewByPts
                         : ChunkDemuxerStream::RangeApi::kLegacyByDts));
+  frame_processor->SetParallelTrackAppends(
+      base::FeatureList::IsEnabled(kParallelMseTrackAppends));
 
   std::unique_ptr<SourceBufferState> source_state(new SourceBufferState(
       std::move(stream_parser), std::move(frame_processor),
@@ -4,6 +4,7 @@
 
 #include "media/filters/decoder_stream.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
@@ -58,6 +59,7 @@ DecoderStream<StreamType>::DecoderStream(
       has_fallen_back_once_on_decode_error_(false),
       decoding_eos_(false),
       pending_decode_requests_(0),
+      max_decode_ahead_(0),
       duration_tracker_(8),
       received_config_change_during_reinit_(false),
       pending_demuxer_read_(false),
@@ -239,7 +241,10 @@ bool DecoderStream<StreamType>::CanDecodeMore() const {
   // empty.
   int num_decodes =
       static_cast<int>(ready_outputs_.size()) + pending_decode_requests_;
-  return buffers_left && num_decodes < GetMaxDecodeRequests();
+  int max_decodes = GetMaxDecodeRequests();
+  if (max_decode_ahead_)
+    max_decodes = std::min(max_decodes, max_decode_ahead_);
+  return buffers_left && num_decodes < max_decodes;
 }
 
 template <DemuxerStream::Type StreamType>
@@ -106,6 +106,13 @@ class MEDIA_EXPORT DecoderStream {
   // Returns true if one more decode request can be submitted to the decoder.
   bool CanDecodeMore() const;
 
+  // Limits the number of outputs stored in |ready_outputs_| and being decoded
+  // to |max_decode_ahead|, if lower than GetMaxDecodeRequests(). Zero removes
+  // the limit.
+  void set_max_decode_ahead(int max_decode_ahead) {
+    max_decode_ahead_ = max_decode_ahead;
+  }
+
   base::TimeDelta AverageDuration() const;
 
   // Tells decoders that we won't need frames before |start_timestamp| so they
@@ -249,6 +256,9 @@ class MEDIA_EXPORT DecoderStream {
   // Number of outstanding decode requests sent to the |decoder_|.
   int pending_decode_requests_;
 
+  // Limit set by the client on top of GetMaxDecodeRequests(), or 0.
+  int max_decode_ahead_;
+
   // Tracks the duration of incoming packets over time.
   MovingAverage duration_tracker_;
 
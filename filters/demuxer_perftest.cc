@@ -11,12 +11,15 @@
 #include "base/macros.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/scoped_task_environment.h"
+#include "base/threading/thread.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 #include "media/base/media.h"
 #include "media/base/media_log.h"
+#include "media/base/media_switches.h"
 #include "media/base/media_tracks.h"
 #include "media/base/test_data_util.h"
 #include "media/base/timestamp_constants.h"
@@ -30,6 +33,11 @@ namespace media {
 
 static const int kBenchmarkIterations = 100;
 
+// Files are read this many times each for the read-ahead benchmark, through a
+// DataSource taking this long per read.
+static const int kReadAheadIterations = 10;
+static const int kReadDelayMs = 1;
+
 class DemuxerHostImpl : public media::DemuxerHost {
  public:
   DemuxerHostImpl() {}
@@ -63,6 +71,47 @@ static void OnMediaTracksUpdated(std::unique_ptr<MediaTracks> tracks) {
   DVLOG(1) << "Got media tracks info, tracks = " << tracks->tracks().size();
 }
 
+// Completes reads of a file on another thread after a delay, as a remote
+// source or a cold disk would.
+class DelayedDataSource : public DataSource {
+ public:
+  explicit DelayedDataSource(base::TimeDelta delay)
+      : delay_(delay), thread_("DelayedDataSource") {
+    CHECK(thread_.Start());
+  }
+  ~DelayedDataSource() override { thread_.Stop(); }
+
+  bool Initialize(const base::FilePath& file_path) {
+    return data_source_.Initialize(file_path);
+  }
+
+  // DataSource implementation.
+  void Read(int64_t position,
+            int size,
+            uint8_t* data,
+            const DataSource::ReadCB& read_cb) override {
+    thread_.task_runner()->PostDelayedTask(
+        FROM_HERE,
+        base::Bind(&FileDataSource::Read, base::Unretained(&data_source_),
+                   position, size, data, read_cb),
+        delay_);
+  }
+  void Stop() override { data_source_.Stop(); }
+  void Abort() override { data_source_.Abort(); }
+  bool GetSize(int64_t* size_out) override {
+    return data_source_.GetSize(size_out);
+  }
+  bool IsStreaming() override { return data_source_.IsStreaming(); }
+  void SetBitrate(int bitrate) override {}
+
+ private:
+  const base::TimeDelta delay_;
+  FileDataSource data_source_;
+  base::Thread thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayedDataSource);
+};
+
 typedef std::vector<media::DemuxerStream*> Streams;
 
 // Simulates playback reading requirements by reading from each stream
@@ -173,6 +222,43 @@ int StreamReader::GetNextStreamIndexToRead() {
   return index;
 }
 
+// Demuxes all of |data_source|, and returns how long reading the streams took,
+// including initialization if |time_initialize| is set.  Must be called with
+// a ScopedTaskEnvironment in place.
+static base::TimeDelta DemuxDataSource(DataSource* data_source,
+                                       bool time_initialize,
+                                       MediaLog* media_log) {
+  DemuxerHostImpl demuxer_host;
+  Demuxer::EncryptedMediaInitDataCB encrypted_media_init_data_cb =
+      base::Bind(&OnEncryptedMediaInitData);
+  Demuxer::MediaTracksUpdatedCB tracks_updated_cb =
+      base::Bind(&OnMediaTracksUpdated);
+  FFmpegDemuxer demuxer(base::ThreadTaskRunnerHandle::Get(), data_source,
+                        encrypted_media_init_data_cb, tracks_updated_cb,
+                        media_log);
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  {
+    base::RunLoop run_loop;
+    demuxer.Initialize(
+        &demuxer_host, base::Bind(&QuitLoopWithStatus, run_loop.QuitClosure()),
+        false);
+    run_loop.Run();
+  }
+
+  StreamReader stream_reader(&demuxer, false);
+
+  // Benchmark.
+  if (!time_initialize)
+    start = base::TimeTicks::Now();
+  while (!stream_reader.IsDone())
+    stream_reader.Read();
+  base::TimeDelta time = base::TimeTicks::Now() - start;
+  demuxer.Stop();
+  base::RunLoop().RunUntilIdle();
+  return time;
+}
+
 static void RunDemuxerBenchmark(const std::string& filename) {
   base::FilePath file_path(GetTestDataFilePath(filename));
   base::TimeDelta total_time;
@@ -180,35 +266,10 @@ static void RunDemuxerBenchmark(const std::string& filename) {
   for (int i = 0; i < kBenchmarkIterations; ++i) {
     // Setup.
     base::test::ScopedTaskEnvironment scoped_task_environment_;
-    DemuxerHostImpl demuxer_host;
     FileDataSource data_source;
     ASSERT_TRUE(data_source.Initialize(file_path));
 
-    Demuxer::EncryptedMediaInitDataCB encrypted_media_init_data_cb =
-        base::Bind(&OnEncryptedMediaInitData);
-    Demuxer::MediaTracksUpdatedCB tracks_updated_cb =
-        base::Bind(&OnMediaTracksUpdated);
-    FFmpegDemuxer demuxer(base::ThreadTaskRunnerHandle::Get(), &data_source,
-                          encrypted_media_init_data_cb, tracks_updated_cb,
-                          &media_log_);
-
-    {
-      base::RunLoop run_loop;
-      demuxer.Initialize(
-          &demuxer_host,
-          base::Bind(&QuitLoopWithStatus, run_loop.QuitClosure()), false);
-      run_loop.Run();
-    }
-
-    StreamReader stream_reader(&demuxer, false);
-
-    // Benchmark.
-    base::TimeTicks start = base::TimeTicks::Now();
-    while (!stream_reader.IsDone())
-      stream_reader.Read();
-    total_time += base::TimeTicks::Now() - start;
-    demuxer.Stop();
-    base::RunLoop().RunUntilIdle();
+    total_time += DemuxDataSource(&data_source, false, &media_log_);
   }
 
   perf_test::PrintResult("demuxer_bench", "", filename,
@@ -216,6 +277,38 @@ static void RunDemuxerBenchmark(const std::string& filename) {
                          "runs/s", true);
 }
 
+// Demuxes |filename| through a DataSource with |kReadDelayMs| of latency per
+// read, and reports the rate at which the file is read.
+static void RunReadAheadBenchmark(const std::string& filename,
+                                  bool read_ahead) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  if (read_ahead)
+    scoped_feature_list.InitAndEnableFeature(kFFmpegDemuxerReadAhead);
+  else
+    scoped_feature_list.InitAndDisableFeature(kFFmpegDemuxerReadAhead);
+
+  base::FilePath file_path(GetTestDataFilePath(filename));
+  base::TimeDelta total_time;
+  int64_t total_size = 0;
+  MediaLog media_log;
+  for (int i = 0; i < kReadAheadIterations; ++i) {
+    base::test::ScopedTaskEnvironment scoped_task_environment;
+    DelayedDataSource data_source(
+        base::TimeDelta::FromMilliseconds(kReadDelayMs));
+    ASSERT_TRUE(data_source.Initialize(file_path));
+    int64_t size;
+    ASSERT_TRUE(data_source.GetSize(&size));
+    total_size += size;
+
+    total_time += DemuxDataSource(&data_source, true, &media_log);
+  }
+
+  perf_test::PrintResult("demuxer_read_throughput",
+                         read_ahead ? "_read_ahead" : "", filename,
+                         total_size / (1024.0 * 1024) / total_time.InSecondsF(),
+                         "MB/s", true);
+}
+
 #if defined(OS_WIN)
 // http://crbug.com/399002
 #define MAYBE_Demuxer DISABLED_Demuxer
@@ -236,4 +329,23 @@ TEST(DemuxerPerfTest, MAYBE_Demuxer) {
 #endif
 }
 
+#if defined(OS_WIN)
+// http://crbug.com/399002
+#define MAYBE_ReadAhead DISABLED_ReadAhead
+#else
+#define MAYBE_ReadAhead ReadAhead
+#endif
+// Benchmark demuxing with and without FFmpegDemuxer's read-ahead, reading from
+// a source where each read has a round trip.
+TEST(DemuxerPerfTest, MAYBE_ReadAhead) {
+  RunReadAheadBenchmark("bear-640x360.webm", false);
+  RunReadAheadBenchmark("bear-640x360.webm", true);
+  RunReadAheadBenchmark("sfx_s16le.wav", false);
+  RunReadAheadBenchmark("sfx_s16le.wav", true);
+#if BUILDFLAG(USE_PROPRIETARY_CODECS)
+  RunReadAheadBenchmark("bear-1280x720.mp4", false);
+  RunReadAheadBenchmark("bear-1280x720.mp4", true);
+#endif
+}
+
 }  // namespace media
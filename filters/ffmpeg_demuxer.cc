@@ -14,6 +14,7 @@
 #include "base/callback_helpers.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/single_thread_task_runner.h"
@@ -32,6 +33,7 @@
 #include "media/base/demuxer_memory_limit.h"
 #include "media/base/limits.h"
 #include "media/base/media_log.h"
+#include "media/base/media_switches.h"
 #include "media/base/media_tracks.h"
 #include "media/base/sample_rates.h"
 #include "media/base/timestamp_constants.h"
@@ -42,6 +44,7 @@
 #include "media/filters/ffmpeg_bitstream_converter.h"
 #include "media/filters/ffmpeg_glue.h"
 #include "media/filters/ffmpeg_h264_to_annex_b_bitstream_converter.h"
+#include "media/filters/read_ahead_data_source.h"
 #include "media/formats/webm/webm_crypto_helpers.h"
 #include "media/media_features.h"
 #include "third_party/ffmpeg/ffmpeg_features.h"
@@ -54,11 +57,44 @@ namespace media {
 
 namespace {
 
+// How much data ReadAheadDataSource keeps fetched past FFmpeg's last read.
+const int kReadAheadWindowSize = 1024 * 1024;
+
 void SetAVStreamDiscard(AVStream* stream, AVDiscard discard) {
   DCHECK(stream);
   stream->discard = discard;
 }
 
+// Holds a reference to the ref-counted buffer behind an AVPacket, so that
+// DecoderBuffers can reference the packet's data rather than copying it.
+// FFmpeg allocates packet buffers with zeroed padding that size() includes.
+class AVBufferMemory : public base::RefCountedMemory {
+ public:
+  explicit AVBufferMemory(AVBufferRef* buffer)
+      : buffer_(av_buffer_ref(buffer)) {
+    CHECK(buffer_);
+  }
+
+  // base::RefCountedMemory implementation.
+  const unsigned char* front() const override { return buffer_->data; }
+  size_t size() const override { return buffer_->size; }
+
+ private:
+  ~AVBufferMemory() override { av_buffer_unref(&buffer_); }
+
+  AVBufferRef* buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(AVBufferMemory);
+};
+
+// Returns the memory behind |packet|'s data, or null if the data isn't held in
+// a ref-counted buffer and so must be copied.
+scoped_refptr<base::RefCountedMemory> GetPacketMemory(AVPacket* packet) {
+  if (!packet->buf)
+    return nullptr;
+  return base::MakeRefCounted<AVBufferMemory>(packet->buf);
+}
+
 }  // namespace
 
 static base::Time ExtractTimelineOffset(
@@ -420,17 +456,15 @@ void FFmpegDemuxerStream::EnqueuePacket(ScopedAVPacket packet) {
       }
     }
 
+    // Reference the packet's data where it is held in a ref-counted buffer.
     // If a packet is returned by FFmpeg's av_parser_parse2() the packet will
-    // reference inner memory of FFmpeg.  As such we should transfer the packet
-    // into memory we control.
-    if (side_data_size > 0) {
-      buffer = DecoderBuffer::CopyFrom(packet.get()->data + data_offset,
-                                       packet.get()->size - data_offset,
-                                       side_data, side_data_size);
-    } else {
-      buffer = DecoderBuffer::CopyFrom(packet.get()->data + data_offset,
-                                       packet.get()->size - data_offset);
-    }
+    // reference inner memory of FFmpeg instead.  As such we should transfer the
+    // packet into memory we control.
+    buffer = DecoderBuffer::FromSharedData(GetPacketMemory(packet.get()),
+                                           packet.get()->data + data_offset,
+                                           packet.get()->size - data_offset);
+    if (side_data_size > 0)
+      buffer->CopySideDataFrom(side_data, side_data_size);
 
     int skip_samples_size = 0;
     const uint32_t* skip_samples_ptr =
@@ -892,6 +926,14 @@ void FFmpegDemuxer::Initialize(DemuxerHost* host,
   text_enabled_ = enable_text_tracks;
   weak_this_ = cancel_pending_seek_factory_.GetWeakPtr();
 
+  // Route FFmpeg's reads through a read-ahead window if enabled.  All later
+  // use of |data_source_|, including Stop() and Abort(), goes through it too.
+  if (base::FeatureList::IsEnabled(kFFmpegDemuxerReadAhead)) {
+    read_ahead_data_source_ =
+        new ReadAheadDataSource(data_source_, kReadAheadWindowSize);
+    data_source_ = read_ahead_data_source_.get();
+  }
+
   // Give a WeakPtr to BlockingUrlProtocol since we'll need to release it on the
   // blocking thread pool.
   url_protocol_.reset(new BlockingUrlProtocol(
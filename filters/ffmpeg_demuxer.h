@@ -32,6 +32,7 @@
 
 #include "base/callback.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequenced_task_runner.h"
 #include "base/single_thread_task_runner.h"
@@ -58,6 +59,7 @@ class MediaLog;
 class FFmpegBitstreamConverter;
 class FFmpegDemuxer;
 class FFmpegGlue;
+class ReadAheadDataSource;
 
 typedef std::unique_ptr<AVPacket, ScopedPtrAVFreePacket> ScopedAVPacket;
 
@@ -334,6 +336,10 @@ class MEDIA_EXPORT FFmpegDemuxer : public Demuxer {
   // integrate with libavformat.
   DataSource* data_source_;
 
+  // Wraps the DataSource given at construction when kFFmpegDemuxerReadAhead is
+  // enabled, in which case |data_source_| points to it.
+  scoped_refptr<ReadAheadDataSource> read_ahead_data_source_;
+
   MediaLog* media_log_;
 
   // Derived bitrate after initialization has completed.
@@ -13,6 +13,7 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/single_thread_task_runner.h"
 #include "base/strings/string_number_conversions.h"
@@ -249,7 +250,7 @@ void FFmpegVideoDecoder::Initialize(const VideoDecoderConfig& config,
 
   // Success!
   config_ = config;
-  output_cb_ = output_cb;
+  output_cb_ = decode_stream_ ? BindToCurrentLoop(output_cb) : output_cb;
   state_ = kNormal;
   bound_init_cb.Run(true);
 }
@@ -259,10 +260,24 @@ void FFmpegVideoDecoder::Decode(const scoped_refptr<DecoderBuffer>& buffer,
   DCHECK(thread_checker_.CalledOnValidThread());
   DCHECK(buffer.get());
   DCHECK(!decode_cb.is_null());
-  CHECK_NE(state_, kUninitialized);
 
   DecodeCB decode_cb_bound = BindToCurrentLoop(decode_cb);
 
+  if (decode_stream_) {
+    decode_stream_->task_runner()->PostTask(
+        FROM_HERE,
+        base::Bind(&FFmpegVideoDecoder::DecodeBuffer, base::Unretained(this),
+                   buffer, decode_cb_bound));
+  } else {
+    DecodeBuffer(buffer, decode_cb_bound);
+  }
+}
+
+void FFmpegVideoDecoder::DecodeBuffer(
+    const scoped_refptr<DecoderBuffer>& buffer,
+    const DecodeCB& decode_cb_bound) {
+  CHECK_NE(state_, kUninitialized);
+
   if (state_ == kError) {
     decode_cb_bound.Run(DecodeStatus::DECODE_ERROR);
     return;
@@ -310,16 +325,29 @@ void FFmpegVideoDecoder::Decode(const scoped_refptr<DecoderBuffer>& buffer,
 void FFmpegVideoDecoder::Reset(const base::Closure& closure) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  avcodec_flush_buffers(codec_context_.get());
-  state_ = kNormal;
+  if (decode_stream_) {
+    decode_stream_->task_runner()->PostTaskAndReply(
+        FROM_HERE,
+        base::Bind(&FFmpegVideoDecoder::ResetCodec, base::Unretained(this)),
+        closure);
+    return;
+  }
+
+  ResetCodec();
   // PostTask() to avoid calling |closure| inmediately.
   base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, closure);
 }
 
+void FFmpegVideoDecoder::ResetCodec() {
+  avcodec_flush_buffers(codec_context_.get());
+  state_ = kNormal;
+}
+
 FFmpegVideoDecoder::~FFmpegVideoDecoder() {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  if (state_ != kUninitialized)
+  // Decodes on |decode_stream_| may still be using |state_|.
+  if (decode_stream_ || state_ != kUninitialized)
     ReleaseFFmpegResources();
 }
 
@@ -392,6 +420,11 @@ bool FFmpegVideoDecoder::OnNewFrame(AVFrame* frame) {
 }
 
 void FFmpegVideoDecoder::ReleaseFFmpegResources() {
+  // Decodes posted to |decode_stream_| use the codec, and |this|.
+  if (decode_stream_) {
+    decode_stream_->WaitForOutstandingTasks();
+    decode_stream_.reset();
+  }
   decoding_loop_.reset();
   codec_context_.reset();
 }
@@ -408,7 +441,16 @@ bool FFmpegVideoDecoder::ConfigureDecoder(const VideoDecoderConfig& config,
   codec_context_.reset(avcodec_alloc_context3(NULL));
   VideoDecoderConfigToAVCodecContext(config, codec_context_.get());
 
-  codec_context_->thread_count = GetThreadCount(config);
+  // Decode on the threads shared by all decoders if enabled, with at most our
+  // share of the codec threads. FFmpeg decodes on the calling thread when given
+  // a single thread, which is what we want then.
+  int thread_count = GetThreadCount(config);
+  if (base::FeatureList::IsEnabled(kSharedVideoDecodeThreads)) {
+    decode_stream_ = VideoDecodeScheduler::GetInstance()->RegisterStream(
+        config.coded_size(), thread_count);
+    thread_count = decode_stream_->codec_thread_count();
+  }
+  codec_context_->thread_count = thread_count;
   codec_context_->thread_type =
       FF_THREAD_SLICE | (low_delay ? 0 : FF_THREAD_FRAME);
   codec_context_->opaque = this;
@@ -16,6 +16,7 @@
 #include "media/base/video_decoder_config.h"
 #include "media/base/video_frame_pool.h"
 #include "media/ffmpeg/ffmpeg_deleters.h"
+#include "media/filters/video_decode_scheduler.h"
 
 struct AVCodecContext;
 struct AVFrame;
@@ -63,6 +64,15 @@ class MEDIA_EXPORT FFmpegVideoDecoder : public VideoDecoder {
     kError
   };
 
+  // Decodes |buffer| either on |decode_stream_|'s thread or directly on the
+  // media thread. |decode_cb_bound| must be bound to the thread that called
+  // Decode().
+  void DecodeBuffer(const scoped_refptr<DecoderBuffer>& buffer,
+                    const DecodeCB& decode_cb_bound);
+
+  // Flushes the codec and returns to kNormal, on the same thread as decodes.
+  void ResetCodec();
+
   // Handles decoding of an unencrypted encoded buffer. A return value of false
   // indicates that an error has occurred.
   bool FFmpegDecode(const scoped_refptr<DecoderBuffer>& buffer);
@@ -93,6 +103,11 @@ class MEDIA_EXPORT FFmpegVideoDecoder : public VideoDecoder {
 
   std::unique_ptr<FFmpegDecodingLoop> decoding_loop_;
 
+  // With kSharedVideoDecodeThreads, decodes happen on this stream's thread.
+  // |state_|, |codec_context_| and |decoding_loop_| are then only used there
+  // while decodes are outstanding.
+  std::unique_ptr<VideoDecodeScheduler::Stream> decode_stream_;
+
   DISALLOW_COPY_AND_ASSIGN(FFmpegVideoDecoder);
 };
 
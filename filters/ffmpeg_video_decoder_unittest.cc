@@ -16,10 +16,12 @@
 #include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
 #include "base/strings/string_util.h"
+#include "base/test/scoped_feature_list.h"
 #include "media/base/decoder_buffer.h"
 #include "media/base/gmock_callback_support.h"
 #include "media/base/limits.h"
 #include "media/base/media_log.h"
+#include "media/base/media_switches.h"
 #include "media/base/media_util.h"
 #include "media/base/mock_filters.h"
 #include "media/base/mock_media_log.h"
@@ -36,6 +38,7 @@
 using ::testing::_;
 using ::testing::AtLeast;
 using ::testing::AtMost;
+using ::testing::DoAll;
 using ::testing::InSequence;
 using ::testing::IsNull;
 using ::testing::Return;
@@ -96,9 +99,15 @@ class FFmpegVideoDecoderTest : public testing::Test {
     InitializeWithConfig(TestVideoConfig::Large());
   }
 
+  // Waits for the reset to complete, which with shared decode threads happens
+  // only once the decode thread has flushed the codec.
   void Reset() {
-    decoder_->Reset(NewExpectedClosure());
-    base::RunLoop().RunUntilIdle();
+    base::RunLoop run_loop;
+    EXPECT_CALL(*this, ResetDone())
+        .WillOnce(RunClosure(run_loop.QuitClosure()));
+    decoder_->Reset(base::Bind(&FFmpegVideoDecoderTest::ResetDone,
+                               base::Unretained(this)));
+    run_loop.Run();
   }
 
   void Destroy() {
@@ -188,11 +197,14 @@ class FFmpegVideoDecoderTest : public testing::Test {
 
   DecodeStatus Decode(const scoped_refptr<DecoderBuffer>& buffer) {
     DecodeStatus status;
-    EXPECT_CALL(*this, DecodeDone(_)).WillOnce(SaveArg<0>(&status));
+    base::RunLoop run_loop;
+    EXPECT_CALL(*this, DecodeDone(_))
+        .WillOnce(
+            DoAll(SaveArg<0>(&status), RunClosure(run_loop.QuitClosure())));
 
     decoder_->Decode(buffer, decode_cb_);
 
-    base::RunLoop().RunUntilIdle();
+    run_loop.Run();
 
     return status;
   }
@@ -203,6 +215,7 @@ class FFmpegVideoDecoderTest : public testing::Test {
   }
 
   MOCK_METHOD1(DecodeDone, void(DecodeStatus));
+  MOCK_METHOD0(ResetDone, void());
 
   StrictMock<MockMediaLog> media_log_;
 
@@ -376,4 +389,73 @@ TEST_F(FFmpegVideoDecoderTest, Destroy_EndOfStream) {
   Destroy();
 }
 
+// Runs the tests below with decodes on the threads shared by all video
+// decoders, which return their results by posting back to the test thread.
+class FFmpegVideoDecoderSharedThreadsTest : public FFmpegVideoDecoderTest {
+ public:
+  FFmpegVideoDecoderSharedThreadsTest() {
+    scoped_feature_list_.InitAndEnableFeature(kSharedVideoDecodeThreads);
+  }
+
+ private:
+  base::test::ScopedFeatureList scoped_feature_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(FFmpegVideoDecoderSharedThreadsTest);
+};
+
+TEST_F(FFmpegVideoDecoderSharedThreadsTest, DecodeFrame_Normal) {
+  Initialize();
+
+  EXPECT_EQ(DecodeStatus::OK, DecodeSingleFrame(i_frame_buffer_));
+  ASSERT_EQ(1U, output_frames_.size());
+}
+
+TEST_F(FFmpegVideoDecoderSharedThreadsTest, DecodeFrame_DecodeError) {
+  Initialize();
+
+  EXPECT_MEDIA_LOG(ContainsFailedToSendLog());
+
+  EXPECT_EQ(DecodeStatus::OK, Decode(corrupt_i_frame_buffer_));
+  EXPECT_EQ(DecodeStatus::DECODE_ERROR, Decode(i_frame_buffer_));
+  EXPECT_EQ(DecodeStatus::DECODE_ERROR, Decode(i_frame_buffer_));
+  EXPECT_TRUE(output_frames_.empty());
+}
+
+// Test resetting while a decode is still running on the decode thread: the
+// decode must complete before the reset does, and decoding must work after.
+TEST_F(FFmpegVideoDecoderSharedThreadsTest, Reset_DuringDecode) {
+  Initialize();
+
+  {
+    InSequence s;
+    EXPECT_CALL(*this, DecodeDone(DecodeStatus::OK));
+    decoder_->Decode(i_frame_buffer_, decode_cb_);
+    Reset();
+  }
+
+  output_frames_.clear();
+  EnterDecodingState();
+}
+
+TEST_F(FFmpegVideoDecoderSharedThreadsTest, Reinitialize_AfterDecodeFrame) {
+  Initialize();
+  EnterDecodingState();
+  Reinitialize();
+
+  output_frames_.clear();
+  EnterDecodingState();
+}
+
+// Test destruction with decodes queued on the decode thread: each must still
+// complete, and the decoder must not be used after it is gone.
+TEST_F(FFmpegVideoDecoderSharedThreadsTest, Destroy_WithDecodesPending) {
+  Initialize();
+
+  EXPECT_CALL(*this, DecodeDone(DecodeStatus::OK)).Times(3);
+  decoder_->Decode(i_frame_buffer_, decode_cb_);
+  decoder_->Decode(i_frame_buffer_, decode_cb_);
+  decoder_->Decode(end_of_stream_buffer_, decode_cb_);
+  Destroy();
+}
+
 }  // namespace media
@@ -6,10 +6,14 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
 
+#include "base/bind.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "media/base/run_in_parallel.h"
 #include "media/base/stream_parser_buffer.h"
 #include "media/base/timestamp_constants.h"
 
@@ -73,6 +77,9 @@ class MseTrackBuffer {
   // Gets a pointer to this track's ChunkDemuxerStream.
   ChunkDemuxerStream* stream() const { return stream_; }
 
+  // Returns true if there are processed frames waiting to be appended.
+  bool has_processed_frames() const { return !processed_frames_.empty(); }
+
   // Unsets |last_decode_timestamp_|, unsets |last_frame_duration_|,
   // unsets |highest_presentation_timestamp_|, and sets
   // |needs_random_access_point_| to true.
@@ -272,6 +279,15 @@ void MseTrackBuffer::NotifyStartOfCodedFrameGroup(DecodeTimestamp start_dts,
   stream_->OnStartOfCodedFrameGroup(start_dts, start_pts);
 }
 
+// Runs the FlushProcessedFrames() of |track_buffers[index]|, setting
+// |results[index]| to what it returns.
+static void FlushProcessedFramesOfTrack(
+    const std::vector<MseTrackBuffer*>* track_buffers,
+    bool* results,
+    size_t index) {
+  results[index] = (*track_buffers)[index]->FlushProcessedFrames();
+}
+
 FrameProcessor::FrameProcessor(const UpdateDurationCB& update_duration_cb,
                                MediaLog* media_log,
                                ChunkDemuxerStream::RangeApi range_api)
@@ -475,6 +491,11 @@ void FrameProcessor::OnPossibleAudioConfigUpdate(
       1.0 / current_audio_config_.samples_per_second());
 }
 
+void FrameProcessor::SetParallelTrackAppends(bool parallel_track_appends) {
+  DVLOG(2) << __func__ << "(" << parallel_track_appends << ")";
+  parallel_track_appends_ = parallel_track_appends;
+}
+
 MseTrackBuffer* FrameProcessor::FindTrack(StreamParser::TrackId id) {
   auto itr = track_buffers_.find(id);
   if (itr == track_buffers_.end())
@@ -496,6 +517,9 @@ void FrameProcessor::NotifyStartOfCodedFrameGroup(DecodeTimestamp start_dts,
 bool FrameProcessor::FlushProcessedFrames() {
   DVLOG(2) << __func__ << "()";
 
+  if (parallel_track_appends_)
+    return FlushProcessedFramesInParallel();
+
   bool result = true;
   for (auto itr = track_buffers_.begin(); itr != track_buffers_.end(); ++itr) {
     if (!itr->second->FlushProcessedFrames())
@@ -505,6 +529,29 @@ bool FrameProcessor::FlushProcessedFrames() {
   return result;
 }
 
+bool FrameProcessor::FlushProcessedFramesInParallel() {
+  std::vector<MseTrackBuffer*> track_buffers;
+  for (const auto& itr : track_buffers_) {
+    if (itr.second->has_processed_frames())
+      track_buffers.push_back(itr.second.get());
+  }
+  if (track_buffers.empty())
+    return true;
+
+  // Each track buffer appends to its own stream, and ChunkDemuxerStream::Append
+  // is thread-safe, so the appends are independent.  This runs under
+  // ChunkDemuxer's lock, so any append that no worker has started yet is done
+  // here rather than waited for.
+  const size_t count = track_buffers.size();
+  std::unique_ptr<bool[]> results(new bool[count]);
+  RunInParallel(count, base::Bind(&FlushProcessedFramesOfTrack,
+                                  base::Unretained(&track_buffers),
+                                  base::Unretained(results.get())));
+
+  return std::all_of(results.get(), results.get() + count,
+                     [](bool result) { return result; });
+}
+
 bool FrameProcessor::HandlePartialAppendWindowTrimming(
     base::TimeDelta append_window_start,
     base::TimeDelta append_window_end,
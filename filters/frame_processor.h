@@ -88,6 +88,14 @@ class MEDIA_EXPORT FrameProcessor {
   // preroll buffers.
   void OnPossibleAudioConfigUpdate(const AudioDecoderConfig& config);
 
+  // If true, the processed frames of each track are appended to their streams
+  // concurrently, on the worker pool as well as the calling thread, whenever
+  // more than one track has frames to append.  See RunInParallel(): the
+  // calling thread never waits for an append that no worker has started.
+  // Coded frame processing itself stays serial, since discontinuities in one
+  // track affect every other.  False by default.
+  void SetParallelTrackAppends(bool parallel_track_appends);
+
  private:
   friend class FrameProcessorTest;
 
@@ -105,6 +113,9 @@ class MEDIA_EXPORT FrameProcessor {
   // more of the appends failed.
   bool FlushProcessedFrames();
 
+  // FlushProcessedFrames() for |parallel_track_appends_|.
+  bool FlushProcessedFramesInParallel();
+
   // Handles partial append window trimming of |buffer|.  Returns true if the
   // given |buffer| can be partially trimmed or have preroll added; otherwise,
   // returns false.
@@ -153,6 +164,9 @@ class MEDIA_EXPORT FrameProcessor {
   // set to false ("segments").
   bool sequence_mode_ = false;
 
+  // See SetParallelTrackAppends().
+  bool parallel_track_appends_ = false;
+
   // Tracks whether or not we need to notify all track buffers of a new coded
   // frame group (see https://w3c.github.io/media-source/#coded-frame-group)
   // upon the next successfully processed frame.  Set true initially and upon
@@ -0,0 +1,134 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/time/time.h"
+#include "media/base/audio_decoder_config.h"
+#include "media/base/media_log.h"
+#include "media/base/media_util.h"
+#include "media/base/stream_parser_buffer.h"
+#include "media/base/test_helpers.h"
+#include "media/base/timestamp_constants.h"
+#include "media/filters/chunk_demuxer.h"
+#include "media/filters/frame_processor.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+// Two minutes of one second appends of a 30 fps video track and 20 ms audio
+// frames on every other track, as for a stream with several audio languages.
+static const int kAppends = 120;
+static const int kVideoFramesPerAppend = 30;
+static const int kAudioFramesPerAppend = 50;
+static const int kVideoFrameSize = 4096;
+static const int kAudioFrameSize = 256;
+
+static const int kTrackCounts[] = {2, 4, 8};
+
+static void OnUpdateDuration(base::TimeDelta duration) {}
+
+static base::TimeDelta FrameTime(int frame, int frames_per_second) {
+  return base::TimeDelta::FromMicroseconds(
+      frame * base::Time::kMicrosecondsPerSecond / frames_per_second);
+}
+
+// Returns the frames of append |append| for track |track_id| in decode order.
+// Video frames form one GOP with an IPBB...B pattern; audio frames are all
+// keyframes.
+static StreamParser::BufferQueue CreateAppend(int append,
+                                              StreamParser::TrackId track_id,
+                                              bool video) {
+  static const uint8_t kData[kVideoFrameSize] = {};
+  const int frames = video ? kVideoFramesPerAppend : kAudioFramesPerAppend;
+  const int first_frame = append * frames;
+  StreamParser::BufferQueue buffers;
+  for (int i = 0; i < frames; ++i) {
+    scoped_refptr<StreamParserBuffer> buffer = StreamParserBuffer::CopyFrom(
+        kData, video ? kVideoFrameSize : kAudioFrameSize, !video || i == 0,
+        video ? DemuxerStream::VIDEO : DemuxerStream::AUDIO, track_id);
+    buffer->SetDecodeTimestamp(DecodeTimestamp::FromPresentationTime(
+        FrameTime(first_frame + i, frames)));
+    int presentation_frame = first_frame + i;
+    if (video && i == 1)
+      presentation_frame = first_frame + frames - 1;
+    else if (video && i > 1)
+      presentation_frame = first_frame + i - 1;
+    buffer->set_timestamp(FrameTime(presentation_frame, frames));
+    buffer->set_duration(FrameTime(1, frames));
+    buffers.push_back(buffer);
+  }
+  return buffers;
+}
+
+// Appends all of the media for |track_count| tracks, one of them video, and
+// reports the time per append.
+static void RunMultiTrackAppendBenchmark(int track_count,
+                                         bool parallel_track_appends) {
+  MediaLog media_log;
+  FrameProcessor frame_processor(base::Bind(&OnUpdateDuration), &media_log,
+                                 ChunkDemuxerStream::RangeApi::kNewByPts);
+  frame_processor.SetParallelTrackAppends(parallel_track_appends);
+
+  AudioDecoderConfig audio_config(kCodecOpus, kSampleFormatF32,
+                                  CHANNEL_LAYOUT_STEREO, 48000,
+                                  EmptyExtraData(), Unencrypted());
+  frame_processor.OnPossibleAudioConfigUpdate(audio_config);
+
+  std::vector<std::unique_ptr<ChunkDemuxerStream>> streams;
+  for (int i = 0; i < track_count; ++i) {
+    const bool video = i == 0;
+    streams.push_back(base::MakeUnique<ChunkDemuxerStream>(
+        video ? DemuxerStream::VIDEO : DemuxerStream::AUDIO,
+        std::to_string(i), ChunkDemuxerStream::RangeApi::kNewByPts));
+    if (video) {
+      CHECK(streams[i]->UpdateVideoConfig(TestVideoConfig::Normal(),
+                                          &media_log));
+    } else {
+      CHECK(streams[i]->UpdateAudioConfig(audio_config, &media_log));
+    }
+    CHECK(frame_processor.AddTrack(i, streams[i].get()));
+  }
+
+  base::TimeDelta timestamp_offset;
+  base::TimeDelta append_time;
+  for (int append = 0; append < kAppends; ++append) {
+    StreamParser::BufferQueueMap buffer_queue_map;
+    for (int i = 0; i < track_count; ++i) {
+      buffer_queue_map.insert(
+          std::make_pair(i, CreateAppend(append, i, i == 0)));
+    }
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    CHECK(frame_processor.ProcessFrames(buffer_queue_map, base::TimeDelta(),
+                                        kInfiniteDuration, &timestamp_offset));
+    append_time += base::TimeTicks::Now() - start;
+  }
+
+  perf_test::PrintResult(
+      "frame_processor_append", parallel_track_appends ? "_parallel" : "",
+      std::to_string(track_count) + "_tracks",
+      append_time.InMicrosecondsF() / kAppends, "us/append", true);
+}
+
+// Benchmark appends covering several tracks, with each track's frames
+// appended one after another and concurrently.
+TEST(FrameProcessorPerfTest, MultiTrackAppend) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  for (int track_count : kTrackCounts) {
+    RunMultiTrackAppendBenchmark(track_count, false);
+    RunMultiTrackAppendBenchmark(track_count, true);
+  }
+}
+
+}  // namespace media
@@ -12,11 +12,11 @@
 #include "base/bind.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
-#include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "base/test/scoped_task_environment.h"
 #include "base/time/time.h"
 #include "media/base/media_log.h"
 #include "media/base/media_util.h"
@@ -37,8 +37,11 @@ namespace {
 struct FrameProcessorTestParams {
  public:
   FrameProcessorTestParams(const bool use_sequence_mode,
-                           const media::ChunkDemuxerStream::RangeApi range_api)
-      : use_sequence_mode(use_sequence_mode), range_api(range_api) {}
+                           const media::ChunkDemuxerStream::RangeApi range_api,
+                           const bool parallel_track_appends = false)
+      : use_sequence_mode(use_sequence_mode),
+        range_api(range_api),
+        parallel_track_appends(parallel_track_appends) {}
 
   // Test will use 'sequence' append mode if true, or 'segments' if false.
   const bool use_sequence_mode;
@@ -46,6 +49,9 @@ struct FrameProcessorTestParams {
   // Determines if media::kMseBufferByPts feature should be forced on or off for
   // the test, and is also used in tests' ChunkDemuxerStream constructions.
   const media::ChunkDemuxerStream::RangeApi range_api;
+
+  // Test will append each track's frames on the worker pool if true.
+  const bool parallel_track_appends;
 };
 
 // Helper to shorten "base::TimeDelta::FromMilliseconds(...)" in these test
@@ -103,6 +109,7 @@ class FrameProcessorTest
     frame_processor_->SetParseWarningCallback(
         base::Bind(&FrameProcessorTestCallbackHelper::OnParseWarning,
                    base::Unretained(&callbacks_)));
+    frame_processor_->SetParallelTrackAppends(params.parallel_track_appends);
   }
 
   enum StreamFlags {
@@ -303,7 +310,7 @@ class FrameProcessorTest
     stream->StartReturningData();
   }
 
-  base::MessageLoop message_loop_;
+  base::test::ScopedTaskEnvironment scoped_task_environment_;
   StrictMock<MockMediaLog> media_log_;
   StrictMock<FrameProcessorTestCallbackHelper> callbacks_;
 
@@ -1224,5 +1231,17 @@ INSTANTIATE_TEST_CASE_P(
     FrameProcessorTest,
     Values(FrameProcessorTestParams(false,
                                     ChunkDemuxerStream::RangeApi::kNewByPts)));
+INSTANTIATE_TEST_CASE_P(
+    SequenceModeNewByPtsParallel,
+    FrameProcessorTest,
+    Values(FrameProcessorTestParams(true,
+                                    ChunkDemuxerStream::RangeApi::kNewByPts,
+                                    true)));
+INSTANTIATE_TEST_CASE_P(
+    SegmentsModeNewByPtsParallel,
+    FrameProcessorTest,
+    Values(FrameProcessorTestParams(false,
+                                    ChunkDemuxerStream::RangeApi::kNewByPts,
+                                    true)));
 
 }  // namespace media
@@ -0,0 +1,259 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/read_ahead_data_source.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/task_scheduler/post_task.h"
+
+namespace media {
+
+ReadAheadDataSource::Chunk::Chunk(int64_t position,
+                                  std::unique_ptr<uint8_t[]> data,
+                                  int size)
+    : position(position), data(std::move(data)), size(size) {}
+
+ReadAheadDataSource::Chunk::Chunk(Chunk&& other) = default;
+
+ReadAheadDataSource::Chunk::~Chunk() {}
+
+ReadAheadDataSource::ReadAheadDataSource(DataSource* data_source,
+                                         int window_size)
+    : data_source_(data_source),
+      window_size_(window_size),
+      fetch_size_(std::max(window_size / 4, 1)) {
+  DCHECK(data_source_);
+  DCHECK_GT(window_size_, 0);
+}
+
+ReadAheadDataSource::~ReadAheadDataSource() {}
+
+void ReadAheadDataSource::Read(int64_t position,
+                               int size,
+                               uint8_t* data,
+                               const DataSource::ReadCB& read_cb) {
+  DCHECK(!read_cb.is_null());
+  DCHECK_GE(position, 0);
+  DCHECK_GE(size, 0);
+
+  DataSource::ReadCB served_cb;
+  int result = kReadError;
+  bool fetch = false;
+  {
+    base::AutoLock auto_lock(lock_);
+    DCHECK(read_cb_.is_null());
+    if (stopped_) {
+      served_cb = read_cb;
+    } else {
+      read_position_ = position;
+      read_size_ = size;
+      read_data_ = data;
+      read_cb_ = read_cb;
+      prefetch_ = true;
+      served_cb = ServePendingRead_Locked(&result);
+      fetch = ShouldFetch_Locked();
+    }
+  }
+
+  if (!served_cb.is_null()) {
+    served_cb.Run(result);
+
+    // Refill the window off this thread, so that a DataSource which reads
+    // synchronously does not hold up the reader.
+    if (fetch) {
+      base::PostTaskWithTraits(
+          FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_BLOCKING},
+          base::BindOnce(&ReadAheadDataSource::FetchIfNeeded, this));
+    }
+    return;
+  }
+
+  // The read is waiting on a fetch, so start it straight away.
+  if (fetch)
+    FetchIfNeeded();
+}
+
+void ReadAheadDataSource::Stop() {
+  DataSource::ReadCB read_cb;
+  {
+    base::AutoLock auto_lock(lock_);
+    stopped_ = true;
+    if (!read_cb_.is_null())
+      read_cb = base::ResetAndReturn(&read_cb_);
+  }
+
+  {
+    base::AutoLock auto_lock(data_source_lock_);
+    if (data_source_) {
+      data_source_->Stop();
+      data_source_ = nullptr;
+    }
+  }
+
+  if (!read_cb.is_null())
+    read_cb.Run(kReadError);
+}
+
+void ReadAheadDataSource::Abort() {
+  DataSource::ReadCB read_cb;
+  {
+    base::AutoLock auto_lock(lock_);
+    prefetch_ = false;
+    if (!read_cb_.is_null())
+      read_cb = base::ResetAndReturn(&read_cb_);
+  }
+
+  {
+    base::AutoLock auto_lock(data_source_lock_);
+    if (data_source_)
+      data_source_->Abort();
+  }
+
+  if (!read_cb.is_null())
+    read_cb.Run(kAborted);
+}
+
+bool ReadAheadDataSource::GetSize(int64_t* size_out) {
+  base::AutoLock auto_lock(data_source_lock_);
+  return data_source_ && data_source_->GetSize(size_out);
+}
+
+bool ReadAheadDataSource::IsStreaming() {
+  base::AutoLock auto_lock(data_source_lock_);
+  return data_source_ && data_source_->IsStreaming();
+}
+
+void ReadAheadDataSource::SetBitrate(int bitrate) {
+  base::AutoLock auto_lock(data_source_lock_);
+  if (data_source_)
+    data_source_->SetBitrate(bitrate);
+}
+
+DataSource::ReadCB ReadAheadDataSource::ServePendingRead_Locked(int* result) {
+  lock_.AssertAcquired();
+  DCHECK(!read_cb_.is_null());
+
+  if (end_of_stream_ >= 0 && read_position_ >= end_of_stream_) {
+    *result = 0;
+    return base::ResetAndReturn(&read_cb_);
+  }
+
+  if (chunks_.empty() || read_position_ < chunks_.front().position ||
+      read_position_ >= fetched_end_) {
+    // A miss.  Once nothing is in flight, start over from the read.
+    if (!fetch_pending_) {
+      DVLOG(2) << __func__ << ": missed at " << read_position_;
+      chunks_.clear();
+      fetched_end_ = read_position_;
+    }
+    read_end_ = read_position_;
+    return DataSource::ReadCB();
+  }
+
+  // Copy what is fetched, which may be less than was asked for.
+  int copied = 0;
+  for (const Chunk& chunk : chunks_) {
+    const int64_t position = read_position_ + copied;
+    if (copied == read_size_)
+      break;
+    if (chunk.position + chunk.size <= position)
+      continue;
+    const int offset = position - chunk.position;
+    const int size = std::min(read_size_ - copied, chunk.size - offset);
+    memcpy(read_data_ + copied, chunk.data.get() + offset, size);
+    copied += size;
+  }
+  read_end_ = read_position_ + copied;
+
+  // Drop the chunks that have been read past.
+  while (!chunks_.empty() &&
+         chunks_.front().position + chunks_.front().size <= read_end_) {
+    chunks_.pop_front();
+  }
+
+  *result = copied;
+  return base::ResetAndReturn(&read_cb_);
+}
+
+bool ReadAheadDataSource::ShouldFetch_Locked() const {
+  lock_.AssertAcquired();
+  if (stopped_ || fetch_pending_ || !prefetch_)
+    return false;
+  if (end_of_stream_ >= 0 && fetched_end_ >= end_of_stream_)
+    return false;
+  return !read_cb_.is_null() || fetched_end_ - read_end_ < window_size_;
+}
+
+void ReadAheadDataSource::FetchIfNeeded() {
+  int64_t position;
+  uint8_t* data;
+  {
+    base::AutoLock auto_lock(lock_);
+    if (!ShouldFetch_Locked())
+      return;
+    fetch_pending_ = true;
+    fetch_data_.reset(new uint8_t[fetch_size_]);
+    position = fetched_end_;
+    data = fetch_data_.get();
+  }
+
+  base::AutoLock auto_lock(data_source_lock_);
+  if (!data_source_) {
+    OnFetchDone(kReadError);
+    return;
+  }
+  data_source_->Read(position, fetch_size_, data,
+                     base::Bind(&ReadAheadDataSource::OnFetchDone, this));
+}
+
+void ReadAheadDataSource::OnFetchDone(int bytes_read) {
+  DataSource::ReadCB read_cb;
+  int result = bytes_read;
+  bool fetch = false;
+  {
+    base::AutoLock auto_lock(lock_);
+    DCHECK(fetch_pending_);
+    fetch_pending_ = false;
+    if (bytes_read > 0) {
+      chunks_.emplace_back(fetched_end_, std::move(fetch_data_), bytes_read);
+      fetched_end_ += bytes_read;
+    } else {
+      fetch_data_.reset();
+      if (bytes_read == 0)
+        end_of_stream_ = fetched_end_;
+      else
+        prefetch_ = false;
+    }
+
+    if (!read_cb_.is_null()) {
+      // A failed fetch fails the read waiting on it.
+      if (bytes_read < 0)
+        read_cb = base::ResetAndReturn(&read_cb_);
+      else
+        read_cb = ServePendingRead_Locked(&result);
+    }
+    fetch = ShouldFetch_Locked();
+  }
+
+  // |data_source_| may be running this with its own lock held, so issue the
+  // next fetch from elsewhere.
+  if (fetch) {
+    base::PostTaskWithTraits(
+        FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_BLOCKING},
+        base::BindOnce(&ReadAheadDataSource::FetchIfNeeded, this));
+  }
+
+  if (!read_cb.is_null())
+    read_cb.Run(result);
+}
+
+}  // namespace media
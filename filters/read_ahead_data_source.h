@@ -0,0 +1,122 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_FILTERS_READ_AHEAD_DATA_SOURCE_H_
+#define MEDIA_FILTERS_READ_AHEAD_DATA_SOURCE_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "media/base/data_source.h"
+
+namespace media {
+
+// A DataSource which keeps a window of another DataSource's bytes, past the end
+// of the last read, fetched ahead of time and serves reads from it whenever it
+// can.  FFmpeg reads through BlockingUrlProtocol in small pieces, each of which
+// would otherwise block the demuxing thread on a round trip to the wrapped
+// DataSource.  With this in between, only reads which miss the window (e.g.
+// after a seek) wait on the wrapped DataSource, and the window is refilled from
+// the worker pool while FFmpeg works on what it has already read.
+//
+// Reference counted so that fetches still in flight keep their buffers alive.
+// Like other DataSources, only one Read() may be outstanding at a time.
+class MEDIA_EXPORT ReadAheadDataSource
+    : public DataSource,
+      public base::RefCountedThreadSafe<ReadAheadDataSource> {
+ public:
+  // Reads from |data_source|, which must stay alive until Stop() is called,
+  // keeping up to |window_size| bytes past the last read fetched.  Each fetch
+  // is a quarter of the window.
+  ReadAheadDataSource(DataSource* data_source, int window_size);
+
+  // DataSource implementation.
+  void Read(int64_t position,
+            int size,
+            uint8_t* data,
+            const DataSource::ReadCB& read_cb) override;
+  void Stop() override;
+  void Abort() override;
+  bool GetSize(int64_t* size_out) override;
+  bool IsStreaming() override;
+  void SetBitrate(int bitrate) override;
+
+ private:
+  friend class base::RefCountedThreadSafe<ReadAheadDataSource>;
+  ~ReadAheadDataSource() override;
+
+  // Bytes fetched from |data_source_|, starting at |position|.
+  struct Chunk {
+    Chunk(int64_t position, std::unique_ptr<uint8_t[]> data, int size);
+    Chunk(Chunk&& other);
+    ~Chunk();
+
+    int64_t position;
+    std::unique_ptr<uint8_t[]> data;
+    int size;
+  };
+
+  // If the bytes at the pending read's position are fetched, or it is at the
+  // end of the stream, copies them out and returns the read's callback with
+  // |*result| set to what it should be run with.  Otherwise returns a null
+  // callback, moving the window to the read if no fetch is in flight.
+  DataSource::ReadCB ServePendingRead_Locked(int* result);
+
+  // Returns true if a fetch should be started.
+  bool ShouldFetch_Locked() const;
+
+  // Fetches the bytes following those already fetched, if that is still
+  // needed by the time this runs.
+  void FetchIfNeeded();
+  void OnFetchDone(int bytes_read);
+
+  // Guards |data_source_|, so that Stop() ensures no further use of it.  Never
+  // acquired while holding |lock_|, as |data_source_| may complete fetches
+  // synchronously.
+  base::Lock data_source_lock_;
+  DataSource* data_source_;
+
+  const int window_size_;
+  const int fetch_size_;
+
+  // Guards the members below.
+  base::Lock lock_;
+
+  // Fetched bytes, which are contiguous and end at |fetched_end_|.
+  base::circular_deque<Chunk> chunks_;
+  int64_t fetched_end_ = 0;
+
+  // The end of the last read served; the window runs from here.
+  int64_t read_end_ = 0;
+
+  // Position known to be the end of the stream, or -1.
+  int64_t end_of_stream_ = -1;
+
+  // Buffer for the fetch in flight, if there is one.
+  bool fetch_pending_ = false;
+  std::unique_ptr<uint8_t[]> fetch_data_;
+
+  // Whether to fill the window without a read waiting.  Cleared when a fetch
+  // fails or reads are aborted, until the next Read().
+  bool prefetch_ = false;
+
+  bool stopped_ = false;
+
+  // The pending read, if |read_cb_| is set.
+  int64_t read_position_ = 0;
+  int read_size_ = 0;
+  uint8_t* read_data_ = nullptr;
+  DataSource::ReadCB read_cb_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadAheadDataSource);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_FILTERS_READ_AHEAD_DATA_SOURCE_H_
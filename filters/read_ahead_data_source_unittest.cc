@@ -0,0 +1,268 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/read_ahead_data_source.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/macros.h"
+#include "base/test/scoped_task_environment.h"
+#include "media/filters/memory_data_source.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kDataSize = 10000;
+static const int kWindowSize = 1024;
+static const int kFetchSize = kWindowSize / 4;
+
+// Completes reads of |data| only when told to, as a remote DataSource would.
+class DeferredDataSource : public DataSource {
+ public:
+  explicit DeferredDataSource(const std::vector<uint8_t>& data)
+      : memory_data_source_(data.data(), data.size()) {}
+  ~DeferredDataSource() override {}
+
+  // DataSource implementation.
+  void Read(int64_t position,
+            int size,
+            uint8_t* data,
+            const DataSource::ReadCB& read_cb) override {
+    CHECK(!has_pending_read());
+    read_position_ = position;
+    read_size_ = size;
+    read_data_ = data;
+    read_cb_ = read_cb;
+    ++reads_;
+  }
+  void Stop() override {
+    memory_data_source_.Stop();
+    if (has_pending_read())
+      base::ResetAndReturn(&read_cb_).Run(kReadError);
+  }
+  void Abort() override {
+    if (has_pending_read())
+      base::ResetAndReturn(&read_cb_).Run(kAborted);
+  }
+  bool GetSize(int64_t* size_out) override {
+    return memory_data_source_.GetSize(size_out);
+  }
+  bool IsStreaming() override { return false; }
+  void SetBitrate(int bitrate) override {}
+
+  void CompleteRead() {
+    CHECK(has_pending_read());
+    memory_data_source_.Read(read_position_, read_size_, read_data_,
+                             base::ResetAndReturn(&read_cb_));
+  }
+
+  void FailRead() {
+    CHECK(has_pending_read());
+    base::ResetAndReturn(&read_cb_).Run(kReadError);
+  }
+
+  bool has_pending_read() const { return !read_cb_.is_null(); }
+  int64_t read_position() const { return read_position_; }
+  int reads() const { return reads_; }
+
+ private:
+  MemoryDataSource memory_data_source_;
+
+  int64_t read_position_ = 0;
+  int read_size_ = 0;
+  uint8_t* read_data_ = nullptr;
+  DataSource::ReadCB read_cb_;
+  int reads_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredDataSource);
+};
+
+class ReadAheadDataSourceTest : public testing::Test {
+ public:
+  ReadAheadDataSourceTest() : data_(kDataSize), data_source_(data_) {
+    for (int i = 0; i < kDataSize; ++i)
+      data_[i] = i % 251;
+    read_ahead_data_source_ =
+        new ReadAheadDataSource(&data_source_, kWindowSize);
+  }
+
+  ~ReadAheadDataSourceTest() override { read_ahead_data_source_->Stop(); }
+
+  MOCK_METHOD1(ReadCB, void(int size));
+
+ protected:
+  // Starts reading |size| bytes at |position| into |buffer_|.
+  void Read(int64_t position, int size) {
+    buffer_.assign(size, 0);
+    read_position_ = position;
+    read_ahead_data_source_->Read(
+        position, size, buffer_.data(),
+        base::Bind(&ReadAheadDataSourceTest::ReadCB, base::Unretained(this)));
+  }
+
+  // Checks that the first |size| bytes of |buffer_| were read correctly.
+  void ExpectReadData(int size) {
+    EXPECT_EQ(0, memcmp(data_.data() + read_position_, buffer_.data(), size));
+  }
+
+  // Completes |data_source_|'s reads until it has none left.
+  void CompleteReads() {
+    scoped_task_environment_.RunUntilIdle();
+    while (data_source_.has_pending_read()) {
+      data_source_.CompleteRead();
+      scoped_task_environment_.RunUntilIdle();
+    }
+  }
+
+  base::test::ScopedTaskEnvironment scoped_task_environment_;
+  std::vector<uint8_t> data_;
+  DeferredDataSource data_source_;
+  scoped_refptr<ReadAheadDataSource> read_ahead_data_source_;
+  std::vector<uint8_t> buffer_;
+  int64_t read_position_ = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ReadAheadDataSourceTest);
+};
+
+TEST_F(ReadAheadDataSourceTest, FillsWindowAfterRead) {
+  Read(0, 100);
+  ASSERT_TRUE(data_source_.has_pending_read());
+  EXPECT_EQ(0, data_source_.read_position());
+
+  EXPECT_CALL(*this, ReadCB(100));
+  data_source_.CompleteRead();
+  ExpectReadData(100);
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // The window past the read is fetched one piece after another...
+  CompleteReads();
+  EXPECT_EQ(5, data_source_.reads());
+
+  // ...and serves reads straight away.
+  for (int position = 100; position + 100 <= kWindowSize; position += 100) {
+    EXPECT_CALL(*this, ReadCB(100));
+    Read(position, 100);
+    testing::Mock::VerifyAndClearExpectations(this);
+    ExpectReadData(100);
+  }
+  CompleteReads();
+}
+
+TEST_F(ReadAheadDataSourceTest, SequentialReads) {
+  int64_t position = 0;
+  int size = 0;
+  EXPECT_CALL(*this, ReadCB(testing::_))
+      .WillRepeatedly(testing::SaveArg<0>(&size));
+  do {
+    size = DataSource::kReadError;
+    Read(position, 300);
+    CompleteReads();
+    ASSERT_GE(size, 0);
+    ExpectReadData(size);
+    position += size;
+  } while (size > 0);
+  EXPECT_EQ(kDataSize, position);
+
+  // Every byte was fetched once, plus the final read at the end of the stream.
+  EXPECT_EQ((kDataSize + kFetchSize - 1) / kFetchSize + 1,
+            data_source_.reads());
+}
+
+TEST_F(ReadAheadDataSourceTest, ReadOutsideWindow) {
+  EXPECT_CALL(*this, ReadCB(100)).Times(2);
+  Read(0, 100);
+  data_source_.CompleteRead();
+  scoped_task_environment_.RunUntilIdle();
+
+  // A read away from the window waits for the fetch in flight, then starts a
+  // new window at the read.
+  Read(5000, 100);
+  ASSERT_TRUE(data_source_.has_pending_read());
+  EXPECT_EQ(kFetchSize, data_source_.read_position());
+  data_source_.CompleteRead();
+  scoped_task_environment_.RunUntilIdle();
+  ASSERT_TRUE(data_source_.has_pending_read());
+  EXPECT_EQ(5000, data_source_.read_position());
+  data_source_.CompleteRead();
+  ExpectReadData(100);
+  CompleteReads();
+
+  // Reads before the window miss as well.
+  EXPECT_CALL(*this, ReadCB(100));
+  Read(4000, 100);
+  EXPECT_EQ(4000, data_source_.read_position());
+  data_source_.CompleteRead();
+  ExpectReadData(100);
+}
+
+TEST_F(ReadAheadDataSourceTest, ShortReadAtWindowEnd) {
+  EXPECT_CALL(*this, ReadCB(100));
+  Read(0, 100);
+  data_source_.CompleteRead();
+  CompleteReads();
+
+  // Reads running past what has been fetched return what there is.
+  EXPECT_CALL(*this, ReadCB(kFetchSize * 5 - 1200));
+  Read(1200, 1000);
+  ExpectReadData(kFetchSize * 5 - 1200);
+}
+
+TEST_F(ReadAheadDataSourceTest, EndOfStream) {
+  EXPECT_CALL(*this, ReadCB(100));
+  Read(kDataSize - 100, 100);
+  data_source_.CompleteRead();
+  CompleteReads();
+
+  EXPECT_CALL(*this, ReadCB(0));
+  Read(kDataSize, 100);
+  CompleteReads();
+}
+
+TEST_F(ReadAheadDataSourceTest, ReadError) {
+  Read(0, 100);
+  EXPECT_CALL(*this, ReadCB(DataSource::kReadError));
+  data_source_.FailRead();
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // Failed fetches are retried by the next read.
+  EXPECT_CALL(*this, ReadCB(100));
+  Read(0, 100);
+  data_source_.CompleteRead();
+  ExpectReadData(100);
+}
+
+TEST_F(ReadAheadDataSourceTest, Abort) {
+  Read(0, 100);
+  EXPECT_CALL(*this, ReadCB(DataSource::kAborted));
+  read_ahead_data_source_->Abort();
+  EXPECT_FALSE(data_source_.has_pending_read());
+  testing::Mock::VerifyAndClearExpectations(this);
+
+  // Aborts only affect current reads.
+  EXPECT_CALL(*this, ReadCB(100));
+  Read(0, 100);
+  data_source_.CompleteRead();
+  ExpectReadData(100);
+}
+
+TEST_F(ReadAheadDataSourceTest, Stop) {
+  Read(0, 100);
+  EXPECT_CALL(*this, ReadCB(DataSource::kReadError)).Times(2);
+  read_ahead_data_source_->Stop();
+  EXPECT_FALSE(data_source_.has_pending_read());
+
+  int64_t size;
+  EXPECT_FALSE(read_ahead_data_source_->GetSize(&size));
+  Read(0, 100);
+  CompleteReads();
+}
+
+}  // namespace media
@@ -5,7 +5,11 @@
 #ifndef MEDIA_FILTERS_SOURCE_BUFFER_RANGE_H_
 #define MEDIA_FILTERS_SOURCE_BUFFER_RANGE_H_
 
+#include <algorithm>
+#include <utility>
+
 #include "base/callback.h"
+#include "base/containers/circular_deque.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "media/base/media_export.h"
@@ -98,6 +102,71 @@ class MEDIA_EXPORT SourceBufferRange {
   // Friend of protected is only for IsNextInPresentationSequence testing.
   friend class SourceBufferStreamTest;
 
+  // Sorted index from the timestamp of each keyframe in a range to the
+  // position of its GOP, with the subset of the std::map interface the ranges
+  // use. Entries are held contiguously and found by binary search, and since
+  // keyframes are almost always appended in order and GOPs are evicted from
+  // the front or back, inserting and erasing normally take constant time.
+  // Timestamps are unique; inserting an existing one is a no-op.
+  template <typename TimestampType>
+  class KeyframeIndex {
+   public:
+    using value_type = std::pair<TimestampType, int>;
+    using iterator = typename base::circular_deque<value_type>::iterator;
+    using const_iterator =
+        typename base::circular_deque<value_type>::const_iterator;
+
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    iterator lower_bound(TimestampType timestamp) {
+      return std::lower_bound(
+          entries_.begin(), entries_.end(), timestamp,
+          [](const value_type& entry, TimestampType timestamp) {
+            return entry.first < timestamp;
+          });
+    }
+
+    iterator upper_bound(TimestampType timestamp) {
+      return std::upper_bound(
+          entries_.begin(), entries_.end(), timestamp,
+          [](TimestampType timestamp, const value_type& entry) {
+            return timestamp < entry.first;
+          });
+    }
+
+    void insert(const value_type& entry) {
+      if (entries_.empty() || entries_.back().first < entry.first) {
+        entries_.push_back(entry);
+        return;
+      }
+      iterator itr = lower_bound(entry.first);
+      if (itr->first != entry.first)
+        entries_.insert(itr, entry);
+    }
+
+    void erase(iterator itr) {
+      if (itr == entries_.begin())
+        entries_.pop_front();
+      else
+        entries_.erase(itr);
+    }
+
+    void erase(iterator first, iterator last) {
+      if (first == entries_.begin() && last == entries_.end())
+        entries_.clear();
+      else
+        entries_.erase(first, last);
+    }
+
+   private:
+    base::circular_deque<value_type> entries_;
+  };
+
   // Called during AppendBuffersToEnd to adjust estimated duration at the
   // end of the last append to match the delta in timestamps between
   // the last append and the upcoming append. This is a workaround for
@@ -6,7 +6,6 @@
 #define MEDIA_FILTERS_SOURCE_BUFFER_RANGE_BY_DTS_H_
 
 #include <stddef.h>
-#include <map>
 #include <memory>
 
 #include "media/filters/source_buffer_range.h"
@@ -171,7 +170,7 @@ class MEDIA_EXPORT SourceBufferRangeByDts : public SourceBufferRange {
                          BufferQueue* buffers);
 
  private:
-  typedef std::map<DecodeTimestamp, int> KeyframeMap;
+  using KeyframeMap = KeyframeIndex<DecodeTimestamp>;
 
   // Helper method to delete buffers in |buffers_| starting at
   // |starting_point|, an iterator in |buffers_|.
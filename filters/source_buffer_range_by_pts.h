@@ -6,8 +6,8 @@
 #define MEDIA_FILTERS_SOURCE_BUFFER_RANGE_BY_PTS_H_
 
 #include <stddef.h>
-#include <map>
 #include <memory>
+#include <string>
 
 #include "media/filters/source_buffer_range.h"
 
@@ -172,7 +172,7 @@ class MEDIA_EXPORT SourceBufferRangeByPts : public SourceBufferRange {
                          BufferQueue* buffers);
 
  private:
-  typedef std::map<base::TimeDelta, int> KeyframeMap;
+  using KeyframeMap = KeyframeIndex<base::TimeDelta>;
 
   // Returns an index (or iterator) into |buffers_| pointing to the first buffer
   // at or after |timestamp|.  If |skip_given_timestamp| is true, this returns
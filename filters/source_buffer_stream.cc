@@ -12,6 +12,8 @@
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/time/time.h"
 #include "base/trace_event/trace_event.h"
 #include "media/base/demuxer_memory_limit.h"
 #include "media/base/media_switches.h"
@@ -45,6 +47,36 @@ const int kMaxAudioSpliceLogs = 20;
 // work or other side-effects.
 const int kMaxStrangeSameTimestampsLogs = 20;
 
+// With kIncrementalSourceBufferGC, garbage collection still starts once an
+// append would take the buffered data past the effective memory limit, but
+// then frees down to this percentage of it (the low watermark), so the next
+// few appends fit without collecting again. Each call frees at most
+// kGarbageCollectionBudgetPercent of the memory limit, though at least one GOP,
+// beyond what the append needs to fit under the memory limit itself, so
+// evicting a large backlog is spread over many appends.
+const int kGarbageCollectionLowWatermarkPercent = 90;
+const int kGarbageCollectionBudgetPercent = 5;
+
+void RecordGarbageCollectionTime(SourceBufferStreamType type,
+                                 base::TimeDelta elapsed) {
+  // UMA_HISTOGRAM_* macros need a constant name at each call site.
+  const int elapsed_us = static_cast<int>(elapsed.InMicroseconds());
+  switch (type) {
+    case SourceBufferStreamType::kAudio:
+      UMA_HISTOGRAM_CUSTOM_COUNTS("Media.MSE.GarbageCollectionTime.Audio",
+                                  elapsed_us, 1, 1000000, 50);
+      break;
+    case SourceBufferStreamType::kVideo:
+      UMA_HISTOGRAM_CUSTOM_COUNTS("Media.MSE.GarbageCollectionTime.Video",
+                                  elapsed_us, 1, 1000000, 50);
+      break;
+    case SourceBufferStreamType::kText:
+      UMA_HISTOGRAM_CUSTOM_COUNTS("Media.MSE.GarbageCollectionTime.Text",
+                                  elapsed_us, 1, 1000000, 50);
+      break;
+  }
+}
+
 // Helper method that returns true if |ranges| is sorted in increasing order,
 // false otherwise.
 bool IsRangeListSorted(
@@ -853,11 +885,22 @@ bool SourceBufferStream<RangeClass>::GarbageCollectIfNeeded(
   if (ranges_size + newDataSize <= effective_memory_limit)
     return true;
 
+  const base::TimeTicks gc_start = base::TimeTicks::Now();
+
   size_t bytes_over_hard_memory_limit = 0;
   if (ranges_size + newDataSize > memory_limit_)
     bytes_over_hard_memory_limit = ranges_size + newDataSize - memory_limit_;
 
   size_t bytes_to_free = ranges_size + newDataSize - effective_memory_limit;
+  if (base::FeatureList::IsEnabled(kIncrementalSourceBufferGC)) {
+    const size_t low_watermark =
+        effective_memory_limit * kGarbageCollectionLowWatermarkPercent / 100;
+    const size_t budget =
+        std::max<size_t>(memory_limit_ * kGarbageCollectionBudgetPercent / 100,
+                         1);
+    bytes_to_free = std::min(ranges_size + newDataSize - low_watermark,
+                             bytes_over_hard_memory_limit + budget);
+  }
 
   DVLOG(2) << __func__ << " " << GetStreamTypeName()
            << ": Before GC media_time=" << media_time.InMicroseconds()
@@ -990,6 +1033,7 @@ bool SourceBufferStream<RangeClass>::GarbageCollectIfNeeded(
            << " bytes_over_hard_memory_limit=" << bytes_over_hard_memory_limit
            << " ranges_=" << RangesToString<RangeClass>(ranges_);
 
+  RecordGarbageCollectionTime(GetType(), base::TimeTicks::Now() - gc_start);
   return bytes_freed >= bytes_over_hard_memory_limit;
 }
 
@@ -99,7 +99,9 @@ class MEDIA_EXPORT SourceBufferStream {
               base::TimeDelta duration);
 
   // Frees up space if the SourceBufferStream is taking up too much memory.
-  // |media_time| is current playback position.
+  // |media_time| is current playback position. With kIncrementalSourceBufferGC
+  // enabled, this frees a bounded amount per call beyond what an append of
+  // |newDataSize| bytes needs, so backlogs are evicted over several calls.
   bool GarbageCollectIfNeeded(DecodeTimestamp media_time,
                               size_t newDataSize);
 
@@ -0,0 +1,216 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/time/time.h"
+#include "media/base/audio_decoder_config.h"
+#include "media/base/media_log.h"
+#include "media/base/media_switches.h"
+#include "media/base/media_util.h"
+#include "media/base/stream_parser_buffer.h"
+#include "media/base/test_helpers.h"
+#include "media/filters/source_buffer_range_by_dts.h"
+#include "media/filters/source_buffer_range_by_pts.h"
+#include "media/filters/source_buffer_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+// Ten minutes of 60 fps media, roughly what a 4K stream keeps buffered, in one
+// second appends.  Only the accounted size of each frame matters here, so the
+// frames carry much less data than real 4K frames would.
+static const int kFramesPerSecond = 60;
+static const int kFramesPerAppend = 60;
+static const int kAppends = 600;
+static const int kFrameSize = 256;
+static const int kAppendSize = kFramesPerAppend * kFrameSize;
+
+// Two minutes of the above, to make appends past that evict.
+static const size_t kEvictionMemoryLimit = 120 * kAppendSize;
+
+static const int kSeeks = 2000;
+
+static base::TimeDelta FrameTime(int frame) {
+  return base::TimeDelta::FromMicroseconds(
+      frame * base::Time::kMicrosecondsPerSecond / kFramesPerSecond);
+}
+
+// Returns the frames of append |append| in decode order.  With |video| set, the
+// frames form one GOP with an IPBB...B pattern, so decode and presentation
+// order differ as they do for real video.  Otherwise every frame is a keyframe,
+// as for audio.
+static StreamParser::BufferQueue CreateAppend(int append, bool video) {
+  static const uint8_t kData[kFrameSize] = {};
+  StreamParser::BufferQueue buffers;
+  const int first_frame = append * kFramesPerAppend;
+  for (int i = 0; i < kFramesPerAppend; ++i) {
+    scoped_refptr<StreamParserBuffer> buffer = StreamParserBuffer::CopyFrom(
+        kData, kFrameSize, !video || i == 0,
+        video ? DemuxerStream::VIDEO : DemuxerStream::AUDIO, 0);
+    buffer->SetDecodeTimestamp(
+        DecodeTimestamp::FromPresentationTime(FrameTime(first_frame + i)));
+    int presentation_frame = first_frame + i;
+    if (video && i == 1)
+      presentation_frame = first_frame + kFramesPerAppend - 1;
+    else if (video && i > 1)
+      presentation_frame = first_frame + i - 1;
+    buffer->set_timestamp(FrameTime(presentation_frame));
+    buffer->set_duration(FrameTime(1));
+    buffers.push_back(buffer);
+  }
+  return buffers;
+}
+
+template <typename RangeClass>
+class SourceBufferStreamBenchmark {
+ public:
+  SourceBufferStreamBenchmark(bool video, const std::string& trace_name)
+      : video_(video), trace_name_(trace_name), stream_(CreateStream(video)) {}
+
+  // Appends all of the media one Append() at a time, as a demuxer would,
+  // optionally garbage collecting before each.  With |playback| set, the
+  // stream is read up to the start of each append before making it.
+  void Append(bool garbage_collect, bool playback) {
+    stream_->OnStartOfCodedFrameGroup(DecodeTimestamp(), base::TimeDelta());
+    stream_->Seek(base::TimeDelta());
+
+    base::TimeDelta append_time;
+    base::TimeDelta gc_time;
+    for (int append = 0; append < kAppends; ++append) {
+      StreamParser::BufferQueue buffers = CreateAppend(append, video_);
+      if (playback && append > 0)
+        ReadFrames(kFramesPerAppend);
+
+      if (garbage_collect) {
+        const DecodeTimestamp media_time =
+            DecodeTimestamp::FromPresentationTime(
+                FrameTime(std::max(append - 1, 0) * kFramesPerAppend));
+        base::TimeTicks start = base::TimeTicks::Now();
+        stream_->GarbageCollectIfNeeded(media_time, kAppendSize);
+        gc_time += base::TimeTicks::Now() - start;
+      }
+
+      base::TimeTicks start = base::TimeTicks::Now();
+      CHECK(stream_->Append(buffers));
+      append_time += base::TimeTicks::Now() - start;
+    }
+
+    perf_test::PrintResult("source_buffer_stream_append",
+                           garbage_collect ? "_evicting" : "", trace_name_,
+                           append_time.InMicrosecondsF() / kAppends,
+                           "us/append", true);
+    if (garbage_collect) {
+      perf_test::PrintResult("source_buffer_stream_garbage_collect", "",
+                             trace_name_, gc_time.InMicrosecondsF() / kAppends,
+                             "us/append", true);
+    }
+  }
+
+  // Seeks to times spread pseudo-randomly over the buffered range and reads
+  // the first buffer from each.
+  void Seek() {
+    const int64_t range_us =
+        FrameTime(kAppends * kFramesPerAppend).InMicroseconds();
+    uint32_t seed = 1;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kSeeks; ++i) {
+      seed = seed * 1664525 + 1013904223;
+      stream_->Seek(base::TimeDelta::FromMicroseconds(seed % range_us));
+      ReadFrames(1);
+    }
+    perf_test::PrintResult(
+        "source_buffer_stream_seek", "", trace_name_,
+        (base::TimeTicks::Now() - start).InMicrosecondsF() / kSeeks, "us/seek",
+        true);
+  }
+
+  void set_memory_limit(size_t memory_limit) {
+    stream_->set_memory_limit(memory_limit);
+  }
+
+ private:
+  std::unique_ptr<SourceBufferStream<RangeClass>> CreateStream(bool video) {
+    if (video) {
+      return base::MakeUnique<SourceBufferStream<RangeClass>>(
+          TestVideoConfig::Normal(), &media_log_);
+    }
+    AudioDecoderConfig config(kCodecOpus, kSampleFormatF32,
+                              CHANNEL_LAYOUT_STEREO, 48000, EmptyExtraData(),
+                              Unencrypted());
+    return base::MakeUnique<SourceBufferStream<RangeClass>>(config,
+                                                            &media_log_);
+  }
+
+  void ReadFrames(int frames) {
+    scoped_refptr<StreamParserBuffer> buffer;
+    for (int i = 0; i < frames; ++i) {
+      CHECK_EQ(SourceBufferStreamStatus::kSuccess,
+               stream_->GetNextBuffer(&buffer));
+    }
+  }
+
+  const bool video_;
+  const std::string trace_name_;
+  MediaLog media_log_;
+  std::unique_ptr<SourceBufferStream<RangeClass>> stream_;
+
+  DISALLOW_COPY_AND_ASSIGN(SourceBufferStreamBenchmark);
+};
+
+// Benchmark appending minutes of media, then seeking around in it.
+template <typename RangeClass>
+static void RunAppendAndSeekBenchmark(bool video,
+                                      const std::string& trace_name) {
+  SourceBufferStreamBenchmark<RangeClass> benchmark(video, trace_name);
+  benchmark.set_memory_limit(2 * kAppends * kAppendSize);
+  benchmark.Append(false, false);
+  benchmark.Seek();
+}
+
+// Benchmark appending media during playback against a memory limit, so each
+// append evicts already played frames.
+template <typename RangeClass>
+static void RunEvictionBenchmark(bool video, const std::string& trace_name) {
+  SourceBufferStreamBenchmark<RangeClass> benchmark(video, trace_name);
+  benchmark.set_memory_limit(kEvictionMemoryLimit);
+  benchmark.Append(true, true);
+}
+
+TEST(SourceBufferStreamPerfTest, AppendAndSeek) {
+  RunAppendAndSeekBenchmark<SourceBufferRangeByDts>(true, "video_by_dts");
+  RunAppendAndSeekBenchmark<SourceBufferRangeByPts>(true, "video_by_pts");
+  RunAppendAndSeekBenchmark<SourceBufferRangeByDts>(false, "audio_by_dts");
+  RunAppendAndSeekBenchmark<SourceBufferRangeByPts>(false, "audio_by_pts");
+}
+
+TEST(SourceBufferStreamPerfTest, Eviction) {
+  RunEvictionBenchmark<SourceBufferRangeByDts>(true, "video_by_dts");
+  RunEvictionBenchmark<SourceBufferRangeByPts>(true, "video_by_pts");
+  RunEvictionBenchmark<SourceBufferRangeByDts>(false, "audio_by_dts");
+  RunEvictionBenchmark<SourceBufferRangeByPts>(false, "audio_by_pts");
+}
+
+TEST(SourceBufferStreamPerfTest, IncrementalEviction) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kIncrementalSourceBufferGC);
+  RunEvictionBenchmark<SourceBufferRangeByDts>(true,
+                                               "video_by_dts_incremental");
+  RunEvictionBenchmark<SourceBufferRangeByPts>(true,
+                                               "video_by_pts_incremental");
+  RunEvictionBenchmark<SourceBufferRangeByDts>(false,
+                                               "audio_by_dts_incremental");
+  RunEvictionBenchmark<SourceBufferRangeByPts>(false,
+                                               "audio_by_pts_incremental");
+}
+
+}  // namespace media
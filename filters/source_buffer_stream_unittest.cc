@@ -5267,6 +5267,84 @@ TEST_P(SourceBufferStreamTest, InstantGarbageCollectionUnderMemoryPressure) {
   CheckExpectedRangesByTimestamp("{ [9,16) }");
 }
 
+TEST_P(SourceBufferStreamTest, IncrementalGarbageCollection_LowWatermark) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kIncrementalSourceBufferGC);
+
+  // Set memory limit to 21 buffers, for a low watermark of 18.
+  SetMemoryLimit(21);
+  NewCodedFrameGroupAppend(0, 20, &kDataA);
+  Seek(10);
+  CheckExpectedRanges("{ [0,19) }");
+
+  // Nothing is collected while an append fits under the memory limit.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(10, 1));
+  CheckExpectedRanges("{ [0,19) }");
+
+  // Once one doesn't, GC frees down to the low watermark rather than just
+  // enough for the append...
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(10, 2));
+  CheckExpectedRanges("{ [5,19) }");
+  CheckExpectedBuffers(10, 19, &kDataA);
+
+  // ...so later appends up to the memory limit don't collect again.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(10, 6));
+  CheckExpectedRanges("{ [5,19) }");
+}
+
+TEST_P(SourceBufferStreamTest, IncrementalGarbageCollection_SpreadOverCalls) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kIncrementalSourceBufferGC);
+  base::test::ScopedFeatureList scoped_memory_pressure_feature_list;
+  scoped_memory_pressure_feature_list.InitAndEnableFeature(
+      kMemoryPressureBasedSourceBufferGC);
+
+  SetMemoryLimit(20);
+  NewCodedFrameGroupAppend(0, 20, &kDataA);
+  Seek(18);
+  CheckExpectedRanges("{ [0,19) }");
+
+  // Moderate memory pressure halves the effective limit, which would free
+  // everything before the GOP being played at once. Incremental GC instead
+  // frees one GOP per call, since the per-call budget is under a GOP here.
+  STREAM_OP(OnMemoryPressure(
+      DecodeTimestamp::FromMilliseconds(0),
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE, false));
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(18, 0));
+  CheckExpectedRanges("{ [5,19) }");
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(18, 0));
+  CheckExpectedRanges("{ [10,19) }");
+
+  // That leaves 10 buffers, which is at the effective limit, so only an append
+  // starts the next collection.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(18, 0));
+  CheckExpectedRanges("{ [10,19) }");
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(18, 1));
+  CheckExpectedRanges("{ [15,19) }");
+
+  // The GOP being played can't be collected.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(18, 7));
+  CheckExpectedRanges("{ [15,19) }");
+  CheckExpectedBuffers(15, 19, &kDataA);
+}
+
+TEST_P(SourceBufferStreamTest, IncrementalGarbageCollection_HardLimit) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kIncrementalSourceBufferGC);
+
+  SetMemoryLimit(20);
+  NewCodedFrameGroupAppend(0, 20, &kDataA);
+  Seek(10);
+
+  // The budget doesn't limit what must be freed for an append to fit under the
+  // memory limit.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(10, 10));
+  CheckExpectedRanges("{ [10,19) }");
+  AppendBuffers(20, 10, &kDataA);
+  CheckExpectedRanges("{ [10,29) }");
+  CheckExpectedBuffers(10, 29, &kDataA);
+}
+
 TEST_P(SourceBufferStreamTest, GCFromFrontThenExplicitRemoveFromMiddleToEnd) {
   // Attempts to exercise SBRByPts::GetBufferIndexAt() after its
   // |keyframe_map_index_base_| has been increased, and when there is a GOP
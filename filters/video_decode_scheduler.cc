@@ -0,0 +1,197 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/filters/video_decode_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/thread.h"
+
+namespace media {
+
+class VideoDecodeScheduler::Stream::TaskRunner
+    : public base::SingleThreadTaskRunner {
+ public:
+  explicit TaskRunner(
+      scoped_refptr<base::SingleThreadTaskRunner> thread_task_runner)
+      : thread_task_runner_(std::move(thread_task_runner)),
+        pending_tasks_(0),
+        idle_(base::WaitableEvent::ResetPolicy::MANUAL,
+              base::WaitableEvent::InitialState::SIGNALED) {}
+
+  // base::SingleThreadTaskRunner implementation.
+  bool PostDelayedTask(const base::Location& from_here,
+                       base::OnceClosure task,
+                       base::TimeDelta delay) override {
+    AddPendingTask();
+    if (thread_task_runner_->PostDelayedTask(
+            from_here, base::BindOnce(&TaskRunner::RunTask, this,
+                                      std::move(task)),
+            delay)) {
+      return true;
+    }
+    RemovePendingTask();
+    return false;
+  }
+
+  bool PostNonNestableDelayedTask(const base::Location& from_here,
+                                  base::OnceClosure task,
+                                  base::TimeDelta delay) override {
+    AddPendingTask();
+    if (thread_task_runner_->PostNonNestableDelayedTask(
+            from_here, base::BindOnce(&TaskRunner::RunTask, this,
+                                      std::move(task)),
+            delay)) {
+      return true;
+    }
+    RemovePendingTask();
+    return false;
+  }
+
+  bool RunsTasksInCurrentSequence() const override {
+    return thread_task_runner_->RunsTasksInCurrentSequence();
+  }
+
+  void WaitForPendingTasks() { idle_.Wait(); }
+
+ private:
+  ~TaskRunner() override {}
+
+  void RunTask(base::OnceClosure task) {
+    std::move(task).Run();
+    RemovePendingTask();
+  }
+
+  void AddPendingTask() {
+    base::AutoLock auto_lock(lock_);
+    if (pending_tasks_++ == 0)
+      idle_.Reset();
+  }
+
+  void RemovePendingTask() {
+    base::AutoLock auto_lock(lock_);
+    DCHECK_GT(pending_tasks_, 0);
+    if (--pending_tasks_ == 0)
+      idle_.Signal();
+  }
+
+  const scoped_refptr<base::SingleThreadTaskRunner> thread_task_runner_;
+
+  base::Lock lock_;
+  int pending_tasks_;
+
+  // Signaled while |pending_tasks_| is zero.
+  base::WaitableEvent idle_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaskRunner);
+};
+
+VideoDecodeScheduler::Stream::Stream(
+    VideoDecodeScheduler* scheduler,
+    size_t thread_index,
+    int64_t pixels,
+    int codec_thread_count,
+    scoped_refptr<base::SingleThreadTaskRunner> thread_task_runner)
+    : scheduler_(scheduler),
+      thread_index_(thread_index),
+      pixels_(pixels),
+      codec_thread_count_(codec_thread_count),
+      task_runner_(new TaskRunner(std::move(thread_task_runner))) {}
+
+VideoDecodeScheduler::Stream::~Stream() {
+  scheduler_->UnregisterStream(thread_index_, pixels_);
+}
+
+scoped_refptr<base::SingleThreadTaskRunner>
+VideoDecodeScheduler::Stream::task_runner() const {
+  return task_runner_;
+}
+
+void VideoDecodeScheduler::Stream::WaitForOutstandingTasks() {
+  DCHECK(!task_runner_->BelongsToCurrentThread());
+  task_runner_->WaitForPendingTasks();
+}
+
+// static
+VideoDecodeScheduler* VideoDecodeScheduler::GetInstance() {
+  static VideoDecodeScheduler* scheduler =
+      new VideoDecodeScheduler(base::SysInfo::NumberOfProcessors());
+  return scheduler;
+}
+
+VideoDecodeScheduler::VideoDecodeScheduler(int thread_count)
+    : thread_streams_(std::max(thread_count, 1), 0),
+      thread_pixels_(std::max(thread_count, 1), 0),
+      stream_count_(0) {
+  for (size_t i = 0; i < thread_streams_.size(); ++i) {
+    threads_.push_back(base::MakeUnique<base::Thread>(
+        "VideoDecodeThread" + base::SizeTToString(i)));
+  }
+}
+
+VideoDecodeScheduler::~VideoDecodeScheduler() {
+  DCHECK_EQ(stream_count_, 0);
+  for (auto& thread : threads_)
+    thread->Stop();
+}
+
+std::unique_ptr<VideoDecodeScheduler::Stream>
+VideoDecodeScheduler::RegisterStream(const gfx::Size& coded_size,
+                                     int max_codec_threads) {
+  const int64_t pixels = coded_size.GetArea();
+
+  base::AutoLock auto_lock(lock_);
+
+  // Use the thread with the fewest pixels to decode, then the fewest streams.
+  // Ties go to the lowest index, which is the most likely to be running.
+  size_t index = 0;
+  for (size_t i = 1; i < threads_.size(); ++i) {
+    if (thread_pixels_[i] < thread_pixels_[index] ||
+        (thread_pixels_[i] == thread_pixels_[index] &&
+         thread_streams_[i] < thread_streams_[index])) {
+      index = i;
+    }
+  }
+
+  // Threads are never stopped once started: a stream that goes away may be
+  // replaced by another one right away, as on a configuration change.
+  if (!threads_[index]->IsRunning())
+    threads_[index]->Start();
+
+  thread_streams_[index]++;
+  thread_pixels_[index] += pixels;
+  stream_count_++;
+
+  // Split the threads evenly between the streams registered so far. Streams
+  // registered earlier keep their codec threads, as codecs can't change them.
+  const int codec_thread_count = std::max(
+      1, std::min(max_codec_threads, thread_count() / stream_count_));
+
+  return base::WrapUnique(new Stream(this, index, pixels, codec_thread_count,
+                                     threads_[index]->task_runner()));
+}
+
+int VideoDecodeScheduler::stream_count() const {
+  base::AutoLock auto_lock(lock_);
+  return stream_count_;
+}
+
+void VideoDecodeScheduler::UnregisterStream(size_t thread_index,
+                                            int64_t pixels) {
+  base::AutoLock auto_lock(lock_);
+  DCHECK_GT(thread_streams_[thread_index], 0);
+  thread_streams_[thread_index]--;
+  thread_pixels_[thread_index] -= pixels;
+  stream_count_--;
+}
+
+}  // namespace media
@@ -0,0 +1,125 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_FILTERS_VIDEO_DECODE_SCHEDULER_H_
+#define MEDIA_FILTERS_VIDEO_DECODE_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/single_thread_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "media/base/media_export.h"
+#include "ui/gfx/geometry/size.h"
+
+namespace base {
+class Thread;
+}
+
+namespace media {
+
+// Shares a fixed set of decode threads among all the software video decoders
+// of the process, instead of each decoder sizing its own threads for the whole
+// machine. With dozens of concurrent decodes, per-decoder thread counts add up
+// to many times the number of cores.
+//
+// Each decoder registers a Stream, and posts its decodes, one frame per task,
+// to the stream's task runner. Streams are spread over the threads by the
+// number of pixels they decode, and the tasks of the streams sharing a thread
+// run in the order they were posted, so each stream gets its share of the
+// thread as long as it keeps only a few decodes in flight. The tasks of a
+// stream always run on the same thread, so decoders may keep thread affine
+// state. For the same reason, streams are not moved when others come and go,
+// even if that leaves the threads unevenly loaded.
+//
+// Codecs also have threads of their own, for tiles or slices. A stream may use
+// as many of those as the decoder asked for when it was registered, but no
+// more than its share of the scheduler's threads at that time. Codecs can't
+// change their thread count, so it is fixed at registration: streams
+// registered while few others were running keep their larger share, and
+// together the codec threads can still exceed the number of cores.
+//
+// All methods may be called on any thread.
+class MEDIA_EXPORT VideoDecodeScheduler {
+ public:
+  class MEDIA_EXPORT Stream {
+   public:
+    // Unregisters the stream. Tasks already posted still run.
+    ~Stream();
+
+    // Runs the decode tasks of the stream, in order.
+    scoped_refptr<base::SingleThreadTaskRunner> task_runner() const;
+
+    // Index of the scheduler thread task_runner() runs tasks on.
+    size_t thread_index() const { return thread_index_; }
+
+    // Number of threads the codec may use for this stream. When 1, the codec
+    // should decode on the task runner's thread.
+    int codec_thread_count() const { return codec_thread_count_; }
+
+    // Blocks until the tasks posted to task_runner() so far have run. Tasks of
+    // other streams on the same thread which were posted before them run
+    // first, but those posted later don't hold this up.
+    void WaitForOutstandingTasks();
+
+   private:
+    friend class VideoDecodeScheduler;
+
+    // Forwards the stream's tasks to its thread, and keeps count of those that
+    // haven't run yet.
+    class TaskRunner;
+
+    Stream(VideoDecodeScheduler* scheduler,
+           size_t thread_index,
+           int64_t pixels,
+           int codec_thread_count,
+           scoped_refptr<base::SingleThreadTaskRunner> thread_task_runner);
+
+    VideoDecodeScheduler* const scheduler_;
+    const size_t thread_index_;
+    const int64_t pixels_;
+    const int codec_thread_count_;
+    const scoped_refptr<TaskRunner> task_runner_;
+
+    DISALLOW_COPY_AND_ASSIGN(Stream);
+  };
+
+  // Returns the scheduler of the process, with a thread per core.
+  static VideoDecodeScheduler* GetInstance();
+
+  // Threads are started as streams need them. Streams must not outlive the
+  // scheduler.
+  explicit VideoDecodeScheduler(int thread_count);
+  ~VideoDecodeScheduler();
+
+  // Registers a stream decoding frames of |coded_size|, for a decoder that
+  // would use |max_codec_threads| codec threads on its own.
+  std::unique_ptr<Stream> RegisterStream(const gfx::Size& coded_size,
+                                         int max_codec_threads);
+
+  int thread_count() const { return static_cast<int>(threads_.size()); }
+  int stream_count() const;
+
+ private:
+  void UnregisterStream(size_t thread_index, int64_t pixels);
+
+  mutable base::Lock lock_;
+
+  std::vector<std::unique_ptr<base::Thread>> threads_;
+
+  // Number of streams, and pixels per frame of the streams, on each thread.
+  std::vector<int> thread_streams_;
+  std::vector<int64_t> thread_pixels_;
+  int stream_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoDecodeScheduler);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_FILTERS_VIDEO_DECODE_SCHEDULER_H_
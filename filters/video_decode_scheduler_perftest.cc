@@ -0,0 +1,269 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/time/time.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/media_switches.h"
+#include "media/base/media_util.h"
+#include "media/base/test_data_util.h"
+#include "media/base/video_decoder_config.h"
+#include "media/filters/ivf_parser.h"
+#include "media/filters/vpx_video_decoder.h"
+#include "media/media_features.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+#if !defined(MEDIA_DISABLE_FFMPEG) && !defined(DISABLE_FFMPEG_VIDEO_DECODERS)
+#include "media/base/media_log.h"
+#include "media/ffmpeg/ffmpeg_common.h"
+#include "media/filters/ffmpeg_glue.h"
+#include "media/filters/ffmpeg_video_decoder.h"
+#include "media/filters/in_memory_url_protocol.h"
+#endif
+
+namespace media {
+
+// Each decoder decodes its clip this many times.
+static const int kLoops = 4;
+
+static const int kDecoderCounts[] = {1, 4, 16, 32};
+
+struct Clip {
+  VideoDecoderConfig config;
+  std::vector<scoped_refptr<DecoderBuffer>> buffers;
+};
+
+using CreateDecoderCB = base::Callback<std::unique_ptr<VideoDecoder>()>;
+
+static std::unique_ptr<VideoDecoder> CreateVpxVideoDecoder() {
+  return base::MakeUnique<VpxVideoDecoder>();
+}
+
+static Clip ReadIvfClip(const std::string& name) {
+  scoped_refptr<DecoderBuffer> file = ReadTestDataFile(name);
+  IvfParser parser;
+  IvfFileHeader file_header = {};
+  CHECK(parser.Initialize(file->data(), file->data_size(), &file_header));
+
+  const gfx::Size size(file_header.width, file_header.height);
+  Clip clip;
+  clip.config.Initialize(kCodecVP9, VP9PROFILE_PROFILE0, PIXEL_FORMAT_YV12,
+                         COLOR_SPACE_UNSPECIFIED, VIDEO_ROTATION_0, size,
+                         gfx::Rect(size), size, EmptyExtraData(),
+                         Unencrypted());
+
+  IvfFrameHeader frame_header = {};
+  const uint8_t* payload = nullptr;
+  while (parser.ParseNextFrame(&frame_header, &payload)) {
+    scoped_refptr<DecoderBuffer> buffer =
+        DecoderBuffer::CopyFrom(payload, frame_header.frame_size);
+    buffer->set_timestamp(base::TimeDelta::FromMilliseconds(
+        33 * static_cast<int64_t>(clip.buffers.size())));
+    clip.buffers.push_back(buffer);
+  }
+  CHECK(!clip.buffers.empty());
+  return clip;
+}
+
+#if !defined(MEDIA_DISABLE_FFMPEG) && !defined(DISABLE_FFMPEG_VIDEO_DECODERS)
+static std::unique_ptr<VideoDecoder> CreateFFmpegVideoDecoder(
+    MediaLog* media_log) {
+  return base::MakeUnique<FFmpegVideoDecoder>(media_log);
+}
+
+// Reads the packets of the first video stream of the container file |name|.
+static Clip ReadContainerClip(const std::string& name) {
+  scoped_refptr<DecoderBuffer> file = ReadTestDataFile(name);
+  InMemoryUrlProtocol protocol(file->data(), file->data_size(), false);
+  FFmpegGlue glue(&protocol);
+  CHECK(glue.OpenContext());
+  AVFormatContext* format_context = glue.format_context();
+  CHECK_GE(avformat_find_stream_info(format_context, nullptr), 0);
+
+  int stream_index = -1;
+  for (size_t i = 0; i < format_context->nb_streams; ++i) {
+    if (format_context->streams[i]->codecpar->codec_type ==
+        AVMEDIA_TYPE_VIDEO) {
+      stream_index = static_cast<int>(i);
+      break;
+    }
+  }
+  CHECK_GE(stream_index, 0);
+
+  const AVStream* stream = format_context->streams[stream_index];
+  Clip clip;
+  CHECK(AVStreamToVideoDecoderConfig(stream, &clip.config));
+
+  AVPacket packet;
+  while (av_read_frame(format_context, &packet) >= 0) {
+    if (packet.stream_index == stream_index) {
+      scoped_refptr<DecoderBuffer> buffer =
+          DecoderBuffer::CopyFrom(packet.data, packet.size);
+      buffer->set_timestamp(ConvertFromTimeBase(stream->time_base, packet.pts));
+      buffer->set_is_key_frame((packet.flags & AV_PKT_FLAG_KEY) != 0);
+      clip.buffers.push_back(buffer);
+    }
+    av_packet_unref(&packet);
+  }
+  CHECK(!clip.buffers.empty());
+  return clip;
+}
+#endif  // !defined(MEDIA_DISABLE_FFMPEG) &&
+        // !defined(DISABLE_FFMPEG_VIDEO_DECODERS)
+
+// Decodes a clip over and over with one decode in flight, as DecoderStream
+// does for software decoders, and records how long each decode took.
+class DecodeLoop {
+ public:
+  DecodeLoop(const Clip& clip,
+             std::unique_ptr<VideoDecoder> decoder,
+             std::vector<base::TimeDelta>* latencies,
+             const base::Closure& done_cb)
+      : clip_(clip),
+        decoder_(std::move(decoder)),
+        latencies_(latencies),
+        done_cb_(done_cb),
+        next_buffer_(0) {}
+
+  void Start() {
+    decoder_->Initialize(
+        clip_.config, false, nullptr,
+        base::Bind(&DecodeLoop::OnInitialized, base::Unretained(this)),
+        base::Bind(&DecodeLoop::OnOutput, base::Unretained(this)));
+  }
+
+ private:
+  void OnInitialized(bool success) {
+    CHECK(success);
+    DecodeNextBuffer();
+  }
+
+  void OnOutput(const scoped_refptr<VideoFrame>& frame) {}
+
+  void DecodeNextBuffer() {
+    const size_t buffer_count = clip_.buffers.size();
+    if (next_buffer_ == buffer_count * kLoops) {
+      done_cb_.Run();
+      return;
+    }
+    decode_start_ = base::TimeTicks::Now();
+    decoder_->Decode(
+        clip_.buffers[next_buffer_++ % buffer_count],
+        base::Bind(&DecodeLoop::OnDecoded, base::Unretained(this)));
+  }
+
+  void OnDecoded(DecodeStatus status) {
+    CHECK_EQ(DecodeStatus::OK, status);
+    latencies_->push_back(base::TimeTicks::Now() - decode_start_);
+    DecodeNextBuffer();
+  }
+
+  const Clip& clip_;
+  std::unique_ptr<VideoDecoder> decoder_;
+  std::vector<base::TimeDelta>* const latencies_;
+  const base::Closure done_cb_;
+  size_t next_buffer_;
+  base::TimeTicks decode_start_;
+
+  DISALLOW_COPY_AND_ASSIGN(DecodeLoop);
+};
+
+// Runs |decoder_count| decoders of |clip| at once, and reports the frames
+// decoded per second by all of them together, and the 99th percentile of the
+// time a decode took.
+static void RunParallelDecodeBenchmark(const std::string& name,
+                                       const Clip& clip,
+                                       const CreateDecoderCB& create_decoder_cb,
+                                       int decoder_count,
+                                       bool shared_threads) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  if (shared_threads)
+    scoped_feature_list.InitAndEnableFeature(kSharedVideoDecodeThreads);
+  else
+    scoped_feature_list.InitAndDisableFeature(kSharedVideoDecodeThreads);
+
+  base::RunLoop run_loop;
+  base::Closure done_cb =
+      base::BarrierClosure(decoder_count, run_loop.QuitClosure());
+  std::vector<base::TimeDelta> latencies;
+  std::vector<std::unique_ptr<DecodeLoop>> loops;
+  for (int i = 0; i < decoder_count; ++i)
+    loops.push_back(base::MakeUnique<DecodeLoop>(clip, create_decoder_cb.Run(),
+                                                 &latencies, done_cb));
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (auto& loop : loops)
+    loop->Start();
+  run_loop.Run();
+  const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  loops.clear();
+  base::RunLoop().RunUntilIdle();
+
+  std::sort(latencies.begin(), latencies.end());
+  const std::string trace = name + "_" + std::to_string(decoder_count) +
+                            (shared_threads ? "_shared" : "_per_decoder");
+  perf_test::PrintResult("parallel_decode", "_aggregate", trace,
+                         latencies.size() / elapsed.InSecondsF(), "fps",
+                         true);
+  perf_test::PrintResult(
+      "parallel_decode", "_p99_latency", trace,
+      latencies[latencies.size() * 99 / 100].InMillisecondsF(), "ms", true);
+}
+
+TEST(VideoDecodeSchedulerPerfTest, ParallelVpxDecodes) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  const struct {
+    const char* name;
+    const char* file;
+  } kClips[] = {
+      {"bear", "bear-vp9.ivf"}, {"crowd", "crowd-vp9.2.ivf"},
+  };
+  const CreateDecoderCB create_decoder_cb =
+      base::Bind(&CreateVpxVideoDecoder);
+  for (const auto& clip_file : kClips) {
+    const Clip clip = ReadIvfClip(clip_file.file);
+    for (int decoder_count : kDecoderCounts) {
+      RunParallelDecodeBenchmark(clip_file.name, clip, create_decoder_cb,
+                                 decoder_count, false);
+      RunParallelDecodeBenchmark(clip_file.name, clip, create_decoder_cb,
+                                 decoder_count, true);
+    }
+  }
+}
+
+#if BUILDFLAG(USE_PROPRIETARY_CODECS) && !defined(MEDIA_DISABLE_FFMPEG) && \
+    !defined(DISABLE_FFMPEG_VIDEO_DECODERS)
+TEST(VideoDecodeSchedulerPerfTest, ParallelFFmpegH264Decodes) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  MediaLog media_log;
+  const CreateDecoderCB create_decoder_cb =
+      base::Bind(&CreateFFmpegVideoDecoder, &media_log);
+  const Clip clip = ReadContainerClip("bear-1280x720.mp4");
+  for (int decoder_count : kDecoderCounts) {
+    RunParallelDecodeBenchmark("bear_h264", clip, create_decoder_cb,
+                               decoder_count, false);
+    RunParallelDecodeBenchmark("bear_h264", clip, create_decoder_cb,
+                               decoder_count, true);
+  }
+}
+#endif  // BUILDFLAG(USE_PROPRIETARY_CODECS) && !defined(MEDIA_DISABLE_FFMPEG)
+        // && !defined(DISABLE_FFMPEG_VIDEO_DECODERS)
+
+}  // namespace media
@@ -0,0 +1,144 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "media/filters/video_decode_scheduler.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const gfx::Size k1080p(1920, 1080);
+static const gfx::Size k360p(640, 360);
+
+static void RecordTask(int task,
+                       std::vector<int>* tasks,
+                       std::vector<base::PlatformThreadId>* threads) {
+  tasks->push_back(task);
+  threads->push_back(base::PlatformThread::CurrentId());
+}
+
+TEST(VideoDecodeSchedulerTest, SpreadsStreamsByPixels) {
+  VideoDecodeScheduler scheduler(2);
+  std::unique_ptr<VideoDecodeScheduler::Stream> large =
+      scheduler.RegisterStream(k1080p, 1);
+  std::unique_ptr<VideoDecodeScheduler::Stream> small1 =
+      scheduler.RegisterStream(k360p, 1);
+  std::unique_ptr<VideoDecodeScheduler::Stream> small2 =
+      scheduler.RegisterStream(k360p, 1);
+  EXPECT_EQ(3, scheduler.stream_count());
+
+  // Both small streams together decode fewer pixels than the large one.
+  EXPECT_NE(large->thread_index(), small1->thread_index());
+  EXPECT_EQ(small1->thread_index(), small2->thread_index());
+
+  // Once the large stream goes away, its thread is the least loaded.
+  large.reset();
+  std::unique_ptr<VideoDecodeScheduler::Stream> small3 =
+      scheduler.RegisterStream(k360p, 1);
+  EXPECT_NE(small1->thread_index(), small3->thread_index());
+}
+
+TEST(VideoDecodeSchedulerTest, SharesCodecThreads) {
+  VideoDecodeScheduler scheduler(8);
+  std::vector<std::unique_ptr<VideoDecodeScheduler::Stream>> streams;
+
+  // Alone, a stream gets all the threads it asks for, up to all of them.
+  streams.push_back(scheduler.RegisterStream(k1080p, 16));
+  EXPECT_EQ(8, streams.back()->codec_thread_count());
+  streams.push_back(scheduler.RegisterStream(k1080p, 16));
+  EXPECT_EQ(4, streams.back()->codec_thread_count());
+  streams.push_back(scheduler.RegisterStream(k360p, 2));
+  EXPECT_EQ(2, streams.back()->codec_thread_count());
+
+  // Past one stream per thread, streams decode on the scheduler's threads.
+  while (scheduler.stream_count() < 9)
+    streams.push_back(scheduler.RegisterStream(k360p, 4));
+  EXPECT_EQ(1, streams.back()->codec_thread_count());
+
+  streams.clear();
+  EXPECT_EQ(0, scheduler.stream_count());
+  EXPECT_EQ(8, scheduler.RegisterStream(k1080p, 16)->codec_thread_count());
+}
+
+TEST(VideoDecodeSchedulerTest, RunsStreamTasksInOrderOnOneThread) {
+  VideoDecodeScheduler scheduler(4);
+  std::unique_ptr<VideoDecodeScheduler::Stream> stream =
+      scheduler.RegisterStream(k360p, 1);
+
+  std::vector<int> tasks;
+  std::vector<base::PlatformThreadId> threads;
+  for (int i = 0; i < 100; ++i) {
+    stream->task_runner()->PostTask(
+        FROM_HERE, base::Bind(&RecordTask, i, &tasks, &threads));
+  }
+  stream->WaitForOutstandingTasks();
+
+  ASSERT_EQ(100u, tasks.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, tasks[i]);
+    EXPECT_EQ(threads[0], threads[i]);
+  }
+  EXPECT_NE(base::PlatformThread::CurrentId(), threads[0]);
+}
+
+TEST(VideoDecodeSchedulerTest, InterleavesStreamsSharingAThread) {
+  VideoDecodeScheduler scheduler(1);
+  std::unique_ptr<VideoDecodeScheduler::Stream> stream1 =
+      scheduler.RegisterStream(k360p, 1);
+  std::unique_ptr<VideoDecodeScheduler::Stream> stream2 =
+      scheduler.RegisterStream(k1080p, 1);
+  ASSERT_EQ(stream1->thread_index(), stream2->thread_index());
+
+  // Streams with one decode in flight each take turns.
+  std::vector<int> tasks;
+  std::vector<base::PlatformThreadId> threads;
+  for (int i = 0; i < 10; ++i) {
+    stream1->task_runner()->PostTask(
+        FROM_HERE, base::Bind(&RecordTask, 1, &tasks, &threads));
+    stream2->task_runner()->PostTask(
+        FROM_HERE, base::Bind(&RecordTask, 2, &tasks, &threads));
+  }
+  stream2->WaitForOutstandingTasks();
+
+  ASSERT_EQ(20u, tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i)
+    EXPECT_EQ(i % 2 ? 2 : 1, tasks[i]);
+}
+
+TEST(VideoDecodeSchedulerTest, WaitsOnlyForTheStreamsOwnTasks) {
+  VideoDecodeScheduler scheduler(1);
+  std::unique_ptr<VideoDecodeScheduler::Stream> stream1 =
+      scheduler.RegisterStream(k360p, 1);
+  std::unique_ptr<VideoDecodeScheduler::Stream> stream2 =
+      scheduler.RegisterStream(k1080p, 1);
+  ASSERT_EQ(stream1->thread_index(), stream2->thread_index());
+
+  // Nothing to wait for yet.
+  stream1->WaitForOutstandingTasks();
+
+  // |stream2| posts a task which doesn't finish until this thread lets it,
+  // after |stream1|'s task. Waiting for |stream1| must not wait for it.
+  std::vector<int> tasks;
+  std::vector<base::PlatformThreadId> threads;
+  base::WaitableEvent unblock(base::WaitableEvent::ResetPolicy::MANUAL,
+                              base::WaitableEvent::InitialState::NOT_SIGNALED);
+  stream1->task_runner()->PostTask(
+      FROM_HERE, base::Bind(&RecordTask, 1, &tasks, &threads));
+  stream2->task_runner()->PostTask(
+      FROM_HERE,
+      base::Bind(&base::WaitableEvent::Wait, base::Unretained(&unblock)));
+  stream1->WaitForOutstandingTasks();
+  ASSERT_EQ(1u, tasks.size());
+
+  unblock.Signal();
+  stream2->WaitForOutstandingTasks();
+}
+
+}  // namespace media
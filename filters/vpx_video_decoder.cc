@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <algorithm>
 #include <memory>
@@ -15,6 +16,7 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/macros.h"
@@ -36,6 +38,7 @@
 #include "media/base/bind_to_current_loop.h"
 #include "media/base/decoder_buffer.h"
 #include "media/base/media_switches.h"
+#include "media/base/shared_frame_buffer_pool.h"
 
 // Include libvpx header files.
 // VPX_CODEC_DISABLE_COMPAT excludes parts of the libvpx API that provide
@@ -157,12 +160,13 @@ static int GetThreadCount(const VideoDecoderConfig& config) {
 }
 
 static vpx_codec_ctx* InitializeVpxContext(vpx_codec_ctx* context,
-                                           const VideoDecoderConfig& config) {
+                                           const VideoDecoderConfig& config,
+                                           int thread_count) {
   context = new vpx_codec_ctx();
   vpx_codec_dec_cfg_t vpx_config = {0};
   vpx_config.w = config.coded_size().width();
   vpx_config.h = config.coded_size().height();
-  vpx_config.threads = GetThreadCount(config);
+  vpx_config.threads = thread_count;
 
   vpx_codec_err_t status = vpx_codec_dec_init(
       context,
@@ -179,11 +183,15 @@ static vpx_codec_ctx* InitializeVpxContext(vpx_codec_ctx* context,
 // MemoryPool is a pool of simple CPU memory, allocated by hand and used by both
 // VP9 and any data consumers. This class needs to be ref-counted to hold on to
 // allocated memory via the memory-release callback of CreateFrameCallback().
+//
+// If |shared_buffer_pool| is given, frame buffers take their memory from it
+// and give it back once they are erased, either for going stale or on shutdown,
+// so that other decoders can reuse it.
 class VpxVideoDecoder::MemoryPool
     : public base::RefCountedThreadSafe<VpxVideoDecoder::MemoryPool>,
       public base::trace_event::MemoryDumpProvider {
  public:
-  MemoryPool();
+  explicit MemoryPool(SharedFrameBufferPool* shared_buffer_pool);
 
   // Callback that will be called by libvpx when it needs a frame buffer.
   // Parameters:
@@ -217,6 +225,9 @@ class VpxVideoDecoder::MemoryPool
   // Reference counted frame buffers used for VP9 decoding.
   struct VP9FrameBuffer {
     std::vector<uint8_t> data;
+    // Used instead of |data| with a shared buffer pool, and returned to it
+    // when the frame buffer is erased or needs a larger buffer.
+    SharedFrameBufferPool::Buffer shared_data;
     std::vector<uint8_t> alpha_data;
     bool held_by_libvpx = false;
     // Needs to be a counter since libvpx may vend a framebuffer multiple times.
@@ -246,6 +257,8 @@ class VpxVideoDecoder::MemoryPool
   // destroyed.
   void OnVideoFrameDestroyed(VP9FrameBuffer* frame_buffer);
 
+  SharedFrameBufferPool* const shared_buffer_pool_;
+
   // Frame buffers to be used by libvpx for VP9 Decoding.
   std::vector<std::unique_ptr<VP9FrameBuffer>> frame_buffers_;
 
@@ -262,7 +275,10 @@ class VpxVideoDecoder::MemoryPool
   DISALLOW_COPY_AND_ASSIGN(MemoryPool);
 };
 
-VpxVideoDecoder::MemoryPool::MemoryPool() : tick_clock_(&default_tick_clock_) {
+VpxVideoDecoder::MemoryPool::MemoryPool(
+    SharedFrameBufferPool* shared_buffer_pool)
+    : shared_buffer_pool_(shared_buffer_pool),
+      tick_clock_(&default_tick_clock_) {
   DETACH_FROM_THREAD(thread_checker_);
 }
 
@@ -295,6 +311,20 @@ VpxVideoDecoder::MemoryPool::GetFreeFrameBuffer(size_t min_size) {
     frame_buffers_.push_back(base::MakeUnique<VP9FrameBuffer>());
   }
 
+  if (shared_buffer_pool_) {
+    SharedFrameBufferPool::Buffer& shared_data = frame_buffers_[i]->shared_data;
+    if (shared_data.size() < min_size) {
+      shared_data = shared_buffer_pool_->Allocate(min_size);
+      // libvpx requires new frame buffers to be zeroed, as resize() does
+      // below, and shared memory may still hold another decoder's frame. All
+      // of the buffer is cleared, since all of it is handed to libvpx and the
+      // next frame may need more of it. A frame buffer reusing its own memory
+      // is left as is, like |data|.
+      memset(shared_data.data(), 0, shared_data.size());
+    }
+    return frame_buffers_[i].get();
+  }
+
   // Resize the frame buffer if necessary.
   if (frame_buffers_[i]->data.size() < min_size)
     frame_buffers_[i]->data.resize(min_size);
@@ -315,8 +345,13 @@ int32_t VpxVideoDecoder::MemoryPool::GetVP9FrameBuffer(
   if (!fb_to_use)
     return -1;
 
-  fb->data = &fb_to_use->data[0];
-  fb->size = fb_to_use->data.size();
+  if (fb_to_use->shared_data.data()) {
+    fb->data = fb_to_use->shared_data.data();
+    fb->size = fb_to_use->shared_data.size();
+  } else {
+    fb->data = &fb_to_use->data[0];
+    fb->size = fb_to_use->data.size();
+  }
 
   DCHECK(!IsUsed(fb_to_use));
   fb_to_use->held_by_libvpx = true;
@@ -377,9 +412,11 @@ bool VpxVideoDecoder::MemoryPool::OnMemoryDump(
   size_t bytes_used = 0;
   size_t bytes_reserved = 0;
   for (const auto& frame_buffer : frame_buffers_) {
+    const size_t size =
+        frame_buffer->data.size() + frame_buffer->shared_data.size();
     if (IsUsed(frame_buffer.get()))
-      bytes_used += frame_buffer->data.size();
-    bytes_reserved += frame_buffer->data.size();
+      bytes_used += size;
+    bytes_reserved += size;
   }
 
   memory_dump->AddScalar(base::trace_event::MemoryAllocatorDump::kNameSize,
@@ -601,7 +638,17 @@ bool VpxVideoDecoder::ConfigureDecoder(const VideoDecoderConfig& config) {
 
   CloseDecoder();
 
-  vpx_codec_ = InitializeVpxContext(vpx_codec_, config);
+  // Decode on the threads shared by all decoders if enabled, with at most our
+  // share of the codec threads.
+  int thread_count = GetThreadCount(config);
+  if (base::FeatureList::IsEnabled(kSharedVideoDecodeThreads)) {
+    decode_stream_ = VideoDecodeScheduler::GetInstance()->RegisterStream(
+        config.coded_size(), thread_count);
+    thread_count = decode_stream_->codec_thread_count();
+    offload_task_runner_ = decode_stream_->task_runner();
+  }
+
+  vpx_codec_ = InitializeVpxContext(vpx_codec_, config, thread_count);
   if (!vpx_codec_)
     return false;
 
@@ -614,13 +661,16 @@ bool VpxVideoDecoder::ConfigureDecoder(const VideoDecoderConfig& config) {
 
     // Move high resolution vp9 decodes off of the main media thread (otherwise
     // decode may block audio decoding, demuxing, and other control activities).
-    if (config.coded_size().width() >= 1024) {
+    if (!decode_stream_ && config.coded_size().width() >= 1024) {
       DCHECK(!offload_task_runner_);
       offload_task_runner_ = GetOffloadThread()->RequestOffloadThread();
     }
 
     DCHECK(!memory_pool_);
-    memory_pool_ = new MemoryPool();
+    memory_pool_ = new MemoryPool(
+        base::FeatureList::IsEnabled(kSharedFrameBufferPool)
+            ? SharedFrameBufferPool::GetInstance()
+            : nullptr);
     if (vpx_codec_set_frame_buffer_functions(vpx_codec_,
                                              &MemoryPool::GetVP9FrameBuffer,
                                              &MemoryPool::ReleaseVP9FrameBuffer,
@@ -634,12 +684,15 @@ bool VpxVideoDecoder::ConfigureDecoder(const VideoDecoderConfig& config) {
   if (config.format() != PIXEL_FORMAT_YV12A)
     return true;
 
-  vpx_codec_alpha_ = InitializeVpxContext(vpx_codec_alpha_, config);
+  vpx_codec_alpha_ =
+      InitializeVpxContext(vpx_codec_alpha_, config, thread_count);
   return !!vpx_codec_alpha_;
 }
 
 void VpxVideoDecoder::CloseDecoder() {
-  if (offload_task_runner_)
+  if (decode_stream_)
+    decode_stream_->WaitForOutstandingTasks();
+  else if (offload_task_runner_)
     GetOffloadThread()->WaitForOutstandingTasks();
 
   if (vpx_codec_) {
@@ -667,7 +720,10 @@ void VpxVideoDecoder::CloseDecoder() {
     memory_pool_ = nullptr;
   }
 
-  if (offload_task_runner_) {
+  if (decode_stream_) {
+    decode_stream_.reset();
+    offload_task_runner_ = nullptr;
+  } else if (offload_task_runner_) {
     GetOffloadThread()->ReleaseOffloadThread();
     offload_task_runner_ = nullptr;
   }
@@ -5,6 +5,8 @@
 #ifndef MEDIA_FILTERS_VPX_VIDEO_DECODER_H_
 #define MEDIA_FILTERS_VPX_VIDEO_DECODER_H_
 
+#include <memory>
+
 #include "base/callback.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
@@ -14,6 +16,7 @@
 #include "media/base/video_decoder_config.h"
 #include "media/base/video_frame.h"
 #include "media/base/video_frame_pool.h"
+#include "media/filters/video_decode_scheduler.h"
 
 struct vpx_codec_ctx;
 struct vpx_image;
@@ -120,8 +123,11 @@ class MEDIA_EXPORT VpxVideoDecoder : public VideoDecoder {
   scoped_refptr<MemoryPool> memory_pool_;
 
   // High resolution vp9 may block the media thread for too long, in such cases
-  // we share a per-process thread to avoid overly long blocks.
+  // we share a per-process thread to avoid overly long blocks. With
+  // kSharedVideoDecodeThreads, all decodes happen on |decode_stream_|'s thread
+  // instead.
   scoped_refptr<base::SingleThreadTaskRunner> offload_task_runner_;
+  std::unique_ptr<VideoDecodeScheduler::Stream> decode_stream_;
 
   VideoFramePool frame_pool_;
 
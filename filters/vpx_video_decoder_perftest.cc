@@ -0,0 +1,211 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/process/process_metrics.h"
+#include "base/run_loop.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/test/scoped_task_environment.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/media_switches.h"
+#include "media/base/media_util.h"
+#include "media/base/shared_frame_buffer_pool.h"
+#include "media/base/test_data_util.h"
+#include "media/base/video_decoder_config.h"
+#include "media/filters/ivf_parser.h"
+#include "media/filters/vpx_video_decoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kDecoderCount = 8;
+
+// Output frames each decoder keeps alive, as a renderer's queue would.
+static const size_t kHeldFrames = 4;
+
+struct Clip {
+  VideoDecoderConfig config;
+  std::vector<scoped_refptr<DecoderBuffer>> buffers;
+};
+
+static Clip ReadIvfClip(const std::string& name) {
+  scoped_refptr<DecoderBuffer> file = ReadTestDataFile(name);
+  IvfParser parser;
+  IvfFileHeader file_header = {};
+  CHECK(parser.Initialize(file->data(), file->data_size(), &file_header));
+
+  const gfx::Size size(file_header.width, file_header.height);
+  Clip clip;
+  clip.config.Initialize(kCodecVP9, VP9PROFILE_PROFILE0, PIXEL_FORMAT_YV12,
+                         COLOR_SPACE_UNSPECIFIED, VIDEO_ROTATION_0, size,
+                         gfx::Rect(size), size, EmptyExtraData(),
+                         Unencrypted());
+
+  IvfFrameHeader frame_header = {};
+  const uint8_t* payload = nullptr;
+  while (parser.ParseNextFrame(&frame_header, &payload)) {
+    clip.buffers.push_back(
+        DecoderBuffer::CopyFrom(payload, frame_header.frame_size));
+  }
+  CHECK(!clip.buffers.empty());
+  return clip;
+}
+
+// Samples the resident memory of the process, and keeps its peak.
+class PeakMemorySampler {
+ public:
+  PeakMemorySampler()
+      : metrics_(base::ProcessMetrics::CreateCurrentProcessMetrics()),
+        baseline_(metrics_->GetWorkingSetSize()),
+        peak_(baseline_) {}
+
+  void Sample() { peak_ = std::max(peak_, metrics_->GetWorkingSetSize()); }
+
+  // Growth of the resident memory over its size at construction.
+  size_t peak_growth() const { return peak_ - baseline_; }
+
+ private:
+  std::unique_ptr<base::ProcessMetrics> metrics_;
+  const size_t baseline_;
+  size_t peak_;
+
+  DISALLOW_COPY_AND_ASSIGN(PeakMemorySampler);
+};
+
+// Decodes each clip in turn with one VpxVideoDecoder, reinitializing it for a
+// resolution change between them, while holding on to the last few frames.
+class DecodeSequence {
+ public:
+  DecodeSequence(std::vector<const Clip*> clips,
+                 PeakMemorySampler* sampler,
+                 const base::Closure& done_cb)
+      : clips_(std::move(clips)),
+        decoder_(new VpxVideoDecoder()),
+        sampler_(sampler),
+        done_cb_(done_cb),
+        clip_index_(0),
+        next_buffer_(0) {}
+
+  void Start() { InitializeDecoder(); }
+
+ private:
+  void InitializeDecoder() {
+    next_buffer_ = 0;
+    decoder_->Initialize(
+        clips_[clip_index_]->config, false, nullptr,
+        base::Bind(&DecodeSequence::OnInitialized, base::Unretained(this)),
+        base::Bind(&DecodeSequence::OnOutput, base::Unretained(this)));
+  }
+
+  void OnInitialized(bool success) {
+    CHECK(success);
+    DecodeNextBuffer();
+  }
+
+  void OnOutput(const scoped_refptr<VideoFrame>& frame) {
+    held_frames_.push_back(frame);
+    if (held_frames_.size() > kHeldFrames)
+      held_frames_.pop_front();
+    sampler_->Sample();
+  }
+
+  void DecodeNextBuffer() {
+    const Clip& clip = *clips_[clip_index_];
+    if (next_buffer_ < clip.buffers.size()) {
+      decoder_->Decode(
+          clip.buffers[next_buffer_++],
+          base::Bind(&DecodeSequence::OnDecoded, base::Unretained(this)));
+      return;
+    }
+    if (++clip_index_ < clips_.size()) {
+      InitializeDecoder();
+      return;
+    }
+    held_frames_.clear();
+    done_cb_.Run();
+  }
+
+  void OnDecoded(DecodeStatus status) {
+    CHECK_EQ(DecodeStatus::OK, status);
+    DecodeNextBuffer();
+  }
+
+  const std::vector<const Clip*> clips_;
+  std::unique_ptr<VpxVideoDecoder> decoder_;
+  PeakMemorySampler* const sampler_;
+  const base::Closure done_cb_;
+  size_t clip_index_;
+  size_t next_buffer_;
+  base::circular_deque<scoped_refptr<VideoFrame>> held_frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(DecodeSequence);
+};
+
+// Runs |kDecoderCount| decoders at once, half of them switching from |clip1|
+// to |clip2| and half the other way around, and reports the peak growth of
+// the resident memory of the process.
+static void RunMemoryBenchmark(const Clip& clip1,
+                               const Clip& clip2,
+                               bool shared_pool) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  if (shared_pool)
+    scoped_feature_list.InitAndEnableFeature(kSharedFrameBufferPool);
+  else
+    scoped_feature_list.InitAndDisableFeature(kSharedFrameBufferPool);
+
+  PeakMemorySampler sampler;
+  base::RunLoop run_loop;
+  base::Closure done_cb =
+      base::BarrierClosure(kDecoderCount, run_loop.QuitClosure());
+  std::vector<std::unique_ptr<DecodeSequence>> sequences;
+  for (int i = 0; i < kDecoderCount; ++i) {
+    std::vector<const Clip*> clips = {&clip1, &clip2};
+    if (i % 2)
+      std::swap(clips[0], clips[1]);
+    sequences.push_back(
+        base::MakeUnique<DecodeSequence>(std::move(clips), &sampler, done_cb));
+  }
+
+  for (auto& sequence : sequences)
+    sequence->Start();
+  run_loop.Run();
+  sequences.clear();
+  base::RunLoop().RunUntilIdle();
+
+  const std::string trace = shared_pool ? "shared_pool" : "per_decoder";
+  perf_test::PrintResult("vpx_decoder_memory", "_peak_rss", trace,
+                         sampler.peak_growth() / 1024, "kb", true);
+  if (shared_pool) {
+    perf_test::PrintResult(
+        "vpx_decoder_memory", "_peak_pool", trace,
+        SharedFrameBufferPool::GetInstance()->peak_allocated_bytes() / 1024,
+        "kb", true);
+  }
+}
+
+TEST(VpxVideoDecoderPerfTest, MultiDecoderPeakMemory) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  const Clip bear = ReadIvfClip("bear-vp9.ivf");
+  const Clip crowd = ReadIvfClip("crowd-vp9.2.ivf");
+
+  // The per decoder run goes first, as the shared pool keeps idle buffers.
+  RunMemoryBenchmark(crowd, bear, false);
+  RunMemoryBenchmark(crowd, bear, true);
+}
+
+}  // namespace media
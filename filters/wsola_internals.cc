@@ -6,12 +6,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <memory>
 
 #include "base/logging.h"
 #include "base/numerics/math_constants.h"
+#include "build/build_config.h"
 #include "media/base/audio_bus.h"
+#include "media/base/vector_math.h"
 
 #if defined(ARCH_CPU_X86_FAMILY)
 #define USE_SIMD 1
@@ -54,55 +57,12 @@ void MultiChannelDotProduct(const AudioBus* a,
   DCHECK_LE(frame_offset_a + num_frames, a->frames());
   DCHECK_LE(frame_offset_b + num_frames, b->frames());
 
-// SIMD optimized variants can provide a massive speedup to this operation.
-#if defined(USE_SIMD)
-  const int rem = num_frames % 4;
-  const int last_index = num_frames - rem;
-  const int channels = a->channels();
-  for (int ch = 0; ch < channels; ++ch) {
-    const float* a_src = a->channel(ch) + frame_offset_a;
-    const float* b_src = b->channel(ch) + frame_offset_b;
-
-#if defined(ARCH_CPU_X86_FAMILY)
-    // First sum all components.
-    __m128 m_sum = _mm_setzero_ps();
-    for (int s = 0; s < last_index; s += 4) {
-      m_sum = _mm_add_ps(
-          m_sum, _mm_mul_ps(_mm_loadu_ps(a_src + s), _mm_loadu_ps(b_src + s)));
-    }
-
-    // Reduce to a single float for this channel. Sadly, SSE1,2 doesn't have a
-    // horizontal sum function, so we have to condense manually.
-    m_sum = _mm_add_ps(_mm_movehl_ps(m_sum, m_sum), m_sum);
-    _mm_store_ss(dot_product + ch,
-                 _mm_add_ss(m_sum, _mm_shuffle_ps(m_sum, m_sum, 1)));
-#elif defined(ARCH_CPU_ARM_FAMILY)
-    // First sum all components.
-    float32x4_t m_sum = vmovq_n_f32(0);
-    for (int s = 0; s < last_index; s += 4)
-      m_sum = vmlaq_f32(m_sum, vld1q_f32(a_src + s), vld1q_f32(b_src + s));
-
-    // Reduce to a single float for this channel.
-    float32x2_t m_half = vadd_f32(vget_high_f32(m_sum), vget_low_f32(m_sum));
-    dot_product[ch] = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
-#endif
-  }
-
-  if (!rem)
-    return;
-  num_frames = rem;
-  frame_offset_a += last_index;
-  frame_offset_b += last_index;
-#else
-  memset(dot_product, 0, sizeof(*dot_product) * a->channels());
-#endif  // defined(USE_SIMD)
-
-  // C version is required to handle remainder of frames (% 4 != 0)
+  // vector_math::DotProduct() picks the widest SIMD implementation available
+  // at runtime, which provides a massive speedup to this operation.
   for (int k = 0; k < a->channels(); ++k) {
-    const float* ch_a = a->channel(k) + frame_offset_a;
-    const float* ch_b = b->channel(k) + frame_offset_b;
-    for (int n = 0; n < num_frames; ++n)
-      dot_product[k] += *ch_a++ * *ch_b++;
+    dot_product[k] = vector_math::DotProduct(a->channel(k) + frame_offset_a,
+                                             b->channel(k) + frame_offset_b,
+                                             num_frames);
   }
 }
 
@@ -115,13 +75,12 @@ void MultiChannelMovingBlockEnergies(const AudioBus* input,
   for (int k = 0; k < input->channels(); ++k) {
     const float* input_channel = input->channel(k);
 
-    energy[k] = 0;
-
     // First block of channel |k|.
-    for (int m = 0; m < frames_per_block; ++m) {
-      energy[k] += input_channel[m] * input_channel[m];
-    }
+    energy[k] = vector_math::DotProduct(input_channel, input_channel,
+                                        frames_per_block);
 
+    // The remaining blocks are a running update, which is inherently serial
+    // but only costs two multiply-adds per block.
     const float* slide_out = input_channel;
     const float* slide_in = input_channel + frames_per_block;
     for (int n = 1; n < num_blocks; ++n, ++slide_in, ++slide_out) {
@@ -306,6 +265,298 @@ int OptimalIndex(const AudioBus* search_block,
                     energy_candidate_blocks.get());
 }
 
+FftCrossCorrelator::FftCrossCorrelator(int target_frames, int search_frames)
+    : target_frames_(target_frames),
+      search_frames_(search_frames),
+      fft_size_(1) {
+  DCHECK_GT(target_frames_, 0);
+  DCHECK_GE(search_frames_, target_frames_);
+
+  // A circular correlation of this size doesn't wrap any of the candidate
+  // blocks, since those never extend past the end of the search segment.
+  int log2_fft_size = 0;
+  while (fft_size_ < search_frames_) {
+    fft_size_ <<= 1;
+    ++log2_fft_size;
+  }
+
+  bit_reversed_indices_.reset(new int[fft_size_]);
+  for (int n = 0; n < fft_size_; ++n) {
+    int reversed = 0;
+    for (int bit = 0; bit < log2_fft_size; ++bit)
+      reversed |= ((n >> bit) & 1) << (log2_fft_size - 1 - bit);
+    bit_reversed_indices_[n] = reversed;
+  }
+
+  // The twiddles of each butterfly stage are stored contiguously, so the
+  // innermost loop of Transform() reads them sequentially: the stage of length
+  // L uses the L / 2 factors starting at offset L / 2 - 1.
+  const int num_twiddles = std::max(fft_size_ - 1, 1);
+  twiddle_real_.reset(new float[num_twiddles]);
+  twiddle_imag_.reset(new float[num_twiddles]);
+  for (int length = 2; length <= fft_size_; length <<= 1) {
+    const int half_length = length / 2;
+    for (int k = 0; k < half_length; ++k) {
+      // Computed in double precision to keep the roots accurate for long FFTs.
+      const double angle = -2.0 * base::kPiDouble * k / length;
+      twiddle_real_[half_length - 1 + k] = static_cast<float>(std::cos(angle));
+      twiddle_imag_[half_length - 1 + k] = static_cast<float>(std::sin(angle));
+    }
+  }
+
+  real_.reset(new float[fft_size_]);
+  imag_.reset(new float[fft_size_]);
+  pair_real_.reset(new float[fft_size_]);
+  pair_imag_.reset(new float[fft_size_]);
+}
+
+FftCrossCorrelator::~FftCrossCorrelator() {}
+
+void FftCrossCorrelator::Transform(bool inverse) {
+  float* real = real_.get();
+  float* imag = imag_.get();
+
+  for (int n = 0; n < fft_size_; ++n) {
+    const int m = bit_reversed_indices_[n];
+    if (m > n) {
+      std::swap(real[n], real[m]);
+      std::swap(imag[n], imag[m]);
+    }
+  }
+
+  const float sign = inverse ? -1.0f : 1.0f;
+  int length = 2;
+  if (fft_size_ >= 4) {
+    // The first two stages only have trivial twiddle factors, 1 and -/+i, so
+    // they are merged into one multiplication-free radix-4 pass.
+    for (int start = 0; start < fft_size_; start += 4) {
+      float* r = real + start;
+      float* i = imag + start;
+      const float b0_real = r[0] + r[1];
+      const float b0_imag = i[0] + i[1];
+      const float b1_real = r[0] - r[1];
+      const float b1_imag = i[0] - i[1];
+      const float b2_real = r[2] + r[3];
+      const float b2_imag = i[2] + i[3];
+      const float t_real = sign * (i[2] - i[3]);
+      const float t_imag = sign * (r[3] - r[2]);
+      r[0] = b0_real + b2_real;
+      i[0] = b0_imag + b2_imag;
+      r[2] = b0_real - b2_real;
+      i[2] = b0_imag - b2_imag;
+      r[1] = b1_real + t_real;
+      i[1] = b1_imag + t_imag;
+      r[3] = b1_real - t_real;
+      i[3] = b1_imag - t_imag;
+    }
+    length = 8;
+  }
+
+  for (; length <= fft_size_; length <<= 1) {
+    const int half_length = length / 2;
+    const float* w_reals = twiddle_real_.get() + half_length - 1;
+    const float* w_imags = twiddle_imag_.get() + half_length - 1;
+    for (int start = 0; start < fft_size_; start += length) {
+      float* even_real = real + start;
+      float* even_imag = imag + start;
+      float* odd_real = even_real + half_length;
+      float* odd_imag = even_imag + half_length;
+      int k = 0;
+#if defined(USE_SIMD)
+      // Four butterflies at a time once the stages are long enough.
+      const int last_index = half_length - half_length % 4;
+#if defined(ARCH_CPU_X86_FAMILY)
+      const __m128 m_sign = _mm_set1_ps(sign);
+      for (; k < last_index; k += 4) {
+        const __m128 w_real = _mm_loadu_ps(w_reals + k);
+        const __m128 w_imag = _mm_mul_ps(m_sign, _mm_loadu_ps(w_imags + k));
+        const __m128 o_real = _mm_loadu_ps(odd_real + k);
+        const __m128 o_imag = _mm_loadu_ps(odd_imag + k);
+        const __m128 e_real = _mm_loadu_ps(even_real + k);
+        const __m128 e_imag = _mm_loadu_ps(even_imag + k);
+        const __m128 t_real = _mm_sub_ps(_mm_mul_ps(o_real, w_real),
+                                         _mm_mul_ps(o_imag, w_imag));
+        const __m128 t_imag = _mm_add_ps(_mm_mul_ps(o_real, w_imag),
+                                         _mm_mul_ps(o_imag, w_real));
+        _mm_storeu_ps(odd_real + k, _mm_sub_ps(e_real, t_real));
+        _mm_storeu_ps(odd_imag + k, _mm_sub_ps(e_imag, t_imag));
+        _mm_storeu_ps(even_real + k, _mm_add_ps(e_real, t_real));
+        _mm_storeu_ps(even_imag + k, _mm_add_ps(e_imag, t_imag));
+      }
+#elif defined(ARCH_CPU_ARM_FAMILY)
+      for (; k < last_index; k += 4) {
+        const float32x4_t w_real = vld1q_f32(w_reals + k);
+        const float32x4_t w_imag = vmulq_n_f32(vld1q_f32(w_imags + k), sign);
+        const float32x4_t o_real = vld1q_f32(odd_real + k);
+        const float32x4_t o_imag = vld1q_f32(odd_imag + k);
+        const float32x4_t e_real = vld1q_f32(even_real + k);
+        const float32x4_t e_imag = vld1q_f32(even_imag + k);
+        const float32x4_t t_real =
+            vmlsq_f32(vmulq_f32(o_real, w_real), o_imag, w_imag);
+        const float32x4_t t_imag =
+            vmlaq_f32(vmulq_f32(o_real, w_imag), o_imag, w_real);
+        vst1q_f32(odd_real + k, vsubq_f32(e_real, t_real));
+        vst1q_f32(odd_imag + k, vsubq_f32(e_imag, t_imag));
+        vst1q_f32(even_real + k, vaddq_f32(e_real, t_real));
+        vst1q_f32(even_imag + k, vaddq_f32(e_imag, t_imag));
+      }
+#endif
+#endif  // defined(USE_SIMD)
+
+      // C version is required for the short stages and their remainder.
+      for (; k < half_length; ++k) {
+        const float w_real = w_reals[k];
+        const float w_imag = sign * w_imags[k];
+        const float t_real = odd_real[k] * w_real - odd_imag[k] * w_imag;
+        const float t_imag = odd_real[k] * w_imag + odd_imag[k] * w_real;
+        odd_real[k] = even_real[k] - t_real;
+        odd_imag[k] = even_imag[k] - t_imag;
+        even_real[k] += t_real;
+        even_imag[k] += t_imag;
+      }
+    }
+  }
+}
+
+void FftCrossCorrelator::ComputeCrossSpectrum(const float* target,
+                                              const float* search) {
+  float* real = real_.get();
+  float* imag = imag_.get();
+
+  // Both real signals are transformed at once by packing the target block into
+  // the real part and the search segment into the imaginary part.
+  memcpy(real, target, sizeof(*real) * target_frames_);
+  memset(real + target_frames_, 0,
+         sizeof(*real) * (fft_size_ - target_frames_));
+  memcpy(imag, search, sizeof(*imag) * search_frames_);
+  memset(imag + search_frames_, 0,
+         sizeof(*imag) * (fft_size_ - search_frames_));
+  Transform(false);
+
+  // Split the spectra using their conjugate symmetry, T[n] = (Z[n] +
+  // conj(Z[-n])) / 2 and S[n] = (Z[n] - conj(Z[-n])) / 2i, and form the
+  // cross-spectrum conj(T[n]) * S[n]. The cross-spectrum of two real signals
+  // is conjugate symmetric too, so bins n and -n are filled at once.
+  for (int n = 0; n <= fft_size_ / 2; ++n) {
+    const int m = (fft_size_ - n) & (fft_size_ - 1);
+    const float t_real = 0.5f * (real[n] + real[m]);
+    const float t_imag = 0.5f * (imag[n] - imag[m]);
+    const float s_real = 0.5f * (imag[n] + imag[m]);
+    const float s_imag = 0.5f * (real[m] - real[n]);
+    const float p_real = t_real * s_real + t_imag * s_imag;
+    const float p_imag = t_real * s_imag - t_imag * s_real;
+    real[n] = p_real;
+    imag[n] = p_imag;
+    real[m] = p_real;
+    imag[m] = -p_imag;
+  }
+}
+
+void FftCrossCorrelator::MultiChannelCrossCorrelation(
+    const AudioBus* target_block,
+    const AudioBus* search_block,
+    float* dot_products) {
+  DCHECK_EQ(target_block->channels(), search_block->channels());
+  DCHECK_EQ(target_frames_, target_block->frames());
+  DCHECK_EQ(search_frames_, search_block->frames());
+
+  const int channels = search_block->channels();
+  const int num_candidate_blocks = search_frames_ - (target_frames_ - 1);
+  const float scale = 1.0f / fft_size_;
+
+  for (int k = 0; k < channels; k += 2) {
+    ComputeCrossSpectrum(target_block->channel(k), search_block->channel(k));
+    const bool has_pair = k + 1 < channels;
+    if (has_pair) {
+      // Channels are inverse transformed in pairs: since both correlations
+      // are real, the one of channel |k| + 1 can ride in the imaginary part.
+      real_.swap(pair_real_);
+      imag_.swap(pair_imag_);
+      ComputeCrossSpectrum(target_block->channel(k + 1),
+                           search_block->channel(k + 1));
+      float* real = real_.get();
+      float* imag = imag_.get();
+      for (int n = 0; n < fft_size_; ++n) {
+        const float p_real = real[n];
+        real[n] = pair_real_[n] - imag[n];
+        imag[n] = pair_imag_[n] + p_real;
+      }
+    }
+    Transform(true);
+
+    for (int n = 0; n < num_candidate_blocks; ++n)
+      dot_products[k + n * channels] = real_[n] * scale;
+    if (has_pair) {
+      for (int n = 0; n < num_candidate_blocks; ++n)
+        dot_products[k + 1 + n * channels] = imag_[n] * scale;
+    }
+  }
+}
+
+bool ShouldUseFftSearch(int target_frames, int search_frames) {
+  // The decimated search costs about |num_candidate_blocks| / 5 + 11 dot
+  // products of |target_frames| each, which grows quadratically with the
+  // sample rate while the correlation grows as N log N. Measured on x86, the
+  // two break even for the 20 ms blocks of an 88.2 or 96 kHz stream; below
+  // that the decimated search is cheaper.
+  const int kMinFftTargetFrames = 1536;
+  return target_frames >= kMinFftTargetFrames &&
+         search_frames >= target_frames;
+}
+
+int OptimalIndex(const AudioBus* search_block,
+                 const AudioBus* target_block,
+                 Interval exclude_interval,
+                 FftCrossCorrelator* correlator) {
+  int channels = search_block->channels();
+  DCHECK_EQ(channels, target_block->channels());
+  int target_size = target_block->frames();
+  int num_candidate_blocks = search_block->frames() - (target_size - 1);
+
+  std::unique_ptr<float[]> energy_target_block(new float[channels]);
+  std::unique_ptr<float[]> energy_candidate_blocks(
+      new float[channels * num_candidate_blocks]);
+  std::unique_ptr<float[]> dot_products(
+      new float[channels * num_candidate_blocks]);
+
+  MultiChannelMovingBlockEnergies(search_block, target_size,
+                                  energy_candidate_blocks.get());
+  MultiChannelDotProduct(target_block, 0, target_block, 0, target_size,
+                         energy_target_block.get());
+  correlator->MultiChannelCrossCorrelation(target_block, search_block,
+                                           dot_products.get());
+
+  // Rounding errors of the FFT are relative to the whole search segment, so a
+  // quiet candidate block next to loud ones could end up with a dot-product
+  // far larger than its energy allows. Clamp to the Cauchy-Schwarz bound so
+  // such a block can't look more similar than an identical one.
+  for (int n = 0; n < num_candidate_blocks; ++n) {
+    float* dot_prod = &dot_products[n * channels];
+    const float* energy_candidate = &energy_candidate_blocks[n * channels];
+    for (int k = 0; k < channels; ++k) {
+      const float bound = std::sqrt(
+          std::max(energy_target_block[k] * energy_candidate[k], 0.0f));
+      dot_prod[k] = std::min(std::max(dot_prod[k], -bound), bound);
+    }
+  }
+
+  // Same selection rule as FullSearch().
+  float best_similarity = std::numeric_limits<float>::min();
+  int optimal_index = 0;
+  for (int n = 0; n < num_candidate_blocks; ++n) {
+    if (InInterval(n, exclude_interval))
+      continue;
+    float similarity = MultiChannelSimilarityMeasure(
+        &dot_products[n * channels], energy_target_block.get(),
+        &energy_candidate_blocks[n * channels], channels);
+    if (similarity > best_similarity) {
+      best_similarity = similarity;
+      optimal_index = n;
+    }
+  }
+  return optimal_index;
+}
+
 void GetSymmetricHanningWindow(int window_length, float* window) {
   const float scale = 2.0f * base::kPiFloat / window_length;
   for (int n = 0; n < window_length; ++n)
@@ -7,8 +7,10 @@
 #ifndef MEDIA_FILTERS_WSOLA_INTERNALS_H_
 #define MEDIA_FILTERS_WSOLA_INTERNALS_H_
 
+#include <memory>
 #include <utility>
 
+#include "base/macros.h"
 #include "media/base/media_export.h"
 
 namespace media {
@@ -76,6 +78,68 @@ MEDIA_EXPORT int OptimalIndex(const AudioBus* search_block,
                               const AudioBus* target_block,
                               Interval exclude_interval);
 
+// Computes the dot-products of a target block with every candidate block of a
+// search segment at once, using FFT-based cross-correlation. This costs
+// O(N log N) per channel, N being the search segment length rounded up to a
+// power of two, instead of the O(N * M) of repeated MultiChannelDotProduct()
+// calls for an M frame target; it pays off for the long windows used at high
+// sample rates.
+class MEDIA_EXPORT FftCrossCorrelator {
+ public:
+  FftCrossCorrelator(int target_frames, int search_frames);
+  ~FftCrossCorrelator();
+
+  // Computes the dot-product of |target_block| with each of the
+  // |search_frames| - |target_frames| + 1 candidate blocks of |search_block|.
+  // Like MultiChannelMovingBlockEnergies(), the results are interleaved; i.e.,
+  // |dot_products[k + n * channels]| is the dot-product of channel |k| of
+  // |target_block| and frames [n, n + |target_frames|) of |search_block|.
+  void MultiChannelCrossCorrelation(const AudioBus* target_block,
+                                    const AudioBus* search_block,
+                                    float* dot_products);
+
+ private:
+  // Fills |real_| and |imag_| with the spectrum of the correlation of |target|
+  // and |search|.
+  void ComputeCrossSpectrum(const float* target, const float* search);
+
+  // In-place radix-2 FFT of |real_| and |imag_|. The inverse transform is not
+  // scaled.
+  void Transform(bool inverse);
+
+  const int target_frames_;
+  const int search_frames_;
+  int fft_size_;
+
+  // Bit-reversed index of each FFT bin and the twiddle factors of every
+  // butterfly stage, exp(-2 * pi * i * k / L) for k < L / 2.
+  std::unique_ptr<int[]> bit_reversed_indices_;
+  std::unique_ptr<float[]> twiddle_real_;
+  std::unique_ptr<float[]> twiddle_imag_;
+
+  // Transform work buffers, plus room for a second cross-spectrum so channels
+  // can be inverse transformed in pairs.
+  std::unique_ptr<float[]> real_;
+  std::unique_ptr<float[]> imag_;
+  std::unique_ptr<float[]> pair_real_;
+  std::unique_ptr<float[]> pair_imag_;
+
+  DISALLOW_COPY_AND_ASSIGN(FftCrossCorrelator);
+};
+
+// Returns true if OptimalIndex() should use a FftCrossCorrelator rather than
+// the decimated search for blocks of the given sizes.
+MEDIA_EXPORT bool ShouldUseFftSearch(int target_frames, int search_frames);
+
+// Like OptimalIndex() above, but evaluates every candidate block using the
+// dot-products computed by |correlator|, whose sizes must match those of
+// |target_block| and |search_block|. Since the search is exhaustive, it never
+// misses the optimal index the way the decimated search can.
+MEDIA_EXPORT int OptimalIndex(const AudioBus* search_block,
+                              const AudioBus* target_block,
+                              Interval exclude_interval,
+                              FftCrossCorrelator* correlator);
+
 // Return a "periodic" Hann window. This is the first L samples of an L+1
 // Hann window. It is perfect reconstruction for overlap-and-add.
 MEDIA_EXPORT void GetSymmetricHanningWindow(int window_length, float* window);
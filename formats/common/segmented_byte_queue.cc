@@ -0,0 +1,217 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/formats/common/segmented_byte_queue.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "base/logging.h"
+
+namespace media {
+
+// Segments are allocated at least this large, so that small pushes share them.
+enum { kMinSegmentSize = 64 * 1024 };
+
+// The most bytes a bridge copies from the segment it runs into beyond the
+// window it was made for.
+enum { kMaxBridgeOverlap = 4 * 1024 };
+
+// Memory holding one or more segments, freed with the last of them.  Bytes are
+// only ever appended to it.
+class SegmentedByteQueue::Memory : public base::RefCounted<Memory> {
+ public:
+  explicit Memory(size_t capacity)
+      : data_(new uint8_t[capacity]), capacity_(capacity), size_(0) {}
+
+  const uint8_t* front() const { return data_.get(); }
+
+  // Returns a pointer just past the bytes appended so far.
+  const uint8_t* end() const { return data_.get() + size_; }
+
+  // Appends as many of the |size| bytes of |data| as fit, and returns how many
+  // that was.
+  int Append(const uint8_t* data, int size) {
+    const int appended = std::min<size_t>(size, capacity_ - size_);
+    memcpy(data_.get() + size_, data, appended);
+    size_ += appended;
+    return appended;
+  }
+
+ private:
+  friend class base::RefCounted<Memory>;
+  ~Memory() {}
+
+  std::unique_ptr<uint8_t[]> data_;
+  const size_t capacity_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(Memory);
+};
+
+SegmentedByteQueue::Segment::Segment(scoped_refptr<Memory> memory,
+                                     int64_t offset,
+                                     const uint8_t* data,
+                                     int size)
+    : memory(std::move(memory)), offset(offset), data(data), size(size) {}
+
+SegmentedByteQueue::Segment::Segment(const Segment& other) = default;
+
+SegmentedByteQueue::Segment::~Segment() {}
+
+SegmentedByteQueue::SegmentedByteQueue() : head_(0), tail_(0) {}
+
+SegmentedByteQueue::~SegmentedByteQueue() {}
+
+void SegmentedByteQueue::Reset() {
+  segments_.clear();
+  head_ = 0;
+  tail_ = 0;
+}
+
+void SegmentedByteQueue::Push(const uint8_t* buf, int size) {
+  DCHECK(buf);
+  DCHECK_GT(size, 0);
+  tail_ += size;
+
+  // Fill up the memory of the last segment first, if the segment runs to its
+  // end.
+  if (!segments_.empty()) {
+    Segment& last = segments_.back();
+    if (last.data + last.size == last.memory->end()) {
+      const int appended = last.memory->Append(buf, size);
+      last.size += appended;
+      buf += appended;
+      size -= appended;
+    }
+  }
+  if (!size)
+    return;
+
+  scoped_refptr<Memory> memory(
+      new Memory(std::max(size, static_cast<int>(kMinSegmentSize))));
+  memory->Append(buf, size);
+  const uint8_t* data = memory->front();
+  segments_.emplace_back(std::move(memory), tail_ - size, data, size);
+  DVLOG(4) << "Segment pushed. head=" << head() << " tail=" << tail()
+           << " segments=" << segments_.size();
+}
+
+void SegmentedByteQueue::Peek(int min_size, const uint8_t** buf, int* size) {
+  PeekAt(head_, min_size, buf, size);
+}
+
+void SegmentedByteQueue::PeekAt(int64_t offset,
+                                int min_size,
+                                const uint8_t** buf,
+                                int* size) {
+  DCHECK(offset >= head());
+  if (offset < head() || offset >= tail()) {
+    *buf = NULL;
+    *size = 0;
+    return;
+  }
+
+  SegmentQueue::iterator it = FindSegment(offset);
+  min_size = std::min<int64_t>(min_size, tail_ - offset);
+  if (it->offset + it->size - offset < min_size)
+    it = Coalesce(offset, min_size);
+
+  *buf = it->data + (offset - it->offset);
+  *size = it->offset + it->size - offset;
+}
+
+void SegmentedByteQueue::Pop(int count) {
+  DCHECK_LE(count, tail_ - head_);
+  head_ += count;
+
+  // A segment is done with once the bytes it holds are popped, or once the
+  // next one holds the head, since only the bridge over the start of that one
+  // can be left.
+  while (!segments_.empty() &&
+         (segments_.front().offset + segments_.front().size <= head_ ||
+          (segments_.size() > 1 && segments_[1].offset <= head_))) {
+    segments_.pop_front();
+  }
+  if (segments_.empty())
+    return;
+
+  Segment& first = segments_.front();
+  if (first.offset < head_) {
+    const int popped = head_ - first.offset;
+    first.offset += popped;
+    first.data += popped;
+    first.size -= popped;
+  }
+}
+
+bool SegmentedByteQueue::Trim(int64_t max_offset) {
+  if (max_offset < head_)
+    return true;
+  if (max_offset > tail()) {
+    Pop(tail_ - head_);
+    return false;
+  }
+  Pop(max_offset - head_);
+  return true;
+}
+
+SegmentedByteQueue::SegmentQueue::iterator SegmentedByteQueue::FindSegment(
+    int64_t offset) {
+  DCHECK(offset >= head() && offset < tail());
+  SegmentQueue::iterator it = std::upper_bound(
+      segments_.begin(), segments_.end(), offset,
+      [](int64_t offset, const Segment& segment) {
+        return offset < segment.offset;
+      });
+  DCHECK(it != segments_.begin());
+  return --it;
+}
+
+SegmentedByteQueue::SegmentQueue::iterator SegmentedByteQueue::LowerBound(
+    int64_t offset) {
+  return std::lower_bound(segments_.begin(), segments_.end(), offset,
+                          [](const Segment& segment, int64_t offset) {
+                            return segment.offset < offset;
+                          });
+}
+
+SegmentedByteQueue::SegmentQueue::iterator SegmentedByteQueue::Coalesce(
+    int64_t offset,
+    int size) {
+  DCHECK_LE(offset + size, tail_);
+
+  // Run the bridge a little way into the segment the window ends in, so that
+  // a window sliding across the start of that segment is only copied once.
+  SegmentQueue::iterator last = FindSegment(offset + size - 1);
+  const int64_t end = std::min(
+      tail_, std::max(offset + size,
+                      last->offset + std::min<int>(size, kMaxBridgeOverlap)));
+  scoped_refptr<Memory> memory(new Memory(end - offset));
+  for (int64_t pos = offset; pos < end;) {
+    SegmentQueue::iterator it = FindSegment(pos);
+    const int64_t segment_end = std::min(end, it->offset + it->size);
+    memory->Append(it->data + (pos - it->offset), segment_end - pos);
+    pos = segment_end;
+  }
+
+  // Drop the segments that the bridge covers entirely.
+  SegmentQueue::iterator it = LowerBound(offset);
+  while (it != segments_.end() && it->offset < end) {
+    if (it->offset + it->size <= end)
+      it = segments_.erase(it);
+    else
+      ++it;
+  }
+
+  const uint8_t* data = memory->front();
+  DVLOG(4) << "Bridged " << end - offset << " bytes at " << offset;
+  return segments_.emplace(LowerBound(offset), std::move(memory), offset, data,
+                           end - offset);
+}
+
+}  // namespace media
@@ -0,0 +1,106 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_FORMATS_COMMON_SEGMENTED_BYTE_QUEUE_H_
+#define MEDIA_FORMATS_COMMON_SEGMENTED_BYTE_QUEUE_H_
+
+#include <stdint.h>
+
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// A queue of bytes addressed by monotonically-increasing offsets, like
+// OffsetByteQueue, but held in a list of segments rather than one contiguous
+// buffer.  Pushing data never moves or reallocates the bytes already queued, so
+// large appends fed in pieces are copied once.  Bytes are only copied again
+// when a parser asks for a window that spans segments, into a "bridge" segment
+// covering the window which overlaps the segment after it.
+class MEDIA_EXPORT SegmentedByteQueue {
+ public:
+  SegmentedByteQueue();
+  ~SegmentedByteQueue();
+
+  // Empties the queue and moves head() and tail() back to zero.
+  void Reset();
+
+  // Appends |size| bytes of |buf| to the end of the queue.
+  void Push(const uint8_t* buf, int size);
+
+  // Sets |buf| to point at the first queued byte, and |size| to the number of
+  // contiguous bytes starting there, which may be fewer than are queued.  At
+  // least |min_size| bytes, or every queued byte if there are fewer, are made
+  // contiguous first.  If the queue is empty, you get back a null |buf| and a
+  // |size| of zero.  These values are only valid until the next Push(), Peek(),
+  // PeekAt(), Pop(), Trim() or Reset() call.
+  void Peek(int min_size, const uint8_t** buf, int* size);
+
+  // Like Peek(), but starting from the byte at |offset|.  It is an error if
+  // |offset| is before head(), and you get back a null |buf| and a |size| of
+  // zero if it is at or beyond tail().
+  void PeekAt(int64_t offset, int min_size, const uint8_t** buf, int* size);
+
+  // Removes |count| bytes from the front of the queue.
+  void Pop(int count);
+
+  // Removes the bytes up to (but not including) |max_offset|.
+  //
+  // Returns true if the full range of bytes were successfully trimmed,
+  // including the case where |max_offset| is less than the current head.
+  // Returns false if |max_offset| > tail() (although all bytes currently
+  // buffered are still cleared).
+  bool Trim(int64_t max_offset);
+
+  // The head and tail positions, in terms of the stream's absolute offsets.
+  // tail() is an exclusive bound.
+  int64_t head() const { return head_; }
+  int64_t tail() const { return tail_; }
+
+ private:
+  class Memory;
+
+  // A run of queued bytes held contiguously in |memory|.  Segments are ordered
+  // by |offset| and cover the queue with no gaps, but a bridge may overlap the
+  // start of the segment after it.
+  struct Segment {
+    Segment(scoped_refptr<Memory> memory,
+            int64_t offset,
+            const uint8_t* data,
+            int size);
+    Segment(const Segment& other);
+    ~Segment();
+
+    scoped_refptr<Memory> memory;
+
+    // Stream offset of the first byte, which is at |data|.
+    int64_t offset;
+    const uint8_t* data;
+    int size;
+  };
+  using SegmentQueue = base::circular_deque<Segment>;
+
+  // Returns the last segment starting at or before |offset|, which must be
+  // queued.
+  SegmentQueue::iterator FindSegment(int64_t offset);
+
+  // Returns the first segment starting at or after |offset|.
+  SegmentQueue::iterator LowerBound(int64_t offset);
+
+  // Copies at least the |size| bytes from |offset| into a new bridge segment,
+  // and returns it.
+  SegmentQueue::iterator Coalesce(int64_t offset, int size);
+
+  SegmentQueue segments_;
+  int64_t head_;
+  int64_t tail_;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentedByteQueue);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_FORMATS_COMMON_SEGMENTED_BYTE_QUEUE_H_
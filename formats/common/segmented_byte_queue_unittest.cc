@@ -0,0 +1,185 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/formats/common/segmented_byte_queue.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+class SegmentedByteQueueTest : public testing::Test {
+ public:
+  void SetUp() override {
+    uint8_t buf[256];
+    for (int i = 0; i < 256; i++) {
+      buf[i] = i;
+    }
+    queue_.reset(new SegmentedByteQueue);
+    queue_->Push(buf, sizeof(buf));
+    queue_->Push(buf, sizeof(buf));
+    queue_->Pop(384);
+
+    // Queue will start with 128 bytes of data and an offset of 384 bytes.
+    // These values are used throughout the test.
+  }
+
+ protected:
+  // Pushes |size| bytes whose values are their offsets in the stream, modulo
+  // 251 so that the pattern does not line up with power of two sizes.
+  void PushPattern(int size) {
+    std::vector<uint8_t> data(size);
+    for (int i = 0; i < size; i++)
+      data[i] = (queue_->tail() + i) % 251;
+    queue_->Push(data.data(), size);
+  }
+
+  // Checks that the |size| bytes at |buf| hold the pattern from |offset|.
+  void ExpectPattern(int64_t offset, const uint8_t* buf, int size) {
+    for (int i = 0; i < size; i++)
+      ASSERT_EQ((offset + i) % 251, buf[i]) << "offset " << offset + i;
+  }
+
+  std::unique_ptr<SegmentedByteQueue> queue_;
+};
+
+TEST_F(SegmentedByteQueueTest, SetUp) {
+  EXPECT_EQ(384, queue_->head());
+  EXPECT_EQ(512, queue_->tail());
+
+  const uint8_t* buf;
+  int size;
+
+  queue_->Peek(0, &buf, &size);
+  EXPECT_EQ(128, size);
+  EXPECT_EQ(128, buf[0]);
+  EXPECT_EQ(255, buf[size-1]);
+}
+
+TEST_F(SegmentedByteQueueTest, PeekAt) {
+  const uint8_t* buf;
+  int size;
+
+  queue_->PeekAt(400, 0, &buf, &size);
+  EXPECT_EQ(queue_->tail() - 400, size);
+  EXPECT_EQ(400 - 256, buf[0]);
+
+  queue_->PeekAt(512, 0, &buf, &size);
+  EXPECT_EQ(NULL, buf);
+  EXPECT_EQ(0, size);
+}
+
+TEST_F(SegmentedByteQueueTest, Trim) {
+  EXPECT_TRUE(queue_->Trim(128));
+  EXPECT_TRUE(queue_->Trim(384));
+  EXPECT_EQ(384, queue_->head());
+  EXPECT_EQ(512, queue_->tail());
+
+  EXPECT_TRUE(queue_->Trim(400));
+  EXPECT_EQ(400, queue_->head());
+  EXPECT_EQ(512, queue_->tail());
+
+  const uint8_t* buf;
+  int size;
+  queue_->PeekAt(400, 0, &buf, &size);
+  EXPECT_EQ(queue_->tail() - 400, size);
+  EXPECT_EQ(400 - 256, buf[0]);
+
+  // Trimming to the exact end of the buffer should return 'true'. This
+  // accomodates EOS cases.
+  EXPECT_TRUE(queue_->Trim(512));
+  EXPECT_EQ(512, queue_->head());
+  queue_->Peek(0, &buf, &size);
+  EXPECT_EQ(NULL, buf);
+
+  // Trimming past the end of the buffer should return 'false'; we haven't seen
+  // the preceeding bytes.
+  EXPECT_FALSE(queue_->Trim(513));
+
+  // However, doing that shouldn't affect the EOS case. Only adding new data
+  // should alter this behavior.
+  EXPECT_TRUE(queue_->Trim(512));
+}
+
+TEST_F(SegmentedByteQueueTest, PushDoesNotMoveData) {
+  queue_->Reset();
+  PushPattern(1000);
+
+  const uint8_t* buf;
+  int size;
+  queue_->Peek(0, &buf, &size);
+  EXPECT_EQ(1000, size);
+
+  // Pushes fill up the first segment and then go to new ones, leaving the bytes
+  // already peeked at where they were.
+  for (int i = 0; i < 100; i++)
+    PushPattern(1000);
+  ExpectPattern(0, buf, 1000);
+
+  const uint8_t* first_buf = buf;
+  queue_->Peek(0, &buf, &size);
+  EXPECT_EQ(first_buf, buf);
+  EXPECT_LT(size, queue_->tail());
+  ExpectPattern(0, buf, size);
+}
+
+TEST_F(SegmentedByteQueueTest, PeekAcrossSegments) {
+  queue_->Reset();
+  PushPattern(100000);
+  PushPattern(100000);
+
+  const uint8_t* buf;
+  int size;
+  queue_->PeekAt(99000, 0, &buf, &size);
+  EXPECT_EQ(1000, size);
+
+  // Asking for more makes the window contiguous.
+  queue_->PeekAt(99000, 2000, &buf, &size);
+  EXPECT_GE(size, 2000);
+  ExpectPattern(99000, buf, size);
+
+  // Windows sliding across the start of the second segment are served by the
+  // same copy...
+  const uint8_t* bridge = buf;
+  queue_->PeekAt(99500, 2000, &buf, &size);
+  EXPECT_EQ(bridge + 500, buf);
+  EXPECT_GE(size, 2000);
+
+  // ...and windows starting in it by the second segment itself.
+  queue_->PeekAt(100000, 2000, &buf, &size);
+  EXPECT_EQ(100000, size);
+  ExpectPattern(100000, buf, size);
+
+  // Windows larger than the queued data are cut short.
+  queue_->PeekAt(1000, 1000000, &buf, &size);
+  EXPECT_EQ(queue_->tail() - 1000, size);
+  ExpectPattern(1000, buf, size);
+
+  queue_->Pop(150000);
+  queue_->Peek(0, &buf, &size);
+  EXPECT_EQ(queue_->tail() - queue_->head(), size);
+  ExpectPattern(150000, buf, size);
+}
+
+TEST_F(SegmentedByteQueueTest, PopAcrossBridge) {
+  queue_->Reset();
+  PushPattern(100000);
+  PushPattern(100000);
+
+  const uint8_t* buf;
+  int size;
+  queue_->PeekAt(99000, 2000, &buf, &size);
+
+  // Popping into the second segment drops the bridge over its start.
+  queue_->Pop(100100);
+  queue_->Peek(0, &buf, &size);
+  EXPECT_EQ(99900, size);
+  ExpectPattern(100100, buf, size);
+}
+
+}  // namespace media
@@ -0,0 +1,311 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/allocator/features.h"
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/time/time.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/media_log.h"
+#include "media/base/media_tracks.h"
+#include "media/base/stream_parser.h"
+#include "media/base/test_data_util.h"
+#include "media/formats/common/offset_byte_queue.h"
+#include "media/formats/common/segmented_byte_queue.h"
+#include "media/formats/webm/webm_stream_parser.h"
+#include "media/media_features.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+#if BUILDFLAG(USE_ALLOCATOR_SHIM)
+#include "base/debug/thread_heap_usage_tracker.h"
+#endif
+
+#if BUILDFLAG(USE_PROPRIETARY_CODECS)
+#include "media/formats/mp4/es_descriptor.h"
+#include "media/formats/mp4/mp4_stream_parser.h"
+#include "media/formats/mpeg/adts_stream_parser.h"
+#include "media/formats/mpeg/mpeg1_audio_stream_parser.h"
+#if BUILDFLAG(ENABLE_MSE_MPEG2TS_STREAM_PARSER)
+#include "media/formats/mp2t/mp2t_stream_parser.h"
+#endif
+#endif
+
+namespace media {
+
+// Bytes parsed per file and append size; the file is parsed again by a new
+// parser until at least this much has gone through.
+static const int kBytesPerRun = 16 * 1024 * 1024;
+
+static const int kAppendSizes[] = {512, 4 * 1024, 64 * 1024, 1024 * 1024};
+
+// The test/data corpus for each parser.  Encrypted files are left out, since
+// parsing them only differs in the extra boxes and elements read.
+static const char* const kWebMFiles[] = {
+    "bear-320x240.webm",
+    "bear-640x360.webm",
+    "bear-1280x720.webm",
+    "bear-320x240-audio-only.webm",
+    "bear-320x240-video-only.webm",
+    "bear-320x240-live.webm",
+    "bear-vp9.webm",
+    "bear-vp9-opus.webm",
+    "bear-opus.webm",
+};
+
+#if BUILDFLAG(USE_PROPRIETARY_CODECS)
+static const char* const kMP4Files[] = {
+    "bear-640x360-av_frag.mp4",
+    "bear-1280x720-av_frag.mp4",
+    "bear-640x360-v_frag.mp4",
+    "bear-640x360-a_frag.mp4",
+    "bear-1280x720-v_frag-avc3.mp4",
+};
+
+static const char* const kADTSFiles[] = {
+    "bear-audio-lc-aac.aac",
+    "bear-audio-main-aac.aac",
+    "bear-audio-implicit-he-aac-v1.aac",
+    "bear-audio-implicit-he-aac-v2.aac",
+};
+
+static const char* const kMPEG1AudioFiles[] = {
+    "sfx.mp3",
+    "bear-audio-10s-CBR-no-TOC.mp3",
+    "bear-audio-10s-VBR-has-TOC.mp3",
+    "bear-audio-10s-VBR-no-TOC.mp3",
+};
+
+#if BUILDFLAG(ENABLE_MSE_MPEG2TS_STREAM_PARSER)
+static const char* const kMp2tFiles[] = {
+    "bear-1280x720.ts",
+    "bear-1280x720-hls.ts",
+    "bear-1280x720-aac_he.ts",
+};
+#endif
+#endif
+
+// A media segment the size of a large MSE append, and the samples in it.
+static const int kSegmentSize = 10 * 1024 * 1024;
+static const int kSampleSize = 10 * 1024;
+static const int kSegmentRuns = 10;
+
+static void OnInit(const StreamParser::InitParameters& params) {}
+
+static bool OnNewConfig(std::unique_ptr<MediaTracks> tracks,
+                        const StreamParser::TextTrackConfigMap& text_tracks) {
+  return true;
+}
+
+// Adds the number of frames in |buffers| to |*frames|.
+static bool OnNewBuffers(int64_t* frames,
+                         const StreamParser::BufferQueueMap& buffers) {
+  for (const auto& it : buffers)
+    *frames += it.second.size();
+  return true;
+}
+
+static void OnEncryptedMediaInitData(EmeInitDataType init_data_type,
+                                     const std::vector<uint8_t>& init_data) {}
+
+static void OnNewMediaSegment() {}
+
+static void OnEndMediaSegment() {}
+
+static std::unique_ptr<StreamParser> CreateWebMParser() {
+  return base::MakeUnique<WebMStreamParser>();
+}
+
+#if BUILDFLAG(USE_PROPRIETARY_CODECS)
+static std::unique_ptr<StreamParser> CreateMP4Parser() {
+  std::set<int> audio_object_types;
+  audio_object_types.insert(mp4::kISO_14496_3);
+  return base::MakeUnique<mp4::MP4StreamParser>(audio_object_types, false,
+                                                false);
+}
+
+static std::unique_ptr<StreamParser> CreateADTSParser() {
+  return base::MakeUnique<ADTSStreamParser>();
+}
+
+static std::unique_ptr<StreamParser> CreateMPEG1AudioParser() {
+  return base::MakeUnique<MPEG1AudioStreamParser>();
+}
+
+#if BUILDFLAG(ENABLE_MSE_MPEG2TS_STREAM_PARSER)
+static std::unique_ptr<StreamParser> CreateMp2tParser() {
+  return base::MakeUnique<mp2t::Mp2tStreamParser>(false);
+}
+#endif
+#endif
+
+static std::string AppendSizeModifier(int append_size) {
+  if (append_size < 1024)
+    return "_" + std::to_string(append_size) + "b";
+  return "_" + std::to_string(append_size / 1024) + "kb";
+}
+
+// Creates a parser with |create_parser| and parses all of |file| with it in
+// |append_size| pieces, adding the number of frames it emits to |*frames|.
+static void ParseFile(const DecoderBuffer& file,
+                      int append_size,
+                      std::unique_ptr<StreamParser> (*create_parser)(),
+                      int64_t* frames) {
+  MediaLog media_log;
+  std::unique_ptr<StreamParser> parser = create_parser();
+  parser->Init(base::Bind(&OnInit), base::Bind(&OnNewConfig),
+               base::Bind(&OnNewBuffers, frames), true,
+               base::Bind(&OnEncryptedMediaInitData),
+               base::Bind(&OnNewMediaSegment), base::Bind(&OnEndMediaSegment),
+               &media_log);
+  const int data_size = static_cast<int>(file.data_size());
+  for (int offset = 0; offset < data_size; offset += append_size) {
+    const int size = std::min(append_size, data_size - offset);
+    CHECK(parser->Parse(file.data() + offset, size));
+  }
+}
+
+// Parses |filename| with parsers made by |create_parser|, appending it in
+// pieces of each of kAppendSizes, and reports how fast the bytes and frames
+// went through.  Where heap usage can be tracked, also reports the most memory
+// a parser had allocated at once, measured in a separate run so that tracking
+// does not slow down the timed ones.
+static void RunParserBenchmark(
+    const std::string& filename,
+    std::unique_ptr<StreamParser> (*create_parser)()) {
+  scoped_refptr<DecoderBuffer> file = ReadTestDataFile(filename);
+
+  const int data_size = static_cast<int>(file->data_size());
+
+  for (int append_size : kAppendSizes) {
+    const int runs = std::max(1, kBytesPerRun / data_size);
+    int64_t frames = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < runs; ++i)
+      ParseFile(*file, append_size, create_parser, &frames);
+    const double seconds = (base::TimeTicks::Now() - start).InSecondsF();
+
+    const double megabytes =
+        static_cast<double>(runs) * data_size / (1024 * 1024);
+    perf_test::PrintResult("stream_parser_throughput",
+                           AppendSizeModifier(append_size), filename,
+                           megabytes / seconds, "MB/s", true);
+    perf_test::PrintResult("stream_parser_frame_rate",
+                           AppendSizeModifier(append_size), filename,
+                           frames / seconds, "frames/s", true);
+
+#if BUILDFLAG(USE_ALLOCATOR_SHIM)
+    if (!base::debug::ThreadHeapUsageTracker::IsHeapTrackingEnabled())
+      base::debug::ThreadHeapUsageTracker::EnableHeapTracking();
+    base::debug::ThreadHeapUsageTracker heap_usage_tracker;
+    heap_usage_tracker.Start();
+    ParseFile(*file, append_size, create_parser, &frames);
+    heap_usage_tracker.Stop(false);
+    perf_test::PrintResult(
+        "stream_parser_peak_allocation", AppendSizeModifier(append_size),
+        filename, heap_usage_tracker.usage().max_allocated_bytes / 1024.0,
+        "KB", true);
+#endif
+  }
+}
+
+// Runs RunParserBenchmark() over each of |filenames|.
+template <size_t N>
+static void RunCorpusBenchmark(
+    const char* const (&filenames)[N],
+    std::unique_ptr<StreamParser> (*create_parser)()) {
+  for (const char* filename : filenames)
+    RunParserBenchmark(filename, create_parser);
+}
+
+static void PeekAt(OffsetByteQueue* queue,
+                   int64_t offset,
+                   int size,
+                   const uint8_t** buf,
+                   int* buf_size) {
+  queue->PeekAt(offset, buf, buf_size);
+}
+
+static void PeekAt(SegmentedByteQueue* queue,
+                   int64_t offset,
+                   int size,
+                   const uint8_t** buf,
+                   int* buf_size) {
+  queue->PeekAt(offset, size, buf, buf_size);
+}
+
+// Appends a segment in |append_size| pieces, consuming it as MP4StreamParser
+// does: each sample is peeked at once it has all arrived, but nothing is
+// trimmed until the whole segment has.
+template <typename Queue>
+static void RunQueueBenchmark(int append_size, const std::string& trace_name) {
+  const std::vector<uint8_t> append(append_size);
+  base::TimeDelta time;
+  for (int i = 0; i < kSegmentRuns; ++i) {
+    Queue queue;
+    int64_t next_sample = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    while (queue.tail() < kSegmentSize) {
+      queue.Push(append.data(),
+                 std::min<int64_t>(append_size, kSegmentSize - queue.tail()));
+      while (queue.tail() - next_sample >= kSampleSize) {
+        const uint8_t* buf;
+        int size;
+        PeekAt(&queue, next_sample, kSampleSize, &buf, &size);
+        CHECK_GE(size, kSampleSize);
+        next_sample += kSampleSize;
+      }
+    }
+    CHECK(queue.Trim(kSegmentSize));
+    time += base::TimeTicks::Now() - start;
+  }
+
+  perf_test::PrintResult(
+      "byte_queue_segment_append", AppendSizeModifier(append_size),
+      trace_name, time.InMillisecondsF() / kSegmentRuns, "ms/segment", true);
+}
+
+// Benchmark each parser on appends of its corpus in small to large pieces.
+TEST(StreamParserPerfTest, WebM) {
+  RunCorpusBenchmark(kWebMFiles, &CreateWebMParser);
+}
+
+#if BUILDFLAG(USE_PROPRIETARY_CODECS)
+TEST(StreamParserPerfTest, MP4) {
+  RunCorpusBenchmark(kMP4Files, &CreateMP4Parser);
+}
+
+TEST(StreamParserPerfTest, ADTS) {
+  RunCorpusBenchmark(kADTSFiles, &CreateADTSParser);
+}
+
+TEST(StreamParserPerfTest, MPEG1Audio) {
+  RunCorpusBenchmark(kMPEG1AudioFiles, &CreateMPEG1AudioParser);
+}
+
+#if BUILDFLAG(ENABLE_MSE_MPEG2TS_STREAM_PARSER)
+TEST(StreamParserPerfTest, Mp2t) {
+  RunCorpusBenchmark(kMp2tFiles, &CreateMp2tParser);
+}
+#endif
+#endif
+
+// Benchmark the queues the parsers sit on with a 10 MB media segment, which
+// OffsetByteQueue holds in one buffer that it grows and compacts as it goes.
+TEST(StreamParserPerfTest, SegmentAppend) {
+  for (int append_size : kAppendSizes) {
+    RunQueueBenchmark<OffsetByteQueue>(append_size, "offset_byte_queue");
+    RunQueueBenchmark<SegmentedByteQueue>(append_size, "segmented_byte_queue");
+  }
+}
+
+}  // namespace media
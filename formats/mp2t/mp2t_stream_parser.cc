@@ -37,6 +37,10 @@ namespace mp2t {
 
 namespace {
 
+// Number of packets TsPacket::Sync() looks at to confirm a syncword, which are
+// made contiguous in the queue before calling it.
+const int kSyncLookahead = 4;
+
 #if BUILDFLAG(ENABLE_HLS_SAMPLE_AES)
 const int64_t kSampleAESPrivateDataIndicatorAVC = 0x7a617663;
 const int64_t kSampleAESPrivateDataIndicatorAAC = 0x61616364;
@@ -287,7 +291,8 @@ bool Mp2tStreamParser::Parse(const uint8_t* buf, int size) {
   while (true) {
     const uint8_t* ts_buffer;
     int ts_buffer_size;
-    ts_byte_queue_.Peek(&ts_buffer, &ts_buffer_size);
+    ts_byte_queue_.Peek(kSyncLookahead * TsPacket::kPacketSize, &ts_buffer,
+                        &ts_buffer_size);
     if (ts_buffer_size < TsPacket::kPacketSize)
       break;
 
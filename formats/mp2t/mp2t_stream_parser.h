@@ -14,12 +14,12 @@
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "media/base/audio_decoder_config.h"
-#include "media/base/byte_queue.h"
 #include "media/base/decrypt_config.h"
 #include "media/base/encryption_scheme.h"
 #include "media/base/media_export.h"
 #include "media/base/stream_parser.h"
 #include "media/base/video_decoder_config.h"
+#include "media/formats/common/segmented_byte_queue.h"
 #include "media/formats/mp2t/timestamp_unroller.h"
 #include "media/media_features.h"
 
@@ -148,7 +148,7 @@ class MEDIA_EXPORT Mp2tStreamParser : public StreamParser {
   bool sbr_in_mimetype_;
 
   // Bytes of the TS stream.
-  ByteQueue ts_byte_queue_;
+  SegmentedByteQueue ts_byte_queue_;
 
   // List of PIDs and their state.
   std::map<int, std::unique_ptr<PidState>> pids_;
@@ -100,7 +100,8 @@ BoxReader::BoxReader(const uint8_t* buf,
       version_(0),
       flags_(0),
       scanned_(false),
-      is_EOS_(is_EOS) {}
+      is_EOS_(is_EOS),
+      require_complete_box_(true) {}
 
 BoxReader::BoxReader(const BoxReader& other) = default;
 
@@ -141,6 +142,22 @@ ParseResult BoxReader::StartTopLevelBox(const uint8_t* buf,
   return ParseResult::kOk;
 }
 
+// static
+ParseResult BoxReader::ReadTopLevelBoxHeader(const uint8_t* buf,
+                                             const size_t buf_size,
+                                             MediaLog* media_log,
+                                             FourCC* out_type,
+                                             size_t* out_box_size) {
+  BoxReader reader(buf, buf_size, media_log, false);
+  reader.require_complete_box_ = false;
+  RCHECK_OK_PARSE_RESULT(reader.ReadHeader());
+  if (!IsValidTopLevelBox(reader.type(), media_log))
+    return ParseResult::kError;
+  *out_type = reader.type();
+  *out_box_size = reader.box_size();
+  return ParseResult::kOk;
+}
+
 // static
 BoxReader* BoxReader::ReadConcatentatedBoxes(const uint8_t* buf,
                                              const size_t buf_size,
@@ -271,8 +288,10 @@ ParseResult BoxReader::ReadHeader() {
 
   // Make sure the buffer contains at least the expected number of bytes.
   // Since the data may be appended in pieces, this is only an error if EOS.
-  if (box_size > base::strict_cast<uint64_t>(buf_size_))
+  if (require_complete_box_ &&
+      box_size > base::strict_cast<uint64_t>(buf_size_)) {
     return is_EOS_ ? ParseResult::kError : ParseResult::kNeedMoreData;
+  }
 
   // Note that the pos_ head has advanced to the byte immediately after the
   // header, which is where we want it.
@@ -116,6 +116,17 @@ class MEDIA_EXPORT BoxReader : public BufferReader {
                                       FourCC* out_type,
                                       size_t* out_box_size) WARN_UNUSED_RESULT;
 
+  // Like StartTopLevelBox(), but only the box header needs to be in |buf|, so
+  // |out_box_size| may be larger than |buf_size|.
+  //
+  // |buf| is not retained.
+  static ParseResult ReadTopLevelBoxHeader(const uint8_t* buf,
+                                           const size_t buf_size,
+                                           MediaLog* media_log,
+                                           FourCC* out_type,
+                                           size_t* out_box_size)
+      WARN_UNUSED_RESULT;
+
   // Create a BoxReader from a buffer. |buf| must be the complete buffer, as
   // errors are returned when sufficient data is not available. |buf| can start
   // with any type of box -- it does not have to be IsValidTopLevelBox().
@@ -218,6 +229,9 @@ class MEDIA_EXPORT BoxReader : public BufferReader {
 
   // True if the buffer provided to the reader is the complete stream.
   const bool is_EOS_;
+
+  // False if ReadHeader() should succeed before the whole box is in the buffer.
+  bool require_complete_box_;
 };
 
 // Template definitions
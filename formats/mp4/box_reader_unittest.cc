@@ -190,6 +190,23 @@ TEST_F(BoxReaderTest, OuterTooShortTest) {
   EXPECT_FALSE(r);
 }
 
+TEST_F(BoxReaderTest, ReadTopLevelBoxHeaderTest) {
+  std::vector<uint8_t> buf = GetBuf();
+
+  // Only the header needs to be there.
+  FourCC type;
+  size_t box_size;
+  ParseResult result = BoxReader::ReadTopLevelBoxHeader(
+      &buf[0], 8, &media_log_, &type, &box_size);
+  EXPECT_EQ(result, ParseResult::kOk);
+  EXPECT_EQ(FOURCC_SKIP, type);
+  EXPECT_EQ(buf.size(), box_size + 1);
+
+  result = BoxReader::ReadTopLevelBoxHeader(&buf[0], 7, &media_log_, &type,
+                                            &box_size);
+  EXPECT_EQ(result, ParseResult::kNeedMoreData);
+}
+
 TEST_F(BoxReaderTest, InnerTooLongTest) {
   std::vector<uint8_t> buf = GetBuf();
 
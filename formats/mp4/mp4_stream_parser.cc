@@ -39,6 +39,10 @@ namespace {
 const int kMaxEmptySampleLogs = 20;
 const int kMaxInvalidConversionLogs = 20;
 
+// Size of the largest top-level box header: a 32-bit size, the type and a
+// 64-bit large size.
+const int kMaxBoxHeaderSize = 16;
+
 // Caller should be prepared to handle return of Unencrypted() in case of
 // unsupported scheme.
 EncryptionScheme GetEncryptionScheme(const ProtectionSchemeInfo& sinf) {
@@ -200,13 +204,33 @@ bool MP4StreamParser::Parse(const uint8_t* buf, int size) {
 ParseResult MP4StreamParser::ParseBox() {
   const uint8_t* buf;
   int size;
-  queue_.Peek(&buf, &size);
+  queue_.Peek(kMaxBoxHeaderSize, &buf, &size);
   if (!size)
     return ParseResult::kNeedMoreData;
 
-  std::unique_ptr<BoxReader> reader;
+  // Only the header is needed to find out how large the box is, so check that
+  // it has all arrived before making it contiguous.
+  FourCC type;
+  size_t box_size;
   ParseResult result =
-      BoxReader::ReadTopLevelBox(buf, size, media_log_, &reader);
+      BoxReader::ReadTopLevelBoxHeader(buf, size, media_log_, &type, &box_size);
+  if (result != ParseResult::kOk)
+    return result;
+  if (queue_.tail() - queue_.head() < base::checked_cast<int64_t>(box_size))
+    return ParseResult::kNeedMoreData;
+
+  if (type != FOURCC_MOOV && type != FOURCC_MOOF) {
+    // TODO(wolenetz,chcunningham): Enforce more strict adherence to MSE byte
+    // stream spec for ftyp and styp. See http://crbug.com/504514.
+    DVLOG(2) << "Skipping unrecognized top-level box: "
+             << FourCCToString(type);
+    queue_.Pop(box_size);
+    return ParseResult::kOk;
+  }
+
+  queue_.Peek(box_size, &buf, &size);
+  std::unique_ptr<BoxReader> reader;
+  result = BoxReader::ReadTopLevelBox(buf, size, media_log_, &reader);
   if (result != ParseResult::kOk)
     return result;
 
@@ -227,11 +251,6 @@ ParseResult MP4StreamParser::ParseBox() {
     // (Since 'default-base-is-moof' is mandated, no data references can come
     // before the head of the 'moof', so keeping this box around is sufficient.)
     return ParseResult::kOk;
-  } else {
-    // TODO(wolenetz,chcunningham): Enforce more strict adherence to MSE byte
-    // stream spec for ftyp and styp. See http://crbug.com/504514.
-    DVLOG(2) << "Skipping unrecognized top-level box: "
-             << FourCCToString(reader->type());
   }
 
   queue_.Pop(reader->box_size());
@@ -645,7 +664,7 @@ ParseResult MP4StreamParser::EnqueueSample(BufferQueueMap* buffers) {
 
   const uint8_t* buf;
   int buf_size;
-  queue_.Peek(&buf, &buf_size);
+  queue_.Peek(0, &buf, &buf_size);
   if (!buf_size)
     return ParseResult::kNeedMoreData;
 
@@ -669,7 +688,10 @@ ParseResult MP4StreamParser::EnqueueSample(BufferQueueMap* buffers) {
   // memory-constrained devices where the source buffer consumes a substantial
   // portion of the total system memory.
   if (runs_->AuxInfoNeedsToBeCached()) {
-    queue_.PeekAt(runs_->aux_info_offset() + moof_head_, &buf, &buf_size);
+    const int64_t aux_info_offset = runs_->aux_info_offset() + moof_head_;
+    if (queue_.tail() - aux_info_offset < runs_->aux_info_size())
+      return ParseResult::kNeedMoreData;
+    queue_.PeekAt(aux_info_offset, runs_->aux_info_size(), &buf, &buf_size);
     if (buf_size < runs_->aux_info_size())
       return ParseResult::kNeedMoreData;
     if (!runs_->CacheAuxInfo(buf, buf_size))
@@ -677,15 +699,19 @@ ParseResult MP4StreamParser::EnqueueSample(BufferQueueMap* buffers) {
     return ParseResult::kOk;
   }
 
-  queue_.PeekAt(runs_->sample_offset() + moof_head_, &buf, &buf_size);
-
   if (runs_->sample_size() >
       static_cast<uint32_t>(std::numeric_limits<int>::max())) {
     MEDIA_LOG(ERROR, media_log_) << "Sample size is too large";
     return ParseResult::kError;
   }
 
+  // Wait for the whole sample before peeking at it, so that a sample spanning
+  // several appends is only made contiguous once.
   int sample_size = base::checked_cast<int>(runs_->sample_size());
+  const int64_t sample_offset = runs_->sample_offset() + moof_head_;
+  if (queue_.tail() - sample_offset < sample_size)
+    return ParseResult::kNeedMoreData;
+  queue_.PeekAt(sample_offset, sample_size, &buf, &buf_size);
 
   if (buf_size < sample_size)
     return ParseResult::kNeedMoreData;
@@ -710,34 +736,40 @@ ParseResult MP4StreamParser::EnqueueSample(BufferQueueMap* buffers) {
     subsamples = decrypt_config->subsamples();
   }
 
-  std::vector<uint8_t> frame_buf(buf, buf + sample_size);
-  if (video) {
-    if (runs_->video_description().video_codec == kCodecH264 ||
-        runs_->video_description().video_codec == kCodecHEVC ||
-        runs_->video_description().video_codec == kCodecDolbyVision) {
-      DCHECK(runs_->video_description().frame_bitstream_converter);
-      if (!runs_->video_description().frame_bitstream_converter->ConvertFrame(
-              &frame_buf, runs_->is_keyframe(), &subsamples)) {
-        MEDIA_LOG(ERROR, media_log_)
-            << "Failed to prepare video sample for decode";
-        return ParseResult::kError;
-      }
-      if (!runs_->video_description().frame_bitstream_converter->IsValid(
-              &frame_buf, &subsamples)) {
-        LIMITED_MEDIA_LOG(DEBUG, media_log_, num_invalid_conversions_,
-                          kMaxInvalidConversionLogs)
-            << "Prepared video sample is not conformant";
-      }
+  // Samples that need converting for decode are copied out of the queue to do
+  // so; all others are copied straight into their buffer.
+  const bool convert_video =
+      video && (runs_->video_description().video_codec == kCodecH264 ||
+                runs_->video_description().video_codec == kCodecHEVC ||
+                runs_->video_description().video_codec == kCodecDolbyVision);
+  const bool convert_audio =
+      audio && ESDescriptor::IsAAC(runs_->audio_description().esds.object_type);
+  const bool convert_sample = convert_video || convert_audio;
+  std::vector<uint8_t> frame_buf;
+  if (convert_sample)
+    frame_buf.assign(buf, buf + sample_size);
+
+  if (convert_video) {
+    DCHECK(runs_->video_description().frame_bitstream_converter);
+    if (!runs_->video_description().frame_bitstream_converter->ConvertFrame(
+            &frame_buf, runs_->is_keyframe(), &subsamples)) {
+      MEDIA_LOG(ERROR, media_log_)
+          << "Failed to prepare video sample for decode";
+      return ParseResult::kError;
+    }
+    if (!runs_->video_description().frame_bitstream_converter->IsValid(
+            &frame_buf, &subsamples)) {
+      LIMITED_MEDIA_LOG(DEBUG, media_log_, num_invalid_conversions_,
+                        kMaxInvalidConversionLogs)
+          << "Prepared video sample is not conformant";
     }
   }
 
-  if (audio) {
-    if (ESDescriptor::IsAAC(runs_->audio_description().esds.object_type) &&
-        !PrepareAACBuffer(runs_->audio_description().esds.aac,
-                          &frame_buf, &subsamples)) {
-      MEDIA_LOG(ERROR, media_log_) << "Failed to prepare AAC sample for decode";
-      return ParseResult::kError;
-    }
+  if (convert_audio &&
+      !PrepareAACBuffer(runs_->audio_description().esds.aac, &frame_buf,
+                        &subsamples)) {
+    MEDIA_LOG(ERROR, media_log_) << "Failed to prepare AAC sample for decode";
+    return ParseResult::kError;
   }
 
   if (decrypt_config) {
@@ -757,9 +789,15 @@ ParseResult MP4StreamParser::EnqueueSample(BufferQueueMap* buffers) {
   StreamParserBuffer::Type buffer_type = audio ? DemuxerStream::AUDIO :
       DemuxerStream::VIDEO;
 
-  scoped_refptr<StreamParserBuffer> stream_buf = StreamParserBuffer::CopyFrom(
-      &frame_buf[0], frame_buf.size(), runs_->is_keyframe(), buffer_type,
-      runs_->track_id());
+  scoped_refptr<StreamParserBuffer> stream_buf;
+  if (convert_sample) {
+    stream_buf = StreamParserBuffer::CopyFrom(
+        &frame_buf[0], frame_buf.size(), runs_->is_keyframe(), buffer_type,
+        runs_->track_id());
+  } else {
+    stream_buf = StreamParserBuffer::CopyFrom(
+        buf, sample_size, runs_->is_keyframe(), buffer_type, runs_->track_id());
+  }
 
   if (decrypt_config)
     stream_buf->set_decrypt_config(std::move(decrypt_config));
@@ -814,13 +852,18 @@ bool MP4StreamParser::ReadAndDiscardMDATsUntil(int64_t max_clear_offset) {
   while (mdat_tail_ < upper_bound) {
     const uint8_t* buf = NULL;
     int size = 0;
-    queue_.PeekAt(mdat_tail_, &buf, &size);
+    queue_.PeekAt(mdat_tail_, kMaxBoxHeaderSize, &buf, &size);
 
     FourCC type;
     size_t box_sz;
-    result = BoxReader::StartTopLevelBox(buf, size, media_log_, &type, &box_sz);
+    result =
+        BoxReader::ReadTopLevelBoxHeader(buf, size, media_log_, &type, &box_sz);
     if (result != ParseResult::kOk)
       break;
+    if (queue_.tail() - mdat_tail_ < base::checked_cast<int64_t>(box_sz)) {
+      result = ParseResult::kNeedMoreData;
+      break;
+    }
 
     if (type != FOURCC_MDAT) {
       MEDIA_LOG(DEBUG, media_log_)
@@ -829,9 +872,8 @@ bool MP4StreamParser::ReadAndDiscardMDATsUntil(int64_t max_clear_offset) {
     }
     // TODO(chcunningham): Fix mdat_tail_ and ByteQueue classes to use size_t.
     // TODO(sandersd): The whole |mdat_tail_| mechanism appears to be pointless
-    // because StartTopLevelBox() only succeeds for complete boxes. Either
-    // remove |mdat_tail_| throughout this class or implement the ability to
-    // discard partial mdats.
+    // because only complete boxes are skipped over. Either remove |mdat_tail_|
+    // throughout this class or implement the ability to discard partial mdats.
     mdat_tail_ += base::checked_cast<int64_t>(box_sz);
   }
   queue_.Trim(std::min(mdat_tail_, upper_bound));
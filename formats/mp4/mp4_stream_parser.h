@@ -16,7 +16,7 @@
 #include "base/macros.h"
 #include "media/base/media_export.h"
 #include "media/base/stream_parser.h"
-#include "media/formats/common/offset_byte_queue.h"
+#include "media/formats/common/segmented_byte_queue.h"
 #include "media/formats/mp4/parse_result.h"
 #include "media/formats/mp4/track_run_iterator.h"
 
@@ -99,7 +99,7 @@ class MEDIA_EXPORT MP4StreamParser : public StreamParser {
   EndMediaSegmentCB end_of_segment_cb_;
   MediaLog* media_log_;
 
-  OffsetByteQueue queue_;
+  SegmentedByteQueue queue_;
 
   // These two parameters are only valid in the |kEmittingSegments| state.
   //
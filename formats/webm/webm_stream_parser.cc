@@ -78,11 +78,11 @@ bool WebMStreamParser::Parse(const uint8_t* buf, int size) {
   byte_queue_.Push(buf, size);
 
   int result = 0;
-  int bytes_parsed = 0;
+  int min_size = 0;
   const uint8_t* cur = NULL;
   int cur_size = 0;
 
-  byte_queue_.Peek(&cur, &cur_size);
+  byte_queue_.Peek(min_size, &cur, &cur_size);
   while (cur_size > 0) {
     State oldState = state_;
     switch (state_) {
@@ -104,16 +104,21 @@ bool WebMStreamParser::Parse(const uint8_t* buf, int size) {
       return false;
     }
 
-    if (state_ == oldState && result == 0)
-      break;
-
-    DCHECK_GE(result, 0);
-    cur += result;
-    cur_size -= result;
-    bytes_parsed += result;
+    if (state_ == oldState && result == 0) {
+      // The element being parsed may continue into the next segment of the
+      // queue, so retry with a larger contiguous window before waiting for
+      // more data.
+      if (cur_size == byte_queue_.tail() - byte_queue_.head())
+        break;
+      min_size = 2 * cur_size;
+    } else {
+      DCHECK_GE(result, 0);
+      byte_queue_.Pop(result);
+      min_size = 0;
+    }
+    byte_queue_.Peek(min_size, &cur, &cur_size);
   }
 
-  byte_queue_.Pop(bytes_parsed);
   return true;
 }
 
@@ -13,10 +13,10 @@
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "media/base/audio_decoder_config.h"
-#include "media/base/byte_queue.h"
 #include "media/base/media_export.h"
 #include "media/base/stream_parser.h"
 #include "media/base/video_decoder_config.h"
+#include "media/formats/common/segmented_byte_queue.h"
 
 namespace media {
 
@@ -85,7 +85,7 @@ class MEDIA_EXPORT WebMStreamParser : public StreamParser {
   bool unknown_segment_size_;
 
   std::unique_ptr<WebMClusterParser> cluster_parser_;
-  ByteQueue byte_queue_;
+  SegmentedByteQueue byte_queue_;
 
   DISALLOW_COPY_AND_ASSIGN(WebMStreamParser);
 };
@@ -5,10 +5,18 @@
 #include "media/renderers/paint_canvas_video_renderer.h"
 
 #include <GLES3/gl3.h>
+#include <string.h>
+
+#include <algorithm>
 #include <limits>
+#include <memory>
+#include <vector>
 
+#include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/sys_info.h"
 #include "cc/paint/paint_canvas.h"
 #include "cc/paint/paint_flags.h"
 #include "cc/paint/paint_image.h"
@@ -18,6 +26,8 @@
 #include "gpu/command_buffer/common/capabilities.h"
 #include "gpu/command_buffer/common/mailbox_holder.h"
 #include "media/base/data_buffer.h"
+#include "media/base/media_switches.h"
+#include "media/base/run_in_parallel.h"
 #include "media/base/video_frame.h"
 #include "skia/ext/texture_handle.h"
 #include "third_party/libyuv/include/libyuv.h"
@@ -59,6 +69,13 @@ namespace {
 // We delete the temporary resource if it is not used for 3 seconds.
 const int kTemporaryResourceDeletionDelay = 3;  // Seconds;
 
+// Frames are converted to RGB in bands of at least this many pixels, since
+// smaller bands cost more to hand to the worker pool than they save.
+const int kMinPixelsPerSlice = 256 * 1024;
+
+// Maximum number of bands ConvertVideoFrameToRGBPixels() converts a frame in.
+const int kMaxConversionSlices = 8;
+
 bool CheckColorSpace(const VideoFrame* video_frame, ColorSpace color_space) {
   int result;
   return video_frame->metadata()->GetInteger(VideoFrameMetadata::COLOR_SPACE,
@@ -472,84 +489,176 @@ void PaintCanvasVideoRenderer::Copy(
 
 namespace {
 
-// libyuv doesn't support 9- and 10-bit video frames yet. This function
-// creates a regular 8-bit video frame which we can give to libyuv.
-scoped_refptr<VideoFrame> DownShiftHighbitVideoFrame(
-    const VideoFrame* video_frame) {
-  VideoPixelFormat format;
-  int shift = 1;
-  switch (video_frame->format()) {
-    case PIXEL_FORMAT_YUV420P12:
-      shift = 4;
-      format = PIXEL_FORMAT_I420;
-      break;
-
-    case PIXEL_FORMAT_YUV420P10:
-      shift = 2;
-      format = PIXEL_FORMAT_I420;
-      break;
-
+// Returns the number of bits per sample of high bit depth YUV |format|, or 0
+// if |format| is not one.
+int HighbitDepth(VideoPixelFormat format) {
+  switch (format) {
     case PIXEL_FORMAT_YUV420P9:
-      shift = 1;
-      format = PIXEL_FORMAT_I420;
-      break;
-
+    case PIXEL_FORMAT_YUV422P9:
+    case PIXEL_FORMAT_YUV444P9:
+      return 9;
+    case PIXEL_FORMAT_YUV420P10:
+    case PIXEL_FORMAT_YUV422P10:
+    case PIXEL_FORMAT_YUV444P10:
+      return 10;
+    case PIXEL_FORMAT_YUV420P12:
     case PIXEL_FORMAT_YUV422P12:
-      shift = 4;
-      format = PIXEL_FORMAT_YV16;
-      break;
+    case PIXEL_FORMAT_YUV444P12:
+      return 12;
+    default:
+      return 0;
+  }
+}
 
-    case PIXEL_FORMAT_YUV422P10:
-      shift = 2;
-      format = PIXEL_FORMAT_YV16;
-      break;
+// Number of rows ConvertHighbitVideoFrameToARGB() converts at a time. Even,
+// so that every strip starts on a row of the vertically subsampled planes.
+const int kHighbitStripRows = 16;
+
+// Shifts |rows| rows of |width| 16-bit samples from |src| down by |shift| bits
+// into 8-bit samples in |dst|.
+void ShiftRowsDown(const uint8_t* src,
+                   int src_stride,
+                   uint8_t* dst,
+                   int dst_stride,
+                   int width,
+                   int rows,
+                   int shift) {
+  for (int row = 0; row < rows; ++row) {
+    const uint16_t* src_row =
+        reinterpret_cast<const uint16_t*>(src + row * src_stride);
+    uint8_t* dst_row = dst + row * dst_stride;
+    for (int x = 0; x < width; ++x)
+      dst_row[x] = src_row[x] >> shift;
+  }
+}
 
-    case PIXEL_FORMAT_YUV422P9:
-      shift = 1;
-      format = PIXEL_FORMAT_YV16;
-      break;
+// libyuv doesn't support 9- and 10-bit video frames yet. This converts high
+// bit depth |video_frame| to 8-bit ARGB kHighbitStripRows rows at a time: each
+// strip is shifted down into a small 8-bit buffer, which is still in cache
+// when libyuv converts it. So the frame is only read once, and no temporary
+// frame is allocated.
+void ConvertHighbitVideoFrameToARGB(const VideoFrame* video_frame,
+                                    uint8_t* rgb_pixels,
+                                    size_t row_bytes) {
+  const VideoPixelFormat format = video_frame->format();
+  const int shift = HighbitDepth(format) - 8;
+  DCHECK_GT(shift, 0);
+  const gfx::Size chroma_sample =
+      VideoFrame::SampleSize(format, VideoFrame::kUPlane);
+  const int width = video_frame->visible_rect().width();
+  const int height = video_frame->visible_rect().height();
+  const int chroma_width =
+      (width + chroma_sample.width() - 1) / chroma_sample.width();
+  const int chroma_strip_rows = kHighbitStripRows / chroma_sample.height();
+
+  std::unique_ptr<uint8_t[]> strip(
+      new uint8_t[(width + 2 * chroma_width) * kHighbitStripRows]);
+  uint8_t* const strip_y = strip.get();
+  uint8_t* const strip_u = strip_y + width * kHighbitStripRows;
+  uint8_t* const strip_v = strip_u + chroma_width * chroma_strip_rows;
+
+  for (int row = 0; row < height; row += kHighbitStripRows) {
+    const int rows = std::min(kHighbitStripRows, height - row);
+    const int chroma_row = row / chroma_sample.height();
+    const int chroma_rows =
+        (rows + chroma_sample.height() - 1) / chroma_sample.height();
+    ShiftRowsDown(video_frame->visible_data(VideoFrame::kYPlane) +
+                      row * video_frame->stride(VideoFrame::kYPlane),
+                  video_frame->stride(VideoFrame::kYPlane), strip_y, width,
+                  width, rows, shift);
+    ShiftRowsDown(video_frame->visible_data(VideoFrame::kUPlane) +
+                      chroma_row * video_frame->stride(VideoFrame::kUPlane),
+                  video_frame->stride(VideoFrame::kUPlane), strip_u,
+                  chroma_width, chroma_width, chroma_rows, shift);
+    ShiftRowsDown(video_frame->visible_data(VideoFrame::kVPlane) +
+                      chroma_row * video_frame->stride(VideoFrame::kVPlane),
+                  video_frame->stride(VideoFrame::kVPlane), strip_v,
+                  chroma_width, chroma_width, chroma_rows, shift);
+
+    // Same conversions as for the matching 8-bit formats.
+    uint8_t* const out = rgb_pixels + row * row_bytes;
+    if (chroma_sample.height() == 2) {
+      if (CheckColorSpace(video_frame, COLOR_SPACE_JPEG)) {
+        LIBYUV_J420_TO_ARGB(strip_y, width, strip_u, chroma_width, strip_v,
+                            chroma_width, out, row_bytes, width, rows);
+      } else if (CheckColorSpace(video_frame, COLOR_SPACE_HD_REC709)) {
+        LIBYUV_H420_TO_ARGB(strip_y, width, strip_u, chroma_width, strip_v,
+                            chroma_width, out, row_bytes, width, rows);
+      } else {
+        LIBYUV_I420_TO_ARGB(strip_y, width, strip_u, chroma_width, strip_v,
+                            chroma_width, out, row_bytes, width, rows);
+      }
+    } else if (chroma_sample.width() == 2) {
+      LIBYUV_I422_TO_ARGB(strip_y, width, strip_u, chroma_width, strip_v,
+                          chroma_width, out, row_bytes, width, rows);
+    } else {
+      LIBYUV_I444_TO_ARGB(strip_y, width, strip_u, chroma_width, strip_v,
+                          chroma_width, out, row_bytes, width, rows);
+    }
+  }
+}
 
-    case PIXEL_FORMAT_YUV444P12:
-      shift = 4;
-      format = PIXEL_FORMAT_YV24;
-      break;
+// Y'CbCr to R'G'B' conversion constants for
+// ConvertHighbitVideoFrameToRGBPixels().
+struct HighbitToRGBParams {
+  float y_offset;
+  float y_scale;
+  float c_offset;
+  float c_scale;
+  float r_from_v;
+  float g_from_u;
+  float g_from_v;
+  float b_from_u;
+};
 
-    case PIXEL_FORMAT_YUV444P10:
-      shift = 2;
-      format = PIXEL_FORMAT_YV24;
-      break;
+// Rounds |value| in [0, 1] to a 10-bit unsigned normalized integer.
+uint32_t ToUnorm10(float value) {
+  return static_cast<uint32_t>(value * 1023.0f + 0.5f);
+}
 
-    case PIXEL_FORMAT_YUV444P9:
-      shift = 1;
-      format = PIXEL_FORMAT_YV24;
-      break;
+const uint16_t kHalfFloatOne = 0x3c00;
+
+// Converts |value| in [0, 1] to a half float.
+uint16_t ToHalfFloat(float value) {
+  // Below 2^-14, half floats are denormal, in steps of 2^-24.
+  if (value < 6.103515625e-05f)
+    return static_cast<uint16_t>(value * 16777216.0f + 0.5f);
+  // Otherwise rebias the exponent from 127 to 15 and round the mantissa to
+  // 10 bits.
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return static_cast<uint16_t>((bits - (112 << 23) + 0x1000) >> 13);
+}
 
-    default:
-      NOTREACHED();
-      return nullptr;
-  }
-  scoped_refptr<VideoFrame> ret = VideoFrame::CreateFrame(
-      format, video_frame->coded_size(), video_frame->visible_rect(),
-      video_frame->natural_size(), video_frame->timestamp());
-
-  // Copy all metadata.
-  // (May be enough to copy color space)
-  ret->metadata()->MergeMetadataFrom(video_frame->metadata());
-
-  for (int plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane; ++plane) {
-    int width = ret->row_bytes(plane);
-    const uint16_t* src =
-        reinterpret_cast<const uint16_t*>(video_frame->data(plane));
-    uint8_t* dst = ret->data(plane);
-    for (int row = 0; row < video_frame->rows(plane); row++) {
-      for (int x = 0; x < width; x++) {
-        dst[x] = src[x] >> shift;
-      }
-      src += video_frame->stride(plane) / 2;
-      dst += ret->stride(plane);
+template <PaintCanvasVideoRenderer::HighbitRGBFormat kFormat>
+void ConvertHighbitRow(const uint16_t* y_row,
+                       const uint16_t* u_row,
+                       const uint16_t* v_row,
+                       int chroma_shift,
+                       int width,
+                       const HighbitToRGBParams& params,
+                       uint8_t* out_row) {
+  for (int x = 0; x < width; ++x) {
+    const int c = x >> chroma_shift;
+    const float y = (y_row[x] - params.y_offset) * params.y_scale;
+    const float u = (u_row[c] - params.c_offset) * params.c_scale;
+    const float v = (v_row[c] - params.c_offset) * params.c_scale;
+    const float r = std::min(std::max(y + params.r_from_v * v, 0.0f), 1.0f);
+    const float g = std::min(
+        std::max(y + params.g_from_u * u + params.g_from_v * v, 0.0f), 1.0f);
+    const float b = std::min(std::max(y + params.b_from_u * u, 0.0f), 1.0f);
+    if (kFormat == PaintCanvasVideoRenderer::HighbitRGBFormat::kRGB10A2) {
+      reinterpret_cast<uint32_t*>(out_row)[x] =
+          ToUnorm10(r) | (ToUnorm10(g) << 10) | (ToUnorm10(b) << 20) |
+          (3u << 30);
+    } else {
+      uint16_t* out = reinterpret_cast<uint16_t*>(out_row) + 4 * x;
+      out[0] = ToHalfFloat(r);
+      out[1] = ToHalfFloat(g);
+      out[2] = ToHalfFloat(b);
+      out[3] = kHalfFloatOne;
     }
   }
-  return ret;
 }
 
 // Converts 16-bit data to |out| buffer of specified GL |type|.
@@ -678,18 +787,10 @@ void TextureSubImageUsingIntermediate(unsigned target,
   gl->DeleteTextures(1, &temp_texture);
 }
 
-}  // anonymous namespace
-
-// static
-void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
-    const VideoFrame* video_frame,
-    void* rgb_pixels,
-    size_t row_bytes) {
-  if (!video_frame->IsMappable()) {
-    NOTREACHED() << "Cannot extract pixels from non-CPU frame formats.";
-    return;
-  }
-
+// Converts the whole visible rect of |video_frame| on the calling thread.
+void ConvertVideoFrameToRGBPixelsOnThisThread(const VideoFrame* video_frame,
+                                              void* rgb_pixels,
+                                              size_t row_bytes) {
   switch (video_frame->format()) {
     case PIXEL_FORMAT_YV12:
     case PIXEL_FORMAT_I420:
@@ -774,13 +875,10 @@ void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
     case PIXEL_FORMAT_YUV444P10:
     case PIXEL_FORMAT_YUV420P12:
     case PIXEL_FORMAT_YUV422P12:
-    case PIXEL_FORMAT_YUV444P12: {
-      scoped_refptr<VideoFrame> temporary_frame =
-          DownShiftHighbitVideoFrame(video_frame);
-      ConvertVideoFrameToRGBPixels(temporary_frame.get(), rgb_pixels,
-                                   row_bytes);
+    case PIXEL_FORMAT_YUV444P12:
+      ConvertHighbitVideoFrameToARGB(
+          video_frame, static_cast<uint8_t*>(rgb_pixels), row_bytes);
       break;
-    }
 
     case PIXEL_FORMAT_Y16:
       // Since it is grayscale conversion, we disregard SK_PMCOLOR_BYTE_ORDER
@@ -805,6 +903,154 @@ void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
   }
 }
 
+// Converts |bands[index]| into its rows of |rgb_pixels|, which start
+// |rows_per_band| rows apart.
+void ConvertBand(const std::vector<scoped_refptr<VideoFrame>>* bands,
+                 uint8_t* rgb_pixels,
+                 size_t row_bytes,
+                 int rows_per_band,
+                 size_t index) {
+  ConvertVideoFrameToRGBPixelsOnThisThread(
+      (*bands)[index].get(), rgb_pixels + index * rows_per_band * row_bytes,
+      row_bytes);
+}
+
+}  // anonymous namespace
+
+// static
+void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+    const VideoFrame* video_frame,
+    void* rgb_pixels,
+    size_t row_bytes) {
+  int max_slices = 1;
+  if (base::FeatureList::IsEnabled(kParallelVideoFrameToRGB)) {
+    max_slices =
+        std::min(base::SysInfo::NumberOfProcessors(), kMaxConversionSlices);
+  }
+  ConvertVideoFrameToRGBPixelsInSlices(video_frame, rgb_pixels, row_bytes,
+                                       max_slices);
+}
+
+// static
+void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsInSlices(
+    const VideoFrame* video_frame,
+    void* rgb_pixels,
+    size_t row_bytes,
+    int max_slices) {
+  if (!video_frame->IsMappable()) {
+    NOTREACHED() << "Cannot extract pixels from non-CPU frame formats.";
+    return;
+  }
+
+  const gfx::Rect& visible_rect = video_frame->visible_rect();
+  const int slices = std::min(
+      max_slices, visible_rect.size().GetArea() / kMinPixelsPerSlice);
+  if (slices <= 1) {
+    ConvertVideoFrameToRGBPixelsOnThisThread(video_frame, rgb_pixels,
+                                             row_bytes);
+    return;
+  }
+
+  // Each band is a frame wrapping the same data with a visible rect covering
+  // some of the rows. Bands start on even rows, so that they also start on a
+  // row of every vertically subsampled plane. Wrapping only takes a
+  // reference to |video_frame|, it does not change it.
+  scoped_refptr<VideoFrame> frame(const_cast<VideoFrame*>(video_frame));
+  const int rows_per_slice =
+      ((visible_rect.height() + slices - 1) / slices + 1) & ~1;
+  std::vector<scoped_refptr<VideoFrame>> bands;
+  for (int row = 0; row < visible_rect.height(); row += rows_per_slice) {
+    const gfx::Rect band_rect(
+        visible_rect.x(), visible_rect.y() + row, visible_rect.width(),
+        std::min(rows_per_slice, visible_rect.height() - row));
+    scoped_refptr<VideoFrame> band = VideoFrame::WrapVideoFrame(
+        frame, frame->format(), band_rect, band_rect.size());
+    if (!band) {
+      ConvertVideoFrameToRGBPixelsOnThisThread(video_frame, rgb_pixels,
+                                               row_bytes);
+      return;
+    }
+    bands.push_back(band);
+  }
+
+  // Callers, such as SkImageGenerator::GetPixels(), need the pixels when this
+  // returns, so this cannot hand the conversion off and reply later. Any band
+  // no worker has started yet is converted on this thread instead.
+  RunInParallel(bands.size(),
+                base::Bind(&ConvertBand, base::Unretained(&bands),
+                           static_cast<uint8_t*>(rgb_pixels), row_bytes,
+                           rows_per_slice));
+}
+
+// static
+void PaintCanvasVideoRenderer::ConvertHighbitVideoFrameToRGBPixels(
+    const VideoFrame* video_frame,
+    void* rgb_pixels,
+    size_t row_bytes,
+    HighbitRGBFormat format) {
+  const int bits = HighbitDepth(video_frame->format());
+  if (!video_frame->IsMappable() || !bits) {
+    NOTREACHED() << "Only mappable high bit depth YUV frames are supported.";
+    return;
+  }
+
+  // See ITU-R BT.601 and BT.709. JPEG uses the full range of sample values,
+  // other color spaces put luma in [16, 235] and chroma in [16, 240], scaled
+  // up to the bit depth.
+  const float kr = CheckColorSpace(video_frame, COLOR_SPACE_HD_REC709)
+                       ? 0.2126f
+                       : 0.299f;
+  const float kb = CheckColorSpace(video_frame, COLOR_SPACE_HD_REC709)
+                       ? 0.0722f
+                       : 0.114f;
+  const float kg = 1.0f - kr - kb;
+  const float scale = 1 << (bits - 8);
+  HighbitToRGBParams params;
+  params.c_offset = 128 * scale;
+  if (CheckColorSpace(video_frame, COLOR_SPACE_JPEG)) {
+    params.y_offset = 0;
+    params.y_scale = 1.0f / ((1 << bits) - 1);
+    params.c_scale = params.y_scale;
+  } else {
+    params.y_offset = 16 * scale;
+    params.y_scale = 1.0f / (219 * scale);
+    params.c_scale = 1.0f / (224 * scale);
+  }
+  params.r_from_v = 2.0f * (1.0f - kr);
+  params.b_from_u = 2.0f * (1.0f - kb);
+  params.g_from_u = -params.b_from_u * kb / kg;
+  params.g_from_v = -params.r_from_v * kr / kg;
+
+  const gfx::Size chroma_sample =
+      VideoFrame::SampleSize(video_frame->format(), VideoFrame::kUPlane);
+  const int chroma_shift = chroma_sample.width() == 2 ? 1 : 0;
+  const int width = video_frame->visible_rect().width();
+  const int height = video_frame->visible_rect().height();
+  for (int row = 0; row < height; ++row) {
+    const int chroma_row = row / chroma_sample.height();
+    const uint16_t* y_row = reinterpret_cast<const uint16_t*>(
+        video_frame->visible_data(VideoFrame::kYPlane) +
+        row * video_frame->stride(VideoFrame::kYPlane));
+    const uint16_t* u_row = reinterpret_cast<const uint16_t*>(
+        video_frame->visible_data(VideoFrame::kUPlane) +
+        chroma_row * video_frame->stride(VideoFrame::kUPlane));
+    const uint16_t* v_row = reinterpret_cast<const uint16_t*>(
+        video_frame->visible_data(VideoFrame::kVPlane) +
+        chroma_row * video_frame->stride(VideoFrame::kVPlane));
+    uint8_t* out_row = static_cast<uint8_t*>(rgb_pixels) + row * row_bytes;
+    switch (format) {
+      case HighbitRGBFormat::kRGB10A2:
+        ConvertHighbitRow<HighbitRGBFormat::kRGB10A2>(
+            y_row, u_row, v_row, chroma_shift, width, params, out_row);
+        break;
+      case HighbitRGBFormat::kRGBAHalfFloat:
+        ConvertHighbitRow<HighbitRGBFormat::kRGBAHalfFloat>(
+            y_row, u_row, v_row, chroma_shift, width, params, out_row);
+        break;
+    }
+  }
+}
+
 // static
 void PaintCanvasVideoRenderer::CopyVideoFrameSingleTextureToGLTexture(
     gpu::gles2::GLES2Interface* gl,
@@ -61,10 +61,41 @@ class MEDIA_EXPORT PaintCanvasVideoRenderer {
   // Convert the contents of |video_frame| to raw RGB pixels. |rgb_pixels|
   // should point into a buffer large enough to hold as many 32 bit RGBA pixels
   // as are in the visible_rect() area of the frame.
+  // If kParallelVideoFrameToRGB is enabled, large frames are converted in
+  // slices, one per core, see below.
   static void ConvertVideoFrameToRGBPixels(const media::VideoFrame* video_frame,
                                            void* rgb_pixels,
                                            size_t row_bytes);
 
+  // Same as ConvertVideoFrameToRGBPixels(), but splits the visible rect into
+  // at most |max_slices| bands of rows and converts them concurrently, on the
+  // worker pool as well as the calling thread, see RunInParallel(). Frames
+  // too small to be worth splitting use fewer bands. Returns once the whole
+  // frame is converted.
+  static void ConvertVideoFrameToRGBPixelsInSlices(
+      const media::VideoFrame* video_frame,
+      void* rgb_pixels,
+      size_t row_bytes,
+      int max_slices);
+
+  // Pixel formats ConvertHighbitVideoFrameToRGBPixels() can write.
+  enum class HighbitRGBFormat {
+    // 10 bits per color channel and 2 bits of alpha in 32 bits, red in the
+    // lowest bits, as GL_RGB10_A2 with GL_UNSIGNED_INT_2_10_10_10_REV.
+    kRGB10A2,
+    // One half float per channel, as GL_RGBA16F with GL_HALF_FLOAT.
+    kRGBAHalfFloat,
+  };
+
+  // Converts the visible rect of |video_frame|, which must be in a 9-, 10- or
+  // 12-bit YUV format, to opaque RGB pixels of |format| without reducing it to
+  // 8 bits first, for consumers that can keep the extra precision.
+  static void ConvertHighbitVideoFrameToRGBPixels(
+      const media::VideoFrame* video_frame,
+      void* rgb_pixels,
+      size_t row_bytes,
+      HighbitRGBFormat format);
+
   // Copy the visible rect size contents of texture of |video_frame| to
   // texture |texture|. |level|, |internal_format|, |type| specify target
   // texture |texture|. The format of |video_frame| must be
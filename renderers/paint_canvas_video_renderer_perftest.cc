@@ -0,0 +1,147 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/memory/aligned_memory.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/time/time.h"
+#include "media/base/video_frame.h"
+#include "media/renderers/paint_canvas_video_renderer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+#include "ui/gfx/geometry/rect.h"
+#include "ui/gfx/geometry/size.h"
+
+namespace media {
+
+static const int kConversions = 50;
+
+static const gfx::Size kSizes[] = {
+    gfx::Size(640, 360), gfx::Size(1280, 720), gfx::Size(1920, 1080),
+    gfx::Size(3840, 2160),
+};
+
+static const int kSliceCounts[] = {1, 2, 4, 8};
+
+// Converts a |format| frame of |size| to RGB |kConversions| times in at most
+// |max_slices| slices, and reports the time per conversion.
+static void RunConvertBenchmark(VideoPixelFormat format,
+                                const gfx::Size& size,
+                                int max_slices) {
+  scoped_refptr<VideoFrame> frame = VideoFrame::CreateZeroInitializedFrame(
+      format, size, gfx::Rect(size), size, base::TimeDelta());
+  const size_t row_bytes = size.width() * 4;
+  std::unique_ptr<uint8_t, base::AlignedFreeDeleter> rgb_pixels(
+      static_cast<uint8_t*>(base::AlignedAlloc(
+          row_bytes * size.height(), VideoFrame::kFrameAddressAlignment)));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kConversions; ++i) {
+    PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsInSlices(
+        frame.get(), rgb_pixels.get(), row_bytes, max_slices);
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  perf_test::PrintResult(
+      "convert_to_rgb", "_" + VideoPixelFormatToString(format),
+      size.ToString() + "_" + std::to_string(max_slices) + "_slices",
+      elapsed.InMicrosecondsF() / kConversions, "us/frame", true);
+}
+
+TEST(PaintCanvasVideoRendererPerfTest, ConvertVideoFrameToRGBPixels) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  for (const gfx::Size& size : kSizes) {
+    for (int max_slices : kSliceCounts) {
+      RunConvertBenchmark(PIXEL_FORMAT_I420, size, max_slices);
+      RunConvertBenchmark(PIXEL_FORMAT_YUV420P10, size, max_slices);
+    }
+  }
+}
+
+// Converts |frame| to 8-bit I420, the way high bit depth frames used to be
+// converted, then to RGB.
+static void ConvertHighbitInTwoSteps(const VideoFrame* frame,
+                                     void* rgb_pixels,
+                                     size_t row_bytes) {
+  scoped_refptr<VideoFrame> i420_frame = VideoFrame::CreateFrame(
+      PIXEL_FORMAT_I420, frame->coded_size(), frame->visible_rect(),
+      frame->natural_size(), frame->timestamp());
+  for (size_t plane = 0; plane < VideoFrame::NumPlanes(PIXEL_FORMAT_I420);
+       ++plane) {
+    for (int row = 0; row < frame->rows(plane); ++row) {
+      const uint16_t* src = reinterpret_cast<const uint16_t*>(
+          frame->data(plane) + row * frame->stride(plane));
+      uint8_t* dst = i420_frame->data(plane) + row * i420_frame->stride(plane);
+      for (int col = 0; col < i420_frame->row_bytes(plane); ++col)
+        dst[col] = src[col] >> 2;
+    }
+  }
+  PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsInSlices(
+      i420_frame.get(), rgb_pixels, row_bytes, 1);
+}
+
+// Compares converting a 10-bit frame of |size| to 8-bit RGB through a
+// temporary 8-bit frame with converting it directly, and with converting it to
+// the high bit depth RGB formats.
+static void RunHighbitBenchmark(const gfx::Size& size) {
+  scoped_refptr<VideoFrame> frame = VideoFrame::CreateZeroInitializedFrame(
+      PIXEL_FORMAT_YUV420P10, size, gfx::Rect(size), size, base::TimeDelta());
+  const size_t row_bytes = size.width() * 8;
+  std::unique_ptr<uint8_t, base::AlignedFreeDeleter> rgb_pixels(
+      static_cast<uint8_t*>(base::AlignedAlloc(
+          row_bytes * size.height(), VideoFrame::kFrameAddressAlignment)));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kConversions; ++i)
+    ConvertHighbitInTwoSteps(frame.get(), rgb_pixels.get(), row_bytes);
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  perf_test::PrintResult("convert_highbit_to_rgb", "",
+                         size.ToString() + "_two_steps",
+                         elapsed.InMicrosecondsF() / kConversions, "us/frame",
+                         true);
+
+  start = base::TimeTicks::Now();
+  for (int i = 0; i < kConversions; ++i) {
+    PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsInSlices(
+        frame.get(), rgb_pixels.get(), row_bytes, 1);
+  }
+  elapsed = base::TimeTicks::Now() - start;
+  perf_test::PrintResult("convert_highbit_to_rgb", "",
+                         size.ToString() + "_fused",
+                         elapsed.InMicrosecondsF() / kConversions, "us/frame",
+                         true);
+
+  const struct {
+    PaintCanvasVideoRenderer::HighbitRGBFormat format;
+    const char* name;
+  } kFormats[] = {
+      {PaintCanvasVideoRenderer::HighbitRGBFormat::kRGB10A2, "_rgb10a2"},
+      {PaintCanvasVideoRenderer::HighbitRGBFormat::kRGBAHalfFloat,
+       "_rgba_half_float"},
+  };
+  for (const auto& format : kFormats) {
+    start = base::TimeTicks::Now();
+    for (int i = 0; i < kConversions; ++i) {
+      PaintCanvasVideoRenderer::ConvertHighbitVideoFrameToRGBPixels(
+          frame.get(), rgb_pixels.get(), row_bytes, format.format);
+    }
+    elapsed = base::TimeTicks::Now() - start;
+    perf_test::PrintResult("convert_highbit_to_rgb", "",
+                           size.ToString() + format.name,
+                           elapsed.InMicrosecondsF() / kConversions,
+                           "us/frame", true);
+  }
+}
+
+TEST(PaintCanvasVideoRendererPerfTest, ConvertHighbitVideoFrame) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  RunHighbitBenchmark(gfx::Size(1920, 1080));
+  RunHighbitBenchmark(gfx::Size(3840, 2160));
+}
+
+}  // namespace media
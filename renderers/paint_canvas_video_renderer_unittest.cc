@@ -4,10 +4,15 @@
 
 #include <GLES3/gl3.h>
 #include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
-#include "base/message_loop/message_loop.h"
+#include "base/test/scoped_task_environment.h"
 #include "cc/paint/paint_flags.h"
 #include "cc/paint/skia_paint_canvas.h"
 #include "gpu/GLES2/gl2extchromium.h"
@@ -109,7 +114,7 @@ class PaintCanvasVideoRendererTest : public testing::Test {
 
   SkBitmap bitmap_;
   cc::SkiaPaintCanvas target_canvas_;
-  base::MessageLoop message_loop_;
+  base::test::ScopedTaskEnvironment scoped_task_environment_;
 
   DISALLOW_COPY_AND_ASSIGN(PaintCanvasVideoRendererTest);
 };
@@ -628,6 +633,199 @@ void MailboxHoldersReleased(const gpu::SyncToken& sync_token) {}
 
 // Test that PaintCanvasVideoRendererTest::Paint doesn't crash when GrContext is
 // abandoned.
+// Returns a |format| frame whose planes are filled with a pattern that
+// differs in every row and column.
+static scoped_refptr<VideoFrame> CreatePatternFrame(
+    VideoPixelFormat format,
+    const gfx::Size& coded_size,
+    const gfx::Rect& visible_rect) {
+  scoped_refptr<VideoFrame> frame = VideoFrame::CreateFrame(
+      format, coded_size, visible_rect, visible_rect.size(), base::TimeDelta());
+  const bool highbit = format == PIXEL_FORMAT_YUV420P10;
+  for (size_t plane = 0; plane < VideoFrame::NumPlanes(format); ++plane) {
+    for (int row = 0; row < frame->rows(plane); ++row) {
+      uint8_t* data = frame->data(plane) + row * frame->stride(plane);
+      if (highbit) {
+        uint16_t* data16 = reinterpret_cast<uint16_t*>(data);
+        for (int col = 0; col < frame->row_bytes(plane) / 2; ++col)
+          data16[col] = (row * 37 + col * 11 + plane * 101) & 0x3ff;
+      } else {
+        for (int col = 0; col < frame->row_bytes(plane); ++col)
+          data[col] = row * 37 + col * 11 + plane * 101;
+      }
+    }
+  }
+  return frame;
+}
+
+// Converting in slices must give exactly the same pixels as converting on
+// one thread, for every format and color space.
+TEST_F(PaintCanvasVideoRendererTest, ConvertInSlices) {
+  const gfx::Size coded_size(1280, 724);
+  const gfx::Rect visible_rect(2, 2, 1276, 718);
+  const size_t row_bytes = visible_rect.width() * 4 + 16;
+  const VideoPixelFormat kFormats[] = {
+      PIXEL_FORMAT_I420,      PIXEL_FORMAT_YV16, PIXEL_FORMAT_YV12A,
+      PIXEL_FORMAT_YV24,      PIXEL_FORMAT_Y16,  PIXEL_FORMAT_YUV420P10,
+  };
+  const ColorSpace kColorSpaces[] = {COLOR_SPACE_UNSPECIFIED, COLOR_SPACE_JPEG,
+                                     COLOR_SPACE_HD_REC709};
+
+  for (VideoPixelFormat format : kFormats) {
+    for (ColorSpace color_space : kColorSpaces) {
+      SCOPED_TRACE(VideoPixelFormatToString(format) + " " +
+                   std::to_string(color_space));
+      scoped_refptr<VideoFrame> frame =
+          CreatePatternFrame(format, coded_size, visible_rect);
+      frame->metadata()->SetInteger(VideoFrameMetadata::COLOR_SPACE,
+                                    color_space);
+
+      std::vector<uint8_t> expected(row_bytes * visible_rect.height());
+      PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsInSlices(
+          frame.get(), expected.data(), row_bytes, 1);
+      for (int slices : {2, 3, 8}) {
+        std::vector<uint8_t> actual(expected.size());
+        PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsInSlices(
+            frame.get(), actual.data(), row_bytes, slices);
+        EXPECT_EQ(0, memcmp(expected.data(), actual.data(), expected.size()))
+            << slices << " slices";
+      }
+    }
+  }
+}
+
+// High bit depth frames must convert to the same 8-bit pixels as the same
+// frame shifted down to 8 bits.
+TEST_F(PaintCanvasVideoRendererTest, ConvertHighbitLikeEightBit) {
+  const gfx::Size coded_size(336, 204);
+  const gfx::Rect visible_rect(2, 2, 333, 199);
+  const size_t row_bytes = visible_rect.width() * 4;
+  const struct {
+    VideoPixelFormat highbit_format;
+    VideoPixelFormat format;
+    int shift;
+  } kFormats[] = {
+      {PIXEL_FORMAT_YUV420P9, PIXEL_FORMAT_I420, 1},
+      {PIXEL_FORMAT_YUV420P10, PIXEL_FORMAT_I420, 2},
+      {PIXEL_FORMAT_YUV420P12, PIXEL_FORMAT_I420, 4},
+      {PIXEL_FORMAT_YUV422P10, PIXEL_FORMAT_YV16, 2},
+      {PIXEL_FORMAT_YUV444P10, PIXEL_FORMAT_YV24, 2},
+  };
+  const ColorSpace kColorSpaces[] = {COLOR_SPACE_UNSPECIFIED, COLOR_SPACE_JPEG,
+                                     COLOR_SPACE_HD_REC709};
+
+  for (const auto& formats : kFormats) {
+    scoped_refptr<VideoFrame> highbit_frame = VideoFrame::CreateFrame(
+        formats.highbit_format, coded_size, visible_rect, visible_rect.size(),
+        base::TimeDelta());
+    scoped_refptr<VideoFrame> frame =
+        VideoFrame::CreateFrame(formats.format, coded_size, visible_rect,
+                                visible_rect.size(), base::TimeDelta());
+    for (int plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane;
+         ++plane) {
+      for (int row = 0; row < frame->rows(plane); ++row) {
+        uint16_t* src = reinterpret_cast<uint16_t*>(
+            highbit_frame->data(plane) + row * highbit_frame->stride(plane));
+        uint8_t* dst = frame->data(plane) + row * frame->stride(plane);
+        for (int col = 0; col < frame->row_bytes(plane); ++col) {
+          const int sample = (row * 37 + col * 11 + plane * 101) & 0xff;
+          src[col] = (sample << formats.shift) |
+                     (col & ((1 << formats.shift) - 1));
+          dst[col] = src[col] >> formats.shift;
+        }
+      }
+    }
+
+    for (ColorSpace color_space : kColorSpaces) {
+      SCOPED_TRACE(VideoPixelFormatToString(formats.highbit_format) + " " +
+                   std::to_string(color_space));
+      highbit_frame->metadata()->SetInteger(VideoFrameMetadata::COLOR_SPACE,
+                                            color_space);
+      frame->metadata()->SetInteger(VideoFrameMetadata::COLOR_SPACE,
+                                    color_space);
+      std::vector<uint8_t> expected(row_bytes * visible_rect.height());
+      std::vector<uint8_t> actual(expected.size());
+      PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+          frame.get(), expected.data(), row_bytes);
+      PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+          highbit_frame.get(), actual.data(), row_bytes);
+      EXPECT_EQ(0, memcmp(expected.data(), actual.data(), expected.size()));
+    }
+  }
+}
+
+// Returns a 10-bit 4:2:0 |size| frame of a single color.
+static scoped_refptr<VideoFrame> CreateColorFrame10(const gfx::Size& size,
+                                                    uint16_t y,
+                                                    uint16_t u,
+                                                    uint16_t v) {
+  scoped_refptr<VideoFrame> frame =
+      VideoFrame::CreateFrame(PIXEL_FORMAT_YUV420P10, size, gfx::Rect(size),
+                              size, base::TimeDelta());
+  const uint16_t values[] = {y, u, v};
+  for (int plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane; ++plane) {
+    for (int row = 0; row < frame->rows(plane); ++row) {
+      uint16_t* data = reinterpret_cast<uint16_t*>(frame->data(plane) +
+                                                   row * frame->stride(plane));
+      std::fill(data, data + frame->row_bytes(plane) / 2, values[plane]);
+    }
+  }
+  return frame;
+}
+
+TEST_F(PaintCanvasVideoRendererTest, ConvertHighbitToRGB10A2) {
+  const gfx::Size size(16, 8);
+  std::vector<uint32_t> pixels(size.GetArea());
+
+  // Limited range white, black and 50% gray are exact.
+  const struct {
+    uint16_t y;
+    uint32_t rgb10a2;
+  } kColors[] = {{940, 0xffffffff}, {64, 0xc0000000}, {502, 0xe0080200}};
+  for (const auto& color : kColors) {
+    scoped_refptr<VideoFrame> frame =
+        CreateColorFrame10(size, color.y, 512, 512);
+    PaintCanvasVideoRenderer::ConvertHighbitVideoFrameToRGBPixels(
+        frame.get(), pixels.data(), size.width() * 4,
+        PaintCanvasVideoRenderer::HighbitRGBFormat::kRGB10A2);
+    for (uint32_t pixel : pixels)
+      EXPECT_EQ(color.rgb10a2, pixel);
+  }
+
+  // Pure red keeps more than 8 bits of precision: it is 1023 red, with only
+  // rounding error in the other channels.
+  scoped_refptr<VideoFrame> red = CreateColorFrame10(size, 326, 361, 960);
+  PaintCanvasVideoRenderer::ConvertHighbitVideoFrameToRGBPixels(
+      red.get(), pixels.data(), size.width() * 4,
+      PaintCanvasVideoRenderer::HighbitRGBFormat::kRGB10A2);
+  EXPECT_NEAR(1023, pixels[0] & 0x3ff, 2);
+  EXPECT_NEAR(0, (pixels[0] >> 10) & 0x3ff, 2);
+  EXPECT_NEAR(0, (pixels[0] >> 20) & 0x3ff, 2);
+}
+
+TEST_F(PaintCanvasVideoRendererTest, ConvertHighbitToHalfFloat) {
+  const gfx::Size size(16, 8);
+  std::vector<uint16_t> pixels(size.GetArea() * 4);
+  scoped_refptr<VideoFrame> white = CreateColorFrame10(size, 940, 512, 512);
+  PaintCanvasVideoRenderer::ConvertHighbitVideoFrameToRGBPixels(
+      white.get(), pixels.data(), size.width() * 8,
+      PaintCanvasVideoRenderer::HighbitRGBFormat::kRGBAHalfFloat);
+  for (uint16_t channel : pixels)
+    EXPECT_EQ(0x3c00, channel);  // 1.0
+
+  // Full range mid gray is 512 / 1023, just above half float 0.5 (0x3800).
+  scoped_refptr<VideoFrame> gray = CreateColorFrame10(size, 512, 512, 512);
+  gray->metadata()->SetInteger(VideoFrameMetadata::COLOR_SPACE,
+                               COLOR_SPACE_JPEG);
+  PaintCanvasVideoRenderer::ConvertHighbitVideoFrameToRGBPixels(
+      gray.get(), pixels.data(), size.width() * 8,
+      PaintCanvasVideoRenderer::HighbitRGBFormat::kRGBAHalfFloat);
+  EXPECT_EQ(0x3801, pixels[0]);
+  EXPECT_EQ(0x3801, pixels[1]);
+  EXPECT_EQ(0x3801, pixels[2]);
+  EXPECT_EQ(0x3c00, pixels[3]);
+}
+
 TEST_F(PaintCanvasVideoRendererTest, ContextLost) {
   sk_sp<const GrGLInterface> null_interface(GrGLCreateNullInterface());
   sk_sp<GrContext> gr_context(GrContext::Create(
@@ -0,0 +1,173 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/renderers/video_decode_ahead_controller.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/sys_info.h"
+#include "media/base/limits.h"
+
+namespace media {
+
+namespace {
+
+// Frames buffered until decode times have been measured.
+const size_t kInitialFrames = limits::kMaxVideoFrames;
+
+// Bounds on the number of buffered frames. The minimum is one frame on screen
+// and one ready to replace it.
+const size_t kMinFrames = 2;
+const size_t kMaxFrames = 16;
+
+// Weight of a new sample in the decode time statistics. It is low enough that
+// a burst of slow decodes doesn't look like decoding can't keep up.
+const double kSampleWeight = 1.0 / 64;
+
+// Standard deviations of decode time jitter to buffer for.
+const double kDeviations = 2.0;
+
+// The peak backlog decays by this factor for every decoded frame, so that a
+// burst keeps the queue deep for several seconds after it.
+const double kBacklogDecayPerFrame = 0.995;
+
+// Each underflow grows the depth by this factor, up to kMaxStallFactor. The
+// factor decays back towards 1 for every decoded frame.
+const double kStallGrowth = 1.5;
+const double kMaxStallFactor = 4.0;
+const double kStallDecayPerFrame = 0.998;
+
+// The default memory budget is this fraction of the physical memory, within
+// these bounds.
+const int64_t kPhysicalMemoryDivisor = 64;
+const size_t kMinMemoryBudget = 32 << 20;   // 32 MB
+const size_t kMaxMemoryBudget = 256 << 20;  // 256 MB
+
+}  // namespace
+
+VideoDecodeAheadController::VideoDecodeAheadController(size_t memory_budget)
+    : memory_budget_(memory_budget),
+      memory_pressure_level_(
+          base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE),
+      frame_size_(0),
+      has_samples_(false),
+      mean_(0),
+      variance_(0),
+      backlog_(0),
+      peak_backlog_(0),
+      stall_factor_(1.0),
+      buffered_frames_(kInitialFrames),
+      max_decode_requests_(1) {}
+
+VideoDecodeAheadController::~VideoDecodeAheadController() {}
+
+// static
+size_t VideoDecodeAheadController::DefaultMemoryBudget() {
+  const int64_t budget =
+      base::SysInfo::AmountOfPhysicalMemory() / kPhysicalMemoryDivisor;
+  return std::max<int64_t>(
+      std::min<int64_t>(budget, kMaxMemoryBudget), kMinMemoryBudget);
+}
+
+void VideoDecodeAheadController::SetFrameDuration(
+    base::TimeDelta frame_duration) {
+  frame_duration_ = frame_duration;
+}
+
+void VideoDecodeAheadController::SetFrameSize(size_t frame_size) {
+  frame_size_ = frame_size;
+}
+
+void VideoDecodeAheadController::SetMemoryPressureLevel(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  memory_pressure_level_ = level;
+}
+
+void VideoDecodeAheadController::OnFrameDecoded(
+    base::TimeDelta decode_duration) {
+  const double sample = decode_duration.InMicrosecondsF();
+  if (!has_samples_) {
+    has_samples_ = true;
+    mean_ = sample;
+  } else {
+    const double delta = sample - mean_;
+    mean_ += kSampleWeight * delta;
+    variance_ =
+        (1 - kSampleWeight) * (variance_ + kSampleWeight * delta * delta);
+  }
+
+  if (!frame_duration_.is_zero()) {
+    backlog_ = std::max(
+        0.0, backlog_ + sample - frame_duration_.InMicrosecondsF());
+  }
+  peak_backlog_ = std::max(peak_backlog_ * kBacklogDecayPerFrame, backlog_);
+  stall_factor_ = std::max(1.0, stall_factor_ * kStallDecayPerFrame);
+}
+
+void VideoDecodeAheadController::OnUnderflow() {
+  stall_factor_ = std::min(stall_factor_ * kStallGrowth, kMaxStallFactor);
+}
+
+void VideoDecodeAheadController::Reset() {
+  backlog_ = 0;
+}
+
+bool VideoDecodeAheadController::UpdateDepth() {
+  double frames = kInitialFrames;
+  if (has_samples_ && !frame_duration_.is_zero()) {
+    const double frame_duration = frame_duration_.InMicrosecondsF();
+
+    // If decoding can't keep up on average, no depth rides out the backlog;
+    // only buffer for the jitter then.
+    double cover = kDeviations * std::sqrt(variance_);
+    if (mean_ < frame_duration)
+      cover += peak_backlog_;
+    frames = kMinFrames + std::round(cover / frame_duration);
+  }
+
+  size_t buffered_frames = std::min(
+      static_cast<size_t>(std::ceil(frames * stall_factor_)), kMaxFrames);
+  const size_t memory_limited_frames = this->memory_limited_frames();
+  buffered_frames = std::max(
+      std::min(buffered_frames, memory_limited_frames), kMinFrames);
+  if (memory_pressure_level_ ==
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL) {
+    buffered_frames = kMinFrames;
+  }
+
+  const int max_decode_requests = std::max<int>(
+      1, static_cast<int>(memory_limited_frames) -
+             static_cast<int>(buffered_frames));
+
+  const bool changed = buffered_frames != buffered_frames_ ||
+                       max_decode_requests != max_decode_requests_;
+  buffered_frames_ = buffered_frames;
+  max_decode_requests_ = max_decode_requests;
+  return changed;
+}
+
+size_t VideoDecodeAheadController::memory_limited_frames() const {
+  if (!frame_size_)
+    return kMaxFrames;
+  size_t memory_budget = memory_budget_;
+  if (memory_pressure_level_ !=
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+    memory_budget /= 2;
+  }
+  return std::min(memory_budget / frame_size_, kMaxFrames);
+}
+
+base::TimeDelta VideoDecodeAheadController::mean_decode_duration() const {
+  return base::TimeDelta::FromMicroseconds(static_cast<int64_t>(mean_));
+}
+
+base::TimeDelta VideoDecodeAheadController::decode_duration_deviation() const {
+  return base::TimeDelta::FromMicroseconds(
+      static_cast<int64_t>(std::sqrt(variance_)));
+}
+
+}  // namespace media
@@ -0,0 +1,104 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_RENDERERS_VIDEO_DECODE_AHEAD_CONTROLLER_H_
+#define MEDIA_RENDERERS_VIDEO_DECODE_AHEAD_CONTROLLER_H_
+
+#include <stddef.h>
+
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/time/time.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// Sizes how far ahead of playback video is decoded, from what it measures,
+// rather than from fixed frame counts.
+//
+// The controller tracks the mean and variance of the time it takes to decode
+// a frame, and the backlog that bursts of slow decodes build up against the
+// frame duration. It buffers enough frames to ride out both, so a fast and
+// steady decoder runs with a shallow queue while a bursty one gets a deep one.
+// The depth is capped by a memory budget divided by the size of a frame, so
+// that large frames are not over-buffered on devices with little memory. Each
+// underflow makes the controller more cautious for a while.
+//
+// All methods must be called on the same thread.
+class MEDIA_EXPORT VideoDecodeAheadController {
+ public:
+  // |memory_budget| is in bytes, for all the decoded frames of the stream.
+  explicit VideoDecodeAheadController(size_t memory_budget);
+  ~VideoDecodeAheadController();
+
+  // Returns a memory budget scaled to the physical memory of the device.
+  static size_t DefaultMemoryBudget();
+
+  void SetFrameDuration(base::TimeDelta frame_duration);
+
+  // Size in bytes of a decoded frame.
+  void SetFrameSize(size_t frame_size);
+
+  // Moderate pressure halves the memory budget, critical pressure keeps the
+  // queue at its minimum.
+  void SetMemoryPressureLevel(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  // Called with the time it took to get each decoded frame.
+  void OnFrameDecoded(base::TimeDelta decode_duration);
+
+  // Called when playback ran out of frames.
+  void OnUnderflow();
+
+  // Called on seek. The backlog is cleared, but the statistics are kept.
+  void Reset();
+
+  // Recomputes the depth. Returns true if it changed.
+  bool UpdateDepth();
+
+  // Number of decoded frames to queue ahead of playback.
+  size_t buffered_frames() const { return buffered_frames_; }
+
+  // Number of decodes that may be in flight, or decoded but not yet queued,
+  // within what is left of the memory budget.
+  int max_decode_requests() const { return max_decode_requests_; }
+
+  // Number of frames the memory budget allows, at the current frame size.
+  size_t memory_limited_frames() const;
+
+  // Measured decode time statistics, zero until measured.
+  base::TimeDelta mean_decode_duration() const;
+  base::TimeDelta decode_duration_deviation() const;
+
+  // Factor by which the depth is currently grown because of underflows.
+  double stall_factor() const { return stall_factor_; }
+
+ private:
+  const size_t memory_budget_;
+  base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level_;
+
+  base::TimeDelta frame_duration_;
+  size_t frame_size_;
+
+  // Running mean and variance of decode times, in microseconds.
+  bool has_samples_;
+  double mean_;
+  double variance_;
+
+  // Time decoding is behind playback after the slow decodes so far, and the
+  // slowly decaying peak of it, in microseconds.
+  double backlog_;
+  double peak_backlog_;
+
+  double stall_factor_;
+
+  size_t buffered_frames_;
+  int max_decode_requests_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoDecodeAheadController);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_RENDERERS_VIDEO_DECODE_AHEAD_CONTROLLER_H_
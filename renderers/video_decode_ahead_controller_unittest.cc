@@ -0,0 +1,237 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/time/time.h"
+#include "media/base/limits.h"
+#include "media/renderers/video_decode_ahead_controller.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+const size_t k4KFrameSize = 3840 * 2160 * 3 / 2;
+const size_t kMemoryBudget = 128 << 20;  // 128 MB, ten 4K frames.
+
+const int kFrameCount = 3 * 60 * 30;  // Three minutes at 30 fps.
+constexpr base::TimeDelta kFrameDuration =
+    base::TimeDelta::FromMicroseconds(33333);
+
+struct SimulationResult {
+  int dropped_frames;
+  double mean_resident_bytes;
+  int64_t peak_resident_bytes;
+};
+
+class VideoDecodeAheadControllerTest : public testing::Test {
+ public:
+  VideoDecodeAheadControllerTest() : controller_(kMemoryBudget) {}
+
+  // Plays kFrameCount frames of |frame_size| bytes, frame i taking
+  // |decode_time| to decode. Frames are decoded one at a time, as software
+  // decoders do, while fewer than the queue depth are resident: the depth of
+  // a VideoDecodeAheadController if |adaptive| is set, or the old fixed limits
+  // of VideoRendererImpl otherwise, which start at limits::kMaxVideoFrames and
+  // grow by one on each underflow, up to twice that. Playback starts once the
+  // queue is full, and frames decoded after their display time are dropped.
+  SimulationResult Simulate(
+      bool adaptive,
+      size_t frame_size,
+      const base::Callback<base::TimeDelta(int)>& decode_time) {
+    VideoDecodeAheadController controller(kMemoryBudget);
+    controller.SetFrameDuration(kFrameDuration);
+    controller.SetFrameSize(frame_size);
+    controller.UpdateDepth();
+
+    size_t fixed_frames = limits::kMaxVideoFrames;
+    size_t depth = adaptive ? controller.buffered_frames() : fixed_frames;
+
+    SimulationResult result = {0, 0.0, 0};
+    const int64_t frame_us = kFrameDuration.InMicroseconds();
+    bool started = false;
+    base::TimeDelta start_time;
+    base::TimeDelta decoded_time;
+    bool underflowed = false;
+    for (int i = 0; i < kFrameCount; ++i) {
+      if (!started && static_cast<size_t>(i) >= depth) {
+        started = true;
+        start_time = decoded_time;
+      }
+
+      // Wait until a frame leaves the queue if it is full.
+      base::TimeDelta decode_start = decoded_time;
+      const int64_t frame_to_leave = i + 1 - static_cast<int64_t>(depth);
+      if (started && frame_to_leave >= 0) {
+        decode_start = std::max(decode_start,
+                                start_time + kFrameDuration * frame_to_leave);
+      }
+      const base::TimeDelta duration = decode_time.Run(i);
+      decoded_time = decode_start + duration;
+      controller.OnFrameDecoded(duration);
+
+      size_t resident = i + 1;
+      if (started) {
+        if (decoded_time > start_time + kFrameDuration * i) {
+          result.dropped_frames++;
+          if (!underflowed) {
+            underflowed = true;
+            controller.OnUnderflow();
+            fixed_frames = std::min<size_t>(fixed_frames + 1,
+                                            2 * limits::kMaxVideoFrames);
+          }
+        } else {
+          underflowed = false;
+        }
+
+        // Frames past their display time are gone, but for the one on screen.
+        const int64_t elapsed_us = (decoded_time - start_time).InMicroseconds();
+        const int64_t passed = (elapsed_us + frame_us - 1) / frame_us;
+        resident = std::max<int64_t>(0, i + 1 - passed) + 1;
+      }
+      result.mean_resident_bytes +=
+          static_cast<double>(resident * frame_size) / kFrameCount;
+      result.peak_resident_bytes = std::max<int64_t>(
+          result.peak_resident_bytes, resident * frame_size);
+
+      controller.UpdateDepth();
+      depth = adaptive ? controller.buffered_frames() : fixed_frames;
+    }
+    return result;
+  }
+
+  void Report(const std::string& name, const SimulationResult& result) {
+    RecordProperty(name + "_dropped_frames", result.dropped_frames);
+    RecordProperty(name + "_mean_resident_kb",
+                   static_cast<int>(result.mean_resident_bytes / 1024));
+    RecordProperty(name + "_peak_resident_kb",
+                   static_cast<int>(result.peak_resident_bytes / 1024));
+  }
+
+  void DecodeFrames(int count, base::TimeDelta decode_duration) {
+    for (int i = 0; i < count; ++i)
+      controller_.OnFrameDecoded(decode_duration);
+  }
+
+ protected:
+  VideoDecodeAheadController controller_;
+};
+
+// Between 15 and 21 ms.
+static base::TimeDelta SteadyDecodeTime(int frame) {
+  return base::TimeDelta::FromMicroseconds(15000 + (frame * 7919) % 6000);
+}
+
+// Steady, but for a 20 second scene from 20 seconds in, where a burst of eight
+// frames takes 70 ms each to decode every two seconds.
+static base::TimeDelta ComplexSceneDecodeTime(int frame) {
+  if (frame >= 20 * 30 && frame < 40 * 30 && frame % 60 < 8)
+    return base::TimeDelta::FromMilliseconds(70);
+  return SteadyDecodeTime(frame);
+}
+
+TEST_F(VideoDecodeAheadControllerTest, DefaultsBeforeMeasuring) {
+  EXPECT_TRUE(controller_.UpdateDepth());
+  EXPECT_EQ(static_cast<size_t>(limits::kMaxVideoFrames),
+            controller_.buffered_frames());
+  EXPECT_EQ(base::TimeDelta(), controller_.mean_decode_duration());
+  EXPECT_FALSE(controller_.UpdateDepth());
+}
+
+TEST_F(VideoDecodeAheadControllerTest, SteadyDecodesUseShallowQueue) {
+  controller_.SetFrameDuration(kFrameDuration);
+  DecodeFrames(100, base::TimeDelta::FromMilliseconds(15));
+  controller_.UpdateDepth();
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(15),
+            controller_.mean_decode_duration());
+  EXPECT_EQ(2u, controller_.buffered_frames());
+}
+
+TEST_F(VideoDecodeAheadControllerTest, BurstsDeepenQueue) {
+  controller_.SetFrameDuration(kFrameDuration);
+  DecodeFrames(100, base::TimeDelta::FromMilliseconds(15));
+
+  // Five 70 ms decodes put decoding more than five frames behind.
+  DecodeFrames(5, base::TimeDelta::FromMilliseconds(70));
+  controller_.UpdateDepth();
+  EXPECT_GE(controller_.buffered_frames(), 8u);
+  EXPECT_GT(controller_.decode_duration_deviation(), base::TimeDelta());
+
+  // The queue gets shallow again once bursts stop.
+  DecodeFrames(1000, base::TimeDelta::FromMilliseconds(15));
+  controller_.UpdateDepth();
+  EXPECT_EQ(2u, controller_.buffered_frames());
+}
+
+TEST_F(VideoDecodeAheadControllerTest, UnderflowsGrowQueue) {
+  controller_.OnUnderflow();
+  EXPECT_EQ(1.5, controller_.stall_factor());
+  controller_.UpdateDepth();
+  EXPECT_EQ(static_cast<size_t>(limits::kMaxVideoFrames * 3 / 2),
+            controller_.buffered_frames());
+
+  for (int i = 0; i < 10; ++i)
+    controller_.OnUnderflow();
+  EXPECT_EQ(4.0, controller_.stall_factor());
+}
+
+TEST_F(VideoDecodeAheadControllerTest, MemoryBudgetCapsQueue) {
+  controller_.SetFrameDuration(kFrameDuration);
+  controller_.SetFrameSize(k4KFrameSize);
+  EXPECT_EQ(10u, controller_.memory_limited_frames());
+
+  DecodeFrames(100, base::TimeDelta::FromMilliseconds(15));
+  DecodeFrames(10, base::TimeDelta::FromMilliseconds(70));
+  controller_.UpdateDepth();
+  EXPECT_EQ(10u, controller_.buffered_frames());
+  EXPECT_EQ(1, controller_.max_decode_requests());
+
+  controller_.SetMemoryPressureLevel(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  controller_.UpdateDepth();
+  EXPECT_EQ(5u, controller_.buffered_frames());
+
+  controller_.SetMemoryPressureLevel(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  controller_.UpdateDepth();
+  EXPECT_EQ(2u, controller_.buffered_frames());
+  EXPECT_EQ(3, controller_.max_decode_requests());
+}
+
+TEST_F(VideoDecodeAheadControllerTest, SteadyDecoderBuffersFewerFrames) {
+  SimulationResult fixed =
+      Simulate(false, k4KFrameSize, base::Bind(&SteadyDecodeTime));
+  SimulationResult adaptive =
+      Simulate(true, k4KFrameSize, base::Bind(&SteadyDecodeTime));
+  Report("fixed", fixed);
+  Report("adaptive", adaptive);
+
+  EXPECT_EQ(0, fixed.dropped_frames);
+  EXPECT_EQ(0, adaptive.dropped_frames);
+  EXPECT_LT(adaptive.mean_resident_bytes, fixed.mean_resident_bytes * 0.6);
+  EXPECT_LT(adaptive.peak_resident_bytes, fixed.peak_resident_bytes);
+}
+
+TEST_F(VideoDecodeAheadControllerTest, ComplexSceneDropsFewerFrames) {
+  SimulationResult fixed =
+      Simulate(false, k4KFrameSize, base::Bind(&ComplexSceneDecodeTime));
+  SimulationResult adaptive =
+      Simulate(true, k4KFrameSize, base::Bind(&ComplexSceneDecodeTime));
+  Report("fixed", fixed);
+  Report("adaptive", adaptive);
+
+  // The fixed limits learn slowly, and then keep eight frames for good. The
+  // controller deepens the queue as soon as it sees a burst, within its
+  // budget, and makes it shallow again after the scene.
+  EXPECT_LT(adaptive.dropped_frames, fixed.dropped_frames / 2);
+  EXPECT_LT(adaptive.mean_resident_bytes, fixed.mean_resident_bytes * 0.7);
+  EXPECT_LE(adaptive.peak_resident_bytes, static_cast<int64_t>(kMemoryBudget));
+}
+
+}  // namespace media
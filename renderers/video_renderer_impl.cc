@@ -149,6 +149,10 @@ VideoRendererImpl::VideoRendererImpl(
       weak_factory_(this),
       frame_callback_weak_factory_(this) {
   DCHECK(create_video_decoders_cb_);
+  if (base::FeatureList::IsEnabled(kAdaptiveVideoDecodeAhead)) {
+    decode_ahead_controller_.reset(new VideoDecodeAheadController(
+        VideoDecodeAheadController::DefaultMemoryBudget()));
+  }
 }
 
 VideoRendererImpl::~VideoRendererImpl() {
@@ -203,6 +207,14 @@ void VideoRendererImpl::Flush(const base::Closure& callback) {
   // Reset preroll capacity so seek time is not penalized.
   min_buffered_frames_ = max_buffered_frames_ = limits::kMaxVideoFrames;
   read_durations_.Reset();
+  if (decode_ahead_controller_) {
+    // The controller's depth is never zero, even when a single frame is over
+    // the memory budget; zero would keep the renderer from reading at all.
+    decode_ahead_controller_->Reset();
+    min_buffered_frames_ = max_buffered_frames_ =
+        std::min(min_buffered_frames_,
+                 decode_ahead_controller_->buffered_frames());
+  }
 }
 
 void VideoRendererImpl::StartPlayingFrom(base::TimeDelta timestamp) {
@@ -409,6 +421,11 @@ void VideoRendererImpl::SetGpuMemoryBufferVideoForTesting(
   gpu_memory_buffer_pool_.swap(gpu_memory_buffer_pool);
 }
 
+void VideoRendererImpl::SetDecodeAheadControllerForTesting(
+    std::unique_ptr<VideoDecodeAheadController> decode_ahead_controller) {
+  decode_ahead_controller_.swap(decode_ahead_controller);
+}
+
 void VideoRendererImpl::OnTimeProgressing() {
   DCHECK(task_runner_->BelongsToCurrentThread());
 
@@ -459,7 +476,10 @@ void VideoRendererImpl::OnTimeStopped() {
     // If we've underflowed, increase the number of frames required to reach
     // BUFFERING_HAVE_ENOUGH upon resume; this will help prevent us from
     // repeatedly underflowing.
-    if (use_complexity_based_buffering_) {
+    if (decode_ahead_controller_) {
+      // The controller grows the depth on the next UpdateMaxBufferedFrames().
+      decode_ahead_controller_->OnUnderflow();
+    } else if (use_complexity_based_buffering_) {
       if (min_buffered_frames_ < max_buffered_frames_) {
         min_buffered_frames_ = max_buffered_frames_;
         DVLOG(2) << "Increased min buffered frames to " << min_buffered_frames_;
@@ -514,7 +534,8 @@ void VideoRendererImpl::FrameReady(base::TimeTicks read_time,
     return;
   }
 
-  read_durations_.AddSample(tick_clock_->NowTicks() - read_time);
+  const base::TimeDelta read_duration = tick_clock_->NowTicks() - read_time;
+  read_durations_.AddSample(read_duration);
 
   UMA_HISTOGRAM_ENUMERATION("Media.VideoFrame.ColorSpace",
                             ColorSpaceUMAHelper(frame->ColorSpace()),
@@ -545,6 +566,11 @@ void VideoRendererImpl::FrameReady(base::TimeTicks read_time,
     }
 
     AddReadyFrame_Locked(frame);
+    if (decode_ahead_controller_) {
+      decode_ahead_controller_->OnFrameDecoded(read_duration);
+      decode_ahead_controller_->SetFrameSize(
+          VideoFrame::AllocationSize(frame->format(), frame->coded_size()));
+    }
     UpdateMaxBufferedFrames();
   }
 
@@ -622,7 +648,7 @@ bool VideoRendererImpl::HaveEnoughData_Locked(
   if (received_end_of_stream_)
     return true;
 
-  if (use_complexity_based_buffering_) {
+  if (use_complexity_based_buffering_ || decode_ahead_controller_) {
     if (algorithm_->effective_frames_queued() >= min_buffered_frames_)
       return true;
   } else if (HaveReachedBufferingCap()) {
@@ -780,7 +806,7 @@ void VideoRendererImpl::UpdateStats_Locked() {
 bool VideoRendererImpl::HaveReachedBufferingCap() const {
   DCHECK(task_runner_->BelongsToCurrentThread());
 
-  if (use_complexity_based_buffering_)
+  if (use_complexity_based_buffering_ || decode_ahead_controller_)
     return algorithm_->effective_frames_queued() >= max_buffered_frames_;
 
   // When the display rate is less than the frame rate, the effective frames
@@ -933,6 +959,11 @@ void VideoRendererImpl::AttemptReadAndCheckForMetadataChanges(
 }
 
 void VideoRendererImpl::UpdateMaxBufferedFrames() {
+  if (decode_ahead_controller_) {
+    UpdateDecodeAheadDepth();
+    return;
+  }
+
   if (!use_complexity_based_buffering_)
     return;
 
@@ -1005,4 +1036,42 @@ void VideoRendererImpl::UpdateMaxBufferedFrames() {
   max_buffered_frames_ = max_buffered_frames;
 }
 
+void VideoRendererImpl::UpdateDecodeAheadDepth() {
+  DCHECK(decode_ahead_controller_);
+
+  decode_ahead_controller_->SetFrameDuration(
+      algorithm_->average_frame_duration());
+  if (auto* monitor = base::MemoryPressureMonitor::Get()) {
+    decode_ahead_controller_->SetMemoryPressureLevel(
+        monitor->GetCurrentPressureLevel());
+  }
+
+  // Read durations while background rendering don't reflect what playback
+  // needs, since frames are expired in bulk; keep the current depth.
+  if (was_background_rendering_)
+    return;
+
+  if (!decode_ahead_controller_->UpdateDepth())
+    return;
+
+  const size_t buffered_frames = decode_ahead_controller_->buffered_frames();
+  if (max_buffered_frames_ != buffered_frames) {
+    MEDIA_LOG(INFO, media_log_)
+        << "Updating decode-ahead depth to " << buffered_frames
+        << ", average frame duration: "
+        << algorithm_->average_frame_duration().InMillisecondsF()
+        << "ms, mean read duration: "
+        << decode_ahead_controller_->mean_decode_duration().InMillisecondsF()
+        << "ms, deviation: "
+        << decode_ahead_controller_->decode_duration_deviation()
+               .InMillisecondsF()
+        << "ms, memory limit: "
+        << decode_ahead_controller_->memory_limited_frames() << " frames.";
+  }
+
+  min_buffered_frames_ = max_buffered_frames_ = buffered_frames;
+  video_frame_stream_->set_max_decode_ahead(
+      decode_ahead_controller_->max_decode_requests());
+}
+
 }  // namespace media
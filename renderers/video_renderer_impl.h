@@ -28,6 +28,7 @@
 #include "media/filters/decoder_stream.h"
 #include "media/filters/video_renderer_algorithm.h"
 #include "media/renderers/default_renderer_factory.h"
+#include "media/renderers/video_decode_ahead_controller.h"
 #include "media/video/gpu_memory_buffer_video_frame_pool.h"
 #include "media/video/gpu_video_accelerator_factories.h"
 
@@ -76,6 +77,8 @@ class MEDIA_EXPORT VideoRendererImpl
   void SetTickClockForTesting(std::unique_ptr<base::TickClock> tick_clock);
   void SetGpuMemoryBufferVideoForTesting(
       std::unique_ptr<GpuMemoryBufferVideoFramePool> gpu_memory_buffer_pool);
+  void SetDecodeAheadControllerForTesting(
+      std::unique_ptr<VideoDecodeAheadController> decode_ahead_controller);
   size_t frames_queued_for_testing() const {
     return algorithm_->frames_queued();
   }
@@ -209,6 +212,10 @@ class MEDIA_EXPORT VideoRendererImpl
   // |max_read_duration_|, and |time_progressing_|.
   void UpdateMaxBufferedFrames();
 
+  // Feeds |decode_ahead_controller_| and applies the depth it computes to the
+  // buffered frame limits and to |video_frame_stream_|.
+  void UpdateDecodeAheadDepth();
+
   scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
 
   // Sink which calls into VideoRendererImpl via Render() for video frames.  Do
@@ -346,10 +353,17 @@ class MEDIA_EXPORT VideoRendererImpl
   //
   // During an underflow event, the minimum is set to the maximum. Any increases
   // are reset upon Flush() to avoid Seek() penalties.
+  //
+  // With |decode_ahead_controller_|, both are set to the depth it computes.
   size_t min_buffered_frames_;
   size_t max_buffered_frames_;
   MovingAverage read_durations_;
 
+  // Sizes the frame queue and the decodes in flight from the measured read
+  // durations, the frame size and a memory budget. Only set when the adaptive
+  // decode-ahead experiment is enabled.
+  std::unique_ptr<VideoDecodeAheadController> decode_ahead_controller_;
+
   // Indicates that the playback has been ongoing for at least
   // limits::kMinimumElapsedWatchTimeSecs.
   bool has_playback_met_watch_time_duration_requirement_;
@@ -15,6 +15,7 @@
 #include "base/macros.h"
 #include "base/memory/memory_pressure_listener.h"
 #include "base/memory/memory_pressure_monitor.h"
+#include "base/memory/ptr_util.h"
 #include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
 #include "base/single_thread_task_runner.h"
@@ -34,6 +35,7 @@
 #include "media/base/test_helpers.h"
 #include "media/base/video_frame.h"
 #include "media/base/wall_clock_time_source.h"
+#include "media/renderers/video_decode_ahead_controller.h"
 #include "media/renderers/video_renderer_impl.h"
 #include "media/video/mock_gpu_memory_buffer_video_frame_pool.h"
 #include "testing/gmock_mutant.h"
@@ -1004,6 +1006,45 @@ TEST_F(VideoRendererImplTest, ComplexityBasedBufferingUnderflow) {
 }
 
 // Verify that a late decoder response doesn't break invariants in the renderer.
+// Frames larger than the whole decode-ahead memory budget must not keep the
+// renderer from buffering after a seek.
+TEST_F(VideoRendererImplTest, DecodeAheadSeekWithOversizedFrames) {
+  const size_t kFrameSize = VideoFrame::AllocationSize(
+      PIXEL_FORMAT_YV12, TestVideoConfig::NormalCodedSize());
+  renderer_->SetDecodeAheadControllerForTesting(
+      base::MakeUnique<VideoDecodeAheadController>(kFrameSize / 2));
+  Initialize();
+  QueueFrames("0 10 20 30");
+
+  {
+    WaitableMessageLoopEvent event;
+    EXPECT_CALL(mock_cb_, FrameReceived(HasTimestampMatcher(0)));
+    EXPECT_CALL(mock_cb_, OnBufferingStateChange(BUFFERING_HAVE_ENOUGH))
+        .WillOnce(RunClosure(event.GetClosure()));
+    EXPECT_CALL(mock_cb_, OnStatisticsUpdate(_)).Times(AnyNumber());
+    EXPECT_CALL(mock_cb_, OnVideoNaturalSizeChange(_)).Times(1);
+    EXPECT_CALL(mock_cb_, OnVideoOpacityChange(_)).Times(1);
+    StartPlayingFrom(0);
+    event.RunAndWait();
+  }
+
+  EXPECT_CALL(mock_cb_, OnBufferingStateChange(BUFFERING_HAVE_NOTHING));
+  Flush();
+  EXPECT_GT(renderer_->min_buffered_frames_for_testing(), 0u);
+  EXPECT_GT(renderer_->max_buffered_frames_for_testing(), 0u);
+
+  QueueFrames("100 110 120 130");
+  {
+    WaitableMessageLoopEvent event;
+    EXPECT_CALL(mock_cb_, FrameReceived(HasTimestampMatcher(100)));
+    EXPECT_CALL(mock_cb_, OnBufferingStateChange(BUFFERING_HAVE_ENOUGH))
+        .WillOnce(RunClosure(event.GetClosure()));
+    StartPlayingFrom(100);
+    event.RunAndWait();
+  }
+  Destroy();
+}
+
 TEST_F(VideoRendererImplTest, DestroyDuringOutstandingRead) {
   Initialize();
   QueueFrames("0 10 20 30");